@@ -27,9 +27,17 @@
 /* Maximum MMS PDU SIZE - default is 65000 */
 #cmakedefine CONFIG_MMS_MAXIMUM_PDU_SIZE @CONFIG_MMS_MAXIMUM_PDU_SIZE@
 
+/* number of receive buffers of a MMS client connection (each of CONFIG_MMS_MAXIMUM_PDU_SIZE).
+ * Incoming messages are received into a free buffer while older messages are still processed. */
+#define CONFIG_MMS_CLIENT_RECEIVE_BUFFERS 4
+
 /* number of concurrent MMS client connections the server accepts, -1 for no limit */
 #cmakedefine CONFIG_MAXIMUM_TCP_CLIENT_CONNECTIONS @CONFIG_MAXIMUM_TCP_CLIENT_CONNECTIONS@
 
+/* number of messages (reports, command termination) queued per MMS server connection before the overflow policy
+ * applies. Queued messages are sent by a separate thread per connection. 0 -> send without queue */
+#define CONFIG_ISO_SERVER_SEND_QUEUE_SIZE 16
+
 /* activate TCP keep alive mechanism. 1 -> activate */
 #cmakedefine01 CONFIG_ACTIVATE_TCP_KEEPALIVE
 
@@ -52,6 +60,9 @@
 #define CONFIG_ETHERNET_INTERFACE_ID "eth0"
 //#define CONFIG_ETHERNET_INTERFACE_ID "vboxnet0"
 
+/* Set to 1 to include the AF_XDP Ethernet backend (Linux only, interface ID "xdp:<interface>[:<queue>]") */
+#cmakedefine01 CONFIG_ETHERNET_USE_AF_XDP
+
 /* Set to 1 to include GOOSE support in the build. Otherwise set to 0 */
 #cmakedefine01 CONFIG_INCLUDE_GOOSE_SUPPORT
 
@@ -92,6 +103,9 @@
 /* Default destination MAC address for GOOSE */
 #define CONFIG_GOOSE_DEFAULT_DST_ADDRESS {0x01, 0x0c, 0xcd, 0x01, 0x00, 0x01}
 
+/* Maximum time in ms the GOOSE publisher waits for the transmit timestamp (if timestamping is enabled) */
+#define CONFIG_GOOSE_TX_TIMESTAMP_TIMEOUT 1
+
 /* include support for IEC 61850 control services */
 #cmakedefine01 CONFIG_IEC61850_CONTROL_SERVICE
 
@@ -115,6 +129,30 @@
 /* Maximum number of open file per MMS connection (for MMS file read service) */
 #define CONFIG_MMS_MAX_NUMBER_OF_OPEN_FILES_PER_CONNECTION 5
 
+/* Number of free buffers per size class kept by the send buffer pool of a MMS connection (for information reports) */
+#define CONFIG_MMS_SERVER_BUFFER_POOL_SIZE 2
+
+/* collect per service request counters and latency histograms in the MMS server. 0 -> compile out */
+#define CONFIG_MMS_SERVER_METRICS 1
+
+/* binary trace of the protocol stack (see trace.h). 0 -> compile out */
+#define CONFIG_TRACE 1
+
+/* Number of records of the trace ring of each thread (has to be a power of two - each record uses 32 byte) */
+#define CONFIG_TRACE_RING_SIZE 1024
+
+/* Maximum number of threads with an own trace ring (additional threads share a single ring) */
+#define CONFIG_TRACE_MAX_THREADS 32
+
+/* Number of directory listings cached for the MMS file directory service (shared by all connections) */
+#define CONFIG_MMS_FILE_DIRECTORY_SNAPSHOTS 4
+
+/* Maximum age of a cached directory listing in ms (directory changes are also detected by the modification time) */
+#define CONFIG_MMS_FILE_DIRECTORY_SNAPSHOT_MAX_AGE 5000
+
+/* Map files into memory for the MMS file read service (Linux). Files must not be truncated while they are read! */
+#define CONFIG_FILESYSTEM_USE_MMAP 0
+
 /* Definition of supported services */
 #define MMS_DEFAULT_PROFILE 1
 
@@ -0,0 +1,144 @@
+/*
+ * goose_benchmark.c
+ *
+ * Measures the number of GOOSE messages per second that can be published with
+ * GoosePublisher_publish and parsed by a GooseSubscriber.
+ *
+ * By default the in-process loopback bus of the Ethernet HAL is used. So no network
+ * interface and no root privileges are required.
+ *
+ * Usage: goose_benchmark [<interface-id>] [<number of messages>]
+ *
+ *   e.g. goose_benchmark loopback:bench 100000
+ *        goose_benchmark pcap-record:goose.pcap 1000   (only publish to a pcap file)
+ */
+
+#include "goose_publisher.h"
+#include "goose_subscriber.h"
+#include "thread.h"
+#include "hal.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/* maximum number of messages in flight - has to be smaller than the loopback queue size */
+#define MAX_OUTSTANDING_MESSAGES 200
+
+/* the remaining messages are considered lost when nothing is received for this time */
+#define RECEIVE_TIMEOUT_MS 1000
+
+static volatile int receivedMessages = 0;
+
+static void
+gooseListener(GooseSubscriber subscriber, void* parameter)
+{
+    receivedMessages++;
+}
+
+/* returns false when the messages are not received before the timeout */
+static bool
+waitForMessages(int expectedMessages)
+{
+    int lastReceived = receivedMessages;
+    uint64_t deadline = Hal_getMonotonicTimeInNs() + (RECEIVE_TIMEOUT_MS * 1000000ULL);
+
+    while (receivedMessages < expectedMessages) {
+        if (receivedMessages != lastReceived) {
+            lastReceived = receivedMessages;
+            deadline = Hal_getMonotonicTimeInNs() + (RECEIVE_TIMEOUT_MS * 1000000ULL);
+        }
+        else if (Hal_getMonotonicTimeInNs() > deadline)
+            return false;
+
+        Thread_sleep(0);
+    }
+
+    return true;
+}
+
+int
+main(int argc, char** argv)
+{
+    char* interfaceId = "loopback:bench";
+    int numberOfMessages = 100000;
+
+    if (argc > 1)
+        interfaceId = argv[1];
+
+    if (argc > 2)
+        numberOfMessages = atoi(argv[2]);
+
+    bool waitForSubscriber = (strncmp(interfaceId, "loopback", 8) == 0);
+
+    GooseSubscriber subscriber = NULL;
+
+    if (waitForSubscriber) {
+        subscriber = GooseSubscriber_create("bench/LLN0$GO$gcb01", NULL);
+
+        GooseSubscriber_setInterfaceId(subscriber, interfaceId);
+        GooseSubscriber_setAppId(subscriber, 0x1000);
+        GooseSubscriber_setListener(subscriber, gooseListener, NULL);
+        GooseSubscriber_subscribe(subscriber);
+
+        /* give the receiver thread time to connect to the bus */
+        Thread_sleep(100);
+    }
+
+    LinkedList dataSetValues = LinkedList_create();
+
+    LinkedList_add(dataSetValues, MmsValue_newIntegerFromInt32(1234));
+    LinkedList_add(dataSetValues, MmsValue_newBoolean(true));
+    LinkedList_add(dataSetValues, MmsValue_newFloat(0.5f));
+    LinkedList_add(dataSetValues, MmsValue_newUtcTimeByMsTime(Hal_getTimeInMs()));
+
+    GoosePublisher publisher = GoosePublisher_create(NULL, interfaceId);
+
+    if (publisher == NULL) {
+        printf("Failed to create GOOSE publisher for %s\n", interfaceId);
+        return -1;
+    }
+
+    GoosePublisher_setGoCbRef(publisher, "bench/LLN0$GO$gcb01");
+    GoosePublisher_setDataSetRef(publisher, "bench/LLN0$dataset01");
+    GoosePublisher_setConfRev(publisher, 1);
+    GoosePublisher_setTimeAllowedToLive(publisher, 500);
+
+    uint64_t startTime = Hal_getTimeInNs();
+
+    int i;
+
+    for (i = 0; i < numberOfMessages; i++) {
+
+        if (waitForSubscriber) {
+            if (waitForMessages(i - MAX_OUTSTANDING_MESSAGES + 1) == false)
+                break;
+        }
+
+        if (GoosePublisher_publish(publisher, dataSetValues) == -1) {
+            printf("Error sending message!\n");
+            break;
+        }
+    }
+
+    /* i is the number of published messages */
+    if (waitForSubscriber)
+        waitForMessages(i);
+
+    uint64_t duration = Hal_getTimeInNs() - startTime;
+
+    printf("%i messages in %.3f ms -> %.0f messages/s\n", i, (double) duration / 1000000.0,
+            (double) i * 1000000000.0 / (double) duration);
+
+    if (waitForSubscriber && (receivedMessages < i))
+        printf("%i messages lost\n", i - receivedMessages);
+
+    GoosePublisher_destroy(publisher);
+
+    if (subscriber != NULL)
+        GooseSubscriber_destroy(subscriber);
+
+    LinkedList_destroyDeep(dataSetValues, (LinkedListValueDeleteFunction) MmsValue_delete);
+
+    return 0;
+}
@@ -0,0 +1,195 @@
+/*
+ * mms_dataset_benchmark.c
+ *
+ * Measures the round trip times of the dynamic data set services (MMS DefineNamedVariableList,
+ * GetNamedVariableListAttributes and DeleteNamedVariableList) and of data set reads for data sets
+ * of different sizes.
+ *
+ * The server runs in the same process with a data model that is created at runtime. Client and
+ * server communicate over the loopback interface.
+ *
+ * Usage: mms_dataset_benchmark [<number of cycles>] [<tcp port>]
+ */
+
+#include "iec61850_server.h"
+#include "iec61850_client.h"
+#include "hal.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#define MAX_DATA_SET_SIZE 500
+
+/* the data set is read several times before it is deleted */
+#define READS_PER_CYCLE 10
+
+static int dataSetSizes[] = { 10, 50, 100, 250, 500 };
+
+static LinkedList
+createDataSetElements(int size)
+{
+    LinkedList elements = LinkedList_create();
+
+    int i;
+
+    for (i = 0; i < size; i++) {
+        char* elementRef = (char*) malloc(130);
+
+        sprintf(elementRef, "BENCH/GGIO1.AnIn%i.mag.f[MX]", i + 1);
+
+        LinkedList_add(elements, elementRef);
+    }
+
+    return elements;
+}
+
+int
+main(int argc, char** argv)
+{
+    int cycles = 200;
+    int tcpPort = 10102;
+
+    if (argc > 1)
+        cycles = atoi(argv[1]);
+
+    if (argc > 2)
+        tcpPort = atoi(argv[2]);
+
+    IedModel* model = IedModel_create("bench");
+
+    LogicalDevice* lDevice = LogicalDevice_create("BENCH", model);
+
+    LogicalNode* lln0 = LogicalNode_create("LLN0", lDevice);
+    CDC_ENS_create("Mod", (ModelNode*) lln0, 0);
+
+    LogicalNode* ggio1 = LogicalNode_create("GGIO1", lDevice);
+
+    int i;
+
+    for (i = 0; i < MAX_DATA_SET_SIZE; i++) {
+        char doName[20];
+
+        sprintf(doName, "AnIn%i", i + 1);
+
+        CDC_MV_create(doName, (ModelNode*) ggio1, 0, false);
+    }
+
+    IedServer iedServer = IedServer_create(model);
+
+    IedServer_start(iedServer, tcpPort);
+
+    if (!IedServer_isRunning(iedServer)) {
+        printf("Starting server failed! Exit.\n");
+        IedServer_destroy(iedServer);
+        IedModel_destroy(model);
+        return -1;
+    }
+
+    IedClientError error;
+
+    IedConnection con = IedConnection_create();
+
+    IedConnection_connect(con, &error, "localhost", tcpPort);
+
+    if (error != IED_ERROR_OK) {
+        printf("Failed to connect to localhost:%i\n", tcpPort);
+        goto exit_server;
+    }
+
+    printf("%i cycles per data set size - average round trip times in us\n", cycles);
+    printf("members      define   directory        read      delete\n");
+
+    int sizeIndex;
+
+    for (sizeIndex = 0; sizeIndex < (int) (sizeof(dataSetSizes) / sizeof(int)); sizeIndex++) {
+        int size = dataSetSizes[sizeIndex];
+
+        LinkedList elements = createDataSetElements(size);
+
+        uint64_t defineTime = 0;
+        uint64_t directoryTime = 0;
+        uint64_t readTime = 0;
+        uint64_t deleteTime = 0;
+
+        for (i = 0; i < cycles; i++) {
+            uint64_t startTime = Hal_getTimeInNs();
+
+            IedConnection_createDataSet(con, &error, "BENCH/LLN0.benchDataSet", elements);
+
+            uint64_t defineEndTime = Hal_getTimeInNs();
+
+            if (error != IED_ERROR_OK) {
+                printf("Failed to create data set (error %i)\n", error);
+                break;
+            }
+
+            LinkedList directory = IedConnection_getDataSetDirectory(con, &error,
+                    "BENCH/LLN0.benchDataSet", NULL);
+
+            uint64_t directoryEndTime = Hal_getTimeInNs();
+
+            if ((error != IED_ERROR_OK) || (LinkedList_size(directory) != size)) {
+                printf("Failed to get data set directory (error %i)\n", error);
+                break;
+            }
+
+            LinkedList_destroy(directory);
+
+            ClientDataSet dataSet = NULL;
+
+            int j;
+
+            for (j = 0; j < READS_PER_CYCLE; j++) {
+                dataSet = IedConnection_readDataSetValues(con, &error, "BENCH/LLN0.benchDataSet", dataSet);
+
+                if (error != IED_ERROR_OK)
+                    break;
+            }
+
+            uint64_t readEndTime = Hal_getTimeInNs();
+
+            if (error != IED_ERROR_OK) {
+                printf("Failed to read data set (error %i)\n", error);
+                break;
+            }
+
+            ClientDataSet_destroy(dataSet);
+
+            IedConnection_deleteDataSet(con, &error, "BENCH/LLN0.benchDataSet");
+
+            uint64_t deleteEndTime = Hal_getTimeInNs();
+
+            if (error != IED_ERROR_OK) {
+                printf("Failed to delete data set (error %i)\n", error);
+                break;
+            }
+
+            defineTime += defineEndTime - startTime;
+            directoryTime += directoryEndTime - defineEndTime;
+            readTime += readEndTime - directoryEndTime;
+            deleteTime += deleteEndTime - readEndTime;
+        }
+
+        LinkedList_destroy(elements);
+
+        if (i < cycles)
+            break;
+
+        printf("%7i  %10.1f  %10.1f  %10.1f  %10.1f\n", size,
+                (double) defineTime / (cycles * 1000.0),
+                (double) directoryTime / (cycles * 1000.0),
+                (double) readTime / (cycles * READS_PER_CYCLE * 1000.0),
+                (double) deleteTime / (cycles * 1000.0));
+    }
+
+    IedConnection_close(con);
+
+exit_server:
+    IedConnection_destroy(con);
+
+    IedServer_stop(iedServer);
+    IedServer_destroy(iedServer);
+    IedModel_destroy(model);
+
+    return 0;
+}
@@ -0,0 +1,187 @@
+/*
+ * mms_metrics_benchmark.c
+ *
+ * Measures the overhead of the MMS server metrics (see CONFIG_MMS_SERVER_METRICS). A client reads
+ * a single value in a loop. Rounds with enabled and disabled metrics collection alternate. The
+ * fastest round of each mode is used to determine the overhead. Single value reads are the
+ * cheapest requests of the server, so the relative overhead is an upper bound for other services.
+ *
+ * At the end the metrics snapshot of the server is printed.
+ *
+ * The server runs in the same process. Client and server communicate over the loopback interface.
+ *
+ * Usage: mms_metrics_benchmark [<reads per round>] [<rounds>] [<tcp port>]
+ */
+
+#include "iec61850_server.h"
+#include "iec61850_client.h"
+#include "hal.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+static uint64_t
+measureRound(IedConnection con, int reads)
+{
+    IedClientError error;
+
+    uint64_t startTime = Hal_getMonotonicTimeInNs();
+
+    int i;
+
+    for (i = 0; i < reads; i++) {
+        IedConnection_readFloatValue(con, &error, "BENCH/GGIO1.AnIn1.mag.f", MX);
+
+        if (error != IED_ERROR_OK) {
+            printf("Read failed (error %i)\n", error);
+            return 0;
+        }
+    }
+
+    return Hal_getMonotonicTimeInNs() - startTime;
+}
+
+static void
+printMetrics(MmsServerMetrics* metrics)
+{
+    printf("service                         requests  errors  bytes in  bytes out  queue(us)  avg(us)  p50(us)  p99(us) p99.9(us)\n");
+
+    int i;
+
+    for (i = 0; i < MMS_SERVER_SERVICE_COUNT; i++) {
+        MmsServiceMetrics* service = &(metrics->services[i]);
+
+        if (service->requests == 0)
+            continue;
+
+        printf("%-30s %9llu %7llu %9llu %10llu %10.2f %8.2f %8.2f %8.2f %9.2f\n",
+                MmsServerService_getName((MmsServerService) i),
+                (unsigned long long) service->requests,
+                (unsigned long long) service->errors,
+                (unsigned long long) service->bytesIn,
+                (unsigned long long) service->bytesOut,
+                (double) service->queueingDelay / (service->requests * 1000.0),
+                (double) service->processingTime / (service->requests * 1000.0),
+                MmsServiceMetrics_getLatencyPercentile(service, 50.0) / 1000.0,
+                MmsServiceMetrics_getLatencyPercentile(service, 99.0) / 1000.0,
+                MmsServiceMetrics_getLatencyPercentile(service, 99.9) / 1000.0);
+    }
+}
+
+int
+main(int argc, char** argv)
+{
+    int reads = 5000;
+    int rounds = 10;
+    int tcpPort = 10102;
+
+    if (argc > 1)
+        reads = atoi(argv[1]);
+
+    if (argc > 2)
+        rounds = atoi(argv[2]);
+
+    if (argc > 3)
+        tcpPort = atoi(argv[3]);
+
+    IedModel* model = IedModel_create("bench");
+
+    LogicalDevice* lDevice = LogicalDevice_create("BENCH", model);
+
+    LogicalNode* lln0 = LogicalNode_create("LLN0", lDevice);
+    CDC_ENS_create("Mod", (ModelNode*) lln0, 0);
+
+    LogicalNode* ggio1 = LogicalNode_create("GGIO1", lDevice);
+    CDC_MV_create("AnIn1", (ModelNode*) ggio1, 0, false);
+
+    IedServer iedServer = IedServer_create(model);
+
+    IedServer_start(iedServer, tcpPort);
+
+    if (!IedServer_isRunning(iedServer)) {
+        printf("Starting server failed! Exit.\n");
+        IedServer_destroy(iedServer);
+        IedModel_destroy(model);
+        return -1;
+    }
+
+    MmsServer mmsServer = IedServer_getMmsServer(iedServer);
+
+    MmsServerMetrics* metrics = (MmsServerMetrics*) malloc(sizeof(MmsServerMetrics));
+
+    bool metricsAvailable = IedServer_getMetrics(iedServer, metrics);
+
+    if (!metricsAvailable)
+        printf("Metrics are compiled out (CONFIG_MMS_SERVER_METRICS == 0)!\n");
+
+    IedClientError error;
+
+    IedConnection con = IedConnection_create();
+
+    IedConnection_connect(con, &error, "localhost", tcpPort);
+
+    if (error != IED_ERROR_OK) {
+        printf("Failed to connect to localhost:%i\n", tcpPort);
+        goto exit_server;
+    }
+
+    /* warm up */
+    measureRound(con, reads);
+
+    uint64_t bestTimeEnabled = 0;
+    uint64_t bestTimeDisabled = 0;
+
+    printf("%i rounds of %i reads - average round trip times in us\n", rounds, reads);
+    printf("round     enabled    disabled\n");
+
+    int roundIndex;
+
+    for (roundIndex = 0; roundIndex < rounds; roundIndex++) {
+        MmsServer_enableMetrics(mmsServer, true);
+
+        uint64_t timeEnabled = measureRound(con, reads);
+
+        MmsServer_enableMetrics(mmsServer, false);
+
+        uint64_t timeDisabled = measureRound(con, reads);
+
+        if ((timeEnabled == 0) || (timeDisabled == 0))
+            goto exit_connection;
+
+        if ((bestTimeEnabled == 0) || (timeEnabled < bestTimeEnabled))
+            bestTimeEnabled = timeEnabled;
+
+        if ((bestTimeDisabled == 0) || (timeDisabled < bestTimeDisabled))
+            bestTimeDisabled = timeDisabled;
+
+        printf("%5i  %10.2f  %10.2f\n", roundIndex + 1, (double) timeEnabled / (reads * 1000.0),
+                (double) timeDisabled / (reads * 1000.0));
+    }
+
+    MmsServer_enableMetrics(mmsServer, true);
+
+    double overhead = ((double) bestTimeEnabled - (double) bestTimeDisabled) * 100.0 / (double) bestTimeDisabled;
+
+    printf("\nbest round: enabled %.2f us, disabled %.2f us per read -> metrics overhead %.2f%%\n\n",
+            (double) bestTimeEnabled / (reads * 1000.0), (double) bestTimeDisabled / (reads * 1000.0),
+            overhead);
+
+    if (metricsAvailable) {
+        IedServer_getMetrics(iedServer, metrics);
+        printMetrics(metrics);
+    }
+
+exit_connection:
+    IedConnection_close(con);
+
+exit_server:
+    IedConnection_destroy(con);
+
+    free(metrics);
+
+    IedServer_stop(iedServer);
+    IedServer_destroy(iedServer);
+    IedModel_destroy(model);
+
+    return 0;
+}
@@ -0,0 +1,265 @@
+/*
+ * trace_decoder.c
+ *
+ * Converts a trace dump (written by Trace_dump or by the crash handler installed with
+ * Trace_installCrashHandler) to text. The records of all threads are merged and sorted by
+ * their time stamps.
+ *
+ * The dump contains the format strings of the events. So the decoder doesn't depend on the
+ * library version that has written the dump.
+ *
+ * Usage: trace_decoder <dump file>
+ *
+ * Output: <time since first record in us> <thread> <event>
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TRACE_DUMP_VERSION 1
+
+typedef struct {
+    uint64_t timestamp;
+    uint16_t eventId;
+    uint16_t argCount;
+    uint32_t sequenceNumber;
+    uint32_t args[4];
+} TraceRecord;
+
+typedef struct {
+    uint32_t category;
+    char* format;
+} TraceEvent;
+
+typedef struct {
+    TraceRecord record;
+    uint32_t threadNumber;
+} DecodedRecord;
+
+static bool
+readUint32(FILE* file, uint32_t* value)
+{
+    return (fread(value, sizeof(uint32_t), 1, file) == 1);
+}
+
+static int
+compareRecords(const void* a, const void* b)
+{
+    const DecodedRecord* recordA = (const DecodedRecord*) a;
+    const DecodedRecord* recordB = (const DecodedRecord*) b;
+
+    if (recordA->record.timestamp < recordB->record.timestamp)
+        return -1;
+
+    if (recordA->record.timestamp > recordB->record.timestamp)
+        return 1;
+
+    if (recordA->threadNumber != recordB->threadNumber)
+        return (recordA->threadNumber < recordB->threadNumber) ? -1 : 1;
+
+    if (recordA->record.sequenceNumber != recordB->record.sequenceNumber)
+        return (recordA->record.sequenceNumber < recordB->record.sequenceNumber) ? -1 : 1;
+
+    return 0;
+}
+
+/* print the event - only the conversions d, i, u, x, X and c are accepted */
+static void
+printEvent(TraceEvent* event, TraceRecord* record)
+{
+    const char* format = event->format;
+    int argIndex = 0;
+
+    while (*format != 0) {
+        if (*format != '%') {
+            putchar(*format++);
+            continue;
+        }
+
+        if (format[1] == '%') {
+            putchar('%');
+            format += 2;
+            continue;
+        }
+
+        char conversion[16];
+        int length = 0;
+
+        conversion[length++] = *format++;
+
+        while ((*format != 0) && (strchr("-+ 0#", *format) != NULL) && (length < 8))
+            conversion[length++] = *format++;
+
+        while ((*format >= '0') && (*format <= '9') && (length < 12))
+            conversion[length++] = *format++;
+
+        if ((*format == 0) || (strchr("diuxXc", *format) == NULL)) {
+            /* unsupported conversion - print as is */
+            fwrite(conversion, 1, length, stdout);
+            continue;
+        }
+
+        conversion[length++] = *format++;
+        conversion[length] = 0;
+
+        if (argIndex >= record->argCount) {
+            printf("<missing>");
+            continue;
+        }
+
+        uint32_t value = record->args[argIndex++];
+
+        switch (conversion[length - 1]) {
+        case 'd':
+        case 'i':
+            printf(conversion, (int) (int32_t) value);
+            break;
+        case 'c':
+            printf(conversion, (int) (value & 0xff));
+            break;
+        default:
+            printf(conversion, (unsigned int) value);
+            break;
+        }
+    }
+
+    putchar('\n');
+}
+
+int
+main(int argc, char** argv)
+{
+    if (argc < 2) {
+        printf("Usage: trace_decoder <dump file>\n");
+        return 1;
+    }
+
+    FILE* file = fopen(argv[1], "rb");
+
+    if (file == NULL) {
+        printf("Cannot open %s\n", argv[1]);
+        return 1;
+    }
+
+    int retVal = 1;
+
+    TraceEvent* events = NULL;
+    DecodedRecord* records = NULL;
+    uint32_t eventCount = 0;
+    uint32_t recordCount = 0;
+    uint32_t droppedRecords = 0;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint32_t ringCount;
+    uint32_t i;
+
+    if ((fread(magic, 1, 8, file) != 8) || (memcmp(magic, "IECTRACE", 8) != 0)) {
+        printf("%s is not a trace dump\n", argv[1]);
+        goto exit_function;
+    }
+
+    if (!readUint32(file, &version) || !readUint32(file, &recordSize) || !readUint32(file, &eventCount)
+            || !readUint32(file, &ringCount))
+        goto exit_format_error;
+
+    if ((version != TRACE_DUMP_VERSION) || (recordSize != sizeof(TraceRecord))) {
+        printf("Unsupported dump version %u (record size %u)\n", version, recordSize);
+        goto exit_function;
+    }
+
+    events = (TraceEvent*) calloc(eventCount, sizeof(TraceEvent));
+
+    for (i = 0; i < eventCount; i++) {
+        uint32_t formatLength;
+
+        if (!readUint32(file, &(events[i].category)) || !readUint32(file, &formatLength))
+            goto exit_format_error;
+
+        events[i].format = (char*) malloc(formatLength + 1);
+
+        if (fread(events[i].format, 1, formatLength, file) != formatLength)
+            goto exit_format_error;
+
+        events[i].format[formatLength] = 0;
+    }
+
+    uint32_t ringIndex;
+
+    for (ringIndex = 0; ringIndex < ringCount; ringIndex++) {
+        uint32_t threadNumber, previousThreadNumber, firstSequenceNumber, head, ringRecordCount;
+
+        if (!readUint32(file, &threadNumber) || !readUint32(file, &previousThreadNumber)
+                || !readUint32(file, &firstSequenceNumber) || !readUint32(file, &head)
+                || !readUint32(file, &ringRecordCount))
+            goto exit_format_error;
+
+        records = (DecodedRecord*) realloc(records, (recordCount + ringRecordCount) * sizeof(DecodedRecord));
+
+        uint32_t expectedSequenceNumber = head - ringRecordCount;
+
+        for (i = 0; i < ringRecordCount; i++, expectedSequenceNumber++) {
+            DecodedRecord* decoded = &(records[recordCount]);
+
+            if (fread(&(decoded->record), sizeof(TraceRecord), 1, file) != 1)
+                goto exit_format_error;
+
+            /* the record has been overwritten while the dump was created */
+            if ((decoded->record.sequenceNumber != expectedSequenceNumber) ||
+                    (decoded->record.eventId >= eventCount) || (decoded->record.argCount > 4)) {
+                droppedRecords++;
+                continue;
+            }
+
+            if ((expectedSequenceNumber - firstSequenceNumber) < (head - firstSequenceNumber))
+                decoded->threadNumber = threadNumber;
+            else
+                decoded->threadNumber = previousThreadNumber;
+
+            recordCount++;
+        }
+    }
+
+    if (recordCount > 0)
+        qsort(records, recordCount, sizeof(DecodedRecord), compareRecords);
+
+    for (i = 0; i < recordCount; i++) {
+        DecodedRecord* decoded = &(records[i]);
+
+        printf("%14.3f  ", (double) (decoded->record.timestamp - records[0].record.timestamp) / 1000.0);
+
+        if (decoded->threadNumber == 0)
+            printf("T--  ");
+        else
+            printf("T%-3u ", decoded->threadNumber);
+
+        printEvent(&(events[decoded->record.eventId]), &(decoded->record));
+    }
+
+    if (droppedRecords > 0)
+        printf("(%u inconsistent records dropped)\n", droppedRecords);
+
+    retVal = 0;
+    goto exit_function;
+
+exit_format_error:
+    printf("Unexpected end of dump file\n");
+
+exit_function:
+    if (events != NULL) {
+        for (i = 0; i < eventCount; i++)
+            free(events[i].format);
+
+        free(events);
+    }
+
+    free(records);
+
+    fclose(file);
+
+    return retVal;
+}
@@ -0,0 +1,133 @@
+/*
+ *  atomic_operations.h
+ *
+ *  Minimal set of atomic operations used for lock-free data exchange between threads
+ *
+ *  Copyright 2014 Michael Zillgith
+ *
+ *	This file is part of libIEC61850.
+ *
+ *	libIEC61850 is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	libIEC61850 is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with libIEC61850.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *	See COPYING file for the complete license text.
+ */
+
+#ifndef ATOMIC_OPERATIONS_H_
+#define ATOMIC_OPERATIONS_H_
+
+#include <stdint.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
+/*
+ * All operations are sequentially consistent. They are intended for single
+ * values that are handed over between threads (buffer indices, counters).
+ */
+
+#if defined(__GNUC__)
+
+static inline int32_t
+Atomic_exchange32(volatile int32_t* ptr, int32_t value)
+{
+    return __atomic_exchange_n(ptr, value, __ATOMIC_SEQ_CST);
+}
+
+static inline int32_t
+Atomic_load32(volatile int32_t* ptr)
+{
+    return __atomic_load_n(ptr, __ATOMIC_SEQ_CST);
+}
+
+static inline void
+Atomic_store32(volatile int32_t* ptr, int32_t value)
+{
+    __atomic_store_n(ptr, value, __ATOMIC_SEQ_CST);
+}
+
+/* store that only orders the preceding writes (publish data to a reader) */
+static inline void
+Atomic_storeRelease32(volatile int32_t* ptr, int32_t value)
+{
+    __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+static inline uint32_t
+Atomic_add32(volatile uint32_t* ptr, uint32_t value)
+{
+    return __atomic_add_fetch(ptr, value, __ATOMIC_SEQ_CST);
+}
+
+static inline uint64_t
+Atomic_add64(volatile uint64_t* ptr, uint64_t value)
+{
+    return __atomic_add_fetch(ptr, value, __ATOMIC_SEQ_CST);
+}
+
+static inline uint64_t
+Atomic_load64(volatile uint64_t* ptr)
+{
+    return __atomic_load_n(ptr, __ATOMIC_SEQ_CST);
+}
+
+#elif defined(_WIN32)
+
+static inline int32_t
+Atomic_exchange32(volatile int32_t* ptr, int32_t value)
+{
+    return (int32_t) InterlockedExchange((volatile LONG*) ptr, (LONG) value);
+}
+
+static inline int32_t
+Atomic_load32(volatile int32_t* ptr)
+{
+    return (int32_t) InterlockedCompareExchange((volatile LONG*) ptr, 0, 0);
+}
+
+static inline void
+Atomic_store32(volatile int32_t* ptr, int32_t value)
+{
+    InterlockedExchange((volatile LONG*) ptr, (LONG) value);
+}
+
+static inline void
+Atomic_storeRelease32(volatile int32_t* ptr, int32_t value)
+{
+    InterlockedExchange((volatile LONG*) ptr, (LONG) value);
+}
+
+static inline uint32_t
+Atomic_add32(volatile uint32_t* ptr, uint32_t value)
+{
+    return (uint32_t) InterlockedExchangeAdd((volatile LONG*) ptr, (LONG) value) + value;
+}
+
+static inline uint64_t
+Atomic_add64(volatile uint64_t* ptr, uint64_t value)
+{
+    return (uint64_t) InterlockedExchangeAdd64((volatile LONGLONG*) ptr, (LONGLONG) value) + value;
+}
+
+static inline uint64_t
+Atomic_load64(volatile uint64_t* ptr)
+{
+    return (uint64_t) InterlockedCompareExchange64((volatile LONGLONG*) ptr, 0, 0);
+}
+
+#else
+#error "atomic operations are not supported for this platform/compiler"
+#endif
+
+#endif /* ATOMIC_OPERATIONS_H_ */
@@ -0,0 +1,497 @@
+/*
+ *  trace.c
+ *
+ *  Copyright 2013 Michael Zillgith
+ *
+ *  This file is part of libIEC61850.
+ *
+ *  libIEC61850 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libIEC61850 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libIEC61850.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  See COPYING file for the complete license text.
+ */
+
+#include "libiec61850_platform_includes.h"
+#include "stack_config.h"
+#include "trace.h"
+#include "hal.h"
+
+#ifndef CONFIG_TRACE_RING_SIZE
+#define CONFIG_TRACE_RING_SIZE 1024
+#endif
+
+#ifndef CONFIG_TRACE_MAX_THREADS
+#define CONFIG_TRACE_MAX_THREADS 32
+#endif
+
+#if (CONFIG_TRACE == 1)
+
+#if ((CONFIG_TRACE_RING_SIZE & (CONFIG_TRACE_RING_SIZE - 1)) != 0)
+#error "CONFIG_TRACE_RING_SIZE has to be a power of two"
+#endif
+
+#include "atomic_operations.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#define TRACE_THREAD_LOCAL __declspec(thread)
+#else
+#include <pthread.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define TRACE_THREAD_LOCAL __thread
+#endif
+
+#define TRACE_DUMP_VERSION 1
+
+/* the layout of a record is part of the dump format (32 byte) */
+typedef struct {
+    uint64_t timestamp; /* monotonic time in ns */
+    uint16_t eventId;
+    uint16_t argCount;
+    uint32_t sequenceNumber; /* position in the ring - identifies overwritten records in a dump */
+    uint32_t args[4];
+} TraceRecord;
+
+typedef struct {
+    volatile int32_t head; /* sequence number of the next record */
+    volatile int32_t inUse; /* the ring is owned by a running thread */
+    bool shared;
+    uint32_t threadNumber; /* owner of the records starting with firstSequenceNumber */
+    uint32_t previousThreadNumber; /* owner of the older records */
+    uint32_t firstSequenceNumber;
+    TraceRecord records[CONFIG_TRACE_RING_SIZE];
+} TraceRing;
+
+volatile uint32_t private_Trace_categories = 0;
+
+/* the last ring is shared by the threads that didn't get an own ring */
+static TraceRing* rings[CONFIG_TRACE_MAX_THREADS + 1];
+
+static volatile int32_t ringsLock = 0;
+
+static uint32_t nextThreadNumber = 1;
+
+static TRACE_THREAD_LOCAL TraceRing* threadRing = NULL;
+
+static char crashDumpFileName[256];
+
+static const char* eventFormats[] = {
+#define TRACE_EVENT(id, category, format) format,
+#include "trace_events.h"
+#undef TRACE_EVENT
+};
+
+static const uint32_t eventCategories[] = {
+#define TRACE_EVENT(id, category, format) category,
+#include "trace_events.h"
+#undef TRACE_EVENT
+};
+
+/* rings of terminated threads are released for reuse */
+
+#if defined(_WIN32)
+
+static DWORD ringFlsIndex = FLS_OUT_OF_INDEXES;
+
+static VOID WINAPI
+releaseRing(PVOID ring)
+{
+    if (ring != NULL)
+        Atomic_store32(&(((TraceRing*) ring)->inUse), 0);
+}
+
+/* has to be called with ringsLock */
+static void
+registerRingOwner(TraceRing* ring)
+{
+    if (ringFlsIndex == FLS_OUT_OF_INDEXES)
+        ringFlsIndex = FlsAlloc(releaseRing);
+
+    if (ringFlsIndex != FLS_OUT_OF_INDEXES)
+        FlsSetValue(ringFlsIndex, ring);
+}
+
+#else
+
+static pthread_key_t ringKey;
+static bool ringKeyCreated = false;
+
+static void
+releaseRing(void* ring)
+{
+    Atomic_store32(&(((TraceRing*) ring)->inUse), 0);
+}
+
+/* has to be called with ringsLock */
+static void
+registerRingOwner(TraceRing* ring)
+{
+    if (ringKeyCreated == false)
+        ringKeyCreated = (pthread_key_create(&ringKey, releaseRing) == 0);
+
+    if (ringKeyCreated)
+        pthread_setspecific(ringKey, ring);
+}
+
+#endif /* defined(_WIN32) */
+
+static void
+lockRings(void)
+{
+    while (Atomic_exchange32(&ringsLock, 1) != 0)
+        ;
+}
+
+static void
+unlockRings(void)
+{
+    Atomic_store32(&ringsLock, 0);
+}
+
+static TraceRing*
+acquireRing(void)
+{
+    TraceRing* ring = NULL;
+
+    lockRings();
+
+    int i;
+
+    for (i = 0; i < CONFIG_TRACE_MAX_THREADS; i++) {
+        if (rings[i] == NULL) {
+            rings[i] = (TraceRing*) calloc(1, sizeof(TraceRing));
+            ring = rings[i];
+            break;
+        }
+
+        if (Atomic_load32(&(rings[i]->inUse)) == 0) {
+            ring = rings[i];
+            break;
+        }
+    }
+
+    if (ring != NULL) {
+        ring->previousThreadNumber = ring->threadNumber;
+        ring->firstSequenceNumber = (uint32_t) ring->head;
+        ring->threadNumber = nextThreadNumber++;
+        ring->inUse = 1;
+
+        registerRingOwner(ring);
+    }
+    else {
+        if (rings[CONFIG_TRACE_MAX_THREADS] == NULL) {
+            rings[CONFIG_TRACE_MAX_THREADS] = (TraceRing*) calloc(1, sizeof(TraceRing));
+
+            if (rings[CONFIG_TRACE_MAX_THREADS] != NULL)
+                rings[CONFIG_TRACE_MAX_THREADS]->shared = true;
+        }
+
+        ring = rings[CONFIG_TRACE_MAX_THREADS];
+    }
+
+    unlockRings();
+
+    threadRing = ring;
+
+    return ring;
+}
+
+void
+Trace_record(TraceEventId event, int argCount, uint32_t arg0, uint32_t arg1, uint32_t arg2, uint32_t arg3)
+{
+    TraceRing* ring = threadRing;
+
+    if (ring == NULL) {
+        ring = acquireRing();
+
+        if (ring == NULL)
+            return;
+    }
+
+    uint32_t sequenceNumber;
+
+    if (ring->shared)
+        sequenceNumber = Atomic_add32((volatile uint32_t*) &(ring->head), 1) - 1;
+    else
+        sequenceNumber = (uint32_t) ring->head;
+
+    TraceRecord* record = &(ring->records[sequenceNumber & (CONFIG_TRACE_RING_SIZE - 1)]);
+
+    record->timestamp = Hal_getMonotonicTimeInNs();
+    record->eventId = (uint16_t) event;
+    record->argCount = (uint16_t) argCount;
+    record->sequenceNumber = sequenceNumber;
+    record->args[0] = arg0;
+    record->args[1] = arg1;
+    record->args[2] = arg2;
+    record->args[3] = arg3;
+
+    /* publish the record for Trace_dump */
+    if (ring->shared == false)
+        Atomic_storeRelease32(&(ring->head), (int32_t) (sequenceNumber + 1));
+}
+
+/*
+ * Dump file functions - only functions that can be used in a signal handler (no stdio, no heap)
+ */
+
+#if defined(_WIN32)
+
+typedef HANDLE DumpFile;
+
+static bool
+openDumpFile(DumpFile* file, const char* fileName)
+{
+    *file = CreateFileA(fileName, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+
+    return (*file != INVALID_HANDLE_VALUE);
+}
+
+static bool
+writeDumpFile(DumpFile file, const void* buffer, int size)
+{
+    DWORD written;
+
+    if (WriteFile(file, buffer, (DWORD) size, &written, NULL) == 0)
+        return false;
+
+    return (written == (DWORD) size);
+}
+
+static void
+closeDumpFile(DumpFile file)
+{
+    CloseHandle(file);
+}
+
+#else
+
+typedef int DumpFile;
+
+static bool
+openDumpFile(DumpFile* file, const char* fileName)
+{
+    *file = open(fileName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    return (*file != -1);
+}
+
+static bool
+writeDumpFile(DumpFile file, const void* buffer, int size)
+{
+    const uint8_t* position = (const uint8_t*) buffer;
+
+    while (size > 0) {
+        ssize_t written = write(file, position, size);
+
+        if (written <= 0)
+            return false;
+
+        position += written;
+        size -= (int) written;
+    }
+
+    return true;
+}
+
+static void
+closeDumpFile(DumpFile file)
+{
+    close(file);
+}
+
+#endif /* defined(_WIN32) */
+
+static bool
+writeUint32(DumpFile file, uint32_t value)
+{
+    return writeDumpFile(file, &value, sizeof(uint32_t));
+}
+
+static bool
+writeRing(DumpFile file, TraceRing* ring)
+{
+    uint32_t head = (uint32_t) Atomic_load32(&(ring->head));
+
+    uint32_t recordCount = head;
+
+    if (recordCount > CONFIG_TRACE_RING_SIZE)
+        recordCount = CONFIG_TRACE_RING_SIZE;
+
+    if (!writeUint32(file, ring->threadNumber)) return false;
+    if (!writeUint32(file, ring->previousThreadNumber)) return false;
+    if (!writeUint32(file, ring->firstSequenceNumber)) return false;
+    if (!writeUint32(file, head)) return false;
+    if (!writeUint32(file, recordCount)) return false;
+
+    uint32_t firstIndex = (head - recordCount) & (CONFIG_TRACE_RING_SIZE - 1);
+
+    /* the records from the oldest to the newest - in up to two parts */
+    uint32_t firstPartCount = CONFIG_TRACE_RING_SIZE - firstIndex;
+
+    if (firstPartCount > recordCount)
+        firstPartCount = recordCount;
+
+    if (!writeDumpFile(file, &(ring->records[firstIndex]), firstPartCount * sizeof(TraceRecord)))
+        return false;
+
+    if (recordCount > firstPartCount) {
+        if (!writeDumpFile(file, &(ring->records[0]), (recordCount - firstPartCount) * sizeof(TraceRecord)))
+            return false;
+    }
+
+    return true;
+}
+
+static bool
+writeDump(const char* fileName)
+{
+    DumpFile file;
+
+    if (!openDumpFile(&file, fileName))
+        return false;
+
+    bool success = false;
+
+    uint32_t ringCount = 0;
+
+    int i;
+
+    for (i = 0; i <= CONFIG_TRACE_MAX_THREADS; i++) {
+        if (rings[i] != NULL)
+            ringCount++;
+    }
+
+    if (!writeDumpFile(file, "IECTRACE", 8)) goto exit_function;
+    if (!writeUint32(file, TRACE_DUMP_VERSION)) goto exit_function;
+    if (!writeUint32(file, sizeof(TraceRecord))) goto exit_function;
+    if (!writeUint32(file, TRACE_EVENT_COUNT)) goto exit_function;
+    if (!writeUint32(file, ringCount)) goto exit_function;
+
+    for (i = 0; i < TRACE_EVENT_COUNT; i++) {
+        uint32_t formatLength = strlen(eventFormats[i]);
+
+        if (!writeUint32(file, eventCategories[i])) goto exit_function;
+        if (!writeUint32(file, formatLength)) goto exit_function;
+        if (!writeDumpFile(file, eventFormats[i], formatLength)) goto exit_function;
+    }
+
+    for (i = 0; i <= CONFIG_TRACE_MAX_THREADS; i++) {
+        if (rings[i] != NULL) {
+            if (!writeRing(file, rings[i]))
+                goto exit_function;
+
+            ringCount--;
+
+            if (ringCount == 0)
+                break;
+        }
+    }
+
+    success = true;
+
+exit_function:
+    closeDumpFile(file);
+
+    return success;
+}
+
+#if defined(_WIN32)
+
+static LONG WINAPI
+crashHandler(EXCEPTION_POINTERS* exceptionInfo)
+{
+    writeDump(crashDumpFileName);
+
+    return EXCEPTION_CONTINUE_SEARCH;
+}
+
+static void
+installCrashHandler(void)
+{
+    SetUnhandledExceptionFilter(crashHandler);
+}
+
+#else
+
+static void
+crashHandler(int signalNumber)
+{
+    writeDump(crashDumpFileName);
+
+    /* the default action has been restored (SA_RESETHAND) */
+    raise(signalNumber);
+}
+
+static void
+installCrashHandler(void)
+{
+    static const int signals[] = { SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT };
+
+    struct sigaction action;
+
+    memset(&action, 0, sizeof(struct sigaction));
+    action.sa_handler = crashHandler;
+    action.sa_flags = SA_RESETHAND;
+    sigemptyset(&action.sa_mask);
+
+    int i;
+
+    for (i = 0; i < (int) (sizeof(signals) / sizeof(int)); i++)
+        sigaction(signals[i], &action, NULL);
+}
+
+#endif /* defined(_WIN32) */
+
+#endif /* (CONFIG_TRACE == 1) */
+
+void
+Trace_setCategories(uint32_t categories)
+{
+#if (CONFIG_TRACE == 1)
+    private_Trace_categories = categories;
+#endif
+}
+
+uint32_t
+Trace_getCategories()
+{
+#if (CONFIG_TRACE == 1)
+    return private_Trace_categories;
+#else
+    return 0;
+#endif
+}
+
+bool
+Trace_dump(const char* fileName)
+{
+#if (CONFIG_TRACE == 1)
+    return writeDump(fileName);
+#else
+    return false;
+#endif
+}
+
+void
+Trace_installCrashHandler(const char* fileName)
+{
+#if (CONFIG_TRACE == 1)
+    strncpy(crashDumpFileName, fileName, sizeof(crashDumpFileName) - 1);
+    crashDumpFileName[sizeof(crashDumpFileName) - 1] = 0;
+
+    installCrashHandler();
+#endif
+}
@@ -0,0 +1,157 @@
+/*
+ *  trace.h
+ *
+ *  Copyright 2013 Michael Zillgith
+ *
+ *  This file is part of libIEC61850.
+ *
+ *  libIEC61850 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libIEC61850 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libIEC61850.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  See COPYING file for the complete license text.
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include "libiec61850_common_api.h"
+
+#ifndef CONFIG_TRACE
+#define CONFIG_TRACE 1
+#endif
+
+/**
+ * \addtogroup common_api_group
+ */
+/**@{*/
+
+/**
+ * \defgroup trace Binary trace of the protocol stack
+ *
+ * Trace points of the stack write binary records (time stamp, event id, up to four integer arguments)
+ * into an in-memory ring buffer of the calling thread. Writing a record takes some ten nanoseconds
+ * and doesn't require a lock. Trace points of disabled categories only cost a compare.
+ *
+ * The rings are written to a file with Trace_dump or by the crash handler (Trace_installCrashHandler).
+ * The dump contains the format strings of the events and can be converted to text with the
+ * trace_decoder tool (examples/trace_decoder).
+ *
+ * The trace can be compiled out with CONFIG_TRACE = 0.
+ */
+/**@{*/
+
+#define TRACE_CATEGORY_COTP         (1 << 0)
+#define TRACE_CATEGORY_ISO_SERVER   (1 << 1)
+#define TRACE_CATEGORY_SEND_QUEUE   (1 << 2)
+#define TRACE_CATEGORY_MMS_SERVER   (1 << 3)
+#define TRACE_CATEGORY_REPORTING    (1 << 4)
+
+#define TRACE_CATEGORY_ALL          0xffffffff
+
+typedef enum {
+#define TRACE_EVENT(id, category, format) id,
+#include "trace_events.h"
+#undef TRACE_EVENT
+    TRACE_EVENT_COUNT
+} TraceEventId;
+
+/**
+ * \brief select the categories of trace events that are recorded
+ *
+ * No category is enabled by default.
+ *
+ * \param categories bit mask of TRACE_CATEGORY_* values
+ */
+void
+Trace_setCategories(uint32_t categories);
+
+uint32_t
+Trace_getCategories(void);
+
+/**
+ * \brief write the content of all trace rings to a file
+ *
+ * The records of the rings are not removed. Records that are written by other threads while the
+ * dump is created can be missing or appear twice in the dump.
+ *
+ * \param fileName name of the dump file
+ *
+ * \return true if the dump has been written, false otherwise
+ */
+bool
+Trace_dump(const char* fileName);
+
+/**
+ * \brief write a trace dump when the program crashes
+ *
+ * On POSIX systems handlers for SIGSEGV, SIGBUS, SIGILL, SIGFPE and SIGABRT are installed. On
+ * Windows an unhandled exception filter is installed. After the dump is written the default
+ * handling of the signal/exception continues.
+ *
+ * \param fileName name of the dump file (is copied)
+ */
+void
+Trace_installCrashHandler(const char* fileName);
+
+/**@}*/
+
+/**@}*/
+
+#if (CONFIG_TRACE == 1)
+
+/* category of each event for the check of the trace macros */
+enum {
+#define TRACE_EVENT(id, category, format) id##_CATEGORY = category,
+#include "trace_events.h"
+#undef TRACE_EVENT
+    TRACE_EVENT_CATEGORY_END = 0
+};
+
+extern volatile uint32_t private_Trace_categories;
+
+void
+Trace_record(TraceEventId event, int argCount, uint32_t arg0, uint32_t arg1, uint32_t arg2, uint32_t arg3);
+
+#define TRACE_IS_ENABLED(event) ((private_Trace_categories & (uint32_t) event##_CATEGORY) != 0)
+
+#define TRACE0(event) \
+    do { if (TRACE_IS_ENABLED(event)) Trace_record(event, 0, 0, 0, 0, 0); } while (0)
+
+#define TRACE1(event, a0) \
+    do { if (TRACE_IS_ENABLED(event)) Trace_record(event, 1, (uint32_t) (a0), 0, 0, 0); } while (0)
+
+#define TRACE2(event, a0, a1) \
+    do { if (TRACE_IS_ENABLED(event)) Trace_record(event, 2, (uint32_t) (a0), (uint32_t) (a1), 0, 0); } while (0)
+
+#define TRACE3(event, a0, a1, a2) \
+    do { if (TRACE_IS_ENABLED(event)) \
+        Trace_record(event, 3, (uint32_t) (a0), (uint32_t) (a1), (uint32_t) (a2), 0); } while (0)
+
+#define TRACE4(event, a0, a1, a2, a3) \
+    do { if (TRACE_IS_ENABLED(event)) \
+        Trace_record(event, 4, (uint32_t) (a0), (uint32_t) (a1), (uint32_t) (a2), (uint32_t) (a3)); } while (0)
+
+#else
+
+#define TRACE0(event) do {} while (0)
+#define TRACE1(event, a0) do {} while (0)
+#define TRACE2(event, a0, a1) do {} while (0)
+#define TRACE3(event, a0, a1, a2) do {} while (0)
+#define TRACE4(event, a0, a1, a2, a3) do {} while (0)
+
+#endif /* (CONFIG_TRACE == 1) */
+
+/* object pointers are traced as 32 bit identifiers */
+#define TRACE_ID(pointer) ((uint32_t) (uintptr_t) (pointer))
+
+#endif /* TRACE_H_ */
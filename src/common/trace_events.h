@@ -0,0 +1,62 @@
+/*
+ *  trace_events.h
+ *
+ *  Copyright 2013 Michael Zillgith
+ *
+ *  This file is part of libIEC61850.
+ *
+ *  libIEC61850 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libIEC61850 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libIEC61850.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  See COPYING file for the complete license text.
+ */
+
+/*
+ * List of trace events - included by trace.h and trace.c with different definitions of TRACE_EVENT.
+ *
+ * TRACE_EVENT(id, category, format)
+ *
+ * The format is only used to decode a trace dump. All arguments are unsigned 32 bit integers. Only
+ * the conversions d, i, u, x, X and c (with flags and field width) are allowed. New events have to
+ * be added at the end of a category block. The ids are written to the trace dumps together with
+ * the format strings, so dumps of different library versions can be decoded with the same tool.
+ */
+
+/* COTP */
+TRACE_EVENT(TRACE_COTP_DATA_SENT, TRACE_CATEGORY_COTP, "COTP: sent data TPDU (%u bytes, last unit: %u)")
+TRACE_EVENT(TRACE_COTP_DATA_RECEIVED, TRACE_CATEGORY_COTP, "COTP: received data TPDU (%u bytes, last unit: %u)")
+TRACE_EVENT(TRACE_COTP_READ_ERROR, TRACE_CATEGORY_COTP, "COTP: read %i bytes should have been %i")
+
+/* ISO server */
+TRACE_EVENT(TRACE_ISO_SERVER_DATA_INDICATION, TRACE_CATEGORY_ISO_SERVER, "ISO_SERVER: connection %08x: data indication (%u bytes)")
+TRACE_EVENT(TRACE_ISO_SERVER_MMS_MESSAGE, TRACE_CATEGORY_ISO_SERVER, "ISO_SERVER: connection %08x: MMS request (%u bytes) -> response (%u bytes)")
+TRACE_EVENT(TRACE_ISO_SERVER_PRESENTATION_ERROR, TRACE_CATEGORY_ISO_SERVER, "ISO_SERVER: connection %08x: presentation error")
+TRACE_EVENT(TRACE_ISO_SERVER_UNKNOWN_CONTEXT, TRACE_CATEGORY_ISO_SERVER, "ISO_SERVER: connection %08x: unknown presentation context %u")
+
+/* ISO server send queue */
+TRACE_EVENT(TRACE_SEND_QUEUE_WRITE_BLOCKED, TRACE_CATEGORY_SEND_QUEUE, "SEND_QUEUE: connection %08x: write blocked for %u ms")
+TRACE_EVENT(TRACE_SEND_QUEUE_DROP_OLDEST, TRACE_CATEGORY_SEND_QUEUE, "SEND_QUEUE: connection %08x: queue full -> dropped oldest message (type %u)")
+TRACE_EVENT(TRACE_SEND_QUEUE_DROP_NEW, TRACE_CATEGORY_SEND_QUEUE, "SEND_QUEUE: connection %08x: queue full -> dropped new message (type %u)")
+TRACE_EVENT(TRACE_SEND_QUEUE_DISCONNECT, TRACE_CATEGORY_SEND_QUEUE, "SEND_QUEUE: connection %08x: queue full -> close connection")
+
+/* MMS server */
+TRACE_EVENT(TRACE_MMS_SERVER_PDU_RECEIVED, TRACE_CATEGORY_MMS_SERVER, "MMS_SERVER: received PDU type %02x (%u bytes)")
+TRACE_EVENT(TRACE_MMS_SERVER_CONFIRMED_REQUEST, TRACE_CATEGORY_MMS_SERVER, "MMS_SERVER: confirmed request tag %02x (extended: %u) invokeId %u size %u")
+TRACE_EVENT(TRACE_MMS_SERVER_REJECT, TRACE_CATEGORY_MMS_SERVER, "MMS_SERVER: reject request tag %02x (invokeId %u)")
+TRACE_EVENT(TRACE_MMS_SERVER_INFORMATION_REPORT, TRACE_CATEGORY_MMS_SERVER, "MMS_SERVER: information report (%u variables, %u bytes)")
+
+/* reporting */
+TRACE_EVENT(TRACE_REPORTING_ENQUEUE, TRACE_CATEGORY_REPORTING, "REPORTING: enqueue report (SqNum %u, %u bytes, integrity: %u, GI: %u)")
+TRACE_EVENT(TRACE_REPORTING_REMOVE_OLDEST, TRACE_CATEGORY_REPORTING, "REPORTING: buffer overflow -> removed oldest report (%u reports left)")
+TRACE_EVENT(TRACE_REPORTING_SEND_BUFFERED, TRACE_CATEGORY_REPORTING, "REPORTING: send buffered report (%u reports in buffer)")
+TRACE_EVENT(TRACE_REPORTING_PAUSED, TRACE_CATEGORY_REPORTING, "REPORTING: send queue full -> buffered report paused")
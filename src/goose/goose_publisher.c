@@ -57,6 +57,10 @@ struct sGoosePublisher {
     bool simulation;
 
     MmsValue* timestamp; /* time when stNum is increased */
+
+    bool timestampingEnabled;
+    uint64_t lastPublishTime; /* application time (ns) before encoding the last message */
+    uint64_t lastTransmitTime; /* transmit timestamp (ns) of the last message or 0 */
 };
 
 
@@ -342,9 +346,31 @@ createGoosePayload(GoosePublisher self, LinkedList dataSetValues, uint8_t* buffe
     return bufPos;
 }
 
+bool
+GoosePublisher_enableTimestamping(GoosePublisher self, bool useHardwareTimestamps)
+{
+    self->timestampingEnabled = Ethernet_enableTimestamping(self->ethernetSocket, useHardwareTimestamps);
+
+    return self->timestampingEnabled;
+}
+
+uint64_t
+GoosePublisher_getLastPublishTime(GoosePublisher self)
+{
+    return self->lastPublishTime;
+}
+
+uint64_t
+GoosePublisher_getLastTransmitTimestamp(GoosePublisher self)
+{
+    return self->lastTransmitTime;
+}
+
 int
 GoosePublisher_publish(GoosePublisher self, LinkedList dataSet)
 {
+    self->lastPublishTime = Hal_getTimeInNs();
+
     uint8_t* buffer = self->buffer + self->payloadStart;
 
     self->sqNum++;
@@ -365,5 +391,11 @@ GoosePublisher_publish(GoosePublisher self, LinkedList dataSet)
 
     Ethernet_sendPacket(self->ethernetSocket, self->buffer, self->payloadStart + payloadLength);
 
+    if (self->timestampingEnabled) {
+        if (Ethernet_getTransmitTimestamp(self->ethernetSocket, &(self->lastTransmitTime),
+                CONFIG_GOOSE_TX_TIMESTAMP_TIMEOUT) == false)
+            self->lastTransmitTime = 0;
+    }
+
     return 0;
 }
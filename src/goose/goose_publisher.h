@@ -72,4 +72,29 @@ GoosePublisher_increaseStNum(GoosePublisher self);
 void
 GoosePublisher_reset(GoosePublisher self);
 
+/**
+ * \brief Enable software (and optionally hardware) transmit timestamps.
+ *
+ * When enabled GoosePublisher_publish waits up to CONFIG_GOOSE_TX_TIMESTAMP_TIMEOUT ms
+ * for the transmit timestamp of the sent message.
+ *
+ * \return true if timestamping is supported by the Ethernet layer
+ */
+bool
+GoosePublisher_enableTimestamping(GoosePublisher self, bool useHardwareTimestamps);
+
+/**
+ * \brief Get the time (ns since epoch) when GoosePublisher_publish was called the last time (before encoding).
+ */
+uint64_t
+GoosePublisher_getLastPublishTime(GoosePublisher self);
+
+/**
+ * \brief Get the transmit timestamp (ns since epoch) of the last published message.
+ *
+ * \return the timestamp or 0 if not available
+ */
+uint64_t
+GoosePublisher_getLastTransmitTimestamp(GoosePublisher self);
+
 #endif /* GOOSE_PUBLISHER_H_ */
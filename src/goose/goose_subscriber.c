@@ -33,10 +33,28 @@
 #include "mms_value.h"
 #include "mms_value_internal.h"
 
+#include "atomic_operations.h"
+#include "stream_supervisor.h"
+
 #define ETH_BUFFER_LENGTH 1518
 
 #define ETH_P_GOOSE 0x88b8
 
+#define SNAPSHOT_INDEX_MASK 0x03
+#define SNAPSHOT_NEW_FLAG 0x04
+
+struct sGooseSnapshot {
+    uint32_t stNum;
+    uint32_t sqNum;
+    uint32_t timeAllowedToLive;
+    uint32_t confRev;
+    uint64_t timestamp;
+    uint64_t receiveTimestamp;
+    bool simulation;
+    bool ndsCom;
+    MmsValue* dataSetValues;
+};
+
 struct sGooseSubscriber {
     char* goCBRef;
     int goCBRefLen;
@@ -55,6 +73,22 @@ struct sGooseSubscriber {
 
     GooseListener listener;
     void* listenerParameter;
+
+    /* triple buffer for the snapshot handoff to an application thread */
+    bool snapshotsEnabled;
+    struct sGooseSnapshot snapshots[3];
+    int writeSnapshot; /* only accessed by the receiver thread */
+    volatile int32_t middleSnapshot; /* index of the latest published snapshot + SNAPSHOT_NEW_FLAG */
+    int readSnapshot; /* only accessed by the reading application thread */
+    bool snapshotAvailable;
+
+    bool timestampingEnabled;
+    bool useHardwareTimestamps;
+    uint64_t receiveTimestamp; /* in ns */
+
+    SupervisedStream supervisedStream;
+    StreamSupervisor supervisor;
+
     bool running;
     Thread receiver;
     char* interfaceId;
@@ -591,6 +625,45 @@ parseGooseMessage(uint8_t* buffer, int numbytes, GooseSubscriber subscriber)
     return parseGoosePayload(buffer + bufPos, apduLength, subscriber);
 }
 
+static void
+publishSnapshot(GooseSubscriber self)
+{
+    GooseSnapshot snapshot = &(self->snapshots[self->writeSnapshot]);
+
+    if (self->dataSetValues == NULL)
+        return;
+
+    if (snapshot->dataSetValues == NULL)
+        snapshot->dataSetValues = MmsValue_clone(self->dataSetValues);
+    else
+        MmsValue_update(snapshot->dataSetValues, self->dataSetValues);
+
+    snapshot->stNum = self->stNum;
+    snapshot->sqNum = self->sqNum;
+    snapshot->timeAllowedToLive = self->timeAllowedToLive;
+    snapshot->confRev = self->confRev;
+    snapshot->timestamp = MmsValue_getUtcTimeInMs(self->timestamp);
+    snapshot->receiveTimestamp = self->receiveTimestamp;
+    snapshot->simulation = self->simulation;
+    snapshot->ndsCom = self->ndsCom;
+
+    /* hand the filled buffer over and continue with the one the reader released last */
+    self->writeSnapshot = Atomic_exchange32(&(self->middleSnapshot),
+            self->writeSnapshot | SNAPSHOT_NEW_FLAG) & SNAPSHOT_INDEX_MASK;
+}
+
+static uint64_t
+getUtcTimeInUs(MmsValue* utcTime)
+{
+    uint8_t* valueArray = utcTime->value.utcTime;
+
+    uint32_t seconds = (valueArray[0] << 24) + (valueArray[1] << 16) + (valueArray[2] << 8) + valueArray[3];
+
+    uint32_t fractionOfSecond = (valueArray[4] << 16) + (valueArray[5] << 8) + valueArray[6];
+
+    return (seconds * 1000000ULL) + ((fractionOfSecond * 1000000ULL) >> 24);
+}
+
 static void
 gooseSubscriberLoop(void* threadParameter)
 {
@@ -605,23 +678,44 @@ gooseSubscriberLoop(void* threadParameter)
     else
     	socket = Ethernet_createSocket(self->interfaceId, NULL);
 
+    if (socket == NULL) {
+        free(buffer);
+        return;
+    }
+
     Ethernet_setProtocolFilter(socket, ETH_P_GOOSE);
 
+    if (self->timestampingEnabled)
+        Ethernet_enableTimestamping(socket, self->useHardwareTimestamps);
+
     int running = 1;
 
     while (running) {
 
-        int packetSize = Ethernet_receivePacket(socket, buffer, ETH_BUFFER_LENGTH);
+        uint64_t receiveTimestamp;
+
+        int packetSize = Ethernet_receivePacketWithTimestamp(socket, buffer, ETH_BUFFER_LENGTH, &receiveTimestamp);
 
         if (packetSize > 0) {
+
             if (parseGooseMessage(buffer, packetSize, self) == 1) {
+
+                self->receiveTimestamp = receiveTimestamp;
+
+                if (self->supervisedStream != NULL)
+                    SupervisedStream_messageReceived(self->supervisedStream, self->stNum, self->sqNum,
+                            self->timeAllowedToLive, getUtcTimeInUs(self->timestamp), receiveTimestamp / 1000);
+
+                if (self->snapshotsEnabled)
+                    publishSnapshot(self);
+
                 if (self->listener != NULL) {
                     self->listener(self, self->listenerParameter);
                 }
             }
         }
-
-        Thread_sleep(1);
+        else /* only sleep when the socket is drained */
+            Thread_sleep(1);
 
         running = self->running;
     }
@@ -648,6 +742,10 @@ GooseSubscriber_create(char* goCbRef, MmsValue* dataSetValues)
 
     self->appId = -1;
 
+    self->writeSnapshot = 0;
+    self->middleSnapshot = 1;
+    self->readSnapshot = 2;
+
     return self;
 }
 
@@ -686,6 +784,9 @@ GooseSubscriber_destroy(GooseSubscriber self)
 {
     GooseSubscriber_unsubscribe(self);
 
+    if (self->supervisedStream != NULL)
+        StreamSupervisor_removeStream(self->supervisor, self->supervisedStream);
+
     free(self->goCBRef);
 
     MmsValue_delete(self->timestamp);
@@ -696,6 +797,10 @@ GooseSubscriber_destroy(GooseSubscriber self)
     if (self->interfaceId != NULL)
     	free(self->interfaceId);
 
+    int i;
+    for (i = 0; i < 3; i++)
+        MmsValue_deleteIfNotNull(self->snapshots[i].dataSetValues);
+
     free(self);
 }
 
@@ -748,10 +853,111 @@ GooseSubscriber_getDataSetValues(GooseSubscriber self)
     return self->dataSetValues;
 }
 
+void
+GooseSubscriber_enableTimestamping(GooseSubscriber self, bool useHardwareTimestamps)
+{
+    self->timestampingEnabled = true;
+    self->useHardwareTimestamps = useHardwareTimestamps;
+}
+
+uint64_t
+GooseSubscriber_getReceiveTimestamp(GooseSubscriber self)
+{
+    return self->receiveTimestamp;
+}
+
+void
+GooseSubscriber_setSupervisor(GooseSubscriber self, StreamSupervisor supervisor)
+{
+    if (self->supervisedStream != NULL)
+        StreamSupervisor_removeStream(self->supervisor, self->supervisedStream);
+
+    self->supervisor = supervisor;
+
+    if (supervisor != NULL)
+        self->supervisedStream = StreamSupervisor_addStream(supervisor, self->goCBRef, self);
+    else
+        self->supervisedStream = NULL;
+}
+
+SupervisedStream
+GooseSubscriber_getSupervisedStream(GooseSubscriber self)
+{
+    return self->supervisedStream;
+}
+
+void
+GooseSubscriber_enableSnapshots(GooseSubscriber self)
+{
+    self->snapshotsEnabled = true;
+}
+
+GooseSnapshot
+GooseSubscriber_getLatestSnapshot(GooseSubscriber self)
+{
+    if (Atomic_load32(&(self->middleSnapshot)) & SNAPSHOT_NEW_FLAG) {
+        self->readSnapshot = Atomic_exchange32(&(self->middleSnapshot), self->readSnapshot)
+                & SNAPSHOT_INDEX_MASK;
+
+        self->snapshotAvailable = true;
+    }
+
+    if (self->snapshotAvailable)
+        return &(self->snapshots[self->readSnapshot]);
+    else
+        return NULL;
+}
+
+uint32_t
+GooseSnapshot_getStNum(GooseSnapshot self)
+{
+    return self->stNum;
+}
+
+uint32_t
+GooseSnapshot_getSqNum(GooseSnapshot self)
+{
+    return self->sqNum;
+}
 
+uint32_t
+GooseSnapshot_getTimeAllowedToLive(GooseSnapshot self)
+{
+    return self->timeAllowedToLive;
+}
 
+uint32_t
+GooseSnapshot_getConfRev(GooseSnapshot self)
+{
+    return self->confRev;
+}
 
+uint64_t
+GooseSnapshot_getTimestamp(GooseSnapshot self)
+{
+    return self->timestamp;
+}
 
+uint64_t
+GooseSnapshot_getReceiveTimestamp(GooseSnapshot self)
+{
+    return self->receiveTimestamp;
+}
 
+bool
+GooseSnapshot_isTest(GooseSnapshot self)
+{
+    return self->simulation;
+}
 
+bool
+GooseSnapshot_needsCommission(GooseSnapshot self)
+{
+    return self->ndsCom;
+}
 
+MmsValue*
+GooseSnapshot_getDataSetValues(GooseSnapshot self)
+{
+    return self->dataSetValues;
+}
@@ -32,9 +32,15 @@
 /**@{*/
 
 #include "mms_value.h"
+#include "stream_supervisor.h"
 
 typedef struct sGooseSubscriber* GooseSubscriber;
 
+/**
+ * \brief Consistent copy of the state of a GooseSubscriber after a received GOOSE message
+ */
+typedef struct sGooseSnapshot* GooseSnapshot;
+
 /**
  * \brief user provided callback function that will be invoked when a GOOSE message is received.
  *
@@ -137,6 +143,111 @@ GooseSubscriber_getTimestamp(GooseSubscriber self);
 MmsValue*
 GooseSubscriber_getDataSetValues(GooseSubscriber self);
 
+/**
+ * \brief Enable receive timestamps taken by the Ethernet layer.
+ *
+ * Without timestamping the receive time is taken by the receiver thread after the packet has
+ * been read from the socket. This function has to be called before GooseSubscriber_subscribe.
+ *
+ * \param self GooseSubscriber instance to operate on.
+ * \param useHardwareTimestamps use NIC hardware timestamps if available
+ */
+void
+GooseSubscriber_enableTimestamping(GooseSubscriber self, bool useHardwareTimestamps);
+
+/**
+ * \brief Get the receive time of the last GOOSE message in nanoseconds since epoch
+ */
+uint64_t
+GooseSubscriber_getReceiveTimestamp(GooseSubscriber self);
+
+/**
+ * \brief Add the subscriber to a stream supervisor.
+ *
+ * The supervisor checks the time allowed to live of each received message and keeps
+ * statistics about lost, duplicated and out-of-order messages and the transfer latency.
+ * The SupervisedStream uses the subscriber as user data.
+ *
+ * This function has to be called before GooseSubscriber_subscribe.
+ *
+ * \param self GooseSubscriber instance to operate on.
+ * \param supervisor the supervisor or NULL to remove the subscriber from its supervisor
+ */
+void
+GooseSubscriber_setSupervisor(GooseSubscriber self, StreamSupervisor supervisor);
+
+/**
+ * \brief Get the SupervisedStream instance of the subscriber (to access the statistics)
+ *
+ * \return the stream or NULL if the subscriber is not supervised
+ */
+SupervisedStream
+GooseSubscriber_getSupervisedStream(GooseSubscriber self);
+
+/**
+ * \brief Enable the snapshot handoff of received data to an application thread.
+ *
+ * When enabled the receiver thread copies the data set values together with stNum, sqNum
+ * and timestamp into a triple buffer after each valid GOOSE message. The buffer is
+ * published by an atomic index swap. The receiver never waits for the application.
+ *
+ * This function has to be called before GooseSubscriber_subscribe.
+ *
+ * \param self GooseSubscriber instance to operate on.
+ */
+void
+GooseSubscriber_enableSnapshots(GooseSubscriber self);
+
+/**
+ * \brief Get the latest consistent snapshot of the received GOOSE data.
+ *
+ * The returned snapshot is owned by the subscriber. It remains valid and unchanged until the
+ * next call of this function. Only a single application thread may call this function for
+ * a specific subscriber.
+ *
+ * \param self GooseSubscriber instance to operate on.
+ *
+ * \return the latest snapshot or NULL if no GOOSE message has been received yet.
+ */
+GooseSnapshot
+GooseSubscriber_getLatestSnapshot(GooseSubscriber self);
+
+uint32_t
+GooseSnapshot_getStNum(GooseSnapshot self);
+
+uint32_t
+GooseSnapshot_getSqNum(GooseSnapshot self);
+
+uint32_t
+GooseSnapshot_getTimeAllowedToLive(GooseSnapshot self);
+
+uint32_t
+GooseSnapshot_getConfRev(GooseSnapshot self);
+
+/**
+ * \brief Get the timestamp (t) of the GOOSE message in ms since epoch
+ */
+uint64_t
+GooseSnapshot_getTimestamp(GooseSnapshot self);
+
+/**
+ * \brief Get the receive time of the GOOSE message in nanoseconds since epoch
+ */
+uint64_t
+GooseSnapshot_getReceiveTimestamp(GooseSnapshot self);
+
+bool
+GooseSnapshot_isTest(GooseSnapshot self);
+
+bool
+GooseSnapshot_needsCommission(GooseSnapshot self);
+
+/**
+ * \brief Get the data set values of the snapshot. The values must not be modified or deleted.
+ */
+MmsValue*
+GooseSnapshot_getDataSetValues(GooseSnapshot self);
+
 /**@}*/
 
 #endif /* GOOSE_SUBSCRIBER_H_ */
@@ -0,0 +1,468 @@
+/*
+ *  stream_supervisor.c
+ *
+ *  Copyright 2014 Michael Zillgith
+ *
+ *  This file is part of libIEC61850.
+ *
+ *  libIEC61850 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libIEC61850 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libIEC61850.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  See COPYING file for the complete license text.
+ */
+
+#include "libiec61850_platform_includes.h"
+
+#include "stack_config.h"
+#include "stream_supervisor.h"
+#include "thread.h"
+#include "atomic_operations.h"
+
+/* maximum sleep time of the supervisor thread if no deadline is pending */
+#define SUPERVISOR_IDLE_TIMEOUT_MS 1000
+
+#define INITIAL_HEAP_CAPACITY 16
+
+struct sSupervisedStream {
+    char* name;
+    void* userData;
+    StreamSupervisor supervisor;
+
+    /* deadline handling - protected by supervisor lock */
+    uint64_t deadline; /* monotonic time in ms */
+    int heapIndex; /* position in the deadline heap or -1 */
+    bool expired;
+
+    /* sequence tracking - only accessed by the receiving thread */
+    bool firstMessageReceived;
+    uint32_t lastStNum;
+    uint32_t lastSqNum;
+    uint32_t sqNumRange; /* sqNum wraps at this value (SV sample counter) - 0 if not known */
+
+    /* counters - written by the receiving thread, read by any thread */
+    volatile uint64_t received;
+    volatile uint64_t lost;
+    volatile uint64_t duplicated;
+    volatile uint64_t outOfOrder;
+    volatile uint64_t expirations;
+
+    volatile uint64_t latencyCount;
+    volatile uint64_t latencySumUs;
+    volatile uint64_t latencyMaxUs;
+    volatile uint64_t latencyHistogram[STREAM_SUPERVISOR_LATENCY_BUCKETS];
+};
+
+struct sStreamSupervisor {
+    Semaphore lock;
+    Semaphore wakeUp;
+
+    /* binary min-heap of the streams ordered by deadline */
+    SupervisedStream* heap;
+    int heapSize;
+    int heapCapacity;
+
+    StreamSupervisionHandler handler;
+    void* handlerParameter;
+
+    bool running;
+    Thread thread;
+};
+
+static void
+heapSwap(StreamSupervisor self, int i, int j)
+{
+    SupervisedStream tmp = self->heap[i];
+
+    self->heap[i] = self->heap[j];
+    self->heap[j] = tmp;
+
+    self->heap[i]->heapIndex = i;
+    self->heap[j]->heapIndex = j;
+}
+
+static void
+heapSiftUp(StreamSupervisor self, int index)
+{
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+
+        if (self->heap[parent]->deadline <= self->heap[index]->deadline)
+            break;
+
+        heapSwap(self, parent, index);
+        index = parent;
+    }
+}
+
+static void
+heapSiftDown(StreamSupervisor self, int index)
+{
+    while (true) {
+        int left = (2 * index) + 1;
+        int right = left + 1;
+        int smallest = index;
+
+        if ((left < self->heapSize) && (self->heap[left]->deadline < self->heap[smallest]->deadline))
+            smallest = left;
+
+        if ((right < self->heapSize) && (self->heap[right]->deadline < self->heap[smallest]->deadline))
+            smallest = right;
+
+        if (smallest == index)
+            break;
+
+        heapSwap(self, smallest, index);
+        index = smallest;
+    }
+}
+
+static void
+heapInsert(StreamSupervisor self, SupervisedStream stream)
+{
+    if (self->heapSize == self->heapCapacity) {
+        self->heapCapacity = self->heapCapacity * 2;
+        self->heap = (SupervisedStream*) realloc(self->heap, self->heapCapacity * sizeof(SupervisedStream));
+    }
+
+    stream->heapIndex = self->heapSize;
+    self->heap[self->heapSize++] = stream;
+
+    heapSiftUp(self, stream->heapIndex);
+}
+
+static void
+heapRemove(StreamSupervisor self, SupervisedStream stream)
+{
+    int index = stream->heapIndex;
+
+    if (index < 0)
+        return;
+
+    self->heapSize--;
+
+    if (index != self->heapSize) {
+        heapSwap(self, index, self->heapSize);
+        heapSiftDown(self, index);
+        heapSiftUp(self, index);
+    }
+
+    stream->heapIndex = -1;
+}
+
+static void
+heapUpdate(StreamSupervisor self, SupervisedStream stream)
+{
+    if (stream->heapIndex < 0)
+        heapInsert(self, stream);
+    else {
+        heapSiftDown(self, stream->heapIndex);
+        heapSiftUp(self, stream->heapIndex);
+    }
+}
+
+/* deadlines are not affected by changes of the system time */
+static uint64_t
+getMonotonicTimeInMs(void)
+{
+    return Hal_getMonotonicTimeInNs() / 1000000;
+}
+
+static void
+supervisorThread(void* parameter)
+{
+    StreamSupervisor self = (StreamSupervisor) parameter;
+
+    while (self->running) {
+        int waitTime = SUPERVISOR_IDLE_TIMEOUT_MS;
+
+        Semaphore_wait(self->lock);
+
+        uint64_t currentTime = getMonotonicTimeInMs();
+
+        while ((self->heapSize > 0) && (self->heap[0]->deadline <= currentTime)) {
+            SupervisedStream stream = self->heap[0];
+
+            heapRemove(self, stream);
+
+            stream->expired = true;
+            Atomic_add64(&(stream->expirations), 1);
+
+            if (DEBUG) printf("STREAM_SUPERVISOR: stream %s expired\n", stream->name);
+
+            if (self->handler != NULL)
+                self->handler(stream, true, self->handlerParameter);
+        }
+
+        if (self->heapSize > 0) {
+            uint64_t timeToDeadline = self->heap[0]->deadline - currentTime;
+
+            if (timeToDeadline < SUPERVISOR_IDLE_TIMEOUT_MS)
+                waitTime = (int) timeToDeadline;
+        }
+
+        Semaphore_post(self->lock);
+
+        Semaphore_waitWithTimeout(self->wakeUp, waitTime);
+    }
+}
+
+StreamSupervisor
+StreamSupervisor_create()
+{
+    StreamSupervisor self = (StreamSupervisor) calloc(1, sizeof(struct sStreamSupervisor));
+
+    self->lock = Semaphore_create(1);
+    self->wakeUp = Semaphore_create(0);
+
+    self->heapCapacity = INITIAL_HEAP_CAPACITY;
+    self->heap = (SupervisedStream*) malloc(self->heapCapacity * sizeof(SupervisedStream));
+
+    return self;
+}
+
+void
+StreamSupervisor_setHandler(StreamSupervisor self, StreamSupervisionHandler handler, void* parameter)
+{
+    self->handler = handler;
+    self->handlerParameter = parameter;
+}
+
+void
+StreamSupervisor_start(StreamSupervisor self)
+{
+    if (self->running)
+        return;
+
+    self->running = true;
+    self->thread = Thread_create((ThreadExecutionFunction) supervisorThread, self, false);
+    Thread_start(self->thread);
+}
+
+void
+StreamSupervisor_stop(StreamSupervisor self)
+{
+    if (self->running) {
+        self->running = false;
+        Semaphore_post(self->wakeUp);
+        Thread_destroy(self->thread);
+    }
+}
+
+void
+StreamSupervisor_destroy(StreamSupervisor self)
+{
+    StreamSupervisor_stop(self);
+
+    Semaphore_destroy(self->lock);
+    Semaphore_destroy(self->wakeUp);
+
+    free(self->heap);
+    free(self);
+}
+
+SupervisedStream
+StreamSupervisor_addStream(StreamSupervisor self, char* name, void* userData)
+{
+    SupervisedStream stream = (SupervisedStream) calloc(1, sizeof(struct sSupervisedStream));
+
+    stream->name = copyString(name);
+    stream->userData = userData;
+    stream->supervisor = self;
+    stream->heapIndex = -1;
+
+    return stream;
+}
+
+void
+StreamSupervisor_removeStream(StreamSupervisor self, SupervisedStream stream)
+{
+    Semaphore_wait(self->lock);
+    heapRemove(self, stream);
+    Semaphore_post(self->lock);
+
+    free(stream->name);
+    free(stream);
+}
+
+char*
+SupervisedStream_getName(SupervisedStream self)
+{
+    return self->name;
+}
+
+void*
+SupervisedStream_getUserData(SupervisedStream self)
+{
+    return self->userData;
+}
+
+bool
+SupervisedStream_isExpired(SupervisedStream self)
+{
+    return self->expired;
+}
+
+void
+SupervisedStream_setSequenceNumberRange(SupervisedStream self, uint32_t range)
+{
+    self->sqNumRange = range;
+}
+
+static void
+recordLatency(SupervisedStream self, uint64_t publisherTimeInUs, uint64_t receiveTimeInUs)
+{
+    uint64_t latency = 0;
+
+    /* clocks of publisher and subscriber are not perfectly synchronized */
+    if (receiveTimeInUs > publisherTimeInUs)
+        latency = receiveTimeInUs - publisherTimeInUs;
+
+    int bucket = 0;
+
+    while ((latency >> bucket) && (bucket < (STREAM_SUPERVISOR_LATENCY_BUCKETS - 1)))
+        bucket++;
+
+    Atomic_add64(&(self->latencyHistogram[bucket]), 1);
+    Atomic_add64(&(self->latencyCount), 1);
+    Atomic_add64(&(self->latencySumUs), latency);
+
+    /* single writer - no compare and swap required */
+    if (latency > self->latencyMaxUs)
+        Atomic_add64(&(self->latencyMaxUs), latency - self->latencyMaxUs);
+}
+
+/* distance from the last sqNum - serial number arithmetic to handle wrap around */
+static int32_t
+getSequenceDiff(SupervisedStream self, uint32_t sqNum)
+{
+    uint32_t range = self->sqNumRange;
+
+    if (range == 0)
+        return (int32_t) (sqNum - self->lastSqNum);
+
+    uint32_t diff = ((sqNum % range) + range - (self->lastSqNum % range)) % range;
+
+    if (diff > (range / 2))
+        return (int32_t) diff - (int32_t) range;
+
+    return (int32_t) diff;
+}
+
+static bool
+checkSequence(SupervisedStream self, uint32_t stNum, uint32_t sqNum)
+{
+    bool newState = false;
+
+    /* the wrap around of the sample counter is unknown - sequence checks are not possible */
+    if ((stNum == 0) && (self->sqNumRange == 0))
+        return false;
+
+    if (self->firstMessageReceived == false) {
+        self->firstMessageReceived = true;
+        newState = true;
+    }
+    else {
+        /* serial number arithmetic to handle wrap around */
+        int32_t stDiff = (int32_t) (stNum - self->lastStNum);
+        int32_t sqDiff = getSequenceDiff(self, sqNum);
+
+        if (stDiff == 0) {
+            if (sqDiff == 0)
+                Atomic_add64(&(self->duplicated), 1);
+            else if (sqDiff < 0)
+                Atomic_add64(&(self->outOfOrder), 1);
+            else if (sqDiff > 1)
+                Atomic_add64(&(self->lost), sqDiff - 1);
+        }
+        else if (stDiff > 0) {
+            /* lost state changes */
+            if (stDiff > 1)
+                Atomic_add64(&(self->lost), stDiff - 1);
+
+            newState = true;
+        }
+        else {
+            Atomic_add64(&(self->outOfOrder), 1);
+            return false;
+        }
+
+        if ((stDiff == 0) && (sqDiff <= 0))
+            return false;
+    }
+
+    self->lastStNum = stNum;
+    self->lastSqNum = sqNum;
+
+    return newState;
+}
+
+void
+SupervisedStream_messageReceived(SupervisedStream self, uint32_t stNum, uint32_t sqNum,
+        uint32_t timeAllowedToLive, uint64_t publisherTimeInUs, uint64_t receiveTimeInUs)
+{
+    StreamSupervisor supervisor = self->supervisor;
+
+    Atomic_add64(&(self->received), 1);
+
+    bool newState = checkSequence(self, stNum, sqNum);
+
+    if ((publisherTimeInUs != 0) && (newState || (stNum == 0)))
+        recordLatency(self, publisherTimeInUs, receiveTimeInUs);
+
+    Semaphore_wait(supervisor->lock);
+
+    if (timeAllowedToLive > 0) {
+        bool wasFirst = (supervisor->heapSize > 0) && (supervisor->heap[0] == self);
+
+        self->deadline = getMonotonicTimeInMs() + timeAllowedToLive;
+
+        heapUpdate(supervisor, self);
+
+        /* wake up supervisor only if the nearest deadline moved to the front */
+        if ((supervisor->heap[0] == self) && (wasFirst == false))
+            Semaphore_post(supervisor->wakeUp);
+    }
+    else
+        heapRemove(supervisor, self);
+
+    if (self->expired) {
+        self->expired = false;
+
+        if (DEBUG) printf("STREAM_SUPERVISOR: stream %s recovered\n", self->name);
+
+        if (supervisor->handler != NULL)
+            supervisor->handler(self, false, supervisor->handlerParameter);
+    }
+
+    Semaphore_post(supervisor->lock);
+}
+
+void
+SupervisedStream_getStatistics(SupervisedStream self, StreamStatistics* statistics)
+{
+    int i;
+
+    statistics->received = Atomic_load64(&(self->received));
+    statistics->lost = Atomic_load64(&(self->lost));
+    statistics->duplicated = Atomic_load64(&(self->duplicated));
+    statistics->outOfOrder = Atomic_load64(&(self->outOfOrder));
+    statistics->expirations = Atomic_load64(&(self->expirations));
+    statistics->expired = self->expired;
+
+    statistics->latencyCount = Atomic_load64(&(self->latencyCount));
+    statistics->latencySumUs = Atomic_load64(&(self->latencySumUs));
+    statistics->latencyMaxUs = Atomic_load64(&(self->latencyMaxUs));
+
+    for (i = 0; i < STREAM_SUPERVISOR_LATENCY_BUCKETS; i++)
+        statistics->latencyHistogram[i] = Atomic_load64(&(self->latencyHistogram[i]));
+}
@@ -0,0 +1,162 @@
+/*
+ *  stream_supervisor.h
+ *
+ *  Copyright 2014 Michael Zillgith
+ *
+ *  This file is part of libIEC61850.
+ *
+ *  libIEC61850 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libIEC61850 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libIEC61850.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  See COPYING file for the complete license text.
+ */
+
+#ifndef STREAM_SUPERVISOR_H_
+#define STREAM_SUPERVISOR_H_
+
+#include "libiec61850_common_api.h"
+
+/**
+ * \defgroup stream_supervision_api_group Supervision of GOOSE/SV message streams
+ *
+ * A StreamSupervisor supervises an arbitrary number of message streams (e.g. GOOSE subscriptions)
+ * with a single thread. The thread only wakes up when the nearest "time allowed to live"
+ * deadline of all streams elapses. For each stream it keeps counters for received, lost,
+ * duplicated and out-of-order messages and a histogram of the transfer latency
+ * (receive time - publisher timestamp).
+ */
+/**@{*/
+
+/** number of buckets of the latency histogram. Bucket i counts latencies in [2^(i-1), 2^i) us */
+#define STREAM_SUPERVISOR_LATENCY_BUCKETS 24
+
+typedef struct sStreamSupervisor* StreamSupervisor;
+
+typedef struct sSupervisedStream* SupervisedStream;
+
+typedef struct {
+    uint64_t received;
+    uint64_t lost;
+    uint64_t duplicated;
+    uint64_t outOfOrder;
+    uint64_t expirations;
+    bool expired;
+
+    uint64_t latencyCount;
+    uint64_t latencySumUs;
+    uint64_t latencyMaxUs;
+    uint64_t latencyHistogram[STREAM_SUPERVISOR_LATENCY_BUCKETS];
+} StreamStatistics;
+
+/**
+ * \brief user provided callback function that is invoked when a stream expires or recovers.
+ *
+ * The expiry is signaled by the supervisor thread. The recovery is signaled by the thread that
+ * reports the first message after the expiry (e.g. the GOOSE receiver thread). The handler is
+ * called with the supervisor lock held and must not add or remove streams.
+ *
+ * \param stream the stream that changed its state
+ * \param expired true if the time allowed to live elapsed, false if the stream recovered
+ * \param parameter user provided parameter
+ */
+typedef void (*StreamSupervisionHandler)(SupervisedStream stream, bool expired, void* parameter);
+
+StreamSupervisor
+StreamSupervisor_create(void);
+
+/**
+ * \brief set the handler for expiry and recovery events of all streams.
+ */
+void
+StreamSupervisor_setHandler(StreamSupervisor self, StreamSupervisionHandler handler, void* parameter);
+
+/**
+ * \brief Start the supervisor thread.
+ */
+void
+StreamSupervisor_start(StreamSupervisor self);
+
+/**
+ * \brief Stop the supervisor thread.
+ */
+void
+StreamSupervisor_stop(StreamSupervisor self);
+
+/**
+ * \brief Destroy the supervisor. All streams have to be removed before.
+ */
+void
+StreamSupervisor_destroy(StreamSupervisor self);
+
+/**
+ * \brief add a new stream to the supervisor.
+ *
+ * \param name a name of the stream used for identification (e.g. the GoCB reference). The string is copied.
+ * \param userData user provided data that can be accessed by SupervisedStream_getUserData.
+ */
+SupervisedStream
+StreamSupervisor_addStream(StreamSupervisor self, char* name, void* userData);
+
+void
+StreamSupervisor_removeStream(StreamSupervisor self, SupervisedStream stream);
+
+char*
+SupervisedStream_getName(SupervisedStream self);
+
+void*
+SupervisedStream_getUserData(SupervisedStream self);
+
+bool
+SupervisedStream_isExpired(SupervisedStream self);
+
+/**
+ * \brief set the value at which the sqNum of the stream wraps around to 0.
+ *
+ * Required for the sequence checks of streams without state numbers. E.g. the SV sample counter wraps
+ * at the number of samples per second. GOOSE sqNum uses the full 32 bit range (default).
+ *
+ * \param range the number of different sqNum values (e.g. 4000 for SV with 4000 samples per second)
+ */
+void
+SupervisedStream_setSequenceNumberRange(SupervisedStream self, uint32_t range);
+
+/**
+ * \brief report a received message to the supervisor.
+ *
+ * stNum/sqNum are checked for gaps, duplicates and reordering. For streams without state
+ * numbers (e.g. SV) stNum has to be 0 and sqNum is the sample counter. These streams are only checked
+ * when the wrap around of the sample counter is known (see SupervisedStream_setSequenceNumberRange).
+ *
+ * The deadline (time allowed to live) is measured with the monotonic clock from the time of the call.
+ *
+ * For GOOSE the latency is only recorded for the first message of a new state (stNum changed)
+ * because the GOOSE timestamp is the time of the last state change and not the time of
+ * transmission. Streams without state numbers record the latency for every message.
+ *
+ * \param timeAllowedToLive the TAL in ms - the next message has to arrive in this time. 0 disables the check.
+ * \param publisherTimeInUs the timestamp of the message as microseconds since epoch or 0 if not available
+ * \param receiveTimeInUs the time of reception as microseconds since epoch
+ */
+void
+SupervisedStream_messageReceived(SupervisedStream self, uint32_t stNum, uint32_t sqNum,
+        uint32_t timeAllowedToLive, uint64_t publisherTimeInUs, uint64_t receiveTimeInUs);
+
+/**
+ * \brief copy the current counters of the stream. Can be called by any thread without blocking the receiver.
+ */
+void
+SupervisedStream_getStatistics(SupervisedStream self, StreamStatistics* statistics);
+
+/**@}*/
+
+#endif /* STREAM_SUPERVISOR_H_ */
@@ -25,6 +25,7 @@
 #define ETHERNET_H_
 
 #include <stdint.h>
+#include <stdbool.h>
 
 /*! \addtogroup hal
    *
@@ -76,6 +77,48 @@ Ethernet_setProtocolFilter(EthernetSocket ethSocket, uint16_t etherType);
 int
 Ethernet_receivePacket(EthernetSocket self, uint8_t* buffer, int bufferSize);
 
+/**
+ * Enable timestamping of received and sent packets.
+ *
+ * Software timestamps are taken by the operating system when the packet passes the network
+ * driver. If hardware timestamps are requested and supported by the interface the
+ * NIC timestamps are used instead.
+ *
+ * \param ethSocket the socket to operate on
+ * \param useHardwareTimestamps try to enable hardware timestamps of the interface
+ *
+ * \return true if timestamping is supported and has been enabled, false otherwise
+ */
+bool
+Ethernet_enableTimestamping(EthernetSocket ethSocket, bool useHardwareTimestamps);
+
+/**
+ * Receive a packet together with its receive timestamp.
+ *
+ * If timestamping is not enabled or no timestamp is provided by the system the time
+ * of the call (Hal_getTimeInNs) is used.
+ *
+ * \param timestamp pointer to store the receive time in nanoseconds since epoch
+ *
+ * \return the size of the received packet or 0 if no packet is available
+ */
+int
+Ethernet_receivePacketWithTimestamp(EthernetSocket self, uint8_t* buffer, int bufferSize, uint64_t* timestamp);
+
+/**
+ * Get the transmit timestamp of the last sent packet.
+ *
+ * Requires that timestamping is enabled. The timestamp is reported asynchronously by the
+ * operating system. The function waits at most timeoutInMs milliseconds for it.
+ *
+ * \param timestamp pointer to store the transmit time in nanoseconds since epoch
+ * \param timeoutInMs maximum time to wait for the timestamp
+ *
+ * \return true if a timestamp is available, false otherwise
+ */
+bool
+Ethernet_getTransmitTimestamp(EthernetSocket ethSocket, uint64_t* timestamp, int timeoutInMs);
+
 /*! @} */
 
 /*! @} */
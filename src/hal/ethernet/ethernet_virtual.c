@@ -0,0 +1,571 @@
+/*
+ *  ethernet_virtual.c
+ *
+ *  Copyright 2014 Michael Zillgith
+ *
+ *  This file is part of libIEC61850.
+ *
+ *  libIEC61850 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libIEC61850 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libIEC61850.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  See COPYING file for the complete license text.
+ */
+
+#include "libiec61850_platform_includes.h"
+
+#include "stack_config.h"
+#include "ethernet_virtual.h"
+#include "linked_list.h"
+#include "thread.h"
+#include "atomic_operations.h"
+
+#define VIRTUAL_ETHERNET_MAX_FRAME_SIZE 1518
+
+/* number of frames a loopback socket can buffer before frames are dropped */
+#define LOOPBACK_QUEUE_SIZE 256
+
+#define PCAP_MAGIC_US 0xa1b2c3d4
+#define PCAP_MAGIC_NS 0xa1b23c4d
+#define PCAP_LINKTYPE_ETHERNET 1
+
+typedef enum {
+    VIRTUAL_ETHERNET_LOOPBACK,
+    VIRTUAL_ETHERNET_PCAP_READ,
+    VIRTUAL_ETHERNET_PCAP_TIMED,
+    VIRTUAL_ETHERNET_PCAP_RECORD
+} VirtualEthernetType;
+
+typedef struct sLoopbackBus* LoopbackBus;
+
+struct sLoopbackBus {
+    char* name;
+    LinkedList sockets;
+    Semaphore lock;
+};
+
+struct sVirtualEthernetSocket {
+    VirtualEthernetType type;
+    uint16_t etherType; /* 0 = receive all packets */
+    uint64_t lastTransmitTimestamp;
+
+    /* loopback bus */
+    LoopbackBus bus;
+    uint8_t* frames;
+    int frameSizes[LOOPBACK_QUEUE_SIZE];
+    uint64_t frameTimestamps[LOOPBACK_QUEUE_SIZE];
+    int queueHead;
+    int queueCount;
+    uint32_t droppedFrames;
+
+    /* pcap file */
+    FILE* pcapFile;
+    bool swapByteOrder;
+    bool nanosecondTimestamps;
+    uint32_t snapLength;
+    uint64_t firstPacketTimestamp;
+    uint64_t replayStartTime;
+    uint8_t* pendingFrame; /* frame that was read but is not due yet (timed replay) */
+    int pendingFrameSize;
+    uint64_t pendingFrameTimestamp;
+};
+
+static LinkedList loopbackBuses = NULL;
+static Semaphore loopbackBusesLock = NULL;
+static volatile int32_t loopbackInitState = 0; /* 0 - not initialized, 1 - in progress, 2 - done */
+
+static bool
+hasPrefix(const char* string, const char* prefix)
+{
+    return (strncmp(string, prefix, strlen(prefix)) == 0);
+}
+
+bool
+VirtualEthernet_isVirtualInterface(char* interfaceId)
+{
+    if (interfaceId == NULL)
+        return false;
+
+    if (hasPrefix(interfaceId, VIRTUAL_ETHERNET_LOOPBACK_PREFIX))
+        return true;
+
+    if (hasPrefix(interfaceId, VIRTUAL_ETHERNET_PCAP_PREFIX))
+        return true;
+
+    if (hasPrefix(interfaceId, VIRTUAL_ETHERNET_PCAP_TIMED_PREFIX))
+        return true;
+
+    if (hasPrefix(interfaceId, VIRTUAL_ETHERNET_PCAP_RECORD_PREFIX))
+        return true;
+
+    return false;
+}
+
+void
+VirtualEthernet_getInterfaceMACAddress(char* interfaceId, uint8_t* addr)
+{
+    /* locally administered address */
+    static const uint8_t virtualMacAddress[] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+
+    memcpy(addr, virtualMacAddress, 6);
+}
+
+static uint16_t
+getEtherType(uint8_t* buffer, int packetSize)
+{
+    if (packetSize < 14)
+        return 0;
+
+    uint16_t etherType = (buffer[12] << 8) + buffer[13];
+
+    /* skip VLAN tag */
+    if ((etherType == 0x8100) && (packetSize >= 18))
+        etherType = (buffer[16] << 8) + buffer[17];
+
+    return etherType;
+}
+
+/********************************************************************************************
+ * In-process loopback bus
+ ********************************************************************************************/
+
+static void
+initializeLoopbackBuses(void)
+{
+    if (Atomic_load32(&loopbackInitState) == 2)
+        return;
+
+    if (Atomic_exchange32(&loopbackInitState, 1) == 0) {
+        loopbackBusesLock = Semaphore_create(1);
+        loopbackBuses = LinkedList_create();
+        Atomic_store32(&loopbackInitState, 2);
+    }
+    else {
+        while (Atomic_load32(&loopbackInitState) != 2)
+            Thread_sleep(1);
+    }
+}
+
+static LoopbackBus
+connectToLoopbackBus(char* busName, VirtualEthernetSocket socket)
+{
+    initializeLoopbackBuses();
+
+    Semaphore_wait(loopbackBusesLock);
+
+    LoopbackBus bus = NULL;
+
+    LinkedList element = LinkedList_getNext(loopbackBuses);
+
+    while (element != NULL) {
+        LoopbackBus candidate = (LoopbackBus) element->data;
+
+        if (strcmp(candidate->name, busName) == 0) {
+            bus = candidate;
+            break;
+        }
+
+        element = LinkedList_getNext(element);
+    }
+
+    if (bus == NULL) {
+        bus = (LoopbackBus) calloc(1, sizeof(struct sLoopbackBus));
+        bus->name = copyString(busName);
+        bus->sockets = LinkedList_create();
+        bus->lock = Semaphore_create(1);
+
+        LinkedList_add(loopbackBuses, bus);
+    }
+
+    Semaphore_wait(bus->lock);
+    LinkedList_add(bus->sockets, socket);
+    Semaphore_post(bus->lock);
+
+    Semaphore_post(loopbackBusesLock);
+
+    return bus;
+}
+
+static void
+disconnectFromLoopbackBus(LoopbackBus bus, VirtualEthernetSocket socket)
+{
+    Semaphore_wait(loopbackBusesLock);
+
+    Semaphore_wait(bus->lock);
+    LinkedList_remove(bus->sockets, socket);
+    Semaphore_post(bus->lock);
+
+    if (LinkedList_size(bus->sockets) == 0) {
+        LinkedList_remove(loopbackBuses, bus);
+        LinkedList_destroyStatic(bus->sockets);
+        Semaphore_destroy(bus->lock);
+        free(bus->name);
+        free(bus);
+    }
+
+    Semaphore_post(loopbackBusesLock);
+}
+
+static void
+loopbackSendPacket(VirtualEthernetSocket self, uint8_t* buffer, int packetSize, uint64_t timestamp)
+{
+    LoopbackBus bus = self->bus;
+
+    uint16_t etherType = getEtherType(buffer, packetSize);
+
+    Semaphore_wait(bus->lock);
+
+    LinkedList element = LinkedList_getNext(bus->sockets);
+
+    while (element != NULL) {
+        VirtualEthernetSocket receiver = (VirtualEthernetSocket) element->data;
+
+        if ((receiver != self) && ((receiver->etherType == 0) || (receiver->etherType == etherType))) {
+
+            if (receiver->queueCount < LOOPBACK_QUEUE_SIZE) {
+                int index = (receiver->queueHead + receiver->queueCount) % LOOPBACK_QUEUE_SIZE;
+
+                memcpy(receiver->frames + (index * VIRTUAL_ETHERNET_MAX_FRAME_SIZE), buffer, packetSize);
+                receiver->frameSizes[index] = packetSize;
+                receiver->frameTimestamps[index] = timestamp;
+                receiver->queueCount++;
+            }
+            else
+                receiver->droppedFrames++;
+        }
+
+        element = LinkedList_getNext(element);
+    }
+
+    Semaphore_post(bus->lock);
+}
+
+static int
+loopbackReceivePacket(VirtualEthernetSocket self, uint8_t* buffer, int bufferSize, uint64_t* timestamp)
+{
+    int packetSize = 0;
+
+    Semaphore_wait(self->bus->lock);
+
+    if (self->queueCount > 0) {
+        int index = self->queueHead;
+
+        packetSize = self->frameSizes[index];
+
+        if (packetSize > bufferSize)
+            packetSize = bufferSize;
+
+        memcpy(buffer, self->frames + (index * VIRTUAL_ETHERNET_MAX_FRAME_SIZE), packetSize);
+        *timestamp = self->frameTimestamps[index];
+
+        self->queueHead = (self->queueHead + 1) % LOOPBACK_QUEUE_SIZE;
+        self->queueCount--;
+    }
+
+    Semaphore_post(self->bus->lock);
+
+    return packetSize;
+}
+
+/********************************************************************************************
+ * pcap file replay and recording
+ ********************************************************************************************/
+
+static uint32_t
+pcapToHostOrder(VirtualEthernetSocket self, uint32_t value)
+{
+    if (self->swapByteOrder)
+        return ((value & 0xff) << 24) | ((value & 0xff00) << 8) | ((value >> 8) & 0xff00) | (value >> 24);
+    else
+        return value;
+}
+
+static bool
+pcapReadHeader(VirtualEthernetSocket self)
+{
+    uint32_t header[6];
+
+    if (fread(header, sizeof(header), 1, self->pcapFile) != 1)
+        return false;
+
+    switch (header[0]) {
+    case PCAP_MAGIC_US:
+        break;
+    case PCAP_MAGIC_NS:
+        self->nanosecondTimestamps = true;
+        break;
+    default:
+        self->swapByteOrder = true;
+
+        if (pcapToHostOrder(self, header[0]) == PCAP_MAGIC_NS)
+            self->nanosecondTimestamps = true;
+        else if (pcapToHostOrder(self, header[0]) != PCAP_MAGIC_US)
+            return false;
+        break;
+    }
+
+    if (pcapToHostOrder(self, header[5]) != PCAP_LINKTYPE_ETHERNET) {
+        if (DEBUG) printf("VIRTUAL_ETHERNET: pcap file has unsupported link type\n");
+        return false;
+    }
+
+    self->snapLength = pcapToHostOrder(self, header[4]);
+
+    return true;
+}
+
+static void
+pcapWriteHeader(VirtualEthernetSocket self)
+{
+    uint32_t header[6];
+    uint16_t* version = (uint16_t*) &(header[1]);
+
+    header[0] = PCAP_MAGIC_NS;
+    version[0] = 2; /* major */
+    version[1] = 4; /* minor */
+    header[2] = 0; /* time zone */
+    header[3] = 0; /* accuracy */
+    header[4] = VIRTUAL_ETHERNET_MAX_FRAME_SIZE; /* snap length */
+    header[5] = PCAP_LINKTYPE_ETHERNET;
+
+    fwrite(header, sizeof(header), 1, self->pcapFile);
+}
+
+/* returns the size of the packet, 0 at the end of the file or when the file is corrupt */
+static int
+pcapReadPacket(VirtualEthernetSocket self, uint8_t* buffer, int bufferSize, uint64_t* timestamp)
+{
+    uint32_t recordHeader[4];
+
+    if (fread(recordHeader, sizeof(recordHeader), 1, self->pcapFile) != 1)
+        return 0;
+
+    uint64_t seconds = pcapToHostOrder(self, recordHeader[0]);
+    uint64_t fraction = pcapToHostOrder(self, recordHeader[1]);
+    uint32_t includedLength = pcapToHostOrder(self, recordHeader[2]);
+
+    if ((includedLength == 0) || (includedLength > VIRTUAL_ETHERNET_MAX_FRAME_SIZE) ||
+            ((self->snapLength != 0) && (includedLength > self->snapLength)))
+    {
+        if (DEBUG) printf("VIRTUAL_ETHERNET: invalid pcap record length %u - end of replay\n", includedLength);
+
+        /* the following records can't be located - end the replay */
+        fseek(self->pcapFile, 0, SEEK_END);
+
+        return 0;
+    }
+
+    if (self->nanosecondTimestamps)
+        *timestamp = (seconds * 1000000000ULL) + fraction;
+    else
+        *timestamp = (seconds * 1000000000ULL) + (fraction * 1000ULL);
+
+    int packetSize = (int) includedLength;
+
+    if (packetSize > bufferSize)
+        packetSize = bufferSize;
+
+    if (fread(buffer, 1, packetSize, self->pcapFile) != (size_t) packetSize)
+        return 0;
+
+    /* skip the part of the packet that doesn't fit into the buffer */
+    if ((int) includedLength > packetSize)
+        fseek(self->pcapFile, (long) includedLength - packetSize, SEEK_CUR);
+
+    return packetSize;
+}
+
+static int
+pcapReceivePacket(VirtualEthernetSocket self, uint8_t* buffer, int bufferSize, uint64_t* timestamp)
+{
+    while (true) {
+        if (self->pendingFrameSize == 0) {
+            self->pendingFrameSize = pcapReadPacket(self, self->pendingFrame, VIRTUAL_ETHERNET_MAX_FRAME_SIZE,
+                    &(self->pendingFrameTimestamp));
+
+            if (self->pendingFrameSize == 0)
+                return 0;
+
+            if (self->firstPacketTimestamp == 0) {
+                self->firstPacketTimestamp = self->pendingFrameTimestamp;
+                self->replayStartTime = Hal_getTimeInNs();
+            }
+        }
+
+        if (self->type == VIRTUAL_ETHERNET_PCAP_TIMED) {
+            uint64_t elapsedTime = Hal_getTimeInNs() - self->replayStartTime;
+
+            if ((self->pendingFrameTimestamp - self->firstPacketTimestamp) > elapsedTime)
+                return 0;
+        }
+
+        int packetSize = self->pendingFrameSize;
+
+        self->pendingFrameSize = 0;
+
+        if ((self->etherType != 0) && (getEtherType(self->pendingFrame, packetSize) != self->etherType))
+            continue;
+
+        if (packetSize > bufferSize)
+            packetSize = bufferSize;
+
+        memcpy(buffer, self->pendingFrame, packetSize);
+        *timestamp = self->pendingFrameTimestamp;
+
+        return packetSize;
+    }
+}
+
+static void
+pcapWritePacket(VirtualEthernetSocket self, uint8_t* buffer, int packetSize, uint64_t timestamp)
+{
+    uint32_t recordHeader[4];
+
+    recordHeader[0] = (uint32_t) (timestamp / 1000000000ULL);
+    recordHeader[1] = (uint32_t) (timestamp % 1000000000ULL);
+    recordHeader[2] = packetSize;
+    recordHeader[3] = packetSize;
+
+    fwrite(recordHeader, sizeof(recordHeader), 1, self->pcapFile);
+    fwrite(buffer, 1, packetSize, self->pcapFile);
+}
+
+/********************************************************************************************
+ * Socket interface
+ ********************************************************************************************/
+
+VirtualEthernetSocket
+VirtualEthernet_createSocket(char* interfaceId, uint8_t* destAddress)
+{
+    VirtualEthernetSocket self = (VirtualEthernetSocket) calloc(1, sizeof(struct sVirtualEthernetSocket));
+
+    if (hasPrefix(interfaceId, VIRTUAL_ETHERNET_LOOPBACK_PREFIX)) {
+        char* busName = interfaceId + strlen(VIRTUAL_ETHERNET_LOOPBACK_PREFIX);
+
+        if (*busName == ':')
+            busName++;
+
+        self->type = VIRTUAL_ETHERNET_LOOPBACK;
+        self->frames = (uint8_t*) malloc(LOOPBACK_QUEUE_SIZE * VIRTUAL_ETHERNET_MAX_FRAME_SIZE);
+        self->bus = connectToLoopbackBus(busName, self);
+    }
+    else if (hasPrefix(interfaceId, VIRTUAL_ETHERNET_PCAP_RECORD_PREFIX)) {
+        self->type = VIRTUAL_ETHERNET_PCAP_RECORD;
+        self->pcapFile = fopen(interfaceId + strlen(VIRTUAL_ETHERNET_PCAP_RECORD_PREFIX), "wb");
+
+        if (self->pcapFile == NULL)
+            goto exit_with_error;
+
+        pcapWriteHeader(self);
+    }
+    else {
+        char* fileName;
+
+        if (hasPrefix(interfaceId, VIRTUAL_ETHERNET_PCAP_TIMED_PREFIX)) {
+            self->type = VIRTUAL_ETHERNET_PCAP_TIMED;
+            fileName = interfaceId + strlen(VIRTUAL_ETHERNET_PCAP_TIMED_PREFIX);
+        }
+        else {
+            self->type = VIRTUAL_ETHERNET_PCAP_READ;
+            fileName = interfaceId + strlen(VIRTUAL_ETHERNET_PCAP_PREFIX);
+        }
+
+        self->pcapFile = fopen(fileName, "rb");
+
+        if (self->pcapFile == NULL)
+            goto exit_with_error;
+
+        if (pcapReadHeader(self) == false) {
+            fclose(self->pcapFile);
+            goto exit_with_error;
+        }
+
+        self->pendingFrame = (uint8_t*) malloc(VIRTUAL_ETHERNET_MAX_FRAME_SIZE);
+    }
+
+    return self;
+
+exit_with_error:
+    if (DEBUG) printf("VIRTUAL_ETHERNET: failed to open %s\n", interfaceId);
+    free(self);
+    return NULL;
+}
+
+void
+VirtualEthernet_destroySocket(VirtualEthernetSocket self)
+{
+    if (self->type == VIRTUAL_ETHERNET_LOOPBACK) {
+        disconnectFromLoopbackBus(self->bus, self);
+
+        if (DEBUG)
+            if (self->droppedFrames > 0)
+                printf("VIRTUAL_ETHERNET: loopback socket dropped %u frames\n", self->droppedFrames);
+
+        free(self->frames);
+    }
+    else {
+        fclose(self->pcapFile);
+
+        if (self->pendingFrame != NULL)
+            free(self->pendingFrame);
+    }
+
+    free(self);
+}
+
+void
+VirtualEthernet_sendPacket(VirtualEthernetSocket self, uint8_t* buffer, int packetSize)
+{
+    uint64_t timestamp = Hal_getTimeInNs();
+
+    if (packetSize > VIRTUAL_ETHERNET_MAX_FRAME_SIZE)
+        return;
+
+    if (self->type == VIRTUAL_ETHERNET_LOOPBACK)
+        loopbackSendPacket(self, buffer, packetSize, timestamp);
+    else if (self->type == VIRTUAL_ETHERNET_PCAP_RECORD)
+        pcapWritePacket(self, buffer, packetSize, timestamp);
+
+    self->lastTransmitTimestamp = timestamp;
+}
+
+void
+VirtualEthernet_setProtocolFilter(VirtualEthernetSocket self, uint16_t etherType)
+{
+    if (self->type == VIRTUAL_ETHERNET_LOOPBACK) {
+        Semaphore_wait(self->bus->lock);
+        self->etherType = etherType;
+        Semaphore_post(self->bus->lock);
+    }
+    else
+        self->etherType = etherType;
+}
+
+int
+VirtualEthernet_receivePacket(VirtualEthernetSocket self, uint8_t* buffer, int bufferSize, uint64_t* timestamp)
+{
+    switch (self->type) {
+    case VIRTUAL_ETHERNET_LOOPBACK:
+        return loopbackReceivePacket(self, buffer, bufferSize, timestamp);
+    case VIRTUAL_ETHERNET_PCAP_READ:
+    case VIRTUAL_ETHERNET_PCAP_TIMED:
+        return pcapReceivePacket(self, buffer, bufferSize, timestamp);
+    default:
+        return 0;
+    }
+}
+
+uint64_t
+VirtualEthernet_getLastTransmitTimestamp(VirtualEthernetSocket self)
+{
+    return self->lastTransmitTimestamp;
+}
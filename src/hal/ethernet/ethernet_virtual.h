@@ -0,0 +1,75 @@
+/*
+ *  ethernet_virtual.h
+ *
+ *  Virtual Ethernet backends (pcap files and in-process loopback bus) that can be
+ *  used instead of a real network interface.
+ *
+ *  Copyright 2014 Michael Zillgith
+ *
+ *  This file is part of libIEC61850.
+ *
+ *  libIEC61850 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libIEC61850 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libIEC61850.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  See COPYING file for the complete license text.
+ */
+
+#ifndef ETHERNET_VIRTUAL_H_
+#define ETHERNET_VIRTUAL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * The virtual backends are selected by the interface ID:
+ *
+ * "loopback" or "loopback:<bus>"  - in-process bus. Every packet sent by a socket is delivered to all
+ *                                   other sockets connected to the same bus.
+ * "pcap:<file>"                   - receive the packets of a pcap file as fast as possible
+ * "pcap-timed:<file>"             - receive the packets of a pcap file with the original timing
+ * "pcap-record:<file>"            - write all sent packets to a pcap file
+ */
+
+#define VIRTUAL_ETHERNET_LOOPBACK_PREFIX "loopback"
+#define VIRTUAL_ETHERNET_PCAP_PREFIX "pcap:"
+#define VIRTUAL_ETHERNET_PCAP_TIMED_PREFIX "pcap-timed:"
+#define VIRTUAL_ETHERNET_PCAP_RECORD_PREFIX "pcap-record:"
+
+typedef struct sVirtualEthernetSocket* VirtualEthernetSocket;
+
+bool
+VirtualEthernet_isVirtualInterface(char* interfaceId);
+
+void
+VirtualEthernet_getInterfaceMACAddress(char* interfaceId, uint8_t* addr);
+
+VirtualEthernetSocket
+VirtualEthernet_createSocket(char* interfaceId, uint8_t* destAddress);
+
+void
+VirtualEthernet_destroySocket(VirtualEthernetSocket self);
+
+void
+VirtualEthernet_sendPacket(VirtualEthernetSocket self, uint8_t* buffer, int packetSize);
+
+void
+VirtualEthernet_setProtocolFilter(VirtualEthernetSocket self, uint16_t etherType);
+
+/* non-blocking - returns 0 if no packet is available */
+int
+VirtualEthernet_receivePacket(VirtualEthernetSocket self, uint8_t* buffer, int bufferSize, uint64_t* timestamp);
+
+uint64_t
+VirtualEthernet_getLastTransmitTimestamp(VirtualEthernetSocket self);
+
+#endif /* ETHERNET_VIRTUAL_H_ */
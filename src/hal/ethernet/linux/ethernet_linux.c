@@ -26,8 +26,12 @@
 #include <linux/if_packet.h>
 #include <linux/if_ether.h>
 #include <linux/if_arp.h>
+#include <linux/net_tstamp.h>
+#include <linux/sockios.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <poll.h>
+#include <time.h>
 
 #include <stdint.h>
 #include <stdlib.h>
@@ -35,12 +39,35 @@
 #include <stdbool.h>
 #include <stdio.h>
 
+#include "stack_config.h"
+#include "hal.h"
 #include "ethernet.h"
+#include "ethernet_virtual.h"
+
+#if (CONFIG_ETHERNET_USE_AF_XDP == 1)
+#include "ethernet_xdp.h"
+#endif
+
+#ifndef SO_TIMESTAMPING
+#define SO_TIMESTAMPING 37
+#endif
+
+#ifndef SCM_TIMESTAMPING
+#define SCM_TIMESTAMPING SO_TIMESTAMPING
+#endif
+
+#define TIMESTAMP_CONTROL_BUFFER_SIZE 256
 
 struct sEthernetSocket {
     int rawSocket;
     bool isBind;
     struct sockaddr_ll socketAddress;
+    char interfaceName[IFNAMSIZ];
+    bool timestampingEnabled;
+    VirtualEthernetSocket virtualSocket; /* used instead of the raw socket for virtual interfaces */
+#if (CONFIG_ETHERNET_USE_AF_XDP == 1)
+    XdpEthernetSocket xdpSocket; /* used instead of the raw socket for "xdp:" interfaces */
+#endif
 };
 
 static int
@@ -77,6 +104,18 @@ getInterfaceIndex(int sock, char* deviceName)
 void
 Ethernet_getInterfaceMACAddress(char* interfaceId, uint8_t* addr)
 {
+    if (VirtualEthernet_isVirtualInterface(interfaceId)) {
+        VirtualEthernet_getInterfaceMACAddress(interfaceId, addr);
+        return;
+    }
+
+#if (CONFIG_ETHERNET_USE_AF_XDP == 1)
+    if (XdpEthernet_isXdpInterface(interfaceId)) {
+        XdpEthernet_getInterfaceMACAddress(interfaceId, addr);
+        return;
+    }
+#endif
+
     struct ifreq buffer;
 
     int sock = socket(PF_INET, SOCK_DGRAM, 0);
@@ -103,6 +142,32 @@ Ethernet_createSocket(char* interfaceId, uint8_t* destAddress)
 {
     EthernetSocket ethernetSocket = calloc(1, sizeof(struct sEthernetSocket));
 
+    if (VirtualEthernet_isVirtualInterface(interfaceId)) {
+        ethernetSocket->rawSocket = -1;
+        ethernetSocket->virtualSocket = VirtualEthernet_createSocket(interfaceId, destAddress);
+
+        if (ethernetSocket->virtualSocket == NULL) {
+            free(ethernetSocket);
+            return NULL;
+        }
+
+        return ethernetSocket;
+    }
+
+#if (CONFIG_ETHERNET_USE_AF_XDP == 1)
+    if (XdpEthernet_isXdpInterface(interfaceId)) {
+        ethernetSocket->rawSocket = -1;
+        ethernetSocket->xdpSocket = XdpEthernet_createSocket(interfaceId, destAddress);
+
+        if (ethernetSocket->xdpSocket == NULL) {
+            free(ethernetSocket);
+            return NULL;
+        }
+
+        return ethernetSocket;
+    }
+#endif
+
     ethernetSocket->rawSocket = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
 
     if (ethernetSocket->rawSocket == -1) {
@@ -123,6 +188,8 @@ Ethernet_createSocket(char* interfaceId, uint8_t* destAddress)
 
     memset(ethernetSocket->socketAddress.sll_addr, 0, 8);
 
+    strncpy(ethernetSocket->interfaceName, interfaceId, IFNAMSIZ - 1);
+
     if (destAddress != NULL)
         memcpy(ethernetSocket->socketAddress.sll_addr, destAddress, 6);
 
@@ -134,6 +201,18 @@ Ethernet_createSocket(char* interfaceId, uint8_t* destAddress)
 void
 Ethernet_setProtocolFilter(EthernetSocket ethSocket, uint16_t etherType)
 {
+    if (ethSocket->virtualSocket != NULL) {
+        VirtualEthernet_setProtocolFilter(ethSocket->virtualSocket, etherType);
+        return;
+    }
+
+#if (CONFIG_ETHERNET_USE_AF_XDP == 1)
+    if (ethSocket->xdpSocket != NULL) {
+        XdpEthernet_setProtocolFilter(ethSocket->xdpSocket, etherType);
+        return;
+    }
+#endif
+
     ethSocket->socketAddress.sll_protocol = htons(etherType);
 }
 
@@ -142,6 +221,20 @@ Ethernet_setProtocolFilter(EthernetSocket ethSocket, uint16_t etherType)
 int
 Ethernet_receivePacket(EthernetSocket self, uint8_t* buffer, int bufferSize)
 {
+    if (self->virtualSocket != NULL) {
+        uint64_t timestamp;
+
+        return VirtualEthernet_receivePacket(self->virtualSocket, buffer, bufferSize, &timestamp);
+    }
+
+#if (CONFIG_ETHERNET_USE_AF_XDP == 1)
+    if (self->xdpSocket != NULL) {
+        uint64_t timestamp;
+
+        return XdpEthernet_receivePacket(self->xdpSocket, buffer, bufferSize, &timestamp);
+    }
+#endif
+
     if (self->isBind == false) {
         if (bind(self->rawSocket, (struct sockaddr*) &self->socketAddress, sizeof(self->socketAddress)) == 0)
             self->isBind = true;
@@ -152,9 +245,199 @@ Ethernet_receivePacket(EthernetSocket self, uint8_t* buffer, int bufferSize)
     return recvfrom(self->rawSocket, buffer, bufferSize, MSG_DONTWAIT, 0, 0);
 }
 
+static void
+enableHardwareTimestamps(EthernetSocket self)
+{
+    struct hwtstamp_config hwConfig;
+    struct ifreq ifr;
+
+    memset(&hwConfig, 0, sizeof(hwConfig));
+    memset(&ifr, 0, sizeof(ifr));
+
+    hwConfig.tx_type = HWTSTAMP_TX_ON;
+    hwConfig.rx_filter = HWTSTAMP_FILTER_ALL;
+
+    strncpy(ifr.ifr_name, self->interfaceName, IFNAMSIZ - 1);
+    ifr.ifr_data = (char*) &hwConfig;
+
+    /* fails if the NIC does not support hardware timestamps - then only software timestamps are available */
+    if (ioctl(self->rawSocket, SIOCSHWTSTAMP, &ifr) == -1)
+        perror("ETHERNET_LINUX: hardware timestamps not available");
+}
+
+bool
+Ethernet_enableTimestamping(EthernetSocket ethSocket, bool useHardwareTimestamps)
+{
+    /* virtual sockets always provide timestamps */
+    if (ethSocket->virtualSocket != NULL) {
+        ethSocket->timestampingEnabled = true;
+        return true;
+    }
+
+#if (CONFIG_ETHERNET_USE_AF_XDP == 1)
+    /* AF_XDP sockets only provide software receive timestamps */
+    if (ethSocket->xdpSocket != NULL) {
+        ethSocket->timestampingEnabled = (useHardwareTimestamps == false);
+        return ethSocket->timestampingEnabled;
+    }
+#endif
+
+    int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_TX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+
+    if (useHardwareTimestamps) {
+        enableHardwareTimestamps(ethSocket);
+
+        flags |= SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_TX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+    }
+
+#ifdef SOF_TIMESTAMPING_OPT_TSONLY
+    /* don't loop back the packet data with the transmit timestamp */
+    flags |= SOF_TIMESTAMPING_OPT_TSONLY;
+#endif
+
+    if (setsockopt(ethSocket->rawSocket, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) == -1) {
+        perror("ETHERNET_LINUX: Failed to enable timestamping");
+        return false;
+    }
+
+    ethSocket->timestampingEnabled = true;
+
+    return true;
+}
+
+/* get timestamp from SCM_TIMESTAMPING control message - hardware timestamp has precedence */
+static bool
+getTimestampFromControlMessage(struct msghdr* msg, uint64_t* timestamp)
+{
+    struct cmsghdr* cmsg;
+
+    for (cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+        if ((cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SCM_TIMESTAMPING)) {
+            struct timespec* ts = (struct timespec*) CMSG_DATA(cmsg);
+
+            if ((ts[2].tv_sec != 0) || (ts[2].tv_nsec != 0))
+                *timestamp = ((uint64_t) ts[2].tv_sec * 1000000000ULL) + ts[2].tv_nsec;
+            else
+                *timestamp = ((uint64_t) ts[0].tv_sec * 1000000000ULL) + ts[0].tv_nsec;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int
+Ethernet_receivePacketWithTimestamp(EthernetSocket self, uint8_t* buffer, int bufferSize, uint64_t* timestamp)
+{
+    if (self->virtualSocket != NULL)
+        return VirtualEthernet_receivePacket(self->virtualSocket, buffer, bufferSize, timestamp);
+
+#if (CONFIG_ETHERNET_USE_AF_XDP == 1)
+    if (self->xdpSocket != NULL)
+        return XdpEthernet_receivePacket(self->xdpSocket, buffer, bufferSize, timestamp);
+#endif
+
+    if (self->isBind == false) {
+        if (bind(self->rawSocket, (struct sockaddr*) &self->socketAddress, sizeof(self->socketAddress)) == 0)
+            self->isBind = true;
+        else
+            return 0;
+    }
+
+    struct msghdr msg;
+    struct iovec iov;
+    uint8_t control[TIMESTAMP_CONTROL_BUFFER_SIZE];
+
+    memset(&msg, 0, sizeof(msg));
+
+    iov.iov_base = buffer;
+    iov.iov_len = bufferSize;
+
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    int packetSize = recvmsg(self->rawSocket, &msg, MSG_DONTWAIT);
+
+    if (packetSize > 0) {
+        if ((self->timestampingEnabled == false) || (getTimestampFromControlMessage(&msg, timestamp) == false))
+            *timestamp = Hal_getTimeInNs();
+    }
+
+    return packetSize;
+}
+
+bool
+Ethernet_getTransmitTimestamp(EthernetSocket ethSocket, uint64_t* timestamp, int timeoutInMs)
+{
+    if (ethSocket->timestampingEnabled == false)
+        return false;
+
+    if (ethSocket->virtualSocket != NULL) {
+        *timestamp = VirtualEthernet_getLastTransmitTimestamp(ethSocket->virtualSocket);
+        return true;
+    }
+
+#if (CONFIG_ETHERNET_USE_AF_XDP == 1)
+    if (ethSocket->xdpSocket != NULL)
+        return false;
+#endif
+
+    struct pollfd pfd;
+
+    pfd.fd = ethSocket->rawSocket;
+    pfd.events = POLLERR;
+    pfd.revents = 0;
+
+    if (poll(&pfd, 1, timeoutInMs) <= 0)
+        return false;
+
+    bool timestampFound = false;
+
+    /* read all pending timestamps from the error queue - the last one belongs to the last packet */
+    while (true) {
+        struct msghdr msg;
+        struct iovec iov;
+        uint8_t control[TIMESTAMP_CONTROL_BUFFER_SIZE];
+        uint8_t data[64];
+
+        memset(&msg, 0, sizeof(msg));
+
+        iov.iov_base = data;
+        iov.iov_len = sizeof(data);
+
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        if (recvmsg(ethSocket->rawSocket, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+            break;
+
+        if (getTimestampFromControlMessage(&msg, timestamp))
+            timestampFound = true;
+    }
+
+    return timestampFound;
+}
+
 void
 Ethernet_sendPacket(EthernetSocket ethSocket, uint8_t* buffer, int packetSize)
 {
+    if (ethSocket->virtualSocket != NULL) {
+        VirtualEthernet_sendPacket(ethSocket->virtualSocket, buffer, packetSize);
+        return;
+    }
+
+#if (CONFIG_ETHERNET_USE_AF_XDP == 1)
+    if (ethSocket->xdpSocket != NULL) {
+        XdpEthernet_sendPacket(ethSocket->xdpSocket, buffer, packetSize);
+        return;
+    }
+#endif
+
     sendto(ethSocket->rawSocket, buffer, packetSize,
                 0, (struct sockaddr*) &(ethSocket->socketAddress), sizeof(ethSocket->socketAddress));
 }
@@ -162,7 +445,15 @@ Ethernet_sendPacket(EthernetSocket ethSocket, uint8_t* buffer, int packetSize)
 void
 Ethernet_destroySocket(EthernetSocket ethSocket)
 {
-    close(ethSocket->rawSocket);
+    if (ethSocket->virtualSocket != NULL)
+        VirtualEthernet_destroySocket(ethSocket->virtualSocket);
+#if (CONFIG_ETHERNET_USE_AF_XDP == 1)
+    else if (ethSocket->xdpSocket != NULL)
+        XdpEthernet_destroySocket(ethSocket->xdpSocket);
+#endif
+    else
+        close(ethSocket->rawSocket);
+
     free(ethSocket);
 }
 
@@ -0,0 +1,865 @@
+/*
+ *  ethernet_xdp.c
+ *
+ *  AF_XDP backend for the Linux Ethernet HAL. Uses the kernel interfaces directly (no libbpf).
+ *
+ *  Copyright 2014 Michael Zillgith
+ *
+ *  This file is part of libIEC61850.
+ *
+ *  libIEC61850 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libIEC61850 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libIEC61850.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  See COPYING file for the complete license text.
+ */
+
+#include "stack_config.h"
+
+#if (CONFIG_ETHERNET_USE_AF_XDP == 1)
+
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#include <linux/if_xdp.h>
+#include <linux/if_link.h>
+#include <linux/bpf.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "hal.h"
+#include "thread.h"
+#include "atomic_operations.h"
+#include "ethernet_xdp.h"
+
+#ifndef AF_XDP
+#define AF_XDP 44
+#endif
+
+#ifndef SOL_XDP
+#define SOL_XDP 283
+#endif
+
+/* UMEM layout: the first half of the frames is used for reception, the second half for transmission */
+#define XDP_FRAME_SIZE 2048
+#define XDP_NUMBER_OF_FRAMES 4096
+#define XDP_RX_FRAMES (XDP_NUMBER_OF_FRAMES / 2)
+#define XDP_TX_FRAMES (XDP_NUMBER_OF_FRAMES - XDP_RX_FRAMES)
+
+/* number of entries of each ring - has to be a power of 2 */
+#define XDP_RING_SIZE 2048
+
+/* maximum number of descriptors that are taken from the RX ring at once */
+#define XDP_RX_BATCH_SIZE 64
+
+/* maximum number of queues per interface that can be used with AF_XDP sockets */
+#define XDP_MAX_QUEUES 64
+
+#define XDP_MAX_INTERFACES 16
+
+typedef struct {
+    volatile uint32_t* producer;
+    volatile uint32_t* consumer;
+    volatile uint32_t* flags;
+    void* descriptors;
+    uint32_t mask;
+    void* map;
+    size_t mapSize;
+} XdpRing;
+
+typedef struct {
+    int ifIndex;
+    int mapFd;
+    int programFd;
+    int linkFd;
+    bool genericMode;
+    int referenceCount;
+} XdpProgram;
+
+struct sXdpEthernetSocket {
+    int xsk;
+    int ifIndex;
+    uint32_t queueId;
+    XdpProgram* program;
+    bool zeroCopy;
+
+    uint8_t* umem;
+    size_t umemSize;
+
+    XdpRing fillRing;
+    XdpRing completionRing;
+    XdpRing rxRing;
+    XdpRing txRing;
+
+    uint16_t etherType; /* 0 = receive all redirected frames */
+
+    /* descriptors taken from the RX ring that are not yet delivered to the user */
+    struct xdp_desc rxBatch[XDP_RX_BATCH_SIZE];
+    int rxBatchSize;
+    int rxBatchPosition;
+    uint64_t rxBatchTimestamp;
+
+    /* TX frames that are owned by user space */
+    uint64_t freeTxFrames[XDP_TX_FRAMES];
+    int freeTxFrameCount;
+};
+
+static XdpProgram programs[XDP_MAX_INTERFACES];
+static Semaphore programsLock = NULL;
+static volatile int32_t programsInitState = 0; /* 0 - not initialized, 1 - in progress, 2 - done */
+
+static bool
+hasPrefix(const char* string, const char* prefix)
+{
+    return (strncmp(string, prefix, strlen(prefix)) == 0);
+}
+
+bool
+XdpEthernet_isXdpInterface(char* interfaceId)
+{
+    if (interfaceId == NULL)
+        return false;
+
+    return hasPrefix(interfaceId, XDP_ETHERNET_PREFIX);
+}
+
+/* split "xdp:<interface>[:<queue>]" */
+static bool
+parseInterfaceId(char* interfaceId, char* interfaceName, uint32_t* queueId)
+{
+    const char* name = interfaceId + strlen(XDP_ETHERNET_PREFIX);
+    const char* separator = strchr(name, ':');
+
+    int nameLength = (separator != NULL) ? (int) (separator - name) : (int) strlen(name);
+
+    if ((nameLength == 0) || (nameLength >= IFNAMSIZ))
+        return false;
+
+    memcpy(interfaceName, name, nameLength);
+    interfaceName[nameLength] = 0;
+
+    *queueId = (separator != NULL) ? (uint32_t) atoi(separator + 1) : 0;
+
+    return (*queueId < XDP_MAX_QUEUES);
+}
+
+void
+XdpEthernet_getInterfaceMACAddress(char* interfaceId, uint8_t* addr)
+{
+    char interfaceName[IFNAMSIZ];
+    uint32_t queueId;
+    struct ifreq buffer;
+
+    memset(addr, 0, 6);
+
+    if (parseInterfaceId(interfaceId, interfaceName, &queueId) == false)
+        return;
+
+    int sock = socket(PF_INET, SOCK_DGRAM, 0);
+
+    memset(&buffer, 0x00, sizeof(buffer));
+    strcpy(buffer.ifr_name, interfaceName);
+
+    if (ioctl(sock, SIOCGIFHWADDR, &buffer) == 0)
+        memcpy(addr, buffer.ifr_hwaddr.sa_data, 6);
+
+    close(sock);
+}
+
+static bool
+setPromiscuousMode(char* interfaceName)
+{
+    struct ifreq ifr;
+    bool success = false;
+
+    int sock = socket(PF_INET, SOCK_DGRAM, 0);
+
+    memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, interfaceName, IFNAMSIZ - 1);
+
+    if (ioctl(sock, SIOCGIFFLAGS, &ifr) == 0) {
+        ifr.ifr_flags |= IFF_PROMISC;
+
+        if (ioctl(sock, SIOCSIFFLAGS, &ifr) == 0)
+            success = true;
+    }
+
+    close(sock);
+
+    return success;
+}
+
+/********************************************************************************************
+ * XDP program handling
+ ********************************************************************************************/
+
+static int
+bpf(int command, union bpf_attr* attr)
+{
+    return syscall(__NR_bpf, command, attr, sizeof(*attr));
+}
+
+#define BPF_INSN(CODE, DST, SRC, OFF, IMM) \
+    ((struct bpf_insn) { .code = (CODE), .dst_reg = (DST), .src_reg = (SRC), .off = (OFF), .imm = (IMM) })
+
+#define INSN_LDX_MEM(SIZE, DST, SRC, OFF) BPF_INSN(BPF_LDX | BPF_SIZE(SIZE) | BPF_MEM, DST, SRC, OFF, 0)
+#define INSN_MOV64_REG(DST, SRC) BPF_INSN(BPF_ALU64 | BPF_MOV | BPF_X, DST, SRC, 0, 0)
+#define INSN_MOV64_IMM(DST, IMM) BPF_INSN(BPF_ALU64 | BPF_MOV | BPF_K, DST, 0, 0, IMM)
+#define INSN_ADD64_IMM(DST, IMM) BPF_INSN(BPF_ALU64 | BPF_ADD | BPF_K, DST, 0, 0, IMM)
+#define INSN_JMP_REG(OP, DST, SRC, OFF) BPF_INSN(BPF_JMP | (OP) | BPF_X, DST, SRC, OFF, 0)
+#define INSN_JMP_IMM(OP, DST, IMM, OFF) BPF_INSN(BPF_JMP | (OP) | BPF_K, DST, 0, OFF, IMM)
+#define INSN_CALL(FUNCTION) BPF_INSN(BPF_JMP | BPF_CALL, 0, 0, 0, FUNCTION)
+#define INSN_EXIT() BPF_INSN(BPF_JMP | BPF_EXIT, 0, 0, 0, 0)
+
+/*
+ * Redirect GOOSE (0x88b8), GSE management (0x88b9) and SV (0x88ba) frames to the AF_XDP
+ * socket of the receive queue. Everything else (or if no socket is bound to the queue)
+ * is passed to the network stack.
+ */
+static int
+loadProgram(int mapFd)
+{
+    struct bpf_insn instructions[] = {
+        /* 0 */ INSN_MOV64_REG(BPF_REG_6, BPF_REG_1),
+        /* 1 */ INSN_LDX_MEM(BPF_W, BPF_REG_2, BPF_REG_6, offsetof(struct xdp_md, data)),
+        /* 2 */ INSN_LDX_MEM(BPF_W, BPF_REG_3, BPF_REG_6, offsetof(struct xdp_md, data_end)),
+        /* 3 */ INSN_MOV64_REG(BPF_REG_4, BPF_REG_2),
+        /* 4 */ INSN_ADD64_IMM(BPF_REG_4, 18),
+        /* 5 */ INSN_JMP_REG(BPF_JGT, BPF_REG_4, BPF_REG_3, 6), /* -> 12 (pass) */
+        /* 6 */ INSN_LDX_MEM(BPF_H, BPF_REG_5, BPF_REG_2, 12),
+        /* 7 */ INSN_JMP_IMM(BPF_JNE, BPF_REG_5, htons(0x8100), 1), /* -> 9 */
+        /* 8 */ INSN_LDX_MEM(BPF_H, BPF_REG_5, BPF_REG_2, 16),
+        /* 9 */ INSN_JMP_IMM(BPF_JEQ, BPF_REG_5, htons(0x88b8), 4), /* -> 14 (redirect) */
+        /* 10 */ INSN_JMP_IMM(BPF_JEQ, BPF_REG_5, htons(0x88b9), 3),
+        /* 11 */ INSN_JMP_IMM(BPF_JEQ, BPF_REG_5, htons(0x88ba), 2),
+        /* 12 */ INSN_MOV64_IMM(BPF_REG_0, XDP_PASS),
+        /* 13 */ INSN_EXIT(),
+        /* 14 */ INSN_LDX_MEM(BPF_W, BPF_REG_2, BPF_REG_6, offsetof(struct xdp_md, rx_queue_index)),
+        /* 15 */ BPF_INSN(BPF_LD | BPF_DW | BPF_IMM, BPF_REG_1, BPF_PSEUDO_MAP_FD, 0, mapFd),
+        /* 16 */ BPF_INSN(0, 0, 0, 0, 0),
+        /* 17 */ INSN_MOV64_IMM(BPF_REG_3, XDP_PASS), /* action if no socket is bound to the queue */
+        /* 18 */ INSN_CALL(BPF_FUNC_redirect_map),
+        /* 19 */ INSN_EXIT()
+    };
+
+    static const char license[] = "GPL";
+    char log[4096];
+
+    union bpf_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+
+    attr.prog_type = BPF_PROG_TYPE_XDP;
+    attr.insns = (uint64_t) (uintptr_t) instructions;
+    attr.insn_cnt = sizeof(instructions) / sizeof(struct bpf_insn);
+    attr.license = (uint64_t) (uintptr_t) license;
+
+    int programFd = bpf(BPF_PROG_LOAD, &attr);
+
+    if (programFd == -1) {
+        perror("ETHERNET_XDP: Failed to load XDP program");
+
+        /* load again to get the verifier output */
+        log[0] = 0;
+
+        attr.log_buf = (uint64_t) (uintptr_t) log;
+        attr.log_size = sizeof(log);
+        attr.log_level = 1;
+
+        if (bpf(BPF_PROG_LOAD, &attr) == -1)
+            printf("%s\n", log);
+    }
+
+    return programFd;
+}
+
+static int
+attachProgram(int programFd, int ifIndex, uint32_t flags)
+{
+    union bpf_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+
+    attr.link_create.prog_fd = programFd;
+    attr.link_create.target_ifindex = ifIndex;
+    attr.link_create.attach_type = BPF_XDP;
+    attr.link_create.flags = flags;
+
+    return bpf(BPF_LINK_CREATE, &attr);
+}
+
+static void
+initializePrograms(void)
+{
+    if (Atomic_load32(&programsInitState) == 2)
+        return;
+
+    if (Atomic_exchange32(&programsInitState, 1) == 0) {
+        programsLock = Semaphore_create(1);
+        Atomic_store32(&programsInitState, 2);
+    }
+    else {
+        while (Atomic_load32(&programsInitState) != 2)
+            Thread_sleep(1);
+    }
+}
+
+/* get the program of the interface - load and attach it if it doesn't exist */
+static XdpProgram*
+getProgram(int ifIndex)
+{
+    XdpProgram* program = NULL;
+    XdpProgram* unused = NULL;
+    int i;
+
+    initializePrograms();
+
+    Semaphore_wait(programsLock);
+
+    for (i = 0; i < XDP_MAX_INTERFACES; i++) {
+        if (programs[i].referenceCount == 0) {
+            if (unused == NULL)
+                unused = &(programs[i]);
+        }
+        else if (programs[i].ifIndex == ifIndex) {
+            program = &(programs[i]);
+            break;
+        }
+    }
+
+    if (program != NULL) {
+        program->referenceCount++;
+        goto exit_function;
+    }
+
+    if (unused == NULL)
+        goto exit_function;
+
+    union bpf_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+
+    attr.map_type = BPF_MAP_TYPE_XSKMAP;
+    attr.key_size = sizeof(uint32_t);
+    attr.value_size = sizeof(uint32_t);
+    attr.max_entries = XDP_MAX_QUEUES;
+
+    int mapFd = bpf(BPF_MAP_CREATE, &attr);
+
+    if (mapFd == -1) {
+        perror("ETHERNET_XDP: Failed to create XSKMAP");
+        goto exit_function;
+    }
+
+    int programFd = loadProgram(mapFd);
+
+    if (programFd == -1) {
+        close(mapFd);
+        goto exit_function;
+    }
+
+    bool genericMode = false;
+
+    int linkFd = attachProgram(programFd, ifIndex, XDP_FLAGS_DRV_MODE);
+
+    if (linkFd == -1) {
+        /* driver has no XDP support -> fall back to generic XDP */
+        genericMode = true;
+
+        linkFd = attachProgram(programFd, ifIndex, XDP_FLAGS_SKB_MODE);
+    }
+
+    if (linkFd == -1) {
+        perror("ETHERNET_XDP: Failed to attach XDP program");
+        close(programFd);
+        close(mapFd);
+        goto exit_function;
+    }
+
+    if (DEBUG)
+        printf("ETHERNET_XDP: attached XDP program to interface %i (%s mode)\n", ifIndex,
+                genericMode ? "generic" : "driver");
+
+    program = unused;
+    program->ifIndex = ifIndex;
+    program->mapFd = mapFd;
+    program->programFd = programFd;
+    program->linkFd = linkFd;
+    program->genericMode = genericMode;
+    program->referenceCount = 1;
+
+exit_function:
+    Semaphore_post(programsLock);
+
+    return program;
+}
+
+static void
+releaseProgram(XdpProgram* program)
+{
+    Semaphore_wait(programsLock);
+
+    program->referenceCount--;
+
+    if (program->referenceCount == 0) {
+        /* closing the last reference of the link detaches the program */
+        close(program->linkFd);
+        close(program->programFd);
+        close(program->mapFd);
+    }
+
+    Semaphore_post(programsLock);
+}
+
+/********************************************************************************************
+ * UMEM and rings
+ ********************************************************************************************/
+
+static bool
+mapRing(int xsk, XdpRing* ring, struct xdp_ring_offset* offsets, off_t pageOffset, size_t descriptorSize)
+{
+    ring->mapSize = offsets->desc + XDP_RING_SIZE * descriptorSize;
+
+    ring->map = mmap(NULL, ring->mapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, xsk, pageOffset);
+
+    if (ring->map == MAP_FAILED) {
+        ring->map = NULL;
+        return false;
+    }
+
+    ring->producer = (volatile uint32_t*) ((uint8_t*) ring->map + offsets->producer);
+    ring->consumer = (volatile uint32_t*) ((uint8_t*) ring->map + offsets->consumer);
+    ring->flags = (volatile uint32_t*) ((uint8_t*) ring->map + offsets->flags);
+    ring->descriptors = (uint8_t*) ring->map + offsets->desc;
+    ring->mask = XDP_RING_SIZE - 1;
+
+    return true;
+}
+
+static void
+unmapRing(XdpRing* ring)
+{
+    if (ring->map != NULL)
+        munmap(ring->map, ring->mapSize);
+}
+
+/* the producer and consumer indices are free running 32 bit counters */
+
+static inline uint32_t
+ringLoadIndex(volatile uint32_t* index)
+{
+    return (uint32_t) Atomic_load32((volatile int32_t*) index);
+}
+
+static inline void
+ringStoreIndex(volatile uint32_t* index, uint32_t value)
+{
+    Atomic_store32((volatile int32_t*) index, (int32_t) value);
+}
+
+/* number of free entries of a ring that is produced by user space (fill and TX ring) */
+static inline uint32_t
+ringFreeEntries(XdpRing* ring)
+{
+    return XDP_RING_SIZE - (*(ring->producer) - ringLoadIndex(ring->consumer));
+}
+
+/* number of available entries of a ring that is consumed by user space (RX and completion ring) */
+static inline uint32_t
+ringAvailableEntries(XdpRing* ring)
+{
+    return ringLoadIndex(ring->producer) - *(ring->consumer);
+}
+
+static void
+fillRingAdd(XdpEthernetSocket self, uint64_t* addresses, int count)
+{
+    XdpRing* ring = &(self->fillRing);
+    uint32_t producer = *(ring->producer);
+    uint64_t* descriptors = (uint64_t*) ring->descriptors;
+    int i;
+
+    /* the fill ring is large enough for all RX frames - so there is always space */
+    for (i = 0; i < count; i++)
+        descriptors[(producer + i) & ring->mask] = addresses[i];
+
+    ringStoreIndex(ring->producer, producer + count);
+}
+
+/* move completed TX frames back to the free list */
+static void
+reapCompletedFrames(XdpEthernetSocket self)
+{
+    XdpRing* ring = &(self->completionRing);
+
+    uint32_t available = ringAvailableEntries(ring);
+
+    if (available == 0)
+        return;
+
+    uint32_t consumer = *(ring->consumer);
+    uint64_t* descriptors = (uint64_t*) ring->descriptors;
+    uint32_t i;
+
+    for (i = 0; i < available; i++)
+        self->freeTxFrames[self->freeTxFrameCount++] = descriptors[(consumer + i) & ring->mask];
+
+    ringStoreIndex(ring->consumer, consumer + available);
+}
+
+static bool
+createUmem(XdpEthernetSocket self)
+{
+    self->umemSize = (size_t) XDP_NUMBER_OF_FRAMES * XDP_FRAME_SIZE;
+
+    self->umem = mmap(NULL, self->umemSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (self->umem == MAP_FAILED) {
+        self->umem = NULL;
+        return false;
+    }
+
+    struct xdp_umem_reg umemRegistration;
+
+    memset(&umemRegistration, 0, sizeof(umemRegistration));
+
+    umemRegistration.addr = (uint64_t) (uintptr_t) self->umem;
+    umemRegistration.len = self->umemSize;
+    umemRegistration.chunk_size = XDP_FRAME_SIZE;
+    umemRegistration.headroom = 0;
+
+    if (setsockopt(self->xsk, SOL_XDP, XDP_UMEM_REG, &umemRegistration, sizeof(umemRegistration)) == -1)
+        return false;
+
+    int ringSize = XDP_RING_SIZE;
+
+    if (setsockopt(self->xsk, SOL_XDP, XDP_UMEM_FILL_RING, &ringSize, sizeof(ringSize)) == -1)
+        return false;
+
+    if (setsockopt(self->xsk, SOL_XDP, XDP_UMEM_COMPLETION_RING, &ringSize, sizeof(ringSize)) == -1)
+        return false;
+
+    if (setsockopt(self->xsk, SOL_XDP, XDP_RX_RING, &ringSize, sizeof(ringSize)) == -1)
+        return false;
+
+    if (setsockopt(self->xsk, SOL_XDP, XDP_TX_RING, &ringSize, sizeof(ringSize)) == -1)
+        return false;
+
+    struct xdp_mmap_offsets offsets;
+    socklen_t optionLength = sizeof(offsets);
+
+    if (getsockopt(self->xsk, SOL_XDP, XDP_MMAP_OFFSETS, &offsets, &optionLength) == -1)
+        return false;
+
+    if (!mapRing(self->xsk, &(self->fillRing), &(offsets.fr), XDP_UMEM_PGOFF_FILL_RING, sizeof(uint64_t)))
+        return false;
+
+    if (!mapRing(self->xsk, &(self->completionRing), &(offsets.cr), XDP_UMEM_PGOFF_COMPLETION_RING, sizeof(uint64_t)))
+        return false;
+
+    if (!mapRing(self->xsk, &(self->rxRing), &(offsets.rx), XDP_PGOFF_RX_RING, sizeof(struct xdp_desc)))
+        return false;
+
+    if (!mapRing(self->xsk, &(self->txRing), &(offsets.tx), XDP_PGOFF_TX_RING, sizeof(struct xdp_desc)))
+        return false;
+
+    /* hand over all RX frames to the kernel */
+    uint64_t addresses[XDP_RX_BATCH_SIZE];
+    int frame = 0;
+
+    while (frame < XDP_RX_FRAMES) {
+        int count = 0;
+
+        while ((count < XDP_RX_BATCH_SIZE) && (frame < XDP_RX_FRAMES))
+            addresses[count++] = (uint64_t) (frame++) * XDP_FRAME_SIZE;
+
+        fillRingAdd(self, addresses, count);
+    }
+
+    for (frame = XDP_RX_FRAMES; frame < XDP_NUMBER_OF_FRAMES; frame++)
+        self->freeTxFrames[self->freeTxFrameCount++] = (uint64_t) frame * XDP_FRAME_SIZE;
+
+    return true;
+}
+
+static bool
+bindSocket(XdpEthernetSocket self, uint16_t flags)
+{
+    struct sockaddr_xdp socketAddress;
+
+    memset(&socketAddress, 0, sizeof(socketAddress));
+
+    socketAddress.sxdp_family = AF_XDP;
+    socketAddress.sxdp_ifindex = self->ifIndex;
+    socketAddress.sxdp_queue_id = self->queueId;
+    socketAddress.sxdp_flags = flags | XDP_USE_NEED_WAKEUP;
+
+    return (bind(self->xsk, (struct sockaddr*) &socketAddress, sizeof(socketAddress)) == 0);
+}
+
+XdpEthernetSocket
+XdpEthernet_createSocket(char* interfaceId, uint8_t* destAddress)
+{
+    char interfaceName[IFNAMSIZ];
+    uint32_t queueId;
+
+    if (parseInterfaceId(interfaceId, interfaceName, &queueId) == false) {
+        printf("ETHERNET_XDP: Invalid interface ID %s\n", interfaceId);
+        return NULL;
+    }
+
+    int ifIndex = if_nametoindex(interfaceName);
+
+    if (ifIndex == 0) {
+        printf("ETHERNET_XDP: Unknown interface %s\n", interfaceName);
+        return NULL;
+    }
+
+    XdpEthernetSocket self = (XdpEthernetSocket) calloc(1, sizeof(struct sXdpEthernetSocket));
+
+    self->ifIndex = ifIndex;
+    self->queueId = queueId;
+
+    self->xsk = socket(AF_XDP, SOCK_RAW, 0);
+
+    if (self->xsk == -1) {
+        perror("ETHERNET_XDP: Failed to create AF_XDP socket");
+        free(self);
+        return NULL;
+    }
+
+    if (createUmem(self) == false) {
+        perror("ETHERNET_XDP: Failed to set up UMEM");
+        goto exit_error;
+    }
+
+    self->program = getProgram(ifIndex);
+
+    if (self->program == NULL)
+        goto exit_error;
+
+    /* zero-copy requires driver support - fall back to copy mode */
+    if ((self->program->genericMode == false) && bindSocket(self, XDP_ZEROCOPY))
+        self->zeroCopy = true;
+    else {
+        if (bindSocket(self, XDP_COPY) == false) {
+            perror("ETHERNET_XDP: Failed to bind AF_XDP socket");
+            goto exit_error;
+        }
+    }
+
+    uint32_t key = queueId;
+    uint32_t value = self->xsk;
+    union bpf_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+
+    attr.map_fd = self->program->mapFd;
+    attr.key = (uint64_t) (uintptr_t) &key;
+    attr.value = (uint64_t) (uintptr_t) &value;
+    attr.flags = BPF_ANY;
+
+    if (bpf(BPF_MAP_UPDATE_ELEM, &attr) == -1) {
+        perror("ETHERNET_XDP: Failed to register AF_XDP socket");
+        goto exit_error;
+    }
+
+    /* required to receive multicast GOOSE/SV frames */
+    if (setPromiscuousMode(interfaceName) == false)
+        perror("ETHERNET_XDP: Setting device to promiscuous mode failed");
+
+    return self;
+
+exit_error:
+    XdpEthernet_destroySocket(self);
+    return NULL;
+}
+
+void
+XdpEthernet_destroySocket(XdpEthernetSocket self)
+{
+    if (self->program != NULL) {
+        uint32_t key = self->queueId;
+        union bpf_attr attr;
+
+        memset(&attr, 0, sizeof(attr));
+
+        attr.map_fd = self->program->mapFd;
+        attr.key = (uint64_t) (uintptr_t) &key;
+
+        bpf(BPF_MAP_DELETE_ELEM, &attr);
+
+        releaseProgram(self->program);
+    }
+
+    unmapRing(&(self->fillRing));
+    unmapRing(&(self->completionRing));
+    unmapRing(&(self->rxRing));
+    unmapRing(&(self->txRing));
+
+    close(self->xsk);
+
+    if (self->umem != NULL)
+        munmap(self->umem, self->umemSize);
+
+    free(self);
+}
+
+void
+XdpEthernet_setProtocolFilter(XdpEthernetSocket self, uint16_t etherType)
+{
+    self->etherType = etherType;
+}
+
+static uint16_t
+getEtherType(uint8_t* buffer, int packetSize)
+{
+    if (packetSize < 14)
+        return 0;
+
+    uint16_t etherType = (buffer[12] << 8) + buffer[13];
+
+    /* skip VLAN tag */
+    if ((etherType == 0x8100) && (packetSize >= 18))
+        etherType = (buffer[16] << 8) + buffer[17];
+
+    return etherType;
+}
+
+/* return the frames of the delivered batch to the kernel and fetch the next batch from the RX ring */
+static bool
+fetchReceiveBatch(XdpEthernetSocket self)
+{
+    uint64_t addresses[XDP_RX_BATCH_SIZE];
+    int i;
+
+    if (self->rxBatchSize > 0) {
+        for (i = 0; i < self->rxBatchSize; i++)
+            addresses[i] = self->rxBatch[i].addr - (self->rxBatch[i].addr % XDP_FRAME_SIZE);
+
+        fillRingAdd(self, addresses, self->rxBatchSize);
+
+        self->rxBatchSize = 0;
+        self->rxBatchPosition = 0;
+    }
+
+    XdpRing* ring = &(self->rxRing);
+
+    uint32_t available = ringAvailableEntries(ring);
+
+    if (available == 0) {
+        if (*(self->fillRing.flags) & XDP_RING_NEED_WAKEUP)
+            recvfrom(self->xsk, NULL, 0, MSG_DONTWAIT, NULL, NULL);
+
+        return false;
+    }
+
+    if (available > XDP_RX_BATCH_SIZE)
+        available = XDP_RX_BATCH_SIZE;
+
+    uint32_t consumer = *(ring->consumer);
+    struct xdp_desc* descriptors = (struct xdp_desc*) ring->descriptors;
+    uint32_t j;
+
+    for (j = 0; j < available; j++)
+        self->rxBatch[j] = descriptors[(consumer + j) & ring->mask];
+
+    ringStoreIndex(ring->consumer, consumer + available);
+
+    self->rxBatchSize = available;
+    self->rxBatchTimestamp = Hal_getTimeInNs();
+
+    return true;
+}
+
+int
+XdpEthernet_receivePacket(XdpEthernetSocket self, uint8_t* buffer, int bufferSize, uint64_t* timestamp)
+{
+    while (true) {
+        if (self->rxBatchPosition == self->rxBatchSize) {
+            if (fetchReceiveBatch(self) == false)
+                return 0;
+        }
+
+        struct xdp_desc* descriptor = &(self->rxBatch[self->rxBatchPosition++]);
+
+        uint8_t* frame = self->umem + descriptor->addr;
+        int packetSize = descriptor->len;
+
+        if ((self->etherType != 0) && (getEtherType(frame, packetSize) != self->etherType))
+            continue;
+
+        if (packetSize > bufferSize)
+            packetSize = bufferSize;
+
+        memcpy(buffer, frame, packetSize);
+
+        /* AF_XDP provides no timestamps - use the time the batch was taken from the RX ring */
+        *timestamp = self->rxBatchTimestamp;
+
+        return packetSize;
+    }
+}
+
+void
+XdpEthernet_sendPacket(XdpEthernetSocket self, uint8_t* buffer, int packetSize)
+{
+    if (packetSize > XDP_FRAME_SIZE)
+        return;
+
+    reapCompletedFrames(self);
+
+    XdpRing* ring = &(self->txRing);
+
+    if ((self->freeTxFrameCount == 0) || (ringFreeEntries(ring) == 0)) {
+        /* let the kernel process the TX ring and try again */
+        sendto(self->xsk, NULL, 0, MSG_DONTWAIT, NULL, 0);
+
+        reapCompletedFrames(self);
+
+        if ((self->freeTxFrameCount == 0) || (ringFreeEntries(ring) == 0)) {
+            if (DEBUG)
+                printf("ETHERNET_XDP: TX ring full - packet dropped\n");
+
+            return;
+        }
+    }
+
+    uint64_t frameAddress = self->freeTxFrames[--self->freeTxFrameCount];
+
+    memcpy(self->umem + frameAddress, buffer, packetSize);
+
+    uint32_t producer = *(ring->producer);
+    struct xdp_desc* descriptor = &(((struct xdp_desc*) ring->descriptors)[producer & ring->mask]);
+
+    descriptor->addr = frameAddress;
+    descriptor->len = packetSize;
+    descriptor->options = 0;
+
+    ringStoreIndex(ring->producer, producer + 1);
+
+    /* copy mode always needs the syscall - zero-copy drivers only if they request it */
+    if ((self->zeroCopy == false) || (*(ring->flags) & XDP_RING_NEED_WAKEUP))
+        sendto(self->xsk, NULL, 0, MSG_DONTWAIT, NULL, 0);
+}
+
+#endif /* (CONFIG_ETHERNET_USE_AF_XDP == 1) */
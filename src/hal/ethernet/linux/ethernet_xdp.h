@@ -0,0 +1,72 @@
+/*
+ *  ethernet_xdp.h
+ *
+ *  AF_XDP backend for the Linux Ethernet HAL
+ *
+ *  Copyright 2014 Michael Zillgith
+ *
+ *  This file is part of libIEC61850.
+ *
+ *  libIEC61850 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libIEC61850 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libIEC61850.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  See COPYING file for the complete license text.
+ */
+
+#ifndef ETHERNET_XDP_H_
+#define ETHERNET_XDP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * The AF_XDP backend is selected by the interface ID "xdp:<interface>" or
+ * "xdp:<interface>:<queue>" (default queue is 0).
+ *
+ * A small XDP program is attached to the interface that redirects GOOSE, GSE and SV
+ * frames (also VLAN tagged) to the AF_XDP sockets. All other traffic is passed to the
+ * kernel network stack. The program is attached in driver mode if possible, otherwise
+ * in generic (SKB) mode, so it also works with veth interfaces. Zero-copy mode is used
+ * when the driver supports it.
+ *
+ * Only one AF_XDP socket can be bound to an interface queue. Requires Linux 5.9 or later
+ * and CAP_NET_ADMIN/CAP_BPF.
+ */
+
+#define XDP_ETHERNET_PREFIX "xdp:"
+
+typedef struct sXdpEthernetSocket* XdpEthernetSocket;
+
+bool
+XdpEthernet_isXdpInterface(char* interfaceId);
+
+void
+XdpEthernet_getInterfaceMACAddress(char* interfaceId, uint8_t* addr);
+
+XdpEthernetSocket
+XdpEthernet_createSocket(char* interfaceId, uint8_t* destAddress);
+
+void
+XdpEthernet_destroySocket(XdpEthernetSocket self);
+
+void
+XdpEthernet_setProtocolFilter(XdpEthernetSocket self, uint16_t etherType);
+
+/* non-blocking - returns 0 if no packet is available */
+int
+XdpEthernet_receivePacket(XdpEthernetSocket self, uint8_t* buffer, int bufferSize, uint64_t* timestamp);
+
+void
+XdpEthernet_sendPacket(XdpEthernetSocket self, uint8_t* buffer, int packetSize);
+
+#endif /* ETHERNET_XDP_H_ */
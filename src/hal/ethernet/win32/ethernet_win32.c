@@ -39,6 +39,7 @@
 #endif
 
 #include "ethernet.h"
+#include "ethernet_virtual.h"
 
 #define HAVE_REMOTE
 
@@ -47,6 +48,7 @@
 struct sEthernetSocket {
     pcap_t* rawSocket;
     struct bpf_program etherTypeFilter;
+    VirtualEthernetSocket virtualSocket; /* used instead of winpcap for virtual interfaces */
 };
 
 #ifdef __GNUC__ /* detect MINGW */
@@ -211,6 +213,11 @@ getAdapterMacAddress(char* pcapAdapterName, uint8_t* macAddress)
 void
 Ethernet_getInterfaceMACAddress(char* interfaceId, uint8_t* addr)
 {
+    if (VirtualEthernet_isVirtualInterface(interfaceId)) {
+        VirtualEthernet_getInterfaceMACAddress(interfaceId, addr);
+        return;
+    }
+
 #ifdef __GNUC__
 #ifndef __MINGW64_VERSION_MAJOR
     if (!dllLoaded) {
@@ -241,6 +248,19 @@ Ethernet_createSocket(char* interfaceId, uint8_t* destAddress)
     pcap_t *pcapSocket;
     char errbuf[PCAP_ERRBUF_SIZE];
 
+    if (VirtualEthernet_isVirtualInterface(interfaceId)) {
+        VirtualEthernetSocket virtualSocket = VirtualEthernet_createSocket(interfaceId, destAddress);
+
+        if (virtualSocket == NULL)
+            return NULL;
+
+        EthernetSocket ethernetSocket = (EthernetSocket) calloc(1, sizeof(struct sEthernetSocket));
+
+        ethernetSocket->virtualSocket = virtualSocket;
+
+        return ethernetSocket;
+    }
+
     int interfaceIndex = atoi(interfaceId);
 
     char* interfaceName = getInterfaceName(interfaceIndex);
@@ -261,13 +281,22 @@ Ethernet_createSocket(char* interfaceId, uint8_t* destAddress)
 void
 Ethernet_destroySocket(EthernetSocket ethSocket)
 {
-    pcap_close(ethSocket->rawSocket);
+    if (ethSocket->virtualSocket != NULL)
+        VirtualEthernet_destroySocket(ethSocket->virtualSocket);
+    else
+        pcap_close(ethSocket->rawSocket);
+
     free(ethSocket);
 }
 
 void
 Ethernet_sendPacket(EthernetSocket ethSocket, uint8_t* buffer, int packetSize)
 {
+    if (ethSocket->virtualSocket != NULL) {
+        VirtualEthernet_sendPacket(ethSocket->virtualSocket, buffer, packetSize);
+        return;
+    }
+
     if (pcap_sendpacket(ethSocket->rawSocket, buffer, packetSize) != 0)
         printf("Error sending the packet: %s\n", pcap_geterr(ethSocket->rawSocket));
 }
@@ -275,6 +304,11 @@ Ethernet_sendPacket(EthernetSocket ethSocket, uint8_t* buffer, int packetSize)
 void
 Ethernet_setProtocolFilter(EthernetSocket ethSocket, uint16_t etherType)
 {
+	if (ethSocket->virtualSocket != NULL) {
+		VirtualEthernet_setProtocolFilter(ethSocket->virtualSocket, etherType);
+		return;
+	}
+
 	char filterString[100];
 
 	sprintf(filterString, "(ether proto 0x%04x) or (vlan and ether proto 0x%04x)", etherType, etherType);
@@ -295,6 +329,48 @@ Ethernet_receivePacket(EthernetSocket self, uint8_t* buffer, int bufferSize)
 	struct pcap_pkthdr* header;
 	uint8_t* packetData;
 
+	if (self->virtualSocket != NULL) {
+		uint64_t timestamp;
+
+		return VirtualEthernet_receivePacket(self->virtualSocket, buffer, bufferSize, &timestamp);
+	}
+
+	int pcapCode = pcap_next_ex(self->rawSocket, &header, (const unsigned char**) &packetData);
+
+	if (pcapCode > 0) {
+		int packetSize = header->caplen;
+
+		if (packetSize > bufferSize)
+			packetSize = bufferSize;
+
+		memcpy(buffer, packetData, packetSize);
+
+		return packetSize;
+	}
+	else {
+		if (pcapCode < 0)
+			printf("winpcap error\n");
+
+		return 0;
+	}
+}
+
+bool
+Ethernet_enableTimestamping(EthernetSocket ethSocket, bool useHardwareTimestamps)
+{
+    /* winpcap always provides software receive timestamps */
+    return true;
+}
+
+int
+Ethernet_receivePacketWithTimestamp(EthernetSocket self, uint8_t* buffer, int bufferSize, uint64_t* timestamp)
+{
+	struct pcap_pkthdr* header;
+	uint8_t* packetData;
+
+	if (self->virtualSocket != NULL)
+		return VirtualEthernet_receivePacket(self->virtualSocket, buffer, bufferSize, timestamp);
+
 	int pcapCode = pcap_next_ex(self->rawSocket, &header, (const unsigned char**) &packetData);
 
 	if (pcapCode > 0) {
@@ -305,6 +381,8 @@ Ethernet_receivePacket(EthernetSocket self, uint8_t* buffer, int bufferSize)
 
 		memcpy(buffer, packetData, packetSize);
 
+		*timestamp = ((uint64_t) header->ts.tv_sec * 1000000000ULL) + ((uint64_t) header->ts.tv_usec * 1000ULL);
+
 		return packetSize;
 	}
 	else {
@@ -315,4 +393,16 @@ Ethernet_receivePacket(EthernetSocket self, uint8_t* buffer, int bufferSize)
 	}
 }
 
+bool
+Ethernet_getTransmitTimestamp(EthernetSocket ethSocket, uint64_t* timestamp, int timeoutInMs)
+{
+    if (ethSocket->virtualSocket != NULL) {
+        *timestamp = VirtualEthernet_getLastTransmitTimestamp(ethSocket->virtualSocket);
+        return true;
+    }
+
+    /* not supported by winpcap */
+    return false;
+}
+
 #endif
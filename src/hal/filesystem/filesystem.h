@@ -71,6 +71,17 @@ FileSystem_openFile(char* pathName, bool readWrite);
 int
 FileSystem_readFile(FileHandle handle, uint8_t* buffer, int maxSize);
 
+/**
+ * \brief set the position for the next read operation
+ *
+ * \param handle the file handle to identify the file
+ * \param position the new file position in bytes from the beginning of the file
+ *
+ * \return true on success, false otherwise
+ */
+bool
+FileSystem_setFilePosition(FileHandle handle, uint32_t position);
+
 /**
  * \brief close an open file
  *
@@ -30,6 +30,8 @@
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include <unistd.h>
 
 #include "filesystem.h"
@@ -40,12 +42,37 @@
 #define CONFIG_VIRTUAL_FILESTORE_BASEPATH "./vmd-filestore/"
 #endif
 
+#ifndef CONFIG_FILESYSTEM_USE_MMAP
+#define CONFIG_FILESYSTEM_USE_MMAP 0
+#endif
+
+/* number of bytes the kernel is asked to read ahead of the current read position */
+#define FILE_READ_AHEAD_SIZE (256 * 1024)
+
+/* reads smaller than this are served from a buffer in the file handle (e.g. the config file parser) */
+#define FILE_READ_BUFFER_SIZE 4096
+
 static char* fileBasePath = CONFIG_VIRTUAL_FILESTORE_BASEPATH;
 
 struct sDirectoryHandle {
     DIR* handle;
 };
 
+/*
+ * Files opened for reading are read with pread or - with CONFIG_FILESYSTEM_USE_MMAP - mapped into
+ * memory. The read position is stored in the handle. Small reads are buffered like stdio does.
+ */
+typedef struct {
+    int fd;
+    uint32_t fileSize;
+    uint32_t position;
+    uint32_t readAheadPosition;
+    uint8_t* mappedData;
+    uint8_t* readBuffer; /* allocated with the first small read */
+    uint32_t readBufferPosition; /* file position of the first byte in readBuffer */
+    int readBufferSize; /* number of valid bytes in readBuffer */
+} LinuxFileHandle;
+
 static void
 createFullPathFromFileName(char* fullPath, char* filename)
 {
@@ -69,26 +96,157 @@ FileSystem_openFile(char* fileName, bool readWrite)
 
     createFullPathFromFileName(fullPath, fileName);
 
-    FileHandle newHandle = NULL;
+    int fd;
 
     if (readWrite)
-        newHandle = (FileHandle) fopen(fullPath, "w");
+        fd = open(fullPath, O_RDWR | O_CREAT | O_TRUNC, 0666);
     else
-        newHandle = (FileHandle) fopen(fullPath, "r");
+        fd = open(fullPath, O_RDONLY);
+
+    if (fd == -1)
+        return NULL;
 
-    return newHandle;
+    LinuxFileHandle* handle = (LinuxFileHandle*) calloc(1, sizeof(LinuxFileHandle));
+
+    handle->fd = fd;
+
+    if (readWrite == false) {
+        struct stat fileStats;
+
+        if (fstat(fd, &fileStats) == 0) {
+            handle->fileSize = (uint32_t) fileStats.st_size;
+
+#if (CONFIG_FILESYSTEM_USE_MMAP == 1)
+            if (handle->fileSize > 0) {
+                void* mappedData = mmap(NULL, handle->fileSize, PROT_READ, MAP_SHARED, fd, 0);
+
+                if (mappedData != MAP_FAILED) {
+                    handle->mappedData = (uint8_t*) mappedData;
+                    madvise(mappedData, handle->fileSize, MADV_SEQUENTIAL);
+                }
+            }
+#endif
+        }
+
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+
+    return (FileHandle) handle;
+}
+
+static int
+readFromFileDescriptor(LinuxFileHandle* self, uint8_t* buffer, int maxSize)
+{
+    int bytesRead = 0;
+
+    /* use the bytes already in the read buffer */
+    if ((self->readBufferSize > 0) && (self->position >= self->readBufferPosition) &&
+            (self->position < self->readBufferPosition + self->readBufferSize))
+    {
+        int offset = (int) (self->position - self->readBufferPosition);
+
+        bytesRead = self->readBufferSize - offset;
+
+        if (bytesRead > maxSize)
+            bytesRead = maxSize;
+
+        memcpy(buffer, self->readBuffer + offset, bytesRead);
+    }
+
+    int remainingBytes = maxSize - bytesRead;
+
+    if (remainingBytes == 0)
+        return bytesRead;
+
+    uint32_t readPosition = self->position + bytesRead;
+
+    if (remainingBytes < FILE_READ_BUFFER_SIZE) {
+        if (self->readBuffer == NULL)
+            self->readBuffer = (uint8_t*) malloc(FILE_READ_BUFFER_SIZE);
+
+        int result = (int) pread(self->fd, self->readBuffer, FILE_READ_BUFFER_SIZE, readPosition);
+
+        if (result <= 0) {
+            self->readBufferSize = 0;
+            return bytesRead;
+        }
+
+        self->readBufferPosition = readPosition;
+        self->readBufferSize = result;
+
+        if (result > remainingBytes)
+            result = remainingBytes;
+
+        memcpy(buffer + bytesRead, self->readBuffer, result);
+
+        bytesRead += result;
+    }
+    else {
+        int result = (int) pread(self->fd, buffer + bytesRead, remainingBytes, readPosition);
+
+        if (result > 0)
+            bytesRead += result;
+    }
+
+    return bytesRead;
 }
 
 int
 FileSystem_readFile(FileHandle handle, uint8_t* buffer, int maxSize)
 {
-    return fread(buffer, maxSize, 1, (FILE*) handle);
+    LinuxFileHandle* self = (LinuxFileHandle*) handle;
+
+    if (self->position >= self->readAheadPosition) {
+        posix_fadvise(self->fd, self->position, FILE_READ_AHEAD_SIZE, POSIX_FADV_WILLNEED);
+        self->readAheadPosition = self->position + (FILE_READ_AHEAD_SIZE / 2);
+    }
+
+    int bytesRead;
+
+    if (self->mappedData != NULL) {
+        if (self->position >= self->fileSize)
+            return 0;
+
+        bytesRead = maxSize;
+
+        if ((uint32_t) bytesRead > (self->fileSize - self->position))
+            bytesRead = (int) (self->fileSize - self->position);
+
+        memcpy(buffer, self->mappedData + self->position, bytesRead);
+    }
+    else
+        bytesRead = readFromFileDescriptor(self, buffer, maxSize);
+
+    self->position += bytesRead;
+
+    return bytesRead;
+}
+
+bool
+FileSystem_setFilePosition(FileHandle handle, uint32_t position)
+{
+    LinuxFileHandle* self = (LinuxFileHandle*) handle;
+
+    self->position = position;
+    self->readAheadPosition = position;
+
+    return true;
 }
 
 void
 FileSystem_closeFile(FileHandle handle)
 {
-    fclose((FILE*) handle);
+    LinuxFileHandle* self = (LinuxFileHandle*) handle;
+
+    if (self->mappedData != NULL)
+        munmap(self->mappedData, self->fileSize);
+
+    close(self->fd);
+
+    if (self->readBuffer != NULL)
+        free(self->readBuffer);
+
+    free(self);
 }
 
 bool
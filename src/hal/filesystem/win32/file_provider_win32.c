@@ -85,7 +85,16 @@ FileSystem_openFile(char* fileName, bool readWrite)
 int
 FileSystem_readFile(FileHandle handle, uint8_t* buffer, int maxSize)
 {
-    return fread(buffer, maxSize, 1, (FILE*) handle);
+    return fread(buffer, 1, maxSize, (FILE*) handle);
+}
+
+bool
+FileSystem_setFilePosition(FileHandle handle, uint32_t position)
+{
+    if (fseek((FILE*) handle, (long) position, SEEK_SET) == 0)
+        return true;
+    else
+        return false;
 }
 
 void
@@ -40,6 +40,16 @@ Hal_getTimeInMs()
 
 	return ((uint64_t) tp.tv_sec) * 1000LL + (tp.tv_nsec / 1000000);
 }
+
+uint64_t
+Hal_getTimeInNs()
+{
+	struct timespec tp;
+
+	clock_gettime(CLOCK_REALTIME, &tp);
+
+	return ((uint64_t) tp.tv_sec) * 1000000000LL + tp.tv_nsec;
+}
 #else
 
 #include <sys/time.h>
@@ -54,8 +64,32 @@ Hal_getTimeInMs()
     return ((uint64_t) now.tv_sec * 1000LL) + (now.tv_usec / 1000);
 }
 
+uint64_t
+Hal_getTimeInNs()
+{
+    struct timeval now;
+
+    gettimeofday(&now, NULL);
+
+    return ((uint64_t) now.tv_sec * 1000000000LL) + (now.tv_usec * 1000LL);
+}
+
 #endif
 
+uint64_t
+Hal_getMonotonicTimeInNs()
+{
+#ifdef CLOCK_MONOTONIC
+    struct timespec tp;
+
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+
+    return ((uint64_t) tp.tv_sec) * 1000000000LL + tp.tv_nsec;
+#else
+    return Hal_getTimeInNs();
+#endif
+}
+
 #elif defined _WIN32
 #include "windows.h"
 
@@ -73,4 +107,34 @@ Hal_getTimeInMs()
 
 	return (now / 10000LL) - DIFF_TO_UNIXTIME;
 }
+
+uint64_t
+Hal_getTimeInNs()
+{
+	FILETIME ft;
+	uint64_t now;
+
+	static const uint64_t DIFF_TO_UNIXTIME = 11644473600000000000ULL;
+
+	GetSystemTimeAsFileTime(&ft);
+
+	now = (LONGLONG)ft.dwLowDateTime + ((LONGLONG)(ft.dwHighDateTime) << 32LL);
+
+	return (now * 100LL) - DIFF_TO_UNIXTIME;
+}
+
+uint64_t
+Hal_getMonotonicTimeInNs()
+{
+	static LARGE_INTEGER frequency;
+	LARGE_INTEGER counter;
+
+	if (frequency.QuadPart == 0)
+		QueryPerformanceFrequency(&frequency);
+
+	QueryPerformanceCounter(&counter);
+
+	return (uint64_t) ((counter.QuadPart / frequency.QuadPart) * 1000000000LL +
+			((counter.QuadPart % frequency.QuadPart) * 1000000000LL) / frequency.QuadPart);
+}
 #endif
@@ -45,6 +45,27 @@
  */
 uint64_t Hal_getTimeInMs(void);
 
+/**
+ * Get the system time in nanoseconds.
+ *
+ * The time value returned as 64-bit unsigned integer should represent the nanoseconds
+ * since the UNIX epoch (1970/01/01 00:00 UTC). It uses the same clock as the software
+ * timestamps of the Ethernet layer. The actual resolution depends on the platform.
+ *
+ * \return the system time with nanosecond resolution.
+ */
+uint64_t Hal_getTimeInNs(void);
+
+/**
+ * Get the time of a monotonic clock in nanoseconds.
+ *
+ * The clock is not affected by changes of the system time. The value has no relation to
+ * calendar time and should only be used to measure time intervals (e.g. latencies).
+ *
+ * \return the time of a monotonic clock with nanosecond resolution.
+ */
+uint64_t Hal_getMonotonicTimeInNs(void);
+
 /*! @} */
 
 /*! @} */
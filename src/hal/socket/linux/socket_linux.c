@@ -35,6 +35,7 @@
 #include <errno.h>
 
 #include <fcntl.h>
+#include <sys/epoll.h>
 
 #include <netinet/tcp.h> // required for TCP keepalive
 
@@ -79,6 +80,19 @@ activateKeepAlive(int sd)
 #endif /* SO_KEEPALIVE */
 }
 
+/*
+ * MMS PDUs are written in one go - disable the Nagle algorithm so that the last segment
+ * of a PDU that is larger than the MSS is not delayed until the peer acknowledges
+ * (delayed ACK) the previous segments.
+ */
+static void
+activateTcpNoDelay(int sd)
+{
+    int optval = 1;
+
+    setsockopt(sd, IPPROTO_TCP, TCP_NODELAY, &optval, sizeof(optval));
+}
+
 static bool
 prepareServerAddress(char* address, int port, struct sockaddr_in* sockaddr)
 {
@@ -102,14 +116,19 @@ prepareServerAddress(char* address, int port, struct sockaddr_in* sockaddr)
     return true;
 }
 
-#if 0
 static void
 setSocketNonBlocking(Socket self)
 {
     int flags = fcntl(self->fd, F_GETFL, 0);
     fcntl(self->fd, F_SETFL, flags | O_NONBLOCK);
 }
-#endif
+
+static void
+setSocketBlocking(Socket self)
+{
+    int flags = fcntl(self->fd, F_GETFL, 0);
+    fcntl(self->fd, F_SETFL, flags & ~O_NONBLOCK);
+}
 
 ServerSocket
 TcpServerSocket_create(char* address, int port)
@@ -165,6 +184,8 @@ ServerSocket_accept(ServerSocket self)
     if (fd >= 0) {
         conSocket = TcpSocket_create();
         conSocket->fd = fd;
+
+        activateTcpNoDelay(fd);
     }
 
     return conSocket;
@@ -232,12 +253,78 @@ Socket_connect(Socket self, char* address, int port)
     activateKeepAlive(self->fd);
 #endif
 
+    activateTcpNoDelay(self->fd);
+
     if (connect(self->fd, (struct sockaddr *) &serverAddress, sizeof(serverAddress)) < 0)
         return 0;
     else
         return 1;
 }
 
+bool
+Socket_connectAsync(Socket self, char* address, int port)
+{
+    struct sockaddr_in serverAddress;
+
+    if (DEBUG_SOCKET)
+        printf("Socket_connectAsync: %s:%i\n", address, port);
+
+    if (!prepareServerAddress(address, port, &serverAddress))
+        return false;
+
+    self->fd = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (self->fd == -1)
+        return false;
+
+#if CONFIG_ACTIVATE_TCP_KEEPALIVE == 1
+    activateKeepAlive(self->fd);
+#endif
+
+    activateTcpNoDelay(self->fd);
+
+    setSocketNonBlocking(self);
+
+    if (connect(self->fd, (struct sockaddr *) &serverAddress, sizeof(serverAddress)) < 0) {
+        if (errno != EINPROGRESS)
+            return false;
+    }
+
+    return true;
+}
+
+SocketState
+Socket_checkAsyncConnectState(Socket self)
+{
+    if (self->fd == -1)
+        return SOCKET_STATE_FAILED;
+
+    int socketError = 0;
+    socklen_t optLen = sizeof(socketError);
+
+    if (getsockopt(self->fd, SOL_SOCKET, SO_ERROR, &socketError, &optLen) < 0)
+        return SOCKET_STATE_FAILED;
+
+    if (socketError == EINPROGRESS)
+        return SOCKET_STATE_CONNECTING;
+
+    if (socketError != 0)
+        return SOCKET_STATE_FAILED;
+
+    /* check that the connection is really established */
+    struct sockaddr_storage addr;
+    socklen_t addrLen = sizeof(addr);
+
+    if (getpeername(self->fd, (struct sockaddr*) &addr, &addrLen) < 0) {
+        if (errno == ENOTCONN)
+            return SOCKET_STATE_FAILED;
+    }
+
+    setSocketBlocking(self);
+
+    return SOCKET_STATE_CONNECTED;
+}
+
 char*
 Socket_getPeerAddress(Socket self)
 {
@@ -316,6 +403,13 @@ Socket_write(Socket self, uint8_t* buf, int size)
     return send(self->fd, buf, size, MSG_NOSIGNAL);
 }
 
+void
+Socket_shutdown(Socket self)
+{
+    if (self->fd != -1)
+        shutdown(self->fd, SHUT_RDWR);
+}
+
 void
 Socket_destroy(Socket self)
 {
@@ -329,3 +423,97 @@ Socket_destroy(Socket self)
 
     free(self);
 }
+
+struct sSocketEventSet {
+    int epollFd;
+};
+
+SocketEventSet
+SocketEventSet_create()
+{
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+
+    if (epollFd == -1)
+        return NULL;
+
+    SocketEventSet self = (SocketEventSet) malloc(sizeof(struct sSocketEventSet));
+
+    self->epollFd = epollFd;
+
+    return self;
+}
+
+void
+SocketEventSet_setSocket(SocketEventSet self, Socket socket, int events, void* parameter)
+{
+    struct epoll_event event;
+
+    memset(&event, 0, sizeof(event));
+
+    if (events & SOCKET_EVENT_READ)
+        event.events |= EPOLLIN;
+
+    if (events & SOCKET_EVENT_WRITE)
+        event.events |= EPOLLOUT;
+
+    event.data.ptr = parameter;
+
+    if (epoll_ctl(self->epollFd, EPOLL_CTL_MOD, socket->fd, &event) == -1) {
+        if (errno == ENOENT)
+            epoll_ctl(self->epollFd, EPOLL_CTL_ADD, socket->fd, &event);
+        else if (DEBUG_SOCKET)
+            printf("socket_linux.c: epoll_ctl failed (%i)\n", errno);
+    }
+}
+
+void
+SocketEventSet_removeSocket(SocketEventSet self, Socket socket)
+{
+    if (socket->fd != -1)
+        epoll_ctl(self->epollFd, EPOLL_CTL_DEL, socket->fd, NULL);
+}
+
+int
+SocketEventSet_wait(SocketEventSet self, void** parameters, int* events, int maxEvents, int timeoutInMs)
+{
+    struct epoll_event epollEvents[64];
+
+    if (maxEvents > 64)
+        maxEvents = 64;
+
+    int readyCount = epoll_wait(self->epollFd, epollEvents, maxEvents, timeoutInMs);
+
+    if (readyCount == -1) {
+        if (errno == EINTR)
+            return 0;
+        else
+            return -1;
+    }
+
+    int i;
+
+    for (i = 0; i < readyCount; i++) {
+        int socketEvents = 0;
+
+        if (epollEvents[i].events & (EPOLLIN | EPOLLRDHUP))
+            socketEvents |= SOCKET_EVENT_READ;
+
+        if (epollEvents[i].events & EPOLLOUT)
+            socketEvents |= SOCKET_EVENT_WRITE;
+
+        if (epollEvents[i].events & (EPOLLERR | EPOLLHUP))
+            socketEvents |= SOCKET_EVENT_ERROR;
+
+        parameters[i] = epollEvents[i].data.ptr;
+        events[i] = socketEvents;
+    }
+
+    return readyCount;
+}
+
+void
+SocketEventSet_destroy(SocketEventSet self)
+{
+    close(self->epollFd);
+    free(self);
+}
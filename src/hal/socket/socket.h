@@ -25,6 +25,7 @@
 #define SOCKET_H_
 
 #include <stdint.h>
+#include <stdbool.h>
 
 /*! \addtogroup hal Hardware/OS abstraction layer
    *
@@ -86,9 +87,80 @@ Socket_write(Socket self, uint8_t* buf, int size);
 char*
 Socket_getPeerAddress(Socket self);
 
+/**
+ * \brief Shut down both directions of the connection without releasing the socket
+ *
+ * Blocking read and write calls of other threads return with an error.
+ */
+void
+Socket_shutdown(Socket self);
+
 void
 Socket_destroy(Socket self);
 
+/** State of a non-blocking connect */
+typedef enum {
+    SOCKET_STATE_CONNECTING,
+    SOCKET_STATE_FAILED,
+    SOCKET_STATE_CONNECTED
+} SocketState;
+
+/**
+ * \brief Start to connect to a server without blocking
+ *
+ * The progress has to be checked with Socket_checkAsyncConnectState when the socket becomes
+ * writable (see SocketEventSet).
+ *
+ * \return true if the connect has been started, false otherwise
+ */
+bool
+Socket_connectAsync(Socket self, char* address, int port);
+
+/**
+ * \brief Check the state of a connect started with Socket_connectAsync
+ *
+ * When the connection is established the socket is switched to blocking mode.
+ */
+SocketState
+Socket_checkAsyncConnectState(Socket self);
+
+/** Opaque reference for a set of sockets that are monitored for events (epoll on Linux) */
+typedef struct sSocketEventSet* SocketEventSet;
+
+#define SOCKET_EVENT_READ 1
+#define SOCKET_EVENT_WRITE 2
+#define SOCKET_EVENT_ERROR 4
+
+SocketEventSet
+SocketEventSet_create(void);
+
+/**
+ * \brief Add a socket to the set or change the events of interest of a socket
+ *
+ * \param events SOCKET_EVENT_READ and/or SOCKET_EVENT_WRITE (0 to temporarily ignore the socket)
+ * \param parameter user provided parameter that is returned by SocketEventSet_wait
+ */
+void
+SocketEventSet_setSocket(SocketEventSet self, Socket socket, int events, void* parameter);
+
+void
+SocketEventSet_removeSocket(SocketEventSet self, Socket socket);
+
+/**
+ * \brief Wait until at least one socket of the set is ready or the timeout expires
+ *
+ * \param parameters returns the parameters of the ready sockets
+ * \param events returns the events (SOCKET_EVENT_*) of the ready sockets
+ * \param maxEvents size of the parameters and events arrays
+ *
+ * \return the number of ready sockets, 0 on timeout, -1 on error
+ */
+int
+SocketEventSet_wait(SocketEventSet self, void** parameters, int* events, int maxEvents, int timeoutInMs);
+
+void
+SocketEventSet_destroy(SocketEventSet self);
+
 /*! @} */
 
 /*! @} */
@@ -70,6 +70,15 @@ activateKeepAlive(SOCKET s)
 	 }
 }
 
+/* disable the Nagle algorithm - see socket_linux.c */
+static void
+activateTcpNoDelay(SOCKET s)
+{
+	BOOL optval = TRUE;
+
+	setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (char*) &optval, sizeof(optval));
+}
+
 static bool
 prepareServerAddress(char* address, int port, struct sockaddr_in* sockaddr)
 {
@@ -161,6 +170,8 @@ ServerSocket_accept(ServerSocket self)
 	if (fd >= 0) {
 		conSocket = TcpSocket_create();
 		conSocket->fd = fd;
+
+		activateTcpNoDelay(fd);
 	}
 
 	return conSocket;
@@ -211,6 +222,8 @@ Socket_connect(Socket self, char* address, int port)
     activateKeepAlive(self->fd);
 #endif
 
+	activateTcpNoDelay(self->fd);
+
 	if (connect(self->fd, (struct sockaddr *) &serverAddress,sizeof(serverAddress)) < 0) {
 		printf("Socket failed connecting!\n");
 		return 0;
@@ -219,6 +232,74 @@ Socket_connect(Socket self, char* address, int port)
 		return 1;
 }
 
+bool
+Socket_connectAsync(Socket self, char* address, int port)
+{
+	struct sockaddr_in serverAddress;
+	WSADATA wsa;
+
+	if (WSAStartup(MAKEWORD(2,0), &wsa) != 0)
+		return false;
+
+	if (!prepareServerAddress(address, port, &serverAddress))
+	    return false;
+
+	self->fd = socket(AF_INET, SOCK_STREAM, 0);
+
+	if (self->fd == INVALID_SOCKET)
+		return false;
+
+#if CONFIG_ACTIVATE_TCP_KEEPALIVE == 1
+    activateKeepAlive(self->fd);
+#endif
+
+	activateTcpNoDelay(self->fd);
+
+	u_long nonBlocking = 1;
+	ioctlsocket(self->fd, FIONBIO, &nonBlocking);
+
+	if (connect(self->fd, (struct sockaddr *) &serverAddress, sizeof(serverAddress)) == SOCKET_ERROR) {
+		if (WSAGetLastError() != WSAEWOULDBLOCK)
+			return false;
+	}
+
+	return true;
+}
+
+SocketState
+Socket_checkAsyncConnectState(Socket self)
+{
+	fd_set writeFds;
+	fd_set exceptFds;
+	struct timeval timeout;
+
+	if (self->fd == INVALID_SOCKET)
+		return SOCKET_STATE_FAILED;
+
+	FD_ZERO(&writeFds);
+	FD_ZERO(&exceptFds);
+	FD_SET(self->fd, &writeFds);
+	FD_SET(self->fd, &exceptFds);
+
+	timeout.tv_sec = 0;
+	timeout.tv_usec = 0;
+
+	if (select(0, NULL, &writeFds, &exceptFds, &timeout) == SOCKET_ERROR)
+		return SOCKET_STATE_FAILED;
+
+	if (FD_ISSET(self->fd, &exceptFds))
+		return SOCKET_STATE_FAILED;
+
+	if (FD_ISSET(self->fd, &writeFds)) {
+		u_long nonBlocking = 0;
+		ioctlsocket(self->fd, FIONBIO, &nonBlocking);
+
+		return SOCKET_STATE_CONNECTED;
+	}
+
+	return SOCKET_STATE_CONNECTING;
+}
+
 char*
 Socket_getPeerAddress(Socket self)
 {
@@ -274,6 +355,13 @@ Socket_write(Socket self, uint8_t* buf, int size)
 	return send(self->fd, (char*) buf, size, 0);
 }
 
+void
+Socket_shutdown(Socket self)
+{
+	if (self->fd != -1)
+		shutdown(self->fd, SD_BOTH);
+}
+
 void
 Socket_destroy(Socket self)
 {
@@ -283,3 +371,128 @@ Socket_destroy(Socket self)
 
 	free(self);
 }
+
+/* select based implementation - limited to FD_SETSIZE sockets per set */
+
+typedef struct {
+	SOCKET fd;
+	int events;
+	void* parameter;
+} SocketEventSetEntry;
+
+struct sSocketEventSet {
+	SocketEventSetEntry entries[FD_SETSIZE];
+	int size;
+};
+
+SocketEventSet
+SocketEventSet_create()
+{
+	SocketEventSet self = (SocketEventSet) calloc(1, sizeof(struct sSocketEventSet));
+
+	return self;
+}
+
+void
+SocketEventSet_setSocket(SocketEventSet self, Socket socket, int events, void* parameter)
+{
+	int i;
+
+	for (i = 0; i < self->size; i++) {
+		if (self->entries[i].fd == socket->fd) {
+			self->entries[i].events = events;
+			self->entries[i].parameter = parameter;
+			return;
+		}
+	}
+
+	if (self->size < FD_SETSIZE) {
+		self->entries[self->size].fd = socket->fd;
+		self->entries[self->size].events = events;
+		self->entries[self->size].parameter = parameter;
+		self->size++;
+	}
+}
+
+void
+SocketEventSet_removeSocket(SocketEventSet self, Socket socket)
+{
+	int i;
+
+	for (i = 0; i < self->size; i++) {
+		if (self->entries[i].fd == socket->fd) {
+			self->size--;
+			self->entries[i] = self->entries[self->size];
+			return;
+		}
+	}
+}
+
+int
+SocketEventSet_wait(SocketEventSet self, void** parameters, int* events, int maxEvents, int timeoutInMs)
+{
+	fd_set readFds;
+	fd_set writeFds;
+	fd_set exceptFds;
+	struct timeval timeout;
+	int i;
+	bool hasSockets = false;
+
+	FD_ZERO(&readFds);
+	FD_ZERO(&writeFds);
+	FD_ZERO(&exceptFds);
+
+	for (i = 0; i < self->size; i++) {
+		if (self->entries[i].events & SOCKET_EVENT_READ) {
+			FD_SET(self->entries[i].fd, &readFds);
+			hasSockets = true;
+		}
+
+		if (self->entries[i].events & SOCKET_EVENT_WRITE) {
+			FD_SET(self->entries[i].fd, &writeFds);
+			FD_SET(self->entries[i].fd, &exceptFds);
+			hasSockets = true;
+		}
+	}
+
+	/* select fails on windows when no socket is given */
+	if (hasSockets == false) {
+		Sleep(timeoutInMs);
+		return 0;
+	}
+
+	timeout.tv_sec = timeoutInMs / 1000;
+	timeout.tv_usec = (timeoutInMs % 1000) * 1000;
+
+	if (select(0, &readFds, &writeFds, &exceptFds, &timeout) == SOCKET_ERROR)
+		return -1;
+
+	int readyCount = 0;
+
+	for (i = 0; (i < self->size) && (readyCount < maxEvents); i++) {
+		int socketEvents = 0;
+
+		if (FD_ISSET(self->entries[i].fd, &readFds))
+			socketEvents |= SOCKET_EVENT_READ;
+
+		if (FD_ISSET(self->entries[i].fd, &writeFds))
+			socketEvents |= SOCKET_EVENT_WRITE;
+
+		if (FD_ISSET(self->entries[i].fd, &exceptFds))
+			socketEvents |= SOCKET_EVENT_ERROR;
+
+		if (socketEvents != 0) {
+			parameters[readyCount] = self->entries[i].parameter;
+			events[readyCount] = socketEvents;
+			readyCount++;
+		}
+	}
+
+	return readyCount;
+}
+
+void
+SocketEventSet_destroy(SocketEventSet self)
+{
+	free(self);
+}
@@ -21,13 +21,25 @@
  *	See COPYING file for the complete license text.
  */
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /* for sem_clockwait */
+#endif
 
 #include <pthread.h>
 #include <semaphore.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <errno.h>
+#include <time.h>
 #include "thread.h"
 
+/* sem_clockwait is available since glibc 2.30 - otherwise the timeout depends on the system time */
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || ((__GLIBC__ == 2) && (__GLIBC_MINOR__ >= 30)))
+#define SEMAPHORE_USE_CLOCKWAIT 1
+#else
+#define SEMAPHORE_USE_CLOCKWAIT 0
+#endif
+
 struct sThread {
 	ThreadExecutionFunction function;
 	void* parameter;
@@ -53,6 +65,37 @@ Semaphore_wait(Semaphore self)
     sem_wait((sem_t*) self);
 }
 
+bool
+Semaphore_waitWithTimeout(Semaphore self, int timeoutInMs)
+{
+    struct timespec deadline;
+
+#if (SEMAPHORE_USE_CLOCKWAIT == 1)
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+#else
+    clock_gettime(CLOCK_REALTIME, &deadline);
+#endif
+
+    deadline.tv_sec += timeoutInMs / 1000;
+    deadline.tv_nsec += (timeoutInMs % 1000) * 1000000L;
+
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+#if (SEMAPHORE_USE_CLOCKWAIT == 1)
+    while (sem_clockwait((sem_t*) self, CLOCK_MONOTONIC, &deadline) == -1) {
+#else
+    while (sem_timedwait((sem_t*) self, &deadline) == -1) {
+#endif
+        if (errno != EINTR)
+            return false;
+    }
+
+    return true;
+}
+
 void
 Semaphore_post(Semaphore self)
 {
@@ -92,6 +92,19 @@ Semaphore_create(int initialValue);
 void
 Semaphore_wait(Semaphore self);
 
+/**
+ * \brief Wait until semaphore value is greater than zero or the timeout elapsed.
+ *
+ * The timeout is measured with a monotonic clock when the platform supports it (Linux: glibc 2.30
+ * or newer, Windows). Changes of the system time don't extend or shorten the wait then.
+ *
+ * \param timeoutInMs maximum time to wait in milliseconds
+ *
+ * \return true if the semaphore value has been decreased, false if the timeout elapsed
+ */
+bool
+Semaphore_waitWithTimeout(Semaphore self, int timeoutInMs);
+
 void
 Semaphore_post(Semaphore self);
 
@@ -101,7 +101,7 @@ Thread_sleep(int millies)
 Semaphore
 Semaphore_create(int initialValue)
 {
-    HANDLE self = CreateSemaphore(NULL, 1, 1, NULL);
+    HANDLE self = CreateSemaphore(NULL, initialValue, 1, NULL);
 
     return self;
 }
@@ -113,6 +113,12 @@ Semaphore_wait(Semaphore self)
     WaitForSingleObject((HANDLE) self, INFINITE);
 }
 
+bool
+Semaphore_waitWithTimeout(Semaphore self, int timeoutInMs)
+{
+    return (WaitForSingleObject((HANDLE) self, (DWORD) timeoutInMs) == WAIT_OBJECT_0);
+}
+
 void
 Semaphore_post(Semaphore self)
 {
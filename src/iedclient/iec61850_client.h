@@ -45,9 +45,15 @@ typedef struct sClientReport* ClientReport;
 /** an opaque handle to the instance data of a ClientReportControlBlock object */
 typedef struct sClientReportControlBlock* ClientReportControlBlock;
 
+/** an opaque handle to the instance data of a ClientReportHandlerPool object */
+typedef struct sClientReportHandlerPool* ClientReportHandlerPool;
+
 /** an opaque handle to the instance data of a ClientGooseControlBlock object */
 typedef struct sClientGooseControlBlock* ClientGooseControlBlock;
 
+/** an opaque handle to the instance data of a ClientPollGroup object */
+typedef struct sClientPollGroup* ClientPollGroup;
+
 /**
  * @defgroup IEC61850_CLIENT_GENERAL General client side connection handling functions and data types
  *
@@ -262,6 +268,107 @@ IedConnection_getMmsConnection(IedConnection self);
 
 /** @} */
 
+/****************************************
+ * Connection manager
+ ****************************************/
+
+/**
+ * @defgroup IEC61850_CLIENT_CONNECTION_MANAGER Handling of many client connections by a few event loop threads
+ *
+ * The connection manager establishes and supervises the associations to a large number of servers
+ * (e.g. all IEDs of a substation) with a small number of threads. Each thread runs an event loop
+ * (epoll on Linux) for its share of the connections. Connects and associations are not blocking,
+ * failed or lost connections are reestablished with an exponential backoff. Responses and reports
+ * are handled by the event loop threads instead of two threads per connection.
+ *
+ * The connections are used with the normal IedConnection service functions. They are owned by the
+ * manager and must not be connected, closed or destroyed by the application.
+ *
+ * @{
+ */
+
+/** An opaque handle to the instance data of the IedConnectionManager object */
+typedef struct sIedConnectionManager* IedConnectionManager;
+
+/**
+ * \brief Callback that is called when a managed connection is established or lost
+ *
+ * The callback is called by an event loop thread. It must not block (e.g. by calling synchronous
+ * service functions for the connection).
+ *
+ * \param parameter user provided parameter
+ * \param connection the connection
+ * \param newState IED_STATE_CONNECTED or IED_STATE_CLOSED
+ */
+typedef void (*IedConnectionManagerStateHandler) (void* parameter, IedConnection connection,
+        IedConnectionState newState);
+
+/**
+ * \brief Create a new connection manager
+ *
+ * \param threadCount number of event loop threads (the connections are distributed round robin)
+ *
+ * \return the new connection manager instance
+ */
+IedConnectionManager
+IedConnectionManager_create(int threadCount);
+
+/**
+ * \brief Install a callback for state changes of the managed connections
+ *
+ * Has to be called before connections are added.
+ */
+void
+IedConnectionManager_setStateHandler(IedConnectionManager self, IedConnectionManagerStateHandler handler,
+        void* parameter);
+
+/**
+ * \brief Set the reconnect delay. The delay is doubled after each failed attempt up to the maximum.
+ *
+ * \param minBackoffInMs delay of the first reconnect attempt (default 1000 ms)
+ * \param maxBackoffInMs maximum delay between reconnect attempts (default 60000 ms)
+ */
+void
+IedConnectionManager_setReconnectParameters(IedConnectionManager self, int minBackoffInMs, int maxBackoffInMs);
+
+/**
+ * \brief Set the timeout for the TCP connect and the association (default 10000 ms)
+ */
+void
+IedConnectionManager_setConnectTimeout(IedConnectionManager self, int timeoutInMs);
+
+/**
+ * \brief Add a connection to a server
+ *
+ * The connection is established in the background. The returned IedConnection can be configured
+ * (e.g. with IedConnection_getMmsConnection) before it is connected. Service functions fail with
+ * IED_ERROR_CONNECTION_LOST until the state handler reports IED_STATE_CONNECTED.
+ *
+ * \param self the connection manager
+ * \param hostname the host name or IP address of the server
+ * \param tcpPort the TCP port of the server (usually 102)
+ *
+ * \return the new connection
+ */
+IedConnection
+IedConnectionManager_addConnection(IedConnectionManager self, char* hostname, int tcpPort);
+
+/**
+ * \brief Close and destroy a managed connection
+ *
+ * The connection is destroyed by its event loop thread. It must not be used after calling this function.
+ */
+void
+IedConnectionManager_removeConnection(IedConnectionManager self, IedConnection connection);
+
+/**
+ * \brief Stop the event loop threads and destroy all managed connections
+ */
+void
+IedConnectionManager_destroy(IedConnectionManager self);
+
+/** @} */
+
 /**
  * @defgroup IEC61850_CLIENT_GOOSE Client side GOOSE control block handling functions
  *
@@ -616,6 +723,10 @@ typedef void (*ReportCallbackFunction) (void* parameter, ClientReport report);
  *
  * This function will replace a formerly set report handler function for the specified RCB.
  *
+ * Received reports are assigned to the handler by the report ID (RptID) if it is the RCB reference
+ * (default report ID) and otherwise by the data set reference. Use IedConnection_enableReporting to
+ * also assign reports by a configured report ID.
+ *
  * \param connection the connection object
  * \param rcbReference object reference of the report control block
  * \param callback user provided callback function to be invoked when a report is received.
@@ -633,6 +744,45 @@ IedConnection_installReportHandler(IedConnection self, char* rcbReference, Repor
 void
 IedConnection_uninstallReportHandler(IedConnection self, char* rcbReference);
 
+/**
+ * \brief Create a thread pool to execute report handlers
+ *
+ * By default report handlers are called by the receive thread of the connection. So a slow report handler
+ * delays all following messages of the connection. When a handler pool is used the report handlers are called
+ * by the threads of the pool instead. The reports of one RCB are still handled one after the other. A report
+ * that is received while the handler of the previous report of the same RCB is still running is dropped (see
+ * ClientReport_getDroppedReportCount). The receive thread never waits for a report handler.
+ *
+ * A pool can be shared by multiple connections.
+ *
+ * \param threadCount number of handler threads
+ *
+ * \return the new pool instance
+ */
+ClientReportHandlerPool
+ClientReportHandlerPool_create(int threadCount);
+
+/**
+ * \brief Stop the threads of the pool and release all resources
+ *
+ * Has to be called after all connections using the pool have been destroyed.
+ *
+ * \param self the pool instance
+ */
+void
+ClientReportHandlerPool_destroy(ClientReportHandlerPool self);
+
+/**
+ * \brief Call the report handlers of the connection in the threads of a report handler pool
+ *
+ * Should be set before reporting is enabled.
+ *
+ * \param self the connection object
+ * \param pool the report handler pool or NULL to call the report handlers by the receive thread
+ */
+void
+IedConnection_setReportHandlerPool(IedConnection self, ClientReportHandlerPool pool);
+
 /**
  * \brief enable a report control block (RCB)
  *
@@ -701,6 +851,17 @@ ClientReport_getDataSet(ClientReport self);
 char*
 ClientReport_getRcbReference(ClientReport self);
 
+/**
+ * \brief return the report ID (RptID) of the server RCB if it is known
+ *
+ * The report ID is known when the report has been enabled by IedConnection_enableReporting.
+ *
+ * \param self the ClientReport object handled to the report handler function
+ * \return report ID as string or NULL
+ */
+char*
+ClientReport_getRptId(ClientReport self);
+
 /**
  * \brief get the reason code (reason for inclusion) for a specific report data set element
  *
@@ -747,6 +908,19 @@ ClientReport_hasTimestamp(ClientReport self);
 uint64_t
 ClientReport_getTimestamp(ClientReport self);
 
+/**
+ * \brief get the number of reports of the RCB that have been dropped
+ *
+ * When a report handler pool is used a report is dropped if it is received while the handler of the
+ * previous report of the same RCB is still running.
+ *
+ * \param self the ClientReport object handled to the report handler function
+ *
+ * \return the number of dropped reports since the report handler has been installed
+ */
+uint32_t
+ClientReport_getDroppedReportCount(ClientReport self);
+
 /**
  * \brief get the reason for inclusion of as a human readable string
  *
@@ -883,6 +1057,26 @@ ClientReportControlBlock_getOwner(ClientReportControlBlock self);
 MmsValue*
 IedConnection_readObject(IedConnection self, IedClientError* error, char* dataAttributeReference, FunctionalConstraint fc);
 
+/**
+ * \brief read multiple functional constrained data attributes (FCDA) or functional constrained data (FCD)
+ *
+ * The object references have the format LDName/LNodeName.item[FC] (e.g. "simpleIOGenericIO/GGIO1.AnIn1.mag.f[MX]").
+ * The objects are grouped by logical device and packed into as few read requests as the negotiated
+ * maximum PDU size allows. The requests are sent without waiting for the responses of the previous
+ * requests (up to the negotiated number of outstanding requests). When the server rejects a request
+ * (e.g. because the response would exceed the maximum PDU size) the request is split and sent again.
+ *
+ * \param self  the connection object to operate on
+ * \param error the error code if an error occurs
+ * \param objectReferences list of object references with functional constraints
+ *
+ * \return MmsValue instance of type MMS_ARRAY with one element for each object reference (in the same order).
+ *         Elements of objects that could not be read are of type MMS_DATA_ACCESS_ERROR. NULL if the connection
+ *         failed.
+ */
+MmsValue*
+IedConnection_readObjects(IedConnection self, IedClientError* error, LinkedList /* <char*> */ objectReferences);
+
 /**
  * \brief write a functional constrained data attribute (FCDA) or functional constrained data (FCD).
  *
@@ -1053,6 +1247,128 @@ IedConnection_writeOctetString(IedConnection self, IedClientError* error, char*
 
 /** @} */
 
+/****************************************
+ * Poll groups
+ ****************************************/
+
+/**
+ * @defgroup IEC61850_CLIENT_POLL_GROUPS Client side cyclic polling of data objects
+ *
+ * A poll group reads a fixed set of data objects/attributes cyclically. The object references
+ * are resolved and the read requests are encoded only once when the poll group is created. The
+ * responses are decoded into the same MmsValue instances in each cycle. The cycles of all poll
+ * groups of a connection are scheduled by a single thread.
+ *
+ * @{
+ */
+
+/**
+ * \brief Callback that is called for each value of a poll group that has changed since the previous cycle
+ *
+ * In the first cycle the callback is called for all values. The callback is called by the receive thread
+ * of the connection. It must not block and must not destroy the poll group.
+ *
+ * \param parameter user provided parameter
+ * \param group the poll group
+ * \param index index of the value (position of the object reference in the list of the poll group)
+ * \param value the new value (owned by the poll group - only valid until the next cycle)
+ */
+typedef void (*ClientPollGroupChangeHandler) (void* parameter, ClientPollGroup group, int index, MmsValue* value);
+
+/**
+ * \brief Create a poll group for a list of functional constrained data objects/attributes
+ *
+ * The object references have the same format as for IedConnection_readObjects. The poll group is
+ * initially stopped.
+ *
+ * \param self the connection object
+ * \param error the error code if an error occurs
+ * \param objectReferences list of object references with FC (e.g. "simpleIOGenericIO/GGIO1.AnIn1.mag.f[MX]")
+ * \param periodInMs the poll cycle period in milliseconds
+ *
+ * \return the new poll group or NULL if an object reference is invalid
+ */
+ClientPollGroup
+IedConnection_createPollGroup(IedConnection self, IedClientError* error, LinkedList /* <char*> */ objectReferences,
+        int periodInMs);
+
+/**
+ * \brief Install a callback for changed values
+ *
+ * \param self the poll group
+ * \param handler the callback function
+ * \param parameter user provided parameter that will be passed to the callback function
+ */
+void
+ClientPollGroup_setChangeHandler(ClientPollGroup self, ClientPollGroupChangeHandler handler, void* parameter);
+
+/**
+ * \brief Start the cyclic polling. The first cycle is started immediately.
+ *
+ * \param self the poll group
+ */
+void
+ClientPollGroup_start(ClientPollGroup self);
+
+/**
+ * \brief Stop the cyclic polling. A running cycle will be completed.
+ *
+ * \param self the poll group
+ */
+void
+ClientPollGroup_stop(ClientPollGroup self);
+
+/**
+ * \brief Get the number of values (object references) of the poll group
+ */
+int
+ClientPollGroup_getSize(ClientPollGroup self);
+
+/**
+ * \brief Get the value of the last completed cycle
+ *
+ * The value is owned by the poll group and is updated in place by each cycle. It should only be
+ * accessed by the change handler or while the poll group is stopped.
+ *
+ * \param self the poll group
+ * \param index index of the value (position of the object reference in the list of the poll group)
+ *
+ * \return the value, a value of type MMS_DATA_ACCESS_ERROR, or NULL if the value has not been read yet
+ */
+MmsValue*
+ClientPollGroup_getValue(ClientPollGroup self, int index);
+
+/**
+ * \brief Get the number of completed cycles
+ */
+uint32_t
+ClientPollGroup_getCycleCount(ClientPollGroup self);
+
+/**
+ * \brief Get the number of cycles that have been skipped because the previous cycle was not completed in time
+ */
+uint32_t
+ClientPollGroup_getOverrunCount(ClientPollGroup self);
+
+/**
+ * \brief Get the error of the last cycle (e.g. IED_ERROR_TIMEOUT or IED_ERROR_NOT_CONNECTED)
+ */
+IedClientError
+ClientPollGroup_getLastError(ClientPollGroup self);
+
+/**
+ * \brief Stop the poll group and release all resources
+ *
+ * Waits until the pending requests of a running cycle are completed. Poll groups that are not
+ * destroyed are released by IedConnection_destroy.
+ *
+ * \param self the poll group
+ */
+void
+ClientPollGroup_destroy(ClientPollGroup self);
+
+/** @} */
+
 /****************************************
  * Data set handling
  ****************************************/
@@ -1259,6 +1575,90 @@ void
 ControlObjectClient_setCommandTerminationHandler(ControlObjectClient self, CommandTerminationHandler handler,
         void* handlerParameter);
 
+typedef enum {
+    CONTROL_ACTION_TYPE_SELECT = 0,
+    CONTROL_ACTION_TYPE_OPERATE = 1
+} ControlActionType;
+
+/**
+ * \brief Handler that is invoked when an asynchronous control action is completed
+ *
+ * For the operate action of controls with enhanced security the action is completed when the
+ * CommandTermination is received. If it is not received within the termination timeout (see
+ * ControlObjectClient_setCommandTerminationTimeout) the action is completed with IED_ERROR_TIMEOUT, and
+ * with IED_ERROR_CONNECTION_LOST when the connection is closed. Otherwise the action is completed with the
+ * response of the server. The handler is called by the connection's receive thread.
+ *
+ * \param invokeId the invokeId of the request
+ * \param parameter user provided parameter
+ * \param err IED_ERROR_OK if the request was accepted by the server, the error code otherwise
+ * \param type the type of the completed control action
+ * \param success true if the action was successful (for enhanced security: positive CommandTermination)
+ */
+typedef void
+(*ControlObjectClient_ControlActionHandler) (uint32_t invokeId, void* parameter, IedClientError err,
+        ControlActionType type, bool success);
+
+/**
+ * \brief Pre-encode the constant parts of the control service requests
+ *
+ * The variable specifications, the origin and the test and check flags are encoded once. For each
+ * asynchronous command only ctlVal, ctlNum, the timestamps and the invokeId are encoded. The templates
+ * are renewed automatically when the origin or the flags are changed. Calling this function is optional -
+ * it avoids the encoding effort for the first command.
+ *
+ * \param self the ControlObjectClient instance
+ */
+void
+ControlObjectClient_prepareCommands(ControlObjectClient self);
+
+/**
+ * \brief Set the maximum time to wait for the CommandTermination of an asynchronous operate command
+ *
+ * The time starts when the response to the operate command is received (default: 10000 ms). The
+ * deadline is checked when a message is received and by MmsConnection_handleTimeouts.
+ *
+ * \param self the ControlObjectClient instance
+ * \param timeoutInMs the timeout in milliseconds
+ */
+void
+ControlObjectClient_setCommandTerminationTimeout(ControlObjectClient self, int timeoutInMs);
+
+/**
+ * \brief Send an operate command without waiting for the response (uses the pre-encoded templates)
+ *
+ * Only one asynchronous action per control object can wait for completion. A new action completes a waiting
+ * action with IED_ERROR_TIMEOUT.
+ * The ControlObjectClient instance must not be destroyed while actions are outstanding.
+ *
+ * \param self the ControlObjectClient instance
+ * \param error the error code if the command could not be sent
+ * \param ctlVal the control value
+ * \param operTime the time of the operation for time activated control (0 for immediate execution)
+ * \param handler the handler that is called when the action is completed
+ * \param parameter user provided parameter that is passed to the handler
+ *
+ * \return the invokeId of the request or 0 if the command could not be sent
+ */
+uint32_t
+ControlObjectClient_operateAsync(ControlObjectClient self, IedClientError* error, MmsValue* ctlVal, uint64_t operTime,
+        ControlObjectClient_ControlActionHandler handler, void* parameter);
+
+/**
+ * \brief Send a select with value command without waiting for the response (uses the pre-encoded templates)
+ *
+ * \param self the ControlObjectClient instance
+ * \param error the error code if the command could not be sent
+ * \param ctlVal the control value
+ * \param handler the handler that is called when the action is completed
+ * \param parameter user provided parameter that is passed to the handler
+ *
+ * \return the invokeId of the request or 0 if the command could not be sent
+ */
+uint32_t
+ControlObjectClient_selectWithValueAsync(ControlObjectClient self, IedClientError* error, MmsValue* ctlVal,
+        ControlObjectClient_ControlActionHandler handler, void* parameter);
+
 /** @} */
 
 /*************************************
@@ -1284,6 +1684,27 @@ ControlObjectClient_setCommandTerminationHandler(ControlObjectClient self, Comma
 void
 IedConnection_getDeviceModelFromServer(IedConnection self, IedClientError* error);
 
+/**
+ * \brief Set a directory to cache the device model and the type specifications of the server
+ *
+ * When set, the server is identified (MMS identify service) and the model is stored in a file
+ * named after vendor, model and revision and the address (host and port) of the server.
+ * The cache file also contains a fingerprint of the model that is created from the logical device
+ * names and the configuration revisions (LLN0.NamPlt.configRev) of the logical devices. The cached
+ * model and type specifications are only used when the fingerprint of the connected server matches.
+ * IedConnection_getDeviceModelFromServer then reuses the cached model instead of requesting the
+ * variables and data sets of the logical devices. Type specifications (IedConnection_getVariableSpecification)
+ * are also taken from the cache. The cache file is updated when the connection is closed.
+ *
+ * NOTE: when a logical device has no readable configRev the cache is not used. The server has to
+ * change configRev whenever the data model is changed.
+ *
+ * \param self the connection object
+ * \param directoryName the cache directory or NULL to disable the cache
+ */
+void
+IedConnection_setModelCacheDirectory(IedConnection self, char* directoryName);
+
 /**
  * \brief Get the list of logical devices available at the server (DEPRECATED)
  *
@@ -1501,6 +1922,63 @@ uint32_t
 IedConnection_getFile(IedConnection self, IedClientError* error, char* fileName, IedClientGetFileHandler handler,
         void* handlerParameter);
 
+/**
+ * \brief Statistics of a file transfer (see IedConnection_getFileWindowed)
+ */
+typedef struct {
+    uint32_t fileSize; /* file size reported by the server */
+    uint32_t initialPosition; /* position where the transfer started */
+    uint32_t bytesReceived;
+    uint32_t fileReadRequests;
+    uint64_t durationInMs;
+    uint32_t bytesPerSecond;
+} IedClientFileTransferStatistics;
+
+/**
+ * \brief Download a file from the server with multiple pipelined FileRead requests
+ *
+ * Unlike IedConnection_getFile this function keeps up to windowSize FileRead requests in flight.
+ * This avoids waiting a full round trip for each data block on high latency links.
+ *
+ * The handler is called in file order with the data blocks directly from the receive buffer. NOTE: the handler
+ * is called by the connection's receive thread. FileRead responses carry no file position, so the transfer
+ * fails if the responses are not received in the order of the requests. Responses to the requests that were
+ * sent after the last data block of the file are ignored.
+ *
+ * \param self the connection object
+ * \param error the error code if an error occurs
+ * \param fileName the name of the file to be read from the server
+ * \param initialPosition the file position to start the transfer (resume an interrupted transfer)
+ * \param windowSize maximum number of outstanding FileRead requests
+ * \param handler the user provided handler that receives the data blocks
+ * \param handlerParameter user provided parameter that is passed to the handler
+ * \param statistics if not NULL the transfer statistics are stored here
+ *
+ * \return number of bytes received
+ */
+uint32_t
+IedConnection_getFileWindowed(IedConnection self, IedClientError* error, char* fileName, uint32_t initialPosition,
+        int windowSize, IedClientGetFileHandler handler, void* handlerParameter,
+        IedClientFileTransferStatistics* statistics);
+
+/**
+ * \brief Download a file from the server to a local file (see IedConnection_getFileWindowed)
+ *
+ * \param self the connection object
+ * \param error the error code if an error occurs
+ * \param fileName the name of the file to be read from the server
+ * \param localFileName the name of the local file
+ * \param resume if true the data is appended to an existing local file starting at its size. Otherwise the
+ *        local file is overwritten.
+ * \param windowSize maximum number of outstanding FileRead requests
+ * \param statistics if not NULL the transfer statistics are stored here
+ *
+ * \return number of bytes received
+ */
+uint32_t
+IedConnection_getFileToLocalFile(IedConnection self, IedClientError* error, char* fileName, char* localFileName,
+        bool resume, int windowSize, IedClientFileTransferStatistics* statistics);
+
 /**
  * \brief Implementation of the DeleteFile ACSI service
  *
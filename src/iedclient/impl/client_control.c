@@ -28,9 +28,14 @@
 #include "stack_config.h"
 
 #include "mms_client_connection.h"
+#include "mms_client_internal.h"
+#include "mms_value_internal.h"
+#include "mms_access_result.h"
 #include "mms_mapping.h"
+#include "ber_encoder.h"
 
 #include "ied_connection_private.h"
+#include "hal.h"
 
 #include <stdio.h>
 
@@ -42,6 +47,26 @@
 #define DEBUG_IED_CLIENT 0
 #endif
 
+#define CONTROL_DEFAULT_TERMINATION_TIMEOUT 10000
+
+typedef struct sControlAction* ControlAction;
+
+struct sControlAction
+{
+    ControlObjectClient control;
+    uint32_t invokeId;
+    ControlActionType type;
+    uint8_t ctlNum;
+    bool waitForTermination;
+    bool responseReceived;
+    bool failed; /* LastApplError received */
+    uint64_t terminationDeadline; /* monotonic time (ns) - set when the response has been received */
+    bool sent;
+    bool released;
+    ControlObjectClient_ControlActionHandler handler;
+    void* handlerParameter;
+};
+
 struct sControlObjectClient
 {
     ControlModel ctlModel;
@@ -63,6 +88,23 @@ struct sControlObjectClient
     uint8_t ctlNum;
     char* orIdent;
     int orCat;
+
+    /* pre-encoded parts of the control service requests (see ControlObjectClient_prepareCommands) */
+    Semaphore asyncLock;
+    bool commandTemplatesValid;
+    uint8_t* operVariableSpec;
+    int operVariableSpecSize;
+    uint8_t* sbowVariableSpec;
+    int sbowVariableSpecSize;
+    uint8_t* encodedOrigin;
+    int encodedOriginSize;
+    uint8_t* encodedFlags; /* Test and Check */
+    int encodedFlagsSize;
+    Semaphore commandLock; /* protects the templates */
+
+    /* asynchronous control action waiting for completion */
+    ControlAction pendingAction;
+    int terminationTimeout; /* in ms */
 };
 
 static void
@@ -98,6 +140,40 @@ convertToMmsAndInsertFC(char* newItemId, char* originalObjectName, char* fc)
     newItemId[dstIndex] = 0;
 }
 
+static void
+releaseCommandTemplates(ControlObjectClient self)
+{
+    if (self->operVariableSpec != NULL) {
+        free(self->operVariableSpec);
+        self->operVariableSpec = NULL;
+    }
+
+    if (self->sbowVariableSpec != NULL) {
+        free(self->sbowVariableSpec);
+        self->sbowVariableSpec = NULL;
+    }
+
+    if (self->encodedOrigin != NULL) {
+        free(self->encodedOrigin);
+        self->encodedOrigin = NULL;
+    }
+
+    if (self->encodedFlags != NULL) {
+        free(self->encodedFlags);
+        self->encodedFlags = NULL;
+    }
+
+    self->commandTemplatesValid = false;
+}
+
+static void
+invalidateCommandTemplates(ControlObjectClient self)
+{
+    Semaphore_wait(self->commandLock);
+    releaseCommandTemplates(self);
+    Semaphore_post(self->commandLock);
+}
+
 ControlObjectClient
 ControlObjectClient_create(char* objectReference, IedConnection connection)
 {
@@ -198,6 +274,9 @@ ControlObjectClient_create(char* objectReference, IedConnection connection)
     self->ctlModel = (ControlModel) ctlModelVal;
     self->hasTimeActivatedMode = hasTimeActivatedControl;
     self->ctlVal = MmsValue_getElement(oper, 0);
+    self->asyncLock = Semaphore_create(1);
+    self->commandLock = Semaphore_create(1);
+    self->terminationTimeout = CONTROL_DEFAULT_TERMINATION_TIMEOUT;
 
     MmsValue_setElement(oper, 0, NULL);
     MmsValue_delete(oper);
@@ -220,6 +299,18 @@ ControlObjectClient_destroy(ControlObjectClient self)
     if (self->orIdent != NULL)
         free(self->orIdent);
 
+    releaseCommandTemplates(self);
+
+    if (self->pendingAction != NULL) {
+        if (self->pendingAction->responseReceived)
+            free(self->pendingAction);
+        else
+            self->pendingAction->control = NULL;
+    }
+
+    Semaphore_destroy(self->asyncLock);
+    Semaphore_destroy(self->commandLock);
+
     free(self);
 }
 
@@ -251,6 +342,8 @@ ControlObjectClient_setOrigin(ControlObjectClient self, char* orIdent, int orCat
 
     self->orIdent = copyString(orIdent);
     self->orCat = orCat;
+
+    invalidateCommandTemplates(self);
 }
 
 static MmsValue*
@@ -529,22 +622,381 @@ ControlObjectClient_cancel(ControlObjectClient self)
     return true;
 }
 
+static uint8_t*
+encodeVariableSpecification(char* domainId, char* itemId, int* size)
+{
+    /* listOfVariable [0] { SEQUENCE { name [0] { domain-specific [1] { domainId, itemId } } } } */
+    int objectNameSize = BerEncoder_determineEncodedStringSize(domainId)
+            + BerEncoder_determineEncodedStringSize(itemId);
+    int nameSize = 1 + BerEncoder_determineLengthSize(objectNameSize) + objectNameSize;
+    int sequenceSize = 1 + BerEncoder_determineLengthSize(nameSize) + nameSize;
+    int listSize = 1 + BerEncoder_determineLengthSize(sequenceSize) + sequenceSize;
+
+    *size = 1 + BerEncoder_determineLengthSize(listSize) + listSize;
+
+    uint8_t* buffer = (uint8_t*) malloc(*size);
+
+    int bufPos = 0;
+
+    bufPos = BerEncoder_encodeTL(0xa0, listSize, buffer, bufPos);
+    bufPos = BerEncoder_encodeTL(0x30, sequenceSize, buffer, bufPos);
+    bufPos = BerEncoder_encodeTL(0xa0, nameSize, buffer, bufPos);
+    bufPos = BerEncoder_encodeTL(0xa1, objectNameSize, buffer, bufPos);
+    bufPos = BerEncoder_encodeStringWithTag(0x1a, domainId, buffer, bufPos);
+    bufPos = BerEncoder_encodeStringWithTag(0x1a, itemId, buffer, bufPos);
+
+    return buffer;
+}
+
+static uint8_t*
+encodeDataValue(MmsValue* value, int* size)
+{
+    *size = mmsServer_encodeAccessResult(value, NULL, 0, false);
+
+    uint8_t* buffer = (uint8_t*) malloc(*size);
+
+    mmsServer_encodeAccessResult(value, buffer, 0, true);
+
+    return buffer;
+}
+
+/* has to be called with commandLock */
+static void
+createCommandTemplates(ControlObjectClient self)
+{
+    char domainId[65];
+    char itemId[130];
+
+    MmsMapping_getMmsDomainFromObjectReference(self->objectReference, domainId);
+
+    convertToMmsAndInsertFC(itemId, self->objectReference + strlen(domainId) + 1, "CO");
+
+    int itemIdLength = strlen(itemId);
+
+    strncat(itemId, "$Oper", 129);
+    self->operVariableSpec = encodeVariableSpecification(domainId, itemId, &(self->operVariableSpecSize));
+
+    itemId[itemIdLength] = 0;
+    strncat(itemId, "$SBOw", 129);
+    self->sbowVariableSpec = encodeVariableSpecification(domainId, itemId, &(self->sbowVariableSpecSize));
+
+    MmsValue* origin = createOriginValue(self);
+    self->encodedOrigin = encodeDataValue(origin, &(self->encodedOriginSize));
+    MmsValue_delete(origin);
+
+    MmsValue* ctlTest = MmsValue_newBoolean(self->test);
+    MmsValue* check = MmsValue_newBitString(2);
+    MmsValue_setBitStringBit(check, 1, self->interlockCheck);
+    MmsValue_setBitStringBit(check, 0, self->synchroCheck);
+
+    int testSize = mmsServer_encodeAccessResult(ctlTest, NULL, 0, false);
+    int checkSize = mmsServer_encodeAccessResult(check, NULL, 0, false);
+
+    self->encodedFlagsSize = testSize + checkSize;
+    self->encodedFlags = (uint8_t*) malloc(self->encodedFlagsSize);
+
+    mmsServer_encodeAccessResult(ctlTest, self->encodedFlags, 0, true);
+    mmsServer_encodeAccessResult(check, self->encodedFlags, testSize, true);
+
+    MmsValue_delete(ctlTest);
+    MmsValue_delete(check);
+
+    self->commandTemplatesValid = true;
+}
+
+void
+ControlObjectClient_prepareCommands(ControlObjectClient self)
+{
+    Semaphore_wait(self->commandLock);
+
+    if (self->commandTemplatesValid == false)
+        createCommandTemplates(self);
+
+    Semaphore_post(self->commandLock);
+}
+
+static int
+encodeUtcTime(uint64_t timeInMs, uint8_t* buffer, int bufPos)
+{
+    struct sMmsValue utcTime;
+
+    utcTime.type = MMS_UTC_TIME;
+    MmsValue_setUtcTimeMs(&utcTime, timeInMs);
+
+    return mmsServer_encodeAccessResult(&utcTime, buffer, bufPos, true);
+}
+
+/*
+ * Assemble the confirmed service request (write) from the pre-encoded templates. Only ctlVal, ctlNum and the
+ * time stamps are encoded for each command. Has to be called with commandLock. The returned buffer has to be
+ * released by the caller.
+ */
+static uint8_t*
+encodeControlCommand(ControlObjectClient self, ControlActionType type, MmsValue* ctlVal, uint64_t operTime,
+        uint8_t ctlNum, int* serviceRequestSize)
+{
+    uint8_t* variableSpec;
+    int variableSpecSize;
+
+    if (type == CONTROL_ACTION_TYPE_OPERATE) {
+        variableSpec = self->operVariableSpec;
+        variableSpecSize = self->operVariableSpecSize;
+    }
+    else {
+        variableSpec = self->sbowVariableSpec;
+        variableSpecSize = self->sbowVariableSpecSize;
+    }
+
+    int ctlValSize = mmsServer_encodeAccessResult(ctlVal, NULL, 0, false);
+    int ctlNumSize = 2 + BerEncoder_UInt32determineEncodedSize(ctlNum);
+
+    int structureContentSize = ctlValSize + self->encodedOriginSize + ctlNumSize + 10 + self->encodedFlagsSize;
+
+    if (self->hasTimeActivatedMode)
+        structureContentSize += 10;
+
+    int structureSize = 1 + BerEncoder_determineLengthSize(structureContentSize) + structureContentSize;
+    int listOfDataSize = 1 + BerEncoder_determineLengthSize(structureSize) + structureSize;
+    int writeRequestSize = variableSpecSize + listOfDataSize;
+    *serviceRequestSize = 1 + BerEncoder_determineLengthSize(writeRequestSize) + writeRequestSize;
+
+    uint8_t* buffer = (uint8_t*) malloc(*serviceRequestSize);
+    int bufPos = 0;
+
+    bufPos = BerEncoder_encodeTL(0xa5, writeRequestSize, buffer, bufPos);
+
+    memcpy(buffer + bufPos, variableSpec, variableSpecSize);
+    bufPos += variableSpecSize;
+
+    bufPos = BerEncoder_encodeTL(0xa0, structureSize, buffer, bufPos);
+    bufPos = BerEncoder_encodeTL(0xa2, structureContentSize, buffer, bufPos);
+
+    bufPos = mmsServer_encodeAccessResult(ctlVal, buffer, bufPos, true);
+
+    if (self->hasTimeActivatedMode)
+        bufPos = encodeUtcTime(operTime, buffer, bufPos);
+
+    memcpy(buffer + bufPos, self->encodedOrigin, self->encodedOriginSize);
+    bufPos += self->encodedOriginSize;
+
+    bufPos = BerEncoder_encodeUInt32WithTL(0x86, ctlNum, buffer, bufPos);
+
+    bufPos = encodeUtcTime(Hal_getTimeInMs(), buffer, bufPos);
+
+    memcpy(buffer + bufPos, self->encodedFlags, self->encodedFlagsSize);
+
+    return buffer;
+}
+
+/* has to be called with asyncLock */
+static void
+releaseControlAction(ControlAction action)
+{
+    if (action->sent)
+        free(action);
+    else
+        action->released = true;
+}
+
+/* has to be called with asyncLock - releases the lock before the handler is called */
+static void
+completeControlAction(ControlObjectClient self, ControlAction action, IedClientError err, bool success,
+        bool release)
+{
+    ControlObjectClient_ControlActionHandler handler = action->handler;
+    void* handlerParameter = action->handlerParameter;
+    uint32_t invokeId = action->invokeId;
+    ControlActionType type = action->type;
+
+    self->pendingAction = NULL;
+
+    if (release)
+        releaseControlAction(action);
+
+    Semaphore_post(self->asyncLock);
+
+    if (handler != NULL)
+        handler(invokeId, handlerParameter, err, type, success);
+}
+
+static void
+controlActionResponseHandler(uint32_t invokeId, void* parameter, MmsError mmsError, ByteBuffer* response)
+{
+    ControlAction action = (ControlAction) parameter;
+    ControlObjectClient self = action->control;
+
+    if (self == NULL) {
+        /* control object has been destroyed */
+        free(action);
+        return;
+    }
+
+    if (mmsError == MMS_ERROR_NONE)
+        mmsClient_parseWriteResponsePdu(response, &mmsError);
+
+    Semaphore_wait(self->asyncLock);
+
+    action->invokeId = invokeId;
+
+    if (self->pendingAction != action) {
+        /* action has been replaced by a newer one */
+        releaseControlAction(action);
+        Semaphore_post(self->asyncLock);
+        return;
+    }
+
+    if (mmsError != MMS_ERROR_NONE) {
+        if (DEBUG_IED_CLIENT)
+            printf("IED_CLIENT: control action failed!\n");
+
+        completeControlAction(self, action, iedConnection_mapMmsErrorToIedError(mmsError), false, true);
+    }
+    else if (action->waitForTermination) {
+        action->responseReceived = true;
+        action->terminationDeadline = Hal_getMonotonicTimeInNs() + ((uint64_t) self->terminationTimeout * 1000000);
+        Semaphore_post(self->asyncLock);
+    }
+    else
+        completeControlAction(self, action, IED_ERROR_OK, true, true);
+}
+
+static uint32_t
+sendControlCommandAsync(ControlObjectClient self, IedClientError* error, ControlActionType type, MmsValue* ctlVal,
+        uint64_t operTime, uint8_t ctlNum, ControlObjectClient_ControlActionHandler handler, void* parameter)
+{
+    ControlAction action = (ControlAction) calloc(1, sizeof(struct sControlAction));
+
+    action->control = self;
+    action->type = type;
+    action->ctlNum = ctlNum;
+    action->handler = handler;
+    action->handlerParameter = parameter;
+
+    if ((type == CONTROL_ACTION_TYPE_OPERATE) &&
+            ((self->ctlModel == CONTROL_MODEL_DIRECT_ENHANCED) || (self->ctlModel == CONTROL_MODEL_SBO_ENHANCED)))
+        action->waitForTermination = true;
+
+    Semaphore_wait(self->asyncLock);
+
+    if (self->pendingAction != NULL) {
+        if (DEBUG_IED_CLIENT)
+            printf("IED_CLIENT: replace pending control action (invokeId: %u)\n", self->pendingAction->invokeId);
+
+        /* a replaced action is released by its response handler */
+        completeControlAction(self, self->pendingAction, IED_ERROR_TIMEOUT, false,
+                self->pendingAction->responseReceived);
+
+        Semaphore_wait(self->asyncLock);
+    }
+
+    self->pendingAction = action;
+
+    Semaphore_post(self->asyncLock);
+
+    Semaphore_wait(self->commandLock);
+
+    if (self->commandTemplatesValid == false)
+        createCommandTemplates(self);
+
+    int serviceRequestSize;
+
+    uint8_t* serviceRequest = encodeControlCommand(self, type, ctlVal, operTime, ctlNum, &serviceRequestSize);
+
+    Semaphore_post(self->commandLock);
+
+    /* no lock is held while sending - sending can block until a slot for the request is free */
+    MmsError mmsError;
+
+    uint32_t invokeId = mmsClient_sendEncodedServiceRequest(IedConnection_getMmsConnection(self->connection),
+            &mmsError, serviceRequest, serviceRequestSize, controlActionResponseHandler, action);
+
+    free(serviceRequest);
+
+    Semaphore_wait(self->asyncLock);
+
+    if (invokeId == 0) {
+        /* response handler will not be called */
+        if (self->pendingAction == action)
+            self->pendingAction = NULL;
+
+        free(action);
+
+        *error = iedConnection_mapMmsErrorToIedError(mmsError);
+    }
+    else {
+        action->invokeId = invokeId;
+        action->sent = true;
+
+        if (action->released)
+            free(action);
+
+        *error = IED_ERROR_OK;
+    }
+
+    Semaphore_post(self->asyncLock);
+
+    return invokeId;
+}
+
+uint32_t
+ControlObjectClient_operateAsync(ControlObjectClient self, IedClientError* error, MmsValue* ctlVal, uint64_t operTime,
+        ControlObjectClient_ControlActionHandler handler, void* parameter)
+{
+    self->ctlNum++;
+
+    if (DEBUG_IED_CLIENT)
+        printf("IED_CLIENT: operate async: %s\n", self->objectReference);
+
+    return sendControlCommandAsync(self, error, CONTROL_ACTION_TYPE_OPERATE, ctlVal, operTime, self->ctlNum,
+            handler, parameter);
+}
+
+uint32_t
+ControlObjectClient_selectWithValueAsync(ControlObjectClient self, IedClientError* error, MmsValue* ctlVal,
+        ControlObjectClient_ControlActionHandler handler, void* parameter)
+{
+    if (DEBUG_IED_CLIENT)
+        printf("IED_CLIENT: select with value async: %s\n", self->objectReference);
+
+    return sendControlCommandAsync(self, error, CONTROL_ACTION_TYPE_SELECT, ctlVal, 0, self->ctlNum + 1,
+            handler, parameter);
+}
+
+void
+ControlObjectClient_setCommandTerminationTimeout(ControlObjectClient self, int timeoutInMs)
+{
+    self->terminationTimeout = timeoutInMs;
+}
+
 void
 ControlObjectClient_enableInterlockCheck(ControlObjectClient self)
 {
     self->interlockCheck = true;
+
+    invalidateCommandTemplates(self);
 }
 
 void
 ControlObjectClient_enableSynchroCheck(ControlObjectClient self)
 {
     self->synchroCheck = true;
+
+    invalidateCommandTemplates(self);
 }
 
 void
 ControlObjectClient_setLastApplError(ControlObjectClient self, LastApplError lastApplError)
 {
     self->lastApplError = lastApplError;
+
+    Semaphore_wait(self->asyncLock);
+
+    ControlAction action = self->pendingAction;
+
+    if ((action != NULL) && (lastApplError.error != 0) && ((uint8_t) lastApplError.ctlNum == action->ctlNum))
+        action->failed = true;
+
+    Semaphore_post(self->asyncLock);
 }
 
 LastApplError
@@ -556,6 +1008,35 @@ ControlObjectClient_getLastApplError(ControlObjectClient self)
 void
 private_ControlObjectClient_invokeCommandTerminationHandler(ControlObjectClient self)
 {
+    Semaphore_wait(self->asyncLock);
+
+    ControlAction action = self->pendingAction;
+
+    if ((action != NULL) && action->waitForTermination && action->responseReceived)
+        completeControlAction(self, action, IED_ERROR_OK, !action->failed, true);
+    else
+        Semaphore_post(self->asyncLock);
+
     if (self->commandTerminationHandler != NULL)
              self->commandTerminationHandler(self->commandTerminaionHandlerParameter, self);
 }
+
+void
+private_ControlObjectClient_handleTimeouts(ControlObjectClient self, bool connectionLost)
+{
+    Semaphore_wait(self->asyncLock);
+
+    ControlAction action = self->pendingAction;
+
+    if ((action != NULL) && action->responseReceived &&
+            (connectionLost || (Hal_getMonotonicTimeInNs() >= action->terminationDeadline)))
+    {
+        if (DEBUG_IED_CLIENT)
+            printf("IED_CLIENT: no CommandTermination for %s\n", self->objectReference);
+
+        completeControlAction(self, action, connectionLost ? IED_ERROR_CONNECTION_LOST : IED_ERROR_TIMEOUT,
+                false, true);
+    }
+    else
+        Semaphore_post(self->asyncLock);
+}
@@ -0,0 +1,760 @@
+/*
+ *  client_model_cache.c
+ *
+ *  Persistent cache for the device model and the type specifications of a server.
+ *
+ *  Copyright 2014 Michael Zillgith
+ *
+ *  This file is part of libIEC61850.
+ *
+ *  libIEC61850 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libIEC61850 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libIEC61850.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  See COPYING file for the complete license text.
+ */
+
+#include "libiec61850_platform_includes.h"
+
+#include "iec61850_client.h"
+
+#include "stack_config.h"
+
+#include "ied_connection_private.h"
+
+#include "mms_client_internal.h"
+
+/*
+ * Cache file layout:
+ *
+ * MODEL_CACHE_MAGIC followed by records of the form <tag (1 byte)> <length (4 byte big endian)> <data>
+ *
+ * 'I' server identity "<vendor>\0<model>\0<revision>\0<server address>\0<model fingerprint>"
+ * 'L' logical device name - the following 'v' and 'd' records belong to this logical device
+ * 'v' MMS variable name
+ * 'd' MMS named variable list (data set) name
+ * 'T' type specification "<domainId>/<itemId>\0<BER encoded type specification>"
+ *
+ * The model fingerprint is a hash of the logical device names and the configuration revisions
+ * (LLN0.NamPlt.configRev) of the logical devices. A cache file is only used when the identity record
+ * matches completely.
+ */
+
+#define MODEL_CACHE_MAGIC "LIBIEC61850-MODEL-CACHE-2\n"
+#define MODEL_CACHE_MAGIC_SIZE (sizeof(MODEL_CACHE_MAGIC) - 1)
+
+#define MODEL_CACHE_RECORD_HEADER_SIZE 5
+
+typedef struct
+{
+    char* key; /* "<domainId>/<itemId>" */
+    int size;
+    uint8_t* buffer;
+} EncodedTypeSpec;
+
+static EncodedTypeSpec*
+EncodedTypeSpec_create(char* key, int keySize, uint8_t* buffer, int size)
+{
+    /* single allocation - can be released with free */
+    EncodedTypeSpec* self = (EncodedTypeSpec*) malloc(sizeof(EncodedTypeSpec) + keySize + 1 + size);
+
+    self->key = (char*) (self + 1);
+    memcpy(self->key, key, keySize);
+    self->key[keySize] = 0;
+
+    self->size = size;
+    self->buffer = (uint8_t*) (self->key + keySize + 1);
+    memcpy(self->buffer, buffer, size);
+
+    return self;
+}
+
+static EncodedTypeSpec*
+lookupTypeSpec(IedConnection self, char* domainId, char* itemId)
+{
+    int domainIdSize = strlen(domainId);
+
+    LinkedList element = LinkedList_getNext(self->typeSpecCache);
+
+    while (element != NULL) {
+        EncodedTypeSpec* typeSpec = (EncodedTypeSpec*) element->data;
+
+        if ((strncmp(typeSpec->key, domainId, domainIdSize) == 0) && (typeSpec->key[domainIdSize] == '/') &&
+                (strcmp(typeSpec->key + domainIdSize + 1, itemId) == 0))
+            return typeSpec;
+
+        element = LinkedList_getNext(element);
+    }
+
+    return NULL;
+}
+
+static void
+deleteCachedLogicalDevices(IedConnection self)
+{
+    if (self->cachedLogicalDevices != NULL) {
+        LinkedList_destroyDeep(self->cachedLogicalDevices, (LinkedListValueDeleteFunction) ICLogicalDevice_destroy);
+        self->cachedLogicalDevices = NULL;
+    }
+}
+
+static void
+clearTypeSpecCache(IedConnection self)
+{
+    LinkedList_destroy(self->typeSpecCache);
+    self->typeSpecCache = LinkedList_create();
+}
+
+#define MODEL_FINGERPRINT_OFFSET 14695981039346656037ULL
+#define MODEL_FINGERPRINT_PRIME 1099511628211ULL
+
+static uint64_t
+updateFingerprint(uint64_t fingerprint, uint8_t* data, int size)
+{
+    int i;
+
+    for (i = 0; i < size; i++) {
+        fingerprint ^= data[i];
+        fingerprint *= MODEL_FINGERPRINT_PRIME;
+    }
+
+    return fingerprint;
+}
+
+static bool
+updateFingerprintWithConfigRev(IedConnection self, uint64_t* fingerprint, char* domainId)
+{
+    MmsError mmsError;
+
+    MmsValue* configRev = MmsConnection_readVariable(self->connection, &mmsError, domainId, "LLN0$DC$NamPlt$configRev");
+
+    if (configRev == NULL)
+        return false;
+
+    bool success = true;
+
+    switch (MmsValue_getType(configRev)) {
+    case MMS_VISIBLE_STRING:
+    case MMS_STRING:
+        {
+            char* value = MmsValue_toString(configRev);
+
+            *fingerprint = updateFingerprint(*fingerprint, (uint8_t*) value, strlen(value) + 1);
+        }
+        break;
+
+    case MMS_INTEGER:
+    case MMS_UNSIGNED:
+        {
+            uint8_t value[8];
+            int64_t intValue = MmsValue_toInt64(configRev);
+            int i;
+
+            for (i = 0; i < 8; i++)
+                value[i] = (uint8_t) (intValue >> (8 * i));
+
+            *fingerprint = updateFingerprint(*fingerprint, value, 8);
+        }
+        break;
+
+    default:
+        success = false;
+        break;
+    }
+
+    MmsValue_delete(configRev);
+
+    return success;
+}
+
+/*
+ * The fingerprint covers the logical device names and the configuration revisions of the logical devices.
+ * The configuration revision has to be changed by the server whenever the data model is changed.
+ */
+static bool
+createModelFingerprint(IedConnection self, uint64_t* fingerprint)
+{
+    MmsError mmsError;
+
+    LinkedList logicalDeviceNames = MmsConnection_getDomainNames(self->connection, &mmsError);
+
+    if (logicalDeviceNames == NULL)
+        return false;
+
+    bool success = true;
+
+    *fingerprint = MODEL_FINGERPRINT_OFFSET;
+
+    LinkedList element = LinkedList_getNext(logicalDeviceNames);
+
+    while (element != NULL) {
+        char* logicalDeviceName = (char*) element->data;
+
+        *fingerprint = updateFingerprint(*fingerprint, (uint8_t*) logicalDeviceName, strlen(logicalDeviceName) + 1);
+
+        if (!updateFingerprintWithConfigRev(self, fingerprint, logicalDeviceName)) {
+            if (DEBUG_IED_CLIENT)
+                printf("IED_CLIENT: configRev of %s not available\n", logicalDeviceName);
+
+            success = false;
+            break;
+        }
+
+        element = LinkedList_getNext(element);
+    }
+
+    LinkedList_destroy(logicalDeviceNames);
+
+    return success;
+}
+
+static char*
+createServerAddress(IedConnection self)
+{
+    IsoConnectionParameters parameters = MmsConnection_getIsoConnectionParameters(self->connection);
+
+    char portString[12];
+
+    sprintf(portString, "%i", parameters->tcpPort);
+
+    return createString(3, parameters->hostname != NULL ? parameters->hostname : "", ":", portString);
+}
+
+static char*
+createIdentityString(MmsServerIdentity* identity, char* serverAddress, uint64_t fingerprint, int* size)
+{
+    char fingerprintString[17];
+
+    sprintf(fingerprintString, "%08x%08x", (unsigned int) (fingerprint >> 32), (unsigned int) fingerprint);
+
+    char* parts[5];
+
+    parts[0] = identity->vendorName != NULL ? identity->vendorName : "";
+    parts[1] = identity->modelName != NULL ? identity->modelName : "";
+    parts[2] = identity->revision != NULL ? identity->revision : "";
+    parts[3] = serverAddress;
+    parts[4] = fingerprintString;
+
+    int identitySize = 0;
+    int i;
+
+    for (i = 0; i < 5; i++)
+        identitySize += strlen(parts[i]) + 1;
+
+    char* identityString = (char*) malloc(identitySize);
+
+    int bufPos = 0;
+
+    /* parts are separated by zero bytes - the terminating zero is not part of the identity */
+    for (i = 0; i < 5; i++) {
+        int partSize = strlen(parts[i]) + 1;
+
+        memcpy(identityString + bufPos, parts[i], partSize);
+        bufPos += partSize;
+    }
+
+    *size = identitySize - 1;
+
+    return identityString;
+}
+
+static char*
+createCacheFileName(char* directoryName, MmsServerIdentity* identity, char* serverAddress)
+{
+    char* fileName = createString(10, directoryName, "/",
+            identity->vendorName != NULL ? identity->vendorName : "", "_",
+            identity->modelName != NULL ? identity->modelName : "", "_",
+            identity->revision != NULL ? identity->revision : "", "_",
+            serverAddress, ".model");
+
+    /* replace characters that are not allowed in file names */
+    char* c = fileName + strlen(directoryName) + 1;
+
+    while (*c != 0) {
+        bool isAllowed = ((*c >= 'a') && (*c <= 'z')) || ((*c >= 'A') && (*c <= 'Z')) ||
+                ((*c >= '0') && (*c <= '9')) || (*c == '-') || (*c == '.');
+
+        if (!isAllowed)
+            *c = '_';
+
+        c++;
+    }
+
+    return fileName;
+}
+
+static uint8_t*
+readFile(char* fileName, int* fileSize)
+{
+    FILE* file = fopen(fileName, "rb");
+
+    if (file == NULL)
+        return NULL;
+
+    uint8_t* buffer = NULL;
+
+    if (fseek(file, 0, SEEK_END) != 0)
+        goto exit_function;
+
+    long size = ftell(file);
+
+    if (size < (long) MODEL_CACHE_MAGIC_SIZE)
+        goto exit_function;
+
+    rewind(file);
+
+    buffer = (uint8_t*) malloc(size);
+
+    if (fread(buffer, 1, size, file) != (size_t) size) {
+        free(buffer);
+        buffer = NULL;
+    }
+    else
+        *fileSize = (int) size;
+
+    exit_function:
+
+    fclose(file);
+
+    return buffer;
+}
+
+static bool
+loadCacheFile(IedConnection self, char* identityString, int identitySize)
+{
+    int fileSize;
+
+    uint8_t* buffer = readFile(self->modelCacheFileName, &fileSize);
+
+    if (buffer == NULL)
+        return false;
+
+    LinkedList logicalDevices = NULL;
+    ICLogicalDevice* logicalDevice = NULL;
+    bool identityChecked = false;
+
+    if (memcmp(buffer, MODEL_CACHE_MAGIC, MODEL_CACHE_MAGIC_SIZE) != 0)
+        goto exit_error;
+
+    int bufPos = MODEL_CACHE_MAGIC_SIZE;
+
+    while (bufPos < fileSize) {
+        if (bufPos + MODEL_CACHE_RECORD_HEADER_SIZE > fileSize)
+            goto exit_error;
+
+        uint8_t tag = buffer[bufPos];
+
+        uint32_t length = ((uint32_t) buffer[bufPos + 1] << 24) + ((uint32_t) buffer[bufPos + 2] << 16) +
+                ((uint32_t) buffer[bufPos + 3] << 8) + (uint32_t) buffer[bufPos + 4];
+
+        bufPos += MODEL_CACHE_RECORD_HEADER_SIZE;
+
+        if (length > (uint32_t) (fileSize - bufPos))
+            goto exit_error;
+
+        uint8_t* data = buffer + bufPos;
+
+        bufPos += length;
+
+        if (tag == 'I') {
+            if ((length != (uint32_t) identitySize) || (memcmp(data, identityString, length) != 0))
+                goto exit_error;
+
+            identityChecked = true;
+            continue;
+        }
+
+        /* the identity has to be the first record */
+        if (identityChecked == false)
+            goto exit_error;
+
+        switch (tag) {
+        case 'L':
+            if (logicalDevices == NULL)
+                logicalDevices = LinkedList_create();
+
+            {
+                char* name = createStringFromBuffer(data, length);
+                logicalDevice = ICLogicalDevice_create(name);
+                free(name);
+            }
+
+            logicalDevice->variables = LinkedList_create();
+            logicalDevice->dataSets = LinkedList_create();
+
+            LinkedList_add(logicalDevices, logicalDevice);
+            break;
+
+        case 'v':
+        case 'd':
+            if (logicalDevice == NULL)
+                goto exit_error;
+
+            LinkedList_add(tag == 'v' ? logicalDevice->variables : logicalDevice->dataSets,
+                    createStringFromBuffer(data, length));
+            break;
+
+        case 'T':
+            {
+                uint8_t* keyEnd = (uint8_t*) memchr(data, 0, length);
+
+                if (keyEnd == NULL)
+                    goto exit_error;
+
+                int keySize = keyEnd - data;
+
+                LinkedList_add(self->typeSpecCache, EncodedTypeSpec_create((char*) data, keySize,
+                        keyEnd + 1, length - keySize - 1));
+            }
+            break;
+
+        default:
+            /* ignore unknown records */
+            break;
+        }
+    }
+
+    if (identityChecked == false)
+        goto exit_error;
+
+    self->cachedLogicalDevices = logicalDevices;
+
+    free(buffer);
+
+    if (DEBUG_IED_CLIENT)
+        printf("IED_CLIENT: loaded model cache %s (%i type specifications)\n", self->modelCacheFileName,
+                LinkedList_size(self->typeSpecCache));
+
+    return true;
+
+exit_error:
+
+    if (DEBUG_IED_CLIENT)
+        printf("IED_CLIENT: invalid model cache %s\n", self->modelCacheFileName);
+
+    if (logicalDevices != NULL)
+        LinkedList_destroyDeep(logicalDevices, (LinkedListValueDeleteFunction) ICLogicalDevice_destroy);
+
+    clearTypeSpecCache(self);
+
+    free(buffer);
+
+    return false;
+}
+
+static bool
+writeRecord(FILE* file, uint8_t tag, uint8_t* data, int size)
+{
+    uint8_t header[MODEL_CACHE_RECORD_HEADER_SIZE];
+
+    header[0] = tag;
+    header[1] = (uint8_t) (size >> 24);
+    header[2] = (uint8_t) (size >> 16);
+    header[3] = (uint8_t) (size >> 8);
+    header[4] = (uint8_t) size;
+
+    if (fwrite(header, 1, MODEL_CACHE_RECORD_HEADER_SIZE, file) != MODEL_CACHE_RECORD_HEADER_SIZE)
+        return false;
+
+    if ((size > 0) && (fwrite(data, 1, size, file) != (size_t) size))
+        return false;
+
+    return true;
+}
+
+static bool
+writeNameRecords(FILE* file, uint8_t tag, LinkedList names)
+{
+    LinkedList element = LinkedList_getNext(names);
+
+    while (element != NULL) {
+        char* name = (char*) element->data;
+
+        if (!writeRecord(file, tag, (uint8_t*) name, strlen(name)))
+            return false;
+
+        element = LinkedList_getNext(element);
+    }
+
+    return true;
+}
+
+static bool
+writeCacheFile(IedConnection self, FILE* file, LinkedList logicalDevices)
+{
+    if (fwrite(MODEL_CACHE_MAGIC, 1, MODEL_CACHE_MAGIC_SIZE, file) != MODEL_CACHE_MAGIC_SIZE)
+        return false;
+
+    if (!writeRecord(file, 'I', (uint8_t*) self->modelCacheIdentity, self->modelCacheIdentitySize))
+        return false;
+
+    LinkedList element = LinkedList_getNext(logicalDevices);
+
+    while (element != NULL) {
+        ICLogicalDevice* logicalDevice = (ICLogicalDevice*) element->data;
+
+        if (!writeRecord(file, 'L', (uint8_t*) logicalDevice->name, strlen(logicalDevice->name)))
+            return false;
+
+        if (!writeNameRecords(file, 'v', logicalDevice->variables))
+            return false;
+
+        if (!writeNameRecords(file, 'd', logicalDevice->dataSets))
+            return false;
+
+        element = LinkedList_getNext(element);
+    }
+
+    element = LinkedList_getNext(self->typeSpecCache);
+
+    while (element != NULL) {
+        EncodedTypeSpec* typeSpec = (EncodedTypeSpec*) element->data;
+
+        /* key, terminating zero and type specification are stored consecutively */
+        if (!writeRecord(file, 'T', (uint8_t*) typeSpec->key, strlen(typeSpec->key) + 1 + typeSpec->size))
+            return false;
+
+        element = LinkedList_getNext(element);
+    }
+
+    return true;
+}
+
+void
+private_IedConnection_initModelCache(IedConnection self)
+{
+    self->modelCacheDirectory = NULL;
+    self->modelCacheFileName = NULL;
+    self->modelCacheIdentity = NULL;
+    self->cachedLogicalDevices = NULL;
+    self->typeSpecCache = LinkedList_create();
+    self->modelCacheDirty = false;
+    self->modelCacheUnavailable = false;
+    self->modelCacheLock = Semaphore_create(1);
+}
+
+void
+private_IedConnection_openModelCache(IedConnection self)
+{
+    Semaphore_wait(self->modelCacheLock);
+
+    if ((self->modelCacheDirectory == NULL) || (self->modelCacheFileName != NULL) || (self->connection == NULL) ||
+            self->modelCacheUnavailable)
+        goto exit_function;
+
+    MmsError mmsError;
+
+    MmsServerIdentity* identity = MmsConnection_identify(self->connection, &mmsError);
+
+    if (identity == NULL) {
+        if (DEBUG_IED_CLIENT)
+            printf("IED_CLIENT: identify failed - model cache not used\n");
+
+        self->modelCacheUnavailable = true;
+
+        goto exit_function;
+    }
+
+    uint64_t fingerprint;
+
+    if (!createModelFingerprint(self, &fingerprint)) {
+        if (DEBUG_IED_CLIENT)
+            printf("IED_CLIENT: cannot create model fingerprint - model cache not used\n");
+
+        MmsServerIdentity_destroy(identity);
+
+        self->modelCacheUnavailable = true;
+
+        goto exit_function;
+    }
+
+    char* serverAddress = createServerAddress(self);
+
+    self->modelCacheFileName = createCacheFileName(self->modelCacheDirectory, identity, serverAddress);
+    self->modelCacheIdentity = createIdentityString(identity, serverAddress, fingerprint,
+            &(self->modelCacheIdentitySize));
+
+    free(serverAddress);
+
+    MmsServerIdentity_destroy(identity);
+
+    loadCacheFile(self, self->modelCacheIdentity, self->modelCacheIdentitySize);
+
+    self->modelCacheDirty = false;
+
+    exit_function:
+
+    Semaphore_post(self->modelCacheLock);
+}
+
+void
+private_IedConnection_saveModelCache(IedConnection self)
+{
+    Semaphore_wait(self->modelCacheLock);
+
+    if (self->modelCacheFileName == NULL)
+        goto exit_function;
+
+    LinkedList logicalDevices = self->logicalDevices;
+
+    if (logicalDevices == NULL)
+        logicalDevices = self->cachedLogicalDevices;
+
+    /* write to a temporary file first - the old cache file stays intact in case of an error */
+    char* tmpFileName = createString(2, self->modelCacheFileName, ".tmp");
+
+    FILE* file = fopen(tmpFileName, "wb");
+
+    if (file != NULL) {
+        bool written = writeCacheFile(self, file, logicalDevices);
+
+        if (fclose(file) != 0)
+            written = false;
+
+        if (written && (rename(tmpFileName, self->modelCacheFileName) == 0))
+            self->modelCacheDirty = false;
+        else
+            remove(tmpFileName);
+    }
+
+    if (DEBUG_IED_CLIENT) {
+        if (self->modelCacheDirty)
+            printf("IED_CLIENT: failed to write model cache %s\n", self->modelCacheFileName);
+        else
+            printf("IED_CLIENT: saved model cache %s\n", self->modelCacheFileName);
+    }
+
+    free(tmpFileName);
+
+    exit_function:
+
+    Semaphore_post(self->modelCacheLock);
+}
+
+void
+private_IedConnection_updateModelCache(IedConnection self)
+{
+    Semaphore_wait(self->modelCacheLock);
+
+    bool cacheOpen = (self->modelCacheFileName != NULL);
+
+    /* the model changed - the cached type specifications may be outdated */
+    if (self->cachedLogicalDevices != NULL) {
+        deleteCachedLogicalDevices(self);
+        clearTypeSpecCache(self);
+    }
+
+    if (cacheOpen)
+        self->modelCacheDirty = true;
+
+    Semaphore_post(self->modelCacheLock);
+
+    if (cacheOpen)
+        private_IedConnection_saveModelCache(self);
+}
+
+void
+private_IedConnection_closeModelCache(IedConnection self)
+{
+    if (self->modelCacheDirty)
+        private_IedConnection_saveModelCache(self);
+
+    Semaphore_wait(self->modelCacheLock);
+
+    if (self->modelCacheFileName != NULL) {
+        free(self->modelCacheFileName);
+        self->modelCacheFileName = NULL;
+    }
+
+    if (self->modelCacheIdentity != NULL) {
+        free(self->modelCacheIdentity);
+        self->modelCacheIdentity = NULL;
+    }
+
+    deleteCachedLogicalDevices(self);
+    clearTypeSpecCache(self);
+
+    self->modelCacheDirty = false;
+    self->modelCacheUnavailable = false;
+
+    Semaphore_post(self->modelCacheLock);
+}
+
+void
+private_IedConnection_destroyModelCache(IedConnection self)
+{
+    deleteCachedLogicalDevices(self);
+
+    LinkedList_destroy(self->typeSpecCache);
+
+    if (self->modelCacheDirectory != NULL)
+        free(self->modelCacheDirectory);
+
+    Semaphore_destroy(self->modelCacheLock);
+}
+
+MmsVariableSpecification*
+private_IedConnection_getCachedTypeSpec(IedConnection self, char* domainId, char* itemId)
+{
+    MmsVariableSpecification* typeSpec = NULL;
+
+    Semaphore_wait(self->modelCacheLock);
+
+    if (self->modelCacheFileName != NULL) {
+        EncodedTypeSpec* encodedTypeSpec = lookupTypeSpec(self, domainId, itemId);
+
+        if (encodedTypeSpec != NULL)
+            typeSpec = mmsClient_decodeTypeSpecification(encodedTypeSpec->buffer, 0, encodedTypeSpec->size);
+    }
+
+    Semaphore_post(self->modelCacheLock);
+
+    return typeSpec;
+}
+
+void
+private_IedConnection_addCachedTypeSpec(IedConnection self, char* domainId, char* itemId,
+        uint8_t* encodedTypeSpec, int encodedTypeSpecSize)
+{
+    Semaphore_wait(self->modelCacheLock);
+
+    if ((self->modelCacheFileName != NULL) && (lookupTypeSpec(self, domainId, itemId) == NULL)) {
+        char* key = createString(3, domainId, "/", itemId);
+
+        LinkedList_add(self->typeSpecCache, EncodedTypeSpec_create(key, strlen(key), encodedTypeSpec,
+                encodedTypeSpecSize));
+
+        free(key);
+
+        self->modelCacheDirty = true;
+    }
+
+    Semaphore_post(self->modelCacheLock);
+
+    free(encodedTypeSpec);
+}
+
+void
+IedConnection_setModelCacheDirectory(IedConnection self, char* directoryName)
+{
+    Semaphore_wait(self->modelCacheLock);
+
+    if (self->modelCacheDirectory != NULL)
+        free(self->modelCacheDirectory);
+
+    if (directoryName != NULL)
+        self->modelCacheDirectory = copyString(directoryName);
+    else
+        self->modelCacheDirectory = NULL;
+
+    Semaphore_post(self->modelCacheLock);
+}
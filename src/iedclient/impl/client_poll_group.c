@@ -0,0 +1,678 @@
+/*
+ *  client_poll_group.c
+ *
+ *  Cyclic polling of a fixed set of data objects/attributes.
+ *
+ *  Copyright 2014 Michael Zillgith
+ *
+ *  This file is part of libIEC61850.
+ *
+ *  libIEC61850 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libIEC61850 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libIEC61850.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  See COPYING file for the complete license text.
+ */
+
+#include "iec61850_client.h"
+
+#include "stack_config.h"
+
+#include "ied_connection_private.h"
+
+#include "mms_mapping.h"
+
+#include "mms_client_internal.h"
+#include "hal.h"
+
+#define POLL_GROUP_REQUEST_OVERHEAD 32
+
+/* maximum time the scheduler sleeps when no poll group is active */
+#define POLL_GROUP_SCHEDULER_IDLE_TIME 1000
+
+typedef struct {
+    char* domainId;
+    char* itemId;
+    int index; /* index of the object reference */
+} PollGroupItem;
+
+typedef struct {
+    ClientPollGroup group;
+    int firstItem;
+    int itemCount;
+    uint8_t* serviceRequest; /* pre-encoded read service request */
+    int serviceRequestSize;
+    bool splitRequired;
+} PollGroupRequest;
+
+struct sClientPollGroup {
+    IedConnection connection;
+    uint32_t periodInMs;
+
+    /* items and values are sorted by domain */
+    int itemCount;
+    PollGroupItem* items;
+    MmsValue** values; /* decoded in place by each cycle */
+    MmsValue** previousValues; /* values of the previous cycle */
+    int* positions; /* position of an object reference in the items/values arrays */
+
+    PollGroupRequest* requests;
+    int requestCount;
+
+    ClientPollGroupChangeHandler changeHandler;
+    void* changeHandlerParameter;
+
+    Semaphore lock;
+    bool active;
+    bool cycleActive; /* requests are pending or the change handlers are running */
+    bool destroyWaiting; /* ClientPollGroup_destroy waits for cycleCompleted */
+    Semaphore cycleCompleted;
+    int pendingRequests;
+    uint64_t nextCycle; /* monotonic time */
+    IedClientError cycleError;
+
+    IedClientError lastError;
+    uint32_t cycleCount;
+    uint32_t overrunCount;
+};
+
+static uint64_t
+getMonotonicTimeInMs(void)
+{
+    return Hal_getMonotonicTimeInNs() / 1000000;
+}
+
+static int
+compareItems(const void* a, const void* b)
+{
+    const PollGroupItem* itemA = (const PollGroupItem*) a;
+    const PollGroupItem* itemB = (const PollGroupItem*) b;
+
+    int result = strcmp(itemA->domainId, itemB->domainId);
+
+    if (result == 0)
+        result = itemA->index - itemB->index;
+
+    return result;
+}
+
+static void
+encodeRequest(ClientPollGroup self, PollGroupRequest* request)
+{
+    LinkedList itemIds = LinkedList_create();
+
+    int i;
+
+    for (i = 0; i < request->itemCount; i++)
+        LinkedList_add(itemIds, self->items[request->firstItem + i].itemId);
+
+    request->group = self;
+    request->splitRequired = false;
+    request->serviceRequest = mmsClient_encodeReadServiceRequestMultipleValues(
+            self->items[request->firstItem].domainId, itemIds, &(request->serviceRequestSize));
+
+    LinkedList_destroyStatic(itemIds);
+}
+
+/* split requests that have been rejected by the server (probably the response doesn't fit into the PDU) */
+static void
+splitRequests(ClientPollGroup self)
+{
+    int i;
+
+    for (i = 0; i < self->requestCount; i++) {
+        PollGroupRequest* request = &(self->requests[i]);
+
+        if (request->splitRequired == false)
+            continue;
+
+        int firstHalf = request->itemCount / 2;
+
+        /* there are never more requests than items */
+        memmove(&(self->requests[i + 2]), &(self->requests[i + 1]),
+                (self->requestCount - i - 1) * sizeof(PollGroupRequest));
+
+        self->requestCount++;
+
+        PollGroupRequest* secondRequest = &(self->requests[i + 1]);
+
+        secondRequest->firstItem = request->firstItem + firstHalf;
+        secondRequest->itemCount = request->itemCount - firstHalf;
+        encodeRequest(self, secondRequest);
+
+        free(request->serviceRequest);
+        request->itemCount = firstHalf;
+        encodeRequest(self, request);
+
+        if (DEBUG_IED_CLIENT)
+            printf("IED_CLIENT: poll group - split request (%i + %i items)\n", request->itemCount,
+                    secondRequest->itemCount);
+
+        i++;
+    }
+}
+
+/* compare the values with the previous cycle and call the change handler for modified values */
+static void
+handleCycleCompleted(ClientPollGroup self)
+{
+    int i;
+
+    for (i = 0; i < self->itemCount; i++) {
+        MmsValue* value = self->values[i];
+
+        if (value == NULL)
+            continue;
+
+        MmsValue* previousValue = self->previousValues[i];
+
+        if ((previousValue != NULL) && MmsValue_equals(value, previousValue))
+            continue;
+
+        if ((previousValue == NULL) || (MmsValue_update(previousValue, value) == false)) {
+            if (previousValue != NULL)
+                MmsValue_delete(previousValue);
+
+            self->previousValues[i] = MmsValue_clone(value);
+        }
+
+        if (self->changeHandler != NULL)
+            self->changeHandler(self->changeHandlerParameter, self, self->items[i].index, value);
+    }
+
+    Semaphore_wait(self->lock);
+
+    self->lastError = self->cycleError;
+    self->cycleCount++;
+    self->cycleActive = false;
+
+    if (self->destroyWaiting)
+        Semaphore_post(self->cycleCompleted);
+
+    Semaphore_post(self->lock);
+}
+
+static void
+handleRequestCompleted(PollGroupRequest* request, MmsError mmsError)
+{
+    ClientPollGroup self = request->group;
+
+    if (mmsError != MMS_ERROR_NONE) {
+        if ((mmsError == MMS_ERROR_CONNECTION_LOST) || (mmsError == MMS_ERROR_SERVICE_TIMEOUT)
+                || (mmsError == MMS_ERROR_PARSING_RESPONSE))
+        {
+            self->cycleError = iedConnection_mapMmsErrorToIedError(mmsError);
+        }
+        else if (request->itemCount > 1)
+            request->splitRequired = true;
+        else {
+            MmsValue** value = &(self->values[request->firstItem]);
+
+            if (*value != NULL)
+                MmsValue_delete(*value);
+
+            *value = MmsValue_newDataAccessError(iedConnection_mapMmsErrorToDataAccessError(mmsError));
+        }
+    }
+
+    Semaphore_wait(self->lock);
+
+    self->pendingRequests--;
+
+    bool cycleCompleted = (self->pendingRequests == 0);
+
+    Semaphore_post(self->lock);
+
+    if (cycleCompleted)
+        handleCycleCompleted(self);
+}
+
+static void
+readResponseHandler(uint32_t invokeId, void* parameter, MmsError mmsError, ByteBuffer* response)
+{
+    PollGroupRequest* request = (PollGroupRequest*) parameter;
+    ClientPollGroup self = request->group;
+
+    if ((mmsError == MMS_ERROR_NONE) && (response != NULL)) {
+        if (mmsClient_parseReadResponseIntoValues(response, NULL, &(self->values[request->firstItem]),
+                request->itemCount) == false)
+            mmsError = MMS_ERROR_PARSING_RESPONSE;
+    }
+    else if (mmsError == MMS_ERROR_NONE)
+        mmsError = MMS_ERROR_PARSING_RESPONSE;
+
+    handleRequestCompleted(request, mmsError);
+}
+
+/*
+ * Called by the scheduler thread with pollGroupsLock held. Returns the time of the next cycle.
+ * When a new cycle is started the requests have to be sent by calling sendPollGroupRequests.
+ */
+static uint64_t
+handlePollGroup(ClientPollGroup self, uint64_t currentTime, bool* cycleStarted)
+{
+    *cycleStarted = false;
+
+    Semaphore_wait(self->lock);
+
+    if (self->active == false) {
+        Semaphore_post(self->lock);
+        return currentTime + POLL_GROUP_SCHEDULER_IDLE_TIME;
+    }
+
+    if (self->nextCycle > currentTime) {
+        uint64_t nextCycle = self->nextCycle;
+        Semaphore_post(self->lock);
+        return nextCycle;
+    }
+
+    bool startCycle = true;
+
+    if (self->cycleActive) {
+        /* previous cycle is not completed - skip this cycle */
+        startCycle = false;
+        self->overrunCount++;
+
+        if (DEBUG_IED_CLIENT)
+            printf("IED_CLIENT: poll group - cycle overrun\n");
+    }
+
+    self->nextCycle += self->periodInMs;
+
+    /* cycles missed by the scheduler are counted as overruns */
+    while (self->nextCycle <= currentTime) {
+        self->nextCycle += self->periodInMs;
+        self->overrunCount++;
+    }
+
+    uint64_t nextCycle = self->nextCycle;
+
+    if (startCycle && (IedConnection_getState(self->connection) != IED_STATE_CONNECTED)) {
+        self->lastError = IED_ERROR_NOT_CONNECTED;
+        startCycle = false;
+    }
+
+    if (startCycle) {
+        splitRequests(self);
+
+        self->cycleActive = true;
+        self->cycleError = IED_ERROR_OK;
+        self->pendingRequests = self->requestCount;
+    }
+
+    Semaphore_post(self->lock);
+
+    *cycleStarted = startCycle;
+
+    return nextCycle;
+}
+
+/*
+ * Called by the scheduler thread without holding any lock - sending blocks when the window of
+ * outstanding requests is full. The group can't be destroyed before the started cycle is completed.
+ */
+static void
+sendPollGroupRequests(ClientPollGroup self)
+{
+    /* the group may be destroyed as soon as the last request is completed */
+    MmsConnection connection = self->connection->connection;
+    PollGroupRequest* requests = self->requests;
+    int requestCount = self->requestCount;
+
+    int i;
+
+    for (i = 0; i < requestCount; i++) {
+        PollGroupRequest* request = &(requests[i]);
+
+        MmsError mmsError;
+
+        if (mmsClient_sendEncodedServiceRequest(connection, &mmsError,
+                request->serviceRequest, request->serviceRequestSize, readResponseHandler, request) == 0)
+            handleRequestCompleted(request, mmsError);
+    }
+}
+
+static void*
+pollGroupSchedulerThread(void* parameter)
+{
+    IedConnection self = (IedConnection) parameter;
+
+    /* groups that have started a cycle - their requests are sent after pollGroupsLock is released */
+    LinkedList startedGroups = LinkedList_create();
+
+    while (self->pollGroupSchedulerRunning) {
+        uint64_t currentTime = getMonotonicTimeInMs();
+        uint64_t nextWakeUp = currentTime + POLL_GROUP_SCHEDULER_IDLE_TIME;
+
+        Semaphore_wait(self->pollGroupsLock);
+
+        LinkedList element = LinkedList_getNext(self->pollGroups);
+
+        while (element != NULL) {
+            ClientPollGroup group = (ClientPollGroup) element->data;
+            bool cycleStarted;
+
+            uint64_t nextCycle = handlePollGroup(group, currentTime, &cycleStarted);
+
+            if (cycleStarted)
+                LinkedList_add(startedGroups, group);
+
+            if (nextCycle < nextWakeUp)
+                nextWakeUp = nextCycle;
+
+            element = LinkedList_getNext(element);
+        }
+
+        Semaphore_post(self->pollGroupsLock);
+
+        if (LinkedList_getNext(startedGroups) != NULL) {
+            element = LinkedList_getNext(startedGroups);
+
+            while (element != NULL) {
+                sendPollGroupRequests((ClientPollGroup) element->data);
+                element = LinkedList_getNext(element);
+            }
+
+            LinkedList_destroyStatic(startedGroups);
+            startedGroups = LinkedList_create();
+        }
+
+        if (IedConnection_getState(self) == IED_STATE_CONNECTED)
+            MmsConnection_handleTimeouts(self->connection);
+
+        currentTime = getMonotonicTimeInMs();
+
+        if (nextWakeUp > currentTime)
+            Semaphore_waitWithTimeout(self->pollGroupsWakeUp, (int) (nextWakeUp - currentTime));
+    }
+
+    LinkedList_destroyStatic(startedGroups);
+
+    return NULL;
+}
+
+void
+private_IedConnection_initPollGroups(IedConnection self)
+{
+    self->pollGroups = LinkedList_create();
+    self->pollGroupsLock = Semaphore_create(1);
+    self->pollGroupsWakeUp = Semaphore_create(0);
+    self->pollGroupScheduler = NULL;
+    self->pollGroupSchedulerRunning = false;
+}
+
+void
+private_IedConnection_stopPollGroups(IedConnection self)
+{
+    Semaphore_wait(self->pollGroupsLock);
+
+    Thread scheduler = self->pollGroupScheduler;
+
+    self->pollGroupScheduler = NULL;
+    self->pollGroupSchedulerRunning = false;
+
+    Semaphore_post(self->pollGroupsLock);
+
+    if (scheduler != NULL) {
+        Semaphore_post(self->pollGroupsWakeUp);
+        Thread_destroy(scheduler);
+    }
+}
+
+void
+private_IedConnection_destroyPollGroups(IedConnection self)
+{
+    private_IedConnection_stopPollGroups(self);
+
+    while (LinkedList_getNext(self->pollGroups) != NULL)
+        ClientPollGroup_destroy((ClientPollGroup) LinkedList_getNext(self->pollGroups)->data);
+
+    LinkedList_destroyStatic(self->pollGroups);
+    Semaphore_destroy(self->pollGroupsLock);
+    Semaphore_destroy(self->pollGroupsWakeUp);
+}
+
+static void
+startScheduler(IedConnection self)
+{
+    Semaphore_wait(self->pollGroupsLock);
+
+    if (self->pollGroupScheduler == NULL) {
+        self->pollGroupSchedulerRunning = true;
+        self->pollGroupScheduler = Thread_create(pollGroupSchedulerThread, self, false);
+        Thread_start(self->pollGroupScheduler);
+    }
+
+    Semaphore_post(self->pollGroupsLock);
+}
+
+ClientPollGroup
+IedConnection_createPollGroup(IedConnection self, IedClientError* error, LinkedList /* <char*> */ objectReferences,
+        int periodInMs)
+{
+    int itemCount = LinkedList_size(objectReferences);
+
+    if ((itemCount == 0) || (periodInMs <= 0)) {
+        *error = IED_ERROR_USER_PROVIDED_INVALID_ARGUMENT;
+        return NULL;
+    }
+
+    ClientPollGroup group = (ClientPollGroup) calloc(1, sizeof(struct sClientPollGroup));
+
+    group->connection = self;
+    group->periodInMs = periodInMs;
+    group->itemCount = 0;
+    group->items = (PollGroupItem*) calloc(itemCount, sizeof(PollGroupItem));
+    group->values = (MmsValue**) calloc(itemCount, sizeof(MmsValue*));
+    group->previousValues = (MmsValue**) calloc(itemCount, sizeof(MmsValue*));
+    group->positions = (int*) calloc(itemCount, sizeof(int));
+    group->requests = (PollGroupRequest*) calloc(itemCount, sizeof(PollGroupRequest));
+    group->lock = Semaphore_create(1);
+    group->cycleCompleted = Semaphore_create(0);
+    group->lastError = IED_ERROR_OK;
+
+    /* resolve the object references only once */
+    LinkedList element = LinkedList_getNext(objectReferences);
+
+    while (element != NULL) {
+        MmsVariableAccessSpecification* accessSpec =
+                MmsMapping_ObjectReferenceToVariableAccessSpec((char*) element->data);
+
+        if ((accessSpec == NULL) || (accessSpec->itemId == NULL) || (accessSpec->arrayIndex != -1)) {
+            if (DEBUG_IED_CLIENT)
+                printf("IED_CLIENT: poll group - invalid object reference %s\n", (char*) element->data);
+
+            if (accessSpec != NULL)
+                MmsVariableAccessSpecification_destroy(accessSpec);
+
+            *error = IED_ERROR_OBJECT_REFERENCE_INVALID;
+            ClientPollGroup_destroy(group);
+            return NULL;
+        }
+
+        PollGroupItem* item = &(group->items[group->itemCount]);
+
+        item->domainId = accessSpec->domainId;
+        item->itemId = accessSpec->itemId;
+        item->index = group->itemCount;
+
+        accessSpec->domainId = NULL;
+        accessSpec->itemId = NULL;
+        MmsVariableAccessSpecification_destroy(accessSpec);
+
+        group->itemCount++;
+
+        element = LinkedList_getNext(element);
+    }
+
+    qsort(group->items, itemCount, sizeof(PollGroupItem), compareItems);
+
+    int i;
+
+    for (i = 0; i < itemCount; i++)
+        group->positions[group->items[i].index] = i;
+
+    /* pack the items of a domain in as few requests as the negotiated PDU size allows */
+    int maxRequestSize = MmsConnection_getLocalDetail(self->connection) - POLL_GROUP_REQUEST_OVERHEAD;
+    int requestSize = 0;
+
+    for (i = 0; i < itemCount; i++) {
+        int itemSize = 12 + strlen(group->items[i].domainId) + strlen(group->items[i].itemId);
+
+        if ((group->requestCount == 0) || (requestSize + itemSize > maxRequestSize) ||
+                (strcmp(group->items[i].domainId,
+                        group->items[group->requests[group->requestCount - 1].firstItem].domainId) != 0))
+        {
+            group->requests[group->requestCount].firstItem = i;
+            group->requests[group->requestCount].itemCount = 0;
+            group->requestCount++;
+            requestSize = 0;
+        }
+
+        group->requests[group->requestCount - 1].itemCount++;
+        requestSize += itemSize;
+    }
+
+    for (i = 0; i < group->requestCount; i++)
+        encodeRequest(group, &(group->requests[i]));
+
+    Semaphore_wait(self->pollGroupsLock);
+    LinkedList_add(self->pollGroups, group);
+    Semaphore_post(self->pollGroupsLock);
+
+    *error = IED_ERROR_OK;
+
+    return group;
+}
+
+void
+ClientPollGroup_setChangeHandler(ClientPollGroup self, ClientPollGroupChangeHandler handler, void* parameter)
+{
+    self->changeHandler = handler;
+    self->changeHandlerParameter = parameter;
+}
+
+void
+ClientPollGroup_start(ClientPollGroup self)
+{
+    Semaphore_wait(self->lock);
+
+    if (self->active == false) {
+        self->active = true;
+        self->nextCycle = getMonotonicTimeInMs();
+    }
+
+    Semaphore_post(self->lock);
+
+    startScheduler(self->connection);
+
+    Semaphore_post(self->connection->pollGroupsWakeUp);
+}
+
+void
+ClientPollGroup_stop(ClientPollGroup self)
+{
+    Semaphore_wait(self->lock);
+    self->active = false;
+    Semaphore_post(self->lock);
+}
+
+int
+ClientPollGroup_getSize(ClientPollGroup self)
+{
+    return self->itemCount;
+}
+
+MmsValue*
+ClientPollGroup_getValue(ClientPollGroup self, int index)
+{
+    if ((index < 0) || (index >= self->itemCount))
+        return NULL;
+
+    return self->values[self->positions[index]];
+}
+
+uint32_t
+ClientPollGroup_getCycleCount(ClientPollGroup self)
+{
+    return self->cycleCount;
+}
+
+uint32_t
+ClientPollGroup_getOverrunCount(ClientPollGroup self)
+{
+    return self->overrunCount;
+}
+
+IedClientError
+ClientPollGroup_getLastError(ClientPollGroup self)
+{
+    return self->lastError;
+}
+
+void
+ClientPollGroup_destroy(ClientPollGroup self)
+{
+    IedConnection connection = self->connection;
+
+    Semaphore_wait(connection->pollGroupsLock);
+    LinkedList_remove(connection->pollGroups, self);
+    Semaphore_post(connection->pollGroupsLock);
+
+    /*
+     * Wait until the responses of the current cycle are received or timed out. The request timeouts are
+     * checked here as well because the scheduler thread may already be stopped.
+     */
+    Semaphore_wait(self->lock);
+
+    while (self->cycleActive) {
+        self->destroyWaiting = true;
+
+        Semaphore_post(self->lock);
+
+        if (Semaphore_waitWithTimeout(self->cycleCompleted, POLL_GROUP_SCHEDULER_IDLE_TIME) == false) {
+            if (IedConnection_getState(connection) == IED_STATE_CONNECTED)
+                MmsConnection_handleTimeouts(connection->connection);
+        }
+
+        Semaphore_wait(self->lock);
+    }
+
+    Semaphore_post(self->lock);
+
+    int i;
+
+    for (i = 0; i < self->itemCount; i++) {
+        free(self->items[i].domainId);
+        free(self->items[i].itemId);
+
+        if (self->values[i] != NULL)
+            MmsValue_delete(self->values[i]);
+
+        if (self->previousValues[i] != NULL)
+            MmsValue_delete(self->previousValues[i]);
+    }
+
+    for (i = 0; i < self->requestCount; i++)
+        free(self->requests[i].serviceRequest);
+
+    free(self->items);
+    free(self->values);
+    free(self->previousValues);
+    free(self->positions);
+    free(self->requests);
+
+    Semaphore_destroy(self->lock);
+    Semaphore_destroy(self->cycleCompleted);
+
+    free(self);
+}
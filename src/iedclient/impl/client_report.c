@@ -31,16 +31,74 @@
 
 #include "mms_mapping.h"
 
+#include "mms_common_internal.h"
+#include "mms_client_internal.h"
+#include "ber_decode.h"
+
+#define REPORT_INDEX_MIN_SIZE 16
+
 struct sClientReport
 {
     ClientDataSet dataSet;
     ReportCallbackFunction callback;
     void* callbackParameter;
     char* rcbReference;
+    char* rptId; /* report ID of the RCB or NULL if not known */
     MmsValue* entryId;
+    MmsValue* timeOfEntry; /* preallocated value to decode the report time stamp */
     ReasonForInclusion* reasonForInclusion;
     bool hasTimestamp;
     uint64_t timestamp;
+
+    /* state of the report when handled by a ClientReportHandlerPool (protected by the pool lock) */
+    ClientReportHandlerPool handlerPool;
+    bool handlerActive; /* report is queued or the handler is running */
+    bool destroyPending; /* report has been uninstalled while the handler is active */
+    uint32_t droppedReports; /* reports received while the handler was active */
+    ClientReport nextPending;
+};
+
+typedef struct sClientReportIndexEntry* ClientReportIndexEntry;
+
+struct sClientReportIndexEntry
+{
+    char* key; /* points to a string of the report */
+    uint32_t hash;
+    ClientReport report;
+    ClientReportIndexEntry next;
+};
+
+/* hash tables to find the report handler for a received report */
+struct sClientReportIndex
+{
+    int size; /* number of buckets (power of 2) */
+    int entryCount;
+    ClientReportIndexEntry* byRcbReference;
+    ClientReportIndexEntry* byReportId;
+    ClientReportIndexEntry* byDataSet;
+};
+
+typedef struct sClientReportHandlerWorker* ClientReportHandlerWorker;
+
+struct sClientReportHandlerWorker
+{
+    ClientReportHandlerPool pool;
+    Thread thread;
+    Semaphore wakeUp;
+    ClientReportHandlerWorker nextIdle;
+};
+
+struct sClientReportHandlerPool
+{
+    Semaphore lock;
+    bool stopped;
+
+    ClientReport firstPending;
+    ClientReport lastPending;
+
+    int workerCount;
+    struct sClientReportHandlerWorker* workers;
+    ClientReportHandlerWorker idleWorkers;
 };
 
 char*
@@ -75,6 +133,8 @@ ClientReport_create(ClientDataSet dataSet)
 
     self->reasonForInclusion = (ReasonForInclusion*) calloc(dataSetSize, sizeof(ReasonForInclusion));
 
+    self->timeOfEntry = MmsValue_newBinaryTime(false);
+
     return self;
 }
 
@@ -84,6 +144,11 @@ ClientReport_destroy(ClientReport self)
     if (self->entryId)
         MmsValue_delete(self->entryId);
 
+    MmsValue_delete(self->timeOfEntry);
+
+    if (self->rptId != NULL)
+        free(self->rptId);
+
     free(self->rcbReference);
     free(self->reasonForInclusion);
     free(self);
@@ -95,6 +160,12 @@ ClientReport_getRcbReference(ClientReport self)
     return self->rcbReference;
 }
 
+char*
+ClientReport_getRptId(ClientReport self)
+{
+    return self->rptId;
+}
+
 ClientDataSet
 ClientReport_getDataSet(ClientReport self)
 {
@@ -125,6 +196,432 @@ ClientReport_getTimestamp(ClientReport self)
     return self->timestamp;
 }
 
+uint32_t
+ClientReport_getDroppedReportCount(ClientReport self)
+{
+    uint32_t droppedReports;
+
+    if (self->handlerPool != NULL) {
+        Semaphore_wait(self->handlerPool->lock);
+        droppedReports = self->droppedReports;
+        Semaphore_post(self->handlerPool->lock);
+    }
+    else
+        droppedReports = self->droppedReports;
+
+    return droppedReports;
+}
+
+/*
+ * Object references and report IDs are compared with '$' and '.' treated as equal. So the
+ * index also finds RCBs whose report ID is the RCB reference in MMS notation.
+ */
+static inline char
+normalizeReferenceChar(char c)
+{
+    if (c == '$')
+        return '.';
+    else
+        return c;
+}
+
+static uint32_t
+hashKey(const char* key, int keyLength)
+{
+    uint32_t hash = 2166136261u;
+
+    int i;
+
+    for (i = 0; i < keyLength; i++) {
+        hash ^= (uint8_t) normalizeReferenceChar(key[i]);
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static bool
+isMatchingKey(const char* key, const char* otherKey, int otherKeyLength)
+{
+    int i;
+
+    for (i = 0; i < otherKeyLength; i++) {
+        if ((key[i] == 0) || (normalizeReferenceChar(key[i]) != normalizeReferenceChar(otherKey[i])))
+            return false;
+    }
+
+    return (key[otherKeyLength] == 0);
+}
+
+static ClientReportIndex
+ClientReportIndex_create(void)
+{
+    ClientReportIndex self = (ClientReportIndex) calloc(1, sizeof(struct sClientReportIndex));
+
+    self->size = REPORT_INDEX_MIN_SIZE;
+    self->byRcbReference = (ClientReportIndexEntry*) calloc(self->size, sizeof(ClientReportIndexEntry));
+    self->byReportId = (ClientReportIndexEntry*) calloc(self->size, sizeof(ClientReportIndexEntry));
+    self->byDataSet = (ClientReportIndexEntry*) calloc(self->size, sizeof(ClientReportIndexEntry));
+
+    return self;
+}
+
+static void
+destroyIndexTable(ClientReportIndexEntry* table, int size)
+{
+    int i;
+
+    for (i = 0; i < size; i++) {
+        ClientReportIndexEntry entry = table[i];
+
+        while (entry != NULL) {
+            ClientReportIndexEntry next = entry->next;
+            free(entry);
+            entry = next;
+        }
+    }
+
+    free(table);
+}
+
+static void
+ClientReportIndex_destroy(ClientReportIndex self)
+{
+    destroyIndexTable(self->byRcbReference, self->size);
+    destroyIndexTable(self->byReportId, self->size);
+    destroyIndexTable(self->byDataSet, self->size);
+
+    free(self);
+}
+
+/* append the entry to the end of the bucket - the report installed first is found first */
+static void
+insertIndexEntry(ClientReportIndexEntry* table, int size, ClientReportIndexEntry entry)
+{
+    ClientReportIndexEntry* position = &(table[entry->hash & (size - 1)]);
+
+    while (*position != NULL)
+        position = &((*position)->next);
+
+    entry->next = NULL;
+    *position = entry;
+}
+
+static ClientReportIndexEntry*
+rehashIndexTable(ClientReportIndexEntry* table, int size, int newSize)
+{
+    ClientReportIndexEntry* newTable = (ClientReportIndexEntry*) calloc(newSize, sizeof(ClientReportIndexEntry));
+
+    int i;
+
+    for (i = 0; i < size; i++) {
+        ClientReportIndexEntry entry = table[i];
+
+        while (entry != NULL) {
+            ClientReportIndexEntry next = entry->next;
+            insertIndexEntry(newTable, newSize, entry);
+            entry = next;
+        }
+    }
+
+    free(table);
+
+    return newTable;
+}
+
+static void
+addIndexEntry(ClientReportIndex self, ClientReportIndexEntry** table, char* key, ClientReport report)
+{
+    if (self->entryCount >= self->size) {
+        int newSize = self->size * 2;
+
+        self->byRcbReference = rehashIndexTable(self->byRcbReference, self->size, newSize);
+        self->byReportId = rehashIndexTable(self->byReportId, self->size, newSize);
+        self->byDataSet = rehashIndexTable(self->byDataSet, self->size, newSize);
+
+        self->size = newSize;
+    }
+
+    ClientReportIndexEntry entry = (ClientReportIndexEntry) malloc(sizeof(struct sClientReportIndexEntry));
+
+    entry->key = key;
+    entry->hash = hashKey(key, strlen(key));
+    entry->report = report;
+
+    insertIndexEntry(*table, self->size, entry);
+
+    self->entryCount++;
+}
+
+static void
+removeIndexEntry(ClientReportIndex self, ClientReportIndexEntry* table, char* key, ClientReport report)
+{
+    ClientReportIndexEntry* position = &(table[hashKey(key, strlen(key)) & (self->size - 1)]);
+
+    while (*position != NULL) {
+        ClientReportIndexEntry entry = *position;
+
+        if (entry->report == report) {
+            *position = entry->next;
+            free(entry);
+            self->entryCount--;
+            return;
+        }
+
+        position = &(entry->next);
+    }
+}
+
+static ClientReport
+lookupIndexEntry(ClientReportIndex self, ClientReportIndexEntry* table, const char* key, int keyLength)
+{
+    uint32_t hash = hashKey(key, keyLength);
+
+    ClientReportIndexEntry entry = table[hash & (self->size - 1)];
+
+    while (entry != NULL) {
+        if ((entry->hash == hash) && isMatchingKey(entry->key, key, keyLength))
+            return entry->report;
+
+        entry = entry->next;
+    }
+
+    return NULL;
+}
+
+static void
+addReportToIndex(ClientReportIndex self, ClientReport report)
+{
+    addIndexEntry(self, &(self->byRcbReference), report->rcbReference, report);
+
+    if (report->rptId != NULL)
+        addIndexEntry(self, &(self->byReportId), report->rptId, report);
+
+    if (report->dataSet != NULL)
+        addIndexEntry(self, &(self->byDataSet), ClientDataSet_getReference(report->dataSet), report);
+}
+
+static void
+removeReportFromIndex(ClientReportIndex self, ClientReport report)
+{
+    removeIndexEntry(self, self->byRcbReference, report->rcbReference, report);
+
+    if (report->rptId != NULL)
+        removeIndexEntry(self, self->byReportId, report->rptId, report);
+
+    if (report->dataSet != NULL)
+        removeIndexEntry(self, self->byDataSet, ClientDataSet_getReference(report->dataSet), report);
+}
+
+static void*
+reportHandlerWorkerThread(void* parameter)
+{
+    ClientReportHandlerWorker worker = (ClientReportHandlerWorker) parameter;
+    ClientReportHandlerPool pool = worker->pool;
+
+    Semaphore_wait(pool->lock);
+
+    while (pool->stopped == false) {
+        ClientReport report = pool->firstPending;
+
+        if (report != NULL) {
+            pool->firstPending = report->nextPending;
+
+            if (pool->firstPending == NULL)
+                pool->lastPending = NULL;
+
+            Semaphore_post(pool->lock);
+
+            if (report->callback != NULL)
+                report->callback(report->callbackParameter, report);
+
+            Semaphore_wait(pool->lock);
+
+            report->handlerActive = false;
+
+            if (report->destroyPending)
+                ClientReport_destroy(report);
+        }
+        else {
+            worker->nextIdle = pool->idleWorkers;
+            pool->idleWorkers = worker;
+
+            Semaphore_post(pool->lock);
+
+            Semaphore_wait(worker->wakeUp);
+
+            Semaphore_wait(pool->lock);
+        }
+    }
+
+    Semaphore_post(pool->lock);
+
+    return NULL;
+}
+
+ClientReportHandlerPool
+ClientReportHandlerPool_create(int threadCount)
+{
+    if (threadCount < 1)
+        threadCount = 1;
+
+    ClientReportHandlerPool self = (ClientReportHandlerPool) calloc(1, sizeof(struct sClientReportHandlerPool));
+
+    self->lock = Semaphore_create(1);
+    self->workerCount = threadCount;
+    self->workers = (struct sClientReportHandlerWorker*)
+            calloc(threadCount, sizeof(struct sClientReportHandlerWorker));
+
+    int i;
+
+    for (i = 0; i < threadCount; i++) {
+        ClientReportHandlerWorker worker = &(self->workers[i]);
+
+        worker->pool = self;
+        worker->wakeUp = Semaphore_create(0);
+        worker->thread = Thread_create(reportHandlerWorkerThread, worker, false);
+    }
+
+    for (i = 0; i < threadCount; i++)
+        Thread_start(self->workers[i].thread);
+
+    return self;
+}
+
+void
+ClientReportHandlerPool_destroy(ClientReportHandlerPool self)
+{
+    Semaphore_wait(self->lock);
+
+    self->stopped = true;
+
+    while (self->idleWorkers != NULL) {
+        ClientReportHandlerWorker worker = self->idleWorkers;
+        self->idleWorkers = worker->nextIdle;
+        Semaphore_post(worker->wakeUp);
+    }
+
+    Semaphore_post(self->lock);
+
+    int i;
+
+    for (i = 0; i < self->workerCount; i++) {
+        Thread_destroy(self->workers[i].thread);
+        Semaphore_destroy(self->workers[i].wakeUp);
+    }
+
+    /* drop reports that have not been handled */
+    while (self->firstPending != NULL) {
+        ClientReport report = self->firstPending;
+
+        self->firstPending = report->nextPending;
+
+        report->handlerActive = false;
+
+        if (report->destroyPending)
+            ClientReport_destroy(report);
+    }
+
+    Semaphore_destroy(self->lock);
+
+    free(self->workers);
+    free(self);
+}
+
+/* has to be called with the pool lock */
+static void
+enqueueReport(ClientReportHandlerPool self, ClientReport report)
+{
+    report->handlerPool = self;
+    report->handlerActive = true;
+    report->nextPending = NULL;
+
+    if (self->lastPending != NULL)
+        self->lastPending->nextPending = report;
+    else
+        self->firstPending = report;
+
+    self->lastPending = report;
+
+    if (self->idleWorkers != NULL) {
+        ClientReportHandlerWorker worker = self->idleWorkers;
+        self->idleWorkers = worker->nextIdle;
+        Semaphore_post(worker->wakeUp);
+    }
+}
+
+/* returns true and counts the dropped report if the handler of the previous report is still active */
+static bool
+dropReportIfHandlerActive(ClientReport report)
+{
+    bool active = false;
+
+    if (report->handlerPool != NULL) {
+        Semaphore_wait(report->handlerPool->lock);
+
+        active = report->handlerActive;
+
+        if (active)
+            report->droppedReports++;
+
+        Semaphore_post(report->handlerPool->lock);
+    }
+
+    return active;
+}
+
+/* destroy the report or delegate this to the pool thread that is currently handling it */
+static void
+releaseReport(ClientReport report)
+{
+    ClientReportHandlerPool pool = report->handlerPool;
+
+    if (pool != NULL) {
+        Semaphore_wait(pool->lock);
+
+        if (report->handlerActive)
+            report->destroyPending = true;
+        else
+            ClientReport_destroy(report);
+
+        Semaphore_post(pool->lock);
+    }
+    else
+        ClientReport_destroy(report);
+}
+
+void
+IedConnection_setReportHandlerPool(IedConnection self, ClientReportHandlerPool pool)
+{
+    self->reportHandlerPool = pool;
+}
+
+void
+private_IedConnection_initReports(IedConnection self)
+{
+    self->enabledReports = LinkedList_create();
+    self->reportIndex = ClientReportIndex_create();
+    self->reportsLock = Semaphore_create(1);
+}
+
+void
+private_IedConnection_destroyReports(IedConnection self)
+{
+    LinkedList element = LinkedList_getNext(self->enabledReports);
+
+    while (element != NULL) {
+        releaseReport((ClientReport) element->data);
+
+        element = LinkedList_getNext(element);
+    }
+
+    LinkedList_destroyStatic(self->enabledReports);
+
+    ClientReportIndex_destroy(self->reportIndex);
+
+    Semaphore_destroy(self->reportsLock);
+}
+
 static void
 writeReportResv(IedConnection self, IedClientError* error, char* rcbReference, bool resvValue)
 {
@@ -173,6 +670,67 @@ IedConnection_releaseRCB(IedConnection self, IedClientError* error, char* rcbRef
     writeReportResv(self, error, rcbReference, false);
 }
 
+static ClientReport
+lookupReportHandler(IedConnection self, char* rcbReference)
+{
+    return lookupIndexEntry(self->reportIndex, self->reportIndex->byRcbReference, rcbReference,
+            strlen(rcbReference));
+}
+
+static void
+installReportHandler(IedConnection self, char* rcbReference, char* rptId, ReportCallbackFunction handler,
+        void* handlerParameter, ClientDataSet dataSet)
+{
+    IedConnection_uninstallReportHandler(self, rcbReference);
+
+    ClientReport report = ClientReport_create(dataSet);
+    report->callback = handler;
+    report->callbackParameter = handlerParameter;
+    report->rcbReference = copyString(rcbReference);
+
+    if ((rptId != NULL) && (strlen(rptId) > 0))
+        report->rptId = copyString(rptId);
+
+    Semaphore_wait(self->reportsLock);
+
+    LinkedList_add(self->enabledReports, report);
+    addReportToIndex(self->reportIndex, report);
+
+    Semaphore_post(self->reportsLock);
+
+    if (DEBUG_IED_CLIENT)
+        printf("DEBUG_IED_CLIENT: Installed new report callback handler for %s\n", rcbReference);
+}
+
+void
+IedConnection_installReportHandler(IedConnection self, char* rcbReference, ReportCallbackFunction handler,
+        void* handlerParameter, ClientDataSet dataSet)
+{
+    installReportHandler(self, rcbReference, NULL, handler, handlerParameter, dataSet);
+}
+
+void
+IedConnection_uninstallReportHandler(IedConnection self, char* rcbReference)
+{
+    Semaphore_wait(self->reportsLock);
+
+    ClientReport report = lookupReportHandler(self, rcbReference);
+
+    if (report != NULL) {
+        LinkedList_remove(self->enabledReports, report);
+        removeReportFromIndex(self->reportIndex, report);
+    }
+
+    Semaphore_post(self->reportsLock);
+
+    if (report != NULL) {
+        releaseReport(report);
+
+        if (DEBUG_IED_CLIENT)
+            printf("DEBUG_IED_CLIENT: Removed report callback handler for %s\n", rcbReference);
+    }
+}
+
 void
 IedConnection_enableReporting(IedConnection self, IedClientError* error,
         char* rcbReference,
@@ -186,6 +744,8 @@ IedConnection_enableReporting(IedConnection self, IedClientError* error,
     char domainId[65];
     char itemId[129];
 
+    char* rptIdStr = NULL;
+
     MmsMapping_getMmsDomainFromObjectReference(rcbReference, domainId);
 
     strcpy(itemId, rcbReference + strlen(domainId) + 1);
@@ -234,6 +794,17 @@ IedConnection_enableReporting(IedConnection self, IedClientError* error,
         return;
     }
 
+    // read report ID - received reports are assigned to the handler by the report ID
+    strcpy(itemId + itemIdLen, "$RptID");
+    MmsValue* rptId = MmsConnection_readVariable(self->connection, &mmsError, domainId, itemId);
+
+    if (rptId != NULL) {
+        if (MmsValue_getType(rptId) == MMS_VISIBLE_STRING)
+            rptIdStr = copyString(MmsValue_toString(rptId));
+
+        MmsValue_delete(rptId);
+    }
+
     // set include data set reference
 
     strcpy(itemId + itemIdLen, "$OptFlds");
@@ -304,7 +875,7 @@ IedConnection_enableReporting(IedConnection self, IedClientError* error,
     MmsValue_delete(rptEna);
 
     if (mmsError == MMS_ERROR_NONE) {
-        IedConnection_installReportHandler(self, rcbReference, callback, callbackParameter, dataSet);
+        installReportHandler(self, rcbReference, rptIdStr, callback, callbackParameter, dataSet);
     }
     else {
         if (DEBUG_IED_CLIENT)
@@ -313,58 +884,11 @@ IedConnection_enableReporting(IedConnection self, IedClientError* error,
     }
 
     cleanup_and_exit:
-    return;
-}
-
-static ClientReport
-lookupReportHandler(IedConnection self, char* rcbReference)
-{
-    LinkedList element = LinkedList_getNext(self->enabledReports);
-
-    while (element != NULL) {
-        ClientReport report = (ClientReport) element->data;
-
-        if (strcmp(report->rcbReference, rcbReference) == 0)
-            return report;
-
-        element = LinkedList_getNext(element);
-    }
-
-    return NULL;
-}
-
-void
-IedConnection_installReportHandler(IedConnection self, char* rcbReference, ReportCallbackFunction handler,
-        void* handlerParameter, ClientDataSet dataSet)
-{
-    ClientReport report = lookupReportHandler(self, rcbReference);
 
-    if (report != NULL) {
-        IedConnection_uninstallReportHandler(self, rcbReference);
+    if (rptIdStr != NULL)
+        free(rptIdStr);
 
-        if (DEBUG_IED_CLIENT)
-            printf("DEBUG_IED_CLIENT: Removed existing report callback handler for %s\n", rcbReference);
-    }
-
-    report = ClientReport_create(dataSet);
-    report->callback = handler;
-    report->callbackParameter = handlerParameter;
-    report->rcbReference = copyString(rcbReference);
-    LinkedList_add(self->enabledReports, report);
-
-    if (DEBUG_IED_CLIENT)
-        printf("DEBUG_IED_CLIENT: Installed new report callback handler for %s\n", rcbReference);
-}
-
-void
-IedConnection_uninstallReportHandler(IedConnection self, char* rcbReference)
-{
-    ClientReport report = lookupReportHandler(self, rcbReference);
-
-    if (report != NULL) {
-        LinkedList_remove(self->enabledReports, report);
-        ClientReport_destroy(report);
-    }
+    return;
 }
 
 void
@@ -443,136 +967,269 @@ IedConnection_triggerGIReport(IedConnection self, IedClientError* error, char* r
     }
 }
 
+/*
+ * returns the position of the content of the access result with the given tag or -1
+ */
+static int
+getAccessResultContent(uint8_t* buffer, int bufPos, int maxBufPos, uint8_t tag, int* length)
+{
+    if ((bufPos >= maxBufPos) || (buffer[bufPos] != tag))
+        return -1;
+
+    bufPos = BerDecoder_decodeLength(buffer, length, bufPos + 1, maxBufPos);
+
+    if ((bufPos < 0) || (*length < 0) || (bufPos + *length > maxBufPos))
+        return -1;
+
+    return bufPos;
+}
+
+/* bitString points to the bit string content (starting with the number of unused bits) */
+static bool
+isBitSet(uint8_t* bitString, int length, int bitPos)
+{
+    int byteIndex = 1 + (bitPos / 8);
+
+    if (byteIndex >= length)
+        return false;
+
+    return ((bitString[byteIndex] & (0x80 >> (bitPos % 8))) != 0);
+}
+
+static int
+getNumberOfSetBits(uint8_t* bitString, int length, int bitCount)
+{
+    int setBits = 0;
+
+    int i;
+
+    for (i = 0; i < bitCount; i++) {
+        if (isBitSet(bitString, length, i))
+            setBits++;
+    }
+
+    return setBits;
+}
+
+static void
+decodeDataSetElement(uint8_t* buffer, int bufPos, int maxBufPos, MmsValue* dataSetElement)
+{
+    if (mmsMsg_decodeMmsDataIntoValue(buffer, bufPos, maxBufPos, NULL, dataSetElement) == false) {
+
+        /* value doesn't match the type of the data set element - fall back to MmsValue_update */
+        MmsValue* newElementValue = mmsMsg_decodeMmsData(buffer, bufPos, maxBufPos, NULL);
+
+        if (newElementValue != NULL) {
+            if (DEBUG_IED_CLIENT)
+                printf("DEBUG_IED_CLIENT:  update element value type: %i\n", MmsValue_getType(newElementValue));
+
+            MmsValue_update(dataSetElement, newElementValue);
+            MmsValue_delete(newElementValue);
+        }
+    }
+}
+
 void
-private_IedConnection_handleReport(IedConnection self, MmsValue* value)
+private_IedConnection_handleEncodedReport(void* parameter, char* variableListName, uint8_t* buffer, int maxBufPos,
+        int* accessResults, int accessResultCount)
 {
-    MmsValue* optFlds = MmsValue_getElement(value, 1);
-    if (MmsValue_getBitStringBit(optFlds, 4) == false)
-       return;
+    IedConnection self = (IedConnection) parameter;
 
-    bool hasTimestamp = false;
-    uint64_t timestamp;
+    int rptIdLength;
+    int optFldsLength;
+    int datSetLength = 0;
+
+    if (accessResultCount < 3)
+        return;
+
+    int rptIdPos = getAccessResultContent(buffer, accessResults[0], maxBufPos, 0x8a, &rptIdLength);
+
+    int optFldsPos = getAccessResultContent(buffer, accessResults[1], maxBufPos, 0x84, &optFldsLength);
+
+    if (optFldsPos < 0)
+        return;
+
+    uint8_t* optFlds = buffer + optFldsPos;
+
+    int timestampIndex = -1;
 
     int datSetIndex = 2;
 
     /* has sequence-number */
-    if (MmsValue_getBitStringBit(optFlds, 1) == true)
+    if (isBitSet(optFlds, optFldsLength, 1))
         datSetIndex++;
 
     /* has report-timestamp */
-    if (MmsValue_getBitStringBit(optFlds, 2) == true) {
-        MmsValue* timeStampValue = MmsValue_getElement(value, datSetIndex);
+    if (isBitSet(optFlds, optFldsLength, 2)) {
+        timestampIndex = datSetIndex;
+        datSetIndex++;
+    }
 
-        if (MmsValue_getType(timeStampValue) == MMS_BINARY_TIME) {
-            timestamp = MmsValue_getBinaryTimeAsUtcMs(timeStampValue);
-            hasTimestamp = true;
-        }
+    int datSetPos = -1;
 
-        datSetIndex++;
+    int inclusionIndex = datSetIndex;
+
+    /* has data set reference */
+    if (isBitSet(optFlds, optFldsLength, 4)) {
+        if (datSetIndex >= accessResultCount)
+            return;
+
+        datSetPos = getAccessResultContent(buffer, accessResults[datSetIndex], maxBufPos, 0x8a, &datSetLength);
+
+        inclusionIndex++;
     }
 
-    MmsValue* datSet = MmsValue_getElement(value, datSetIndex);
-    char* datSetName = MmsValue_toString(datSet);
-    if (DEBUG_IED_CLIENT)
-        printf("DEBUG_IED_CLIENT:  with datSet %s\n", datSetName);
+    /* find the report handler by report ID, RCB reference (default report ID) or data set reference */
+    Semaphore_wait(self->reportsLock);
 
-    int inclusionIndex = datSetIndex + 1;
-    LinkedList element = LinkedList_getNext(self->enabledReports);
     ClientReport report = NULL;
-    while (element != NULL) {
-        report = (ClientReport) element->data;
 
-        ClientDataSet dataSet = report->dataSet;
+    if (rptIdPos >= 0) {
+        char* rptId = (char*) (buffer + rptIdPos);
 
-        if (strcmp(datSetName, ClientDataSet_getReference(dataSet)) == 0) {
-            break;
-        }
+        report = lookupIndexEntry(self->reportIndex, self->reportIndex->byReportId, rptId, rptIdLength);
 
-        element = LinkedList_getNext(element);
+        if (report == NULL)
+            report = lookupIndexEntry(self->reportIndex, self->reportIndex->byRcbReference, rptId, rptIdLength);
     }
-    if (report == NULL)
+
+    if ((report == NULL) && (datSetPos >= 0))
+        report = lookupIndexEntry(self->reportIndex, self->reportIndex->byDataSet,
+                (char*) (buffer + datSetPos), datSetLength);
+
+    if (report == NULL) {
+        Semaphore_post(self->reportsLock);
+
+        if (DEBUG_IED_CLIENT)
+            printf("DEBUG_IED_CLIENT: received report for unknown RCB\n");
+
         return;
+    }
+
+    /* the handler of the previous report is still running in the handler pool - the report values
+     * cannot be decoded without changing the values seen by the handler */
+    if (dropReportIfHandlerActive(report)) {
+        Semaphore_post(self->reportsLock);
+
+        if (DEBUG_IED_CLIENT)
+            printf("DEBUG_IED_CLIENT: report handler busy - report dropped\n");
 
-    if (hasTimestamp) {
-        report->hasTimestamp = true;
-        report->timestamp = timestamp;
+        return;
     }
 
     if (DEBUG_IED_CLIENT)
         printf("DEBUG_IED_CLIENT: Found enabled report!\n");
 
+    report->hasTimestamp = false;
+
+    if ((timestampIndex >= 0) && (timestampIndex < accessResultCount)) {
+        if (mmsMsg_decodeMmsDataIntoValue(buffer, accessResults[timestampIndex], maxBufPos, NULL,
+                report->timeOfEntry))
+        {
+            report->timestamp = MmsValue_getBinaryTimeAsUtcMs(report->timeOfEntry);
+            report->hasTimestamp = true;
+        }
+    }
+
     /* skip bufOvfl */
-    if (MmsValue_getBitStringBit(optFlds, 6) == true)
+    if (isBitSet(optFlds, optFldsLength, 6))
         inclusionIndex++;
 
-    /* skip entryId */
-    if (MmsValue_getBitStringBit(optFlds, 7) == true) {
-        MmsValue* entryId = MmsValue_getElement(value, inclusionIndex);
+    /* entryId */
+    if (isBitSet(optFlds, optFldsLength, 7)) {
+        if (inclusionIndex >= accessResultCount)
+            goto exit_release_lock;
 
-        if (report->entryId != NULL) {
+        int entryIdPos = accessResults[inclusionIndex];
 
-            if (!MmsValue_update(report->entryId, entryId)) {
+        if ((report->entryId == NULL) ||
+                (mmsMsg_decodeMmsDataIntoValue(buffer, entryIdPos, maxBufPos, NULL, report->entryId) == false))
+        {
+            if (report->entryId != NULL)
                 MmsValue_delete(report->entryId);
-                report->entryId = MmsValue_clone(entryId);
-            }
-        }
-        else {
-            report->entryId = MmsValue_clone(entryId);
+
+            report->entryId = mmsMsg_decodeMmsData(buffer, entryIdPos, maxBufPos, NULL);
         }
 
         inclusionIndex++;
     }
 
     /* skip confRev */
-    if (MmsValue_getBitStringBit(optFlds, 8) == true)
+    if (isBitSet(optFlds, optFldsLength, 8))
         inclusionIndex++;
 
     /* skip segmentation fields */
-    if (MmsValue_getBitStringBit(optFlds, 9) == true)
+    if (isBitSet(optFlds, optFldsLength, 9))
         inclusionIndex += 2;
 
-    MmsValue* inclusion = MmsValue_getElement(value, inclusionIndex);
-    int includedElements = MmsValue_getNumberOfSetBits(inclusion);
+    if (inclusionIndex >= accessResultCount)
+        goto exit_release_lock;
+
+    int inclusionLength;
+    int inclusionPos = getAccessResultContent(buffer, accessResults[inclusionIndex], maxBufPos, 0x84,
+            &inclusionLength);
+
+    if (inclusionPos < 0)
+        goto exit_release_lock;
+
+    uint8_t* inclusion = buffer + inclusionPos;
+
+    ClientDataSet dataSet = report->dataSet;
+
+    int dataSetSize = ClientDataSet_getDataSetSize(dataSet);
+
+    int includedElements = getNumberOfSetBits(inclusion, inclusionLength, dataSetSize);
+
     if (DEBUG_IED_CLIENT)
         printf("DEBUG_IED_CLIENT: Report includes %i data set elements\n", includedElements);
 
     int valueIndex = inclusionIndex + 1;
+
     /* skip data-reference fields */
-    if (MmsValue_getBitStringBit(optFlds, 5) == true)
+    if (isBitSet(optFlds, optFldsLength, 5))
         valueIndex += includedElements;
 
-    int i;
-    ClientDataSet dataSet = report->dataSet;
-    MmsValue* dataSetValues = ClientDataSet_getValues(dataSet);
-    bool hasReasonForInclusion = MmsValue_getBitStringBit(optFlds, 3);
+    bool hasReasonForInclusion = isBitSet(optFlds, optFldsLength, 3);
+
     int reasonForInclusionIndex = valueIndex + includedElements;
-    for (i = 0; i < ClientDataSet_getDataSetSize(dataSet); i++) {
-        if (MmsValue_getBitStringBit(inclusion, i) == true) {
 
-            MmsValue* dataSetElement = MmsValue_getElement(dataSetValues, i);
+    if (reasonForInclusionIndex + (hasReasonForInclusion ? includedElements : 0) > accessResultCount)
+        goto exit_release_lock;
 
-            MmsValue* newElementValue = MmsValue_getElement(value, valueIndex);
+    MmsValue* dataSetValues = ClientDataSet_getValues(dataSet);
 
-            if (DEBUG_IED_CLIENT)
-                printf("DEBUG_IED_CLIENT:  update element value type: %i\n", MmsValue_getType(newElementValue));
+    int i;
 
-            MmsValue_update(dataSetElement, newElementValue);
+    for (i = 0; i < dataSetSize; i++) {
+        if (isBitSet(inclusion, inclusionLength, i)) {
+
+            if (dataSetValues != NULL)
+                decodeDataSetElement(buffer, accessResults[valueIndex], maxBufPos,
+                        MmsValue_getElement(dataSetValues, i));
 
             valueIndex++;
 
             if (hasReasonForInclusion) {
-                MmsValue* reasonForInclusion = MmsValue_getElement(value, reasonForInclusionIndex);
-
-                if (MmsValue_getBitStringBit(reasonForInclusion, 1) == true)
-                    report->reasonForInclusion[i] = REASON_DATA_CHANGE;
-                else if (MmsValue_getBitStringBit(reasonForInclusion, 2) == true)
-                    report->reasonForInclusion[i] = REASON_QUALITY_CHANGE;
-                else if (MmsValue_getBitStringBit(reasonForInclusion, 3) == true)
-                    report->reasonForInclusion[i] = REASON_DATA_UPDATE;
-                else if (MmsValue_getBitStringBit(reasonForInclusion, 4) == true)
-                    report->reasonForInclusion[i] = REASON_INTEGRITY;
-                else if (MmsValue_getBitStringBit(reasonForInclusion, 5) == true)
-                    report->reasonForInclusion[i] = REASON_GI;
+                int reasonLength;
+                int reasonPos = getAccessResultContent(buffer, accessResults[reasonForInclusionIndex], maxBufPos,
+                        0x84, &reasonLength);
+
+                if (reasonPos >= 0) {
+                    uint8_t* reasonForInclusion = buffer + reasonPos;
+
+                    if (isBitSet(reasonForInclusion, reasonLength, 1))
+                        report->reasonForInclusion[i] = REASON_DATA_CHANGE;
+                    else if (isBitSet(reasonForInclusion, reasonLength, 2))
+                        report->reasonForInclusion[i] = REASON_QUALITY_CHANGE;
+                    else if (isBitSet(reasonForInclusion, reasonLength, 3))
+                        report->reasonForInclusion[i] = REASON_DATA_UPDATE;
+                    else if (isBitSet(reasonForInclusion, reasonLength, 4))
+                        report->reasonForInclusion[i] = REASON_INTEGRITY;
+                    else if (isBitSet(reasonForInclusion, reasonLength, 5))
+                        report->reasonForInclusion[i] = REASON_GI;
+                }
+
+                reasonForInclusionIndex++;
             }
             else {
                 report->reasonForInclusion[i] = REASON_UNKNOWN;
@@ -582,8 +1239,26 @@ private_IedConnection_handleReport(IedConnection self, MmsValue* value)
             report->reasonForInclusion[i] = REASON_NOT_INCLUDED;
         }
     }
-    if (report->callback != NULL) {
-        report->callback(report->callbackParameter, report);
+
+    if (self->reportHandlerPool != NULL) {
+        Semaphore_wait(self->reportHandlerPool->lock);
+        enqueueReport(self->reportHandlerPool, report);
+        Semaphore_post(self->reportHandlerPool->lock);
+
+        Semaphore_post(self->reportsLock);
     }
-}
+    else {
+        Semaphore_post(self->reportsLock);
 
+        if (report->callback != NULL)
+            report->callback(report->callbackParameter, report);
+    }
+
+    return;
+
+    exit_release_lock:
+    if (DEBUG_IED_CLIENT)
+        printf("DEBUG_IED_CLIENT: received malformed report\n");
+
+    Semaphore_post(self->reportsLock);
+}
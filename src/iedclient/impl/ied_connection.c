@@ -32,13 +32,8 @@
 
 #include "ied_connection_private.h"
 #include "mms_value_internal.h"
-
-typedef struct sICLogicalDevice
-{
-    char* name;
-    LinkedList variables;
-    LinkedList dataSets;
-} ICLogicalDevice;
+#include "mms_client_internal.h"
+#include "hal.h"
 
 struct sClientDataSet
 {
@@ -80,6 +75,9 @@ iedConnection_mapMmsErrorToIedError(MmsError mmsError)
     case MMS_ERROR_FILE_FILE_NON_EXISTENT:
         return IED_ERROR_OBJECT_DOES_NOT_EXIST;
 
+    case MMS_ERROR_FILE_POSITION_INVALID:
+        return IED_ERROR_USER_PROVIDED_INVALID_ARGUMENT;
+
     case MMS_ERROR_CONNECTION_REJECTED:
         return IED_ERROR_CONNECTION_REJECTED;
 
@@ -104,7 +102,7 @@ iedConnection_mapDataAccessErrorToIedError(MmsDataAccessError mmsError)
 }
 
 
-static ICLogicalDevice*
+ICLogicalDevice*
 ICLogicalDevice_create(char* name)
 {
     ICLogicalDevice* self = (ICLogicalDevice*) calloc(1, sizeof(struct sICLogicalDevice));
@@ -126,7 +124,7 @@ ICLogicalDevice_setDataSetList(ICLogicalDevice* self, LinkedList dataSets)
     self->dataSets = dataSets;
 }
 
-static void
+void
 ICLogicalDevice_destroy(ICLogicalDevice* self)
 {
     free(self->name);
@@ -366,8 +364,9 @@ informationReportHandler(void* parameter, char* domainName,
     if (domainName == NULL) {
 
         if (isVariableListName) {
-
-            private_IedConnection_handleReport(self, value);
+            /* reports are decoded by private_IedConnection_handleEncodedReport */
+            if (DEBUG_IED_CLIENT)
+                printf("IED_CLIENT: Ignored variable list report %s\n", variableListName);
         }
         else {
             if (strcmp(variableListName, "LastApplError") == 0)
@@ -404,7 +403,10 @@ IedConnection_create()
 {
     IedConnection self = (IedConnection) calloc(1, sizeof(struct sIedConnection));
 
-    self->enabledReports = LinkedList_create();
+    private_IedConnection_initReports(self);
+    private_IedConnection_initPollGroups(self);
+    private_IedConnection_initModelCache(self);
+
     self->logicalDevices = NULL;
     self->clientControls = LinkedList_create();
 
@@ -445,6 +447,27 @@ IedConnection_installConnectionClosedHandler(IedConnection self, IedConnectionCl
     self->connectionClosedParameter = parameter;
 }
 
+/* check the CommandTermination deadlines of the asynchronous control actions */
+static void
+handleControlTimeouts(IedConnection self, bool connectionLost)
+{
+    LinkedList control = LinkedList_getNext(self->clientControls);
+
+    while (control != NULL) {
+        ControlObjectClient object = (ControlObjectClient) control->data;
+
+        control = LinkedList_getNext(control);
+
+        private_ControlObjectClient_handleTimeouts(object, connectionLost);
+    }
+}
+
+static void
+timeoutHandler(void* parameter)
+{
+    handleControlTimeouts((IedConnection) parameter, false);
+}
+
 static void
 connectionLostHandler(MmsConnection connection, void* parameter)
 {
@@ -452,6 +475,8 @@ connectionLostHandler(MmsConnection connection, void* parameter)
 
     IedConnection_setState(self, IED_STATE_CLOSED);
 
+    handleControlTimeouts(self, true);
+
     if (self->connectionCloseHandler != NULL)
         self->connectionCloseHandler(self->connectionClosedParameter, self);
 
@@ -459,6 +484,21 @@ connectionLostHandler(MmsConnection connection, void* parameter)
         printf("IedConnection closed!\n");
 }
 
+void
+private_IedConnection_installMmsHandlers(IedConnection self)
+{
+    MmsConnection_setConnectionLostHandler(self->connection, connectionLostHandler, (void*) self);
+    MmsConnection_setInformationReportHandler(self->connection, informationReportHandler, self);
+    mmsClient_setEncodedInformationReportHandler(self->connection, private_IedConnection_handleEncodedReport, self);
+    mmsClient_setTimeoutHandler(self->connection, timeoutHandler, self);
+}
+
+void
+private_IedConnection_setState(IedConnection self, IedConnectionState newState)
+{
+    IedConnection_setState(self, newState);
+}
+
 void
 IedConnection_connect(IedConnection self, IedClientError* error, char* hostname, int tcpPort)
 {
@@ -466,8 +506,7 @@ IedConnection_connect(IedConnection self, IedClientError* error, char* hostname,
 
     if (IedConnection_getState(self) != IED_STATE_CONNECTED) {
 
-        MmsConnection_setConnectionLostHandler(self->connection, connectionLostHandler, (void*) self);
-        MmsConnection_setInformationReportHandler(self->connection, informationReportHandler, self);
+        private_IedConnection_installMmsHandlers(self);
 
         if (MmsConnection_connect(self->connection, &mmsError, hostname, tcpPort)) {
             *error = IED_ERROR_OK;
@@ -523,6 +562,10 @@ IedConnection_close(IedConnection self)
         IedConnection_setState(self, IED_STATE_CLOSED);
     }
 
+    private_IedConnection_stopPollGroups(self);
+
+    private_IedConnection_closeModelCache(self);
+
     if (self->connection != NULL) {
         MmsConnection_destroy(self->connection);
         self->connection = NULL;
@@ -537,8 +580,9 @@ IedConnection_destroy(IedConnection self)
     if (self->logicalDevices != NULL)
         LinkedList_destroyDeep(self->logicalDevices, (LinkedListValueDeleteFunction) ICLogicalDevice_destroy);
 
-    if (self->enabledReports != NULL)
-        LinkedList_destroyDeep(self->enabledReports, (LinkedListValueDeleteFunction) ClientReport_destroy);
+    private_IedConnection_destroyReports(self);
+    private_IedConnection_destroyPollGroups(self);
+    private_IedConnection_destroyModelCache(self);
 
     LinkedList_destroyStatic(self->clientControls);
 
@@ -568,11 +612,25 @@ IedConnection_getVariableSpecification(IedConnection self, IedClientError* error
         goto cleanup_and_exit;
     }
 
-    varSpec =
-            MmsConnection_getVariableAccessAttributes(self->connection, &mmsError, domainId, itemId);
+    private_IedConnection_openModelCache(self);
+
+    varSpec = private_IedConnection_getCachedTypeSpec(self, domainId, itemId);
+
+    if (varSpec != NULL) {
+        *error = IED_ERROR_OK;
+        goto cleanup_and_exit;
+    }
+
+    uint8_t* encodedTypeSpec;
+    int encodedTypeSpecSize;
+
+    varSpec = mmsClient_getVariableAccessAttributes(self->connection, &mmsError, domainId, itemId,
+            &encodedTypeSpec, &encodedTypeSpecSize);
 
     if (varSpec != NULL) {
         *error = IED_ERROR_OK;
+
+        private_IedConnection_addCachedTypeSpec(self, domainId, itemId, encodedTypeSpec, encodedTypeSpecSize);
     }
     else
         *error = iedConnection_mapMmsErrorToIedError(mmsError);
@@ -614,6 +672,326 @@ IedConnection_readObject(IedConnection self, IedClientError* error, char* object
     return value;
 }
 
+/* estimated encoded size of the read request without the variable specifications */
+#define READ_OBJECTS_REQUEST_OVERHEAD 32
+
+typedef struct
+{
+    char* domainId;
+    char* itemId;
+    int resultIndex; /* position in the result array */
+} ReadObjectsItem;
+
+typedef struct sReadObjectsContext* ReadObjectsContext;
+
+typedef struct
+{
+    ReadObjectsContext context;
+    int firstItem; /* index of the first item in the (sorted) item array */
+    int itemCount;
+    MmsError error;
+} ReadObjectsRequest;
+
+struct sReadObjectsContext
+{
+    ReadObjectsItem* items;
+    MmsValue* results;
+
+    Semaphore lock;
+    Semaphore requestsCompleted;
+    int pendingRequests;
+    bool waiting;
+};
+
+static int
+compareReadObjectsItems(const void* a, const void* b)
+{
+    const ReadObjectsItem* itemA = (const ReadObjectsItem*) a;
+    const ReadObjectsItem* itemB = (const ReadObjectsItem*) b;
+
+    int result = strcmp(itemA->domainId, itemB->domainId);
+
+    if (result == 0)
+        result = itemA->resultIndex - itemB->resultIndex;
+
+    return result;
+}
+
+static void
+readObjectsResponseHandler(uint32_t invokeId, void* parameter, MmsError mmsError, MmsValue* value)
+{
+    ReadObjectsRequest* request = (ReadObjectsRequest*) parameter;
+    ReadObjectsContext context = request->context;
+
+    if ((mmsError == MMS_ERROR_NONE) && (value != NULL)) {
+        if ((MmsValue_getType(value) == MMS_ARRAY) && (MmsValue_getArraySize(value) == (uint32_t) request->itemCount)) {
+            int i;
+
+            /* move the access results to the result array */
+            for (i = 0; i < request->itemCount; i++) {
+                ReadObjectsItem* item = &(context->items[request->firstItem + i]);
+
+                MmsValue_setElement(context->results, item->resultIndex, value->value.structure.components[i]);
+                value->value.structure.components[i] = NULL;
+            }
+        }
+        else
+            mmsError = MMS_ERROR_PARSING_RESPONSE;
+    }
+    else if (mmsError == MMS_ERROR_NONE)
+        mmsError = MMS_ERROR_PARSING_RESPONSE;
+
+    if (value != NULL)
+        MmsValue_delete(value);
+
+    Semaphore_wait(context->lock);
+
+    request->error = mmsError;
+
+    context->pendingRequests--;
+
+    if ((context->pendingRequests == 0) && context->waiting)
+        Semaphore_post(context->requestsCompleted);
+
+    Semaphore_post(context->lock);
+}
+
+/* send the requests (pipelined) and wait until all requests are completed */
+static void
+sendReadObjectsRequests(IedConnection self, ReadObjectsContext context, ReadObjectsRequest* requests,
+        int requestCount)
+{
+    int i;
+
+    for (i = 0; i < requestCount; i++) {
+        ReadObjectsRequest* request = &(requests[i]);
+
+        LinkedList itemIds = LinkedList_create();
+
+        int j;
+
+        for (j = 0; j < request->itemCount; j++)
+            LinkedList_add(itemIds, context->items[request->firstItem + j].itemId);
+
+        request->context = context;
+        request->error = MMS_ERROR_NONE;
+
+        Semaphore_wait(context->lock);
+        context->pendingRequests++;
+        Semaphore_post(context->lock);
+
+        MmsError mmsError;
+
+        /* blocks when the maximum number of outstanding requests is reached */
+        uint32_t invokeId = MmsConnection_readMultipleVariablesAsync(self->connection, &mmsError,
+                context->items[request->firstItem].domainId, itemIds, readObjectsResponseHandler, request);
+
+        LinkedList_destroyStatic(itemIds);
+
+        if (invokeId == 0) {
+            Semaphore_wait(context->lock);
+            context->pendingRequests--;
+            request->error = mmsError;
+            Semaphore_post(context->lock);
+        }
+    }
+
+    Semaphore_wait(context->lock);
+
+    if (context->pendingRequests > 0) {
+        context->waiting = true;
+
+        Semaphore_post(context->lock);
+
+        while (Semaphore_waitWithTimeout(context->requestsCompleted, 100) == false)
+            MmsConnection_handleTimeouts(self->connection);
+
+        Semaphore_wait(context->lock);
+
+        context->waiting = false;
+    }
+
+    Semaphore_post(context->lock);
+}
+
+MmsDataAccessError
+iedConnection_mapMmsErrorToDataAccessError(MmsError mmsError)
+{
+    switch (mmsError) {
+    case MMS_ERROR_ACCESS_OBJECT_NON_EXISTENT:
+        return DATA_ACCESS_ERROR_OBJECT_NONE_EXISTENT;
+    case MMS_ERROR_ACCESS_OBJECT_ACCESS_DENIED:
+        return DATA_ACCESS_ERROR_OBJECT_ACCESS_DENIED;
+    case MMS_ERROR_ACCESS_OBJECT_ACCESS_UNSUPPORTED:
+        return DATA_ACCESS_ERROR_OBJECT_ACCESS_UNSUPPORTED;
+    case MMS_ERROR_ACCESS_TEMPORARILY_UNAVAILABLE:
+        return DATA_ACCESS_ERROR_TEMPORARILY_UNAVAILABLE;
+    case MMS_ERROR_ACCESS_OBJECT_VALUE_INVALID:
+        return DATA_ACCESS_ERROR_OBJECT_VALUE_INVALID;
+    case MMS_ERROR_HARDWARE_FAULT:
+        return DATA_ACCESS_ERROR_HARDWARE_FAULT;
+    default:
+        return DATA_ACCESS_ERROR_UNKNOWN;
+    }
+}
+
+MmsValue*
+IedConnection_readObjects(IedConnection self, IedClientError* error, LinkedList /* <char*> */ objectReferences)
+{
+    int itemCount = LinkedList_size(objectReferences);
+
+    MmsValue* results = MmsValue_createEmtpyArray(itemCount);
+
+    ReadObjectsItem* items = (ReadObjectsItem*) calloc(itemCount > 0 ? itemCount : 1, sizeof(ReadObjectsItem));
+
+    int validItems = 0;
+    int resultIndex = 0;
+
+    *error = IED_ERROR_OK;
+
+    /* convert object references to MMS domain and item names */
+    LinkedList element = LinkedList_getNext(objectReferences);
+
+    while (element != NULL) {
+        MmsVariableAccessSpecification* accessSpec =
+                MmsMapping_ObjectReferenceToVariableAccessSpec((char*) element->data);
+
+        if ((accessSpec != NULL) && (accessSpec->itemId != NULL) && (accessSpec->arrayIndex == -1)) {
+            items[validItems].domainId = accessSpec->domainId;
+            items[validItems].itemId = accessSpec->itemId;
+            items[validItems].resultIndex = resultIndex;
+
+            accessSpec->domainId = NULL;
+            accessSpec->itemId = NULL;
+
+            validItems++;
+        }
+        else {
+            if (DEBUG_IED_CLIENT)
+                printf("IED_CLIENT: readObjects - invalid object reference %s\n", (char*) element->data);
+
+            MmsValue_setElement(results, resultIndex,
+                    MmsValue_newDataAccessError(DATA_ACCESS_ERROR_OBJECT_ATTRIBUTE_INCONSISTENT));
+        }
+
+        if (accessSpec != NULL)
+            MmsVariableAccessSpecification_destroy(accessSpec);
+
+        resultIndex++;
+        element = LinkedList_getNext(element);
+    }
+
+    /* group by domain - the requested order is kept inside a domain */
+    qsort(items, validItems, sizeof(ReadObjectsItem), compareReadObjectsItems);
+
+    /* pack the items of a domain in as few requests as the negotiated PDU size allows */
+    int maxRequestSize = MmsConnection_getLocalDetail(self->connection) - READ_OBJECTS_REQUEST_OVERHEAD;
+
+    ReadObjectsRequest* requests = (ReadObjectsRequest*) calloc(validItems > 0 ? validItems : 1,
+            sizeof(ReadObjectsRequest));
+
+    int requestCount = 0;
+    int requestSize = 0;
+
+    int i;
+
+    for (i = 0; i < validItems; i++) {
+        int itemSize = 12 + strlen(items[i].domainId) + strlen(items[i].itemId);
+
+        if ((requestCount == 0) || (requestSize + itemSize > maxRequestSize) ||
+                (strcmp(items[i].domainId, items[requests[requestCount - 1].firstItem].domainId) != 0))
+        {
+            requests[requestCount].firstItem = i;
+            requests[requestCount].itemCount = 0;
+            requestCount++;
+            requestSize = 0;
+        }
+
+        requests[requestCount - 1].itemCount++;
+        requestSize += itemSize;
+    }
+
+    struct sReadObjectsContext context;
+
+    context.items = items;
+    context.results = results;
+    context.lock = Semaphore_create(1);
+    context.requestsCompleted = Semaphore_create(0);
+    context.pendingRequests = 0;
+    context.waiting = false;
+
+    ReadObjectsRequest* retryRequests = (ReadObjectsRequest*) calloc(validItems > 0 ? validItems : 1,
+            sizeof(ReadObjectsRequest));
+
+    while (requestCount > 0) {
+
+        if (DEBUG_IED_CLIENT)
+            printf("IED_CLIENT: readObjects - send %i read requests\n", requestCount);
+
+        sendReadObjectsRequests(self, &context, requests, requestCount);
+
+        int retryCount = 0;
+
+        for (i = 0; i < requestCount; i++) {
+            ReadObjectsRequest* request = &(requests[i]);
+
+            if (request->error == MMS_ERROR_NONE)
+                continue;
+
+            if ((request->error == MMS_ERROR_CONNECTION_LOST) || (request->error == MMS_ERROR_SERVICE_TIMEOUT)
+                    || (request->error == MMS_ERROR_PARSING_RESPONSE))
+            {
+                *error = iedConnection_mapMmsErrorToIedError(request->error);
+                goto exit_function;
+            }
+
+            if (request->itemCount > 1) {
+                /* the response is probably too large for the PDU - split the request */
+                int firstHalf = request->itemCount / 2;
+
+                retryRequests[retryCount].firstItem = request->firstItem;
+                retryRequests[retryCount].itemCount = firstHalf;
+                retryCount++;
+
+                retryRequests[retryCount].firstItem = request->firstItem + firstHalf;
+                retryRequests[retryCount].itemCount = request->itemCount - firstHalf;
+                retryCount++;
+            }
+            else {
+                MmsValue_setElement(results, items[request->firstItem].resultIndex,
+                        MmsValue_newDataAccessError(iedConnection_mapMmsErrorToDataAccessError(request->error)));
+            }
+        }
+
+        ReadObjectsRequest* swap = requests;
+        requests = retryRequests;
+        retryRequests = swap;
+
+        requestCount = retryCount;
+    }
+
+    exit_function:
+
+    Semaphore_destroy(context.lock);
+    Semaphore_destroy(context.requestsCompleted);
+
+    for (i = 0; i < validItems; i++) {
+        free(items[i].domainId);
+        free(items[i].itemId);
+    }
+
+    free(items);
+    free(requests);
+    free(retryRequests);
+
+    if (*error != IED_ERROR_OK) {
+        MmsValue_delete(results);
+        results = NULL;
+    }
+
+    return results;
+}
+
 bool
 IedConnection_readBooleanValue(IedConnection self, IedClientError* error, char* objectReference, FunctionalConstraint fc)
 {
@@ -898,62 +1276,294 @@ IedConnection_writeVisibleStringValue(IedConnection self, IedClientError* error,
     IedConnection_writeObject(self, error, objectReference, fc, &mmsValue);
 }
 
-void
-IedConnection_getDeviceModelFromServer(IedConnection self, IedClientError* error)
+typedef enum {
+    DISCOVERY_DOMAIN_NAMES,
+    DISCOVERY_VARIABLE_NAMES,
+    DISCOVERY_DATA_SET_NAMES
+} DiscoveryObjectClass;
+
+typedef struct sModelDiscoveryContext* ModelDiscoveryContext;
+
+typedef struct
 {
-    MmsError mmsError = MMS_ERROR_NONE;
-    *error = IED_ERROR_OK;
+    ModelDiscoveryContext context;
+    DiscoveryObjectClass objectClass;
+    char* domainId;
+    LinkedList names; /* names received so far */
+    bool moreFollows;
+    MmsError error;
+} ModelDiscoveryJob;
 
-    LinkedList logicalDeviceNames = MmsConnection_getDomainNames(self->connection, &mmsError);
+struct sModelDiscoveryContext
+{
+    Semaphore lock;
+    Semaphore requestsCompleted;
+    int pendingRequests;
+    bool waiting;
+};
 
-    if (logicalDeviceNames != NULL) {
+static void
+getNameListResponseHandler(uint32_t invokeId, void* parameter, MmsError mmsError, LinkedList nameList,
+        bool moreFollows)
+{
+    ModelDiscoveryJob* job = (ModelDiscoveryJob*) parameter;
+    ModelDiscoveryContext context = job->context;
+
+    if (nameList != NULL) {
+        /* protect against servers that set moreFollows without sending names */
+        if (LinkedList_getNext(nameList) == NULL)
+            moreFollows = false;
+
+        if (job->names == NULL)
+            job->names = nameList;
+        else {
+            /* append the received names */
+            LinkedList lastElement = LinkedList_getLastElement(job->names);
 
-        if (self->logicalDevices != NULL) {
-            LinkedList_destroyDeep(self->logicalDevices, (LinkedListValueDeleteFunction) ICLogicalDevice_destroy);
-            self->logicalDevices = NULL;
+            lastElement->next = nameList->next;
+            nameList->next = NULL;
+
+            LinkedList_destroyStatic(nameList);
         }
+    }
+    else if (mmsError == MMS_ERROR_NONE)
+        mmsError = MMS_ERROR_PARSING_RESPONSE;
 
-        LinkedList logicalDevice = LinkedList_getNext(logicalDeviceNames);
+    Semaphore_wait(context->lock);
 
-        LinkedList logicalDevices = LinkedList_create();
+    job->error = mmsError;
+    job->moreFollows = moreFollows;
 
-        while (logicalDevice != NULL) {
-            char* name = (char*) logicalDevice->data;
+    context->pendingRequests--;
 
-            ICLogicalDevice* icLogicalDevice = ICLogicalDevice_create(name);
+    if ((context->pendingRequests == 0) && context->waiting)
+        Semaphore_post(context->requestsCompleted);
 
-            LinkedList variables = MmsConnection_getDomainVariableNames(self->connection,
-                    &mmsError, name);
+    Semaphore_post(context->lock);
+}
 
-            if (variables != NULL)
-                ICLogicalDevice_setVariableList(icLogicalDevice, variables);
-            else {
-                *error = iedConnection_mapMmsErrorToIedError(mmsError);
-                break;
+/*
+ * Send one GetNameList request for each job (pipelined) and wait for all responses. Jobs are
+ * continued after the last received name until the server indicates that no more names follow.
+ */
+static MmsError
+runModelDiscoveryJobs(IedConnection self, ModelDiscoveryContext context, ModelDiscoveryJob* jobs, int jobCount)
+{
+    int i;
+
+    for (i = 0; i < jobCount; i++) {
+        jobs[i].context = context;
+        jobs[i].moreFollows = true;
+        jobs[i].error = MMS_ERROR_NONE;
+    }
+
+    bool jobsActive = (jobCount > 0);
+
+    while (jobsActive) {
+
+        for (i = 0; i < jobCount; i++) {
+            ModelDiscoveryJob* job = &(jobs[i]);
+
+            if (job->moreFollows == false)
+                continue;
+
+            char* continueAfter = NULL;
+
+            if (job->names != NULL) {
+                LinkedList lastElement = LinkedList_getLastElement(job->names);
+
+                if (lastElement != job->names)
+                    continueAfter = (char*) lastElement->data;
             }
 
-            LinkedList dataSets = MmsConnection_getDomainVariableListNames(self->connection,
-                    &mmsError, name);
+            Semaphore_wait(context->lock);
+            context->pendingRequests++;
+            Semaphore_post(context->lock);
 
-            if (dataSets != NULL)
-                ICLogicalDevice_setDataSetList(icLogicalDevice, dataSets);
-            else {
-                *error = iedConnection_mapMmsErrorToIedError(mmsError);
-                break;
+            MmsError mmsError;
+            uint32_t invokeId;
+
+            /* blocks when the maximum number of outstanding requests is reached */
+            if (job->objectClass == DISCOVERY_DOMAIN_NAMES)
+                invokeId = MmsConnection_getDomainNamesAsync(self->connection, &mmsError, continueAfter,
+                        getNameListResponseHandler, job);
+            else if (job->objectClass == DISCOVERY_VARIABLE_NAMES)
+                invokeId = MmsConnection_getDomainVariableNamesAsync(self->connection, &mmsError, job->domainId,
+                        continueAfter, getNameListResponseHandler, job);
+            else
+                invokeId = MmsConnection_getDomainVariableListNamesAsync(self->connection, &mmsError,
+                        job->domainId, continueAfter, getNameListResponseHandler, job);
+
+            if (invokeId == 0) {
+                Semaphore_wait(context->lock);
+                context->pendingRequests--;
+                job->error = mmsError;
+                job->moreFollows = false;
+                Semaphore_post(context->lock);
             }
+        }
 
-            LinkedList_add(logicalDevices, icLogicalDevice);
+        Semaphore_wait(context->lock);
 
-            logicalDevice = LinkedList_getNext(logicalDevice);
+        if (context->pendingRequests > 0) {
+            context->waiting = true;
+
+            Semaphore_post(context->lock);
+
+            while (Semaphore_waitWithTimeout(context->requestsCompleted, 100) == false)
+                MmsConnection_handleTimeouts(self->connection);
+
+            Semaphore_wait(context->lock);
+
+            context->waiting = false;
+        }
+
+        Semaphore_post(context->lock);
+
+        jobsActive = false;
+
+        for (i = 0; i < jobCount; i++) {
+            if (jobs[i].error != MMS_ERROR_NONE)
+                return jobs[i].error;
+
+            if (jobs[i].moreFollows)
+                jobsActive = true;
+        }
+    }
+
+    return MMS_ERROR_NONE;
+}
+
+static bool
+isCachedModelValid(LinkedList cachedLogicalDevices, LinkedList logicalDeviceNames)
+{
+    LinkedList cachedDevice = LinkedList_getNext(cachedLogicalDevices);
+    LinkedList name = LinkedList_getNext(logicalDeviceNames);
+
+    while ((cachedDevice != NULL) && (name != NULL)) {
+        ICLogicalDevice* device = (ICLogicalDevice*) cachedDevice->data;
+
+        if (strcmp(device->name, (char*) name->data) != 0)
+            return false;
+
+        cachedDevice = LinkedList_getNext(cachedDevice);
+        name = LinkedList_getNext(name);
+    }
+
+    return ((cachedDevice == NULL) && (name == NULL));
+}
+
+void
+IedConnection_getDeviceModelFromServer(IedConnection self, IedClientError* error)
+{
+    *error = IED_ERROR_OK;
+
+    private_IedConnection_openModelCache(self);
+
+    struct sModelDiscoveryContext context;
+
+    context.lock = Semaphore_create(1);
+    context.requestsCompleted = Semaphore_create(0);
+    context.pendingRequests = 0;
+    context.waiting = false;
+
+    ModelDiscoveryJob domainNamesJob;
+
+    memset(&domainNamesJob, 0, sizeof(ModelDiscoveryJob));
+    domainNamesJob.objectClass = DISCOVERY_DOMAIN_NAMES;
+
+    MmsError mmsError = runModelDiscoveryJobs(self, &context, &domainNamesJob, 1);
+
+    LinkedList logicalDeviceNames = domainNamesJob.names;
+
+    if (mmsError != MMS_ERROR_NONE) {
+        *error = iedConnection_mapMmsErrorToIedError(mmsError);
+        goto exit_function;
+    }
+
+    if (self->logicalDevices != NULL) {
+        LinkedList_destroyDeep(self->logicalDevices, (LinkedListValueDeleteFunction) ICLogicalDevice_destroy);
+        self->logicalDevices = NULL;
+    }
+
+    /*
+     * The cached model has already been checked against the model fingerprint (logical device names and
+     * configuration revisions) when the cache was opened. Check the logical device names again in case the
+     * model has been changed in the meantime.
+     */
+    Semaphore_wait(self->modelCacheLock);
+
+    if ((self->cachedLogicalDevices != NULL) &&
+            isCachedModelValid(self->cachedLogicalDevices, logicalDeviceNames))
+    {
+        if (DEBUG_IED_CLIENT)
+            printf("IED_CLIENT: use cached device model\n");
+
+        self->logicalDevices = self->cachedLogicalDevices;
+        self->cachedLogicalDevices = NULL;
+    }
+
+    Semaphore_post(self->modelCacheLock);
+
+    if (self->logicalDevices != NULL)
+        goto exit_function;
+
+    /* get the variables and data sets of all logical devices in parallel */
+    int deviceCount = LinkedList_size(logicalDeviceNames);
+
+    ModelDiscoveryJob* jobs = (ModelDiscoveryJob*) calloc(deviceCount > 0 ? 2 * deviceCount : 1,
+            sizeof(ModelDiscoveryJob));
+
+    LinkedList logicalDevice = LinkedList_getNext(logicalDeviceNames);
+
+    int i = 0;
+
+    while (logicalDevice != NULL) {
+        jobs[i].objectClass = DISCOVERY_VARIABLE_NAMES;
+        jobs[i].domainId = (char*) logicalDevice->data;
+        jobs[i + 1].objectClass = DISCOVERY_DATA_SET_NAMES;
+        jobs[i + 1].domainId = (char*) logicalDevice->data;
+
+        i += 2;
+        logicalDevice = LinkedList_getNext(logicalDevice);
+    }
+
+    mmsError = runModelDiscoveryJobs(self, &context, jobs, 2 * deviceCount);
+
+    if (mmsError == MMS_ERROR_NONE) {
+        LinkedList logicalDevices = LinkedList_create();
+
+        for (i = 0; i < 2 * deviceCount; i += 2) {
+            ICLogicalDevice* icLogicalDevice = ICLogicalDevice_create(jobs[i].domainId);
+
+            ICLogicalDevice_setVariableList(icLogicalDevice, jobs[i].names);
+            ICLogicalDevice_setDataSetList(icLogicalDevice, jobs[i + 1].names);
+
+            LinkedList_add(logicalDevices, icLogicalDevice);
         }
 
         self->logicalDevices = logicalDevices;
 
-        LinkedList_destroy(logicalDeviceNames);
+        private_IedConnection_updateModelCache(self);
     }
     else {
         *error = iedConnection_mapMmsErrorToIedError(mmsError);
+
+        for (i = 0; i < 2 * deviceCount; i++) {
+            if (jobs[i].names != NULL)
+                LinkedList_destroy(jobs[i].names);
+        }
     }
+
+    free(jobs);
+
+    exit_function:
+
+    if (logicalDeviceNames != NULL)
+        LinkedList_destroy(logicalDeviceNames);
+
+    Semaphore_destroy(context.lock);
+    Semaphore_destroy(context.requestsCompleted);
 }
 
 LinkedList /*<char*>*/
@@ -1029,6 +1639,15 @@ IedConnection_getFileDirectory(IedConnection self, IedClientError* error, char*
             return NULL;
         }
 
+        if (moreFollows) {
+            LinkedList lastElement = LinkedList_getLastElement(fileNames);
+
+            if (lastElement == fileNames)
+                break;
+
+            continueAfter = FileDirectoryEntry_getFileName((FileDirectoryEntry) lastElement->data);
+        }
+
     } while (moreFollows == true);
 
     return fileNames;
@@ -1089,7 +1708,7 @@ IedConnection_getFile(IedConnection self, IedClientError* error, char* fileName,
             return 0;
         }
 
-        if (clientFileReadHandler.retVal == true) {
+        if (clientFileReadHandler.retVal == false) {
             *error = IED_ERROR_UNKNOWN;
             break;
         }
@@ -1105,6 +1724,255 @@ IedConnection_getFile(IedConnection self, IedClientError* error, char* fileName,
     return clientFileReadHandler.byteReceived;
 }
 
+typedef struct sFileTransfer* FileTransfer;
+
+typedef struct
+{
+    FileTransfer transfer;
+    uint32_t sequenceNumber;
+} FileReadRequest;
+
+struct sFileTransfer
+{
+    IedClientGetFileHandler handler;
+    void* handlerParameter;
+
+    FileReadRequest* requests; /* one slot per window position */
+    int windowSize;
+
+    uint32_t nextSequenceNumber; /* sequence number of the next request */
+    uint32_t nextDeliverSequenceNumber; /* sequence number of the next data block for the handler */
+
+    uint32_t bytesReceived;
+    bool finished; /* last data block delivered or transfer stopped */
+    MmsError error;
+    bool aborted; /* stopped by the handler */
+
+    Semaphore lock;
+    Semaphore requestCompleted;
+    int pendingRequests;
+    bool waiting;
+};
+
+/* called with lock - deliver a data block in file order */
+static void
+deliverFileData(FileTransfer transfer, uint8_t* buffer, uint32_t bytesReceived, bool moreFollows)
+{
+    if (transfer->finished)
+        return;
+
+    if ((bytesReceived > 0) && (transfer->handler(transfer->handlerParameter, buffer, bytesReceived) == false)) {
+        transfer->aborted = true;
+        transfer->finished = true;
+    }
+
+    transfer->bytesReceived += bytesReceived;
+
+    if (moreFollows == false)
+        transfer->finished = true;
+}
+
+static void
+fileReadResponseHandler(uint32_t invokeId, void* parameter, MmsError mmsError, int32_t frsmId,
+        uint8_t* buffer, uint32_t bytesReceived, bool moreFollows)
+{
+    FileReadRequest* request = (FileReadRequest*) parameter;
+    FileTransfer transfer = request->transfer;
+
+    Semaphore_wait(transfer->lock);
+
+    if (transfer->finished) {
+        /* the last data block has been delivered or the transfer failed. The responses to the requests
+         * sent after the last data block are ignored (usually errors because the end of file is reached). */
+    }
+    else if (mmsError != MMS_ERROR_NONE) {
+        transfer->error = mmsError;
+        transfer->finished = true;
+    }
+    else if (request->sequenceNumber != transfer->nextDeliverSequenceNumber) {
+        /* FileRead has no file position - a data block received out of order cannot be placed */
+        if (DEBUG_IED_CLIENT)
+            printf("DEBUG_IED_CLIENT: file read response %u out of order\n", request->sequenceNumber);
+
+        transfer->error = MMS_ERROR_OTHER;
+        transfer->finished = true;
+    }
+    else {
+        deliverFileData(transfer, buffer, bytesReceived, moreFollows);
+        transfer->nextDeliverSequenceNumber++;
+    }
+
+    transfer->pendingRequests--;
+
+    if (transfer->waiting) {
+        transfer->waiting = false;
+        Semaphore_post(transfer->requestCompleted);
+    }
+
+    Semaphore_post(transfer->lock);
+}
+
+uint32_t
+IedConnection_getFileWindowed(IedConnection self, IedClientError* error, char* fileName, uint32_t initialPosition,
+        int windowSize, IedClientGetFileHandler handler, void* handlerParameter,
+        IedClientFileTransferStatistics* statistics)
+{
+    MmsError mmsError;
+
+    uint32_t fileSize = 0;
+
+    if (windowSize < 1)
+        windowSize = 1;
+
+    uint64_t startTime = Hal_getTimeInMs();
+
+    int32_t frsmId =
+            MmsConnection_fileOpen(self->connection, &mmsError, fileName, initialPosition, &fileSize, NULL);
+
+    if (mmsError != MMS_ERROR_NONE) {
+        *error = iedConnection_mapMmsErrorToIedError(mmsError);
+        return 0;
+    }
+
+    struct sFileTransfer transfer;
+
+    transfer.handler = handler;
+    transfer.handlerParameter = handlerParameter;
+    transfer.requests = (FileReadRequest*) calloc(windowSize, sizeof(FileReadRequest));
+    transfer.windowSize = windowSize;
+    transfer.nextSequenceNumber = 0;
+    transfer.nextDeliverSequenceNumber = 0;
+    transfer.bytesReceived = 0;
+    transfer.finished = false;
+    transfer.error = MMS_ERROR_NONE;
+    transfer.aborted = false;
+    transfer.lock = Semaphore_create(1);
+    transfer.requestCompleted = Semaphore_create(0);
+    transfer.pendingRequests = 0;
+    transfer.waiting = false;
+
+    Semaphore_wait(transfer.lock);
+
+    while (true) {
+
+        /* keep the window filled - a slot is free when its data block has been delivered */
+        while ((transfer.finished == false) &&
+                (transfer.nextSequenceNumber < transfer.nextDeliverSequenceNumber + (uint32_t) windowSize))
+        {
+            FileReadRequest* request = &(transfer.requests[transfer.nextSequenceNumber % windowSize]);
+
+            request->transfer = &transfer;
+            request->sequenceNumber = transfer.nextSequenceNumber;
+
+            transfer.nextSequenceNumber++;
+            transfer.pendingRequests++;
+
+            Semaphore_post(transfer.lock);
+
+            /* blocks when the maximum number of outstanding requests is reached */
+            uint32_t invokeId = MmsConnection_fileReadAsync(self->connection, &mmsError, frsmId,
+                    fileReadResponseHandler, request);
+
+            Semaphore_wait(transfer.lock);
+
+            if (invokeId == 0) {
+                transfer.pendingRequests--;
+
+                if (transfer.error == MMS_ERROR_NONE)
+                    transfer.error = mmsError;
+
+                transfer.finished = true;
+            }
+        }
+
+        if (transfer.pendingRequests == 0)
+            break;
+
+        transfer.waiting = true;
+
+        Semaphore_post(transfer.lock);
+
+        while (Semaphore_waitWithTimeout(transfer.requestCompleted, 100) == false)
+            MmsConnection_handleTimeouts(self->connection);
+
+        Semaphore_wait(transfer.lock);
+    }
+
+    Semaphore_post(transfer.lock);
+
+    free(transfer.requests);
+
+    Semaphore_destroy(transfer.lock);
+    Semaphore_destroy(transfer.requestCompleted);
+
+    MmsConnection_fileClose(self->connection, &mmsError, frsmId);
+
+    if (transfer.error != MMS_ERROR_NONE)
+        *error = iedConnection_mapMmsErrorToIedError(transfer.error);
+    else if (transfer.aborted)
+        *error = IED_ERROR_UNKNOWN;
+    else
+        *error = iedConnection_mapMmsErrorToIedError(mmsError);
+
+    if (statistics != NULL) {
+        statistics->fileSize = fileSize;
+        statistics->initialPosition = initialPosition;
+        statistics->bytesReceived = transfer.bytesReceived;
+        statistics->fileReadRequests = transfer.nextSequenceNumber;
+        statistics->durationInMs = Hal_getTimeInMs() - startTime;
+
+        if (statistics->durationInMs > 0)
+            statistics->bytesPerSecond = (uint32_t) (((uint64_t) transfer.bytesReceived * 1000) /
+                    statistics->durationInMs);
+        else
+            statistics->bytesPerSecond = 0;
+    }
+
+    return transfer.bytesReceived;
+}
+
+static bool
+localFileWriteHandler(void* parameter, uint8_t* buffer, uint32_t bytesRead)
+{
+    FILE* file = (FILE*) parameter;
+
+    if (fwrite(buffer, 1, bytesRead, file) == bytesRead)
+        return true;
+    else
+        return false;
+}
+
+uint32_t
+IedConnection_getFileToLocalFile(IedConnection self, IedClientError* error, char* fileName, char* localFileName,
+        bool resume, int windowSize, IedClientFileTransferStatistics* statistics)
+{
+    FILE* file = fopen(localFileName, resume ? "ab" : "wb");
+
+    if (file == NULL) {
+        *error = IED_ERROR_USER_PROVIDED_INVALID_ARGUMENT;
+        return 0;
+    }
+
+    uint32_t initialPosition = 0;
+
+    if (resume) {
+        if (fseek(file, 0, SEEK_END) == 0) {
+            long position = ftell(file);
+
+            if (position > 0)
+                initialPosition = (uint32_t) position;
+        }
+    }
+
+    uint32_t bytesReceived = IedConnection_getFileWindowed(self, error, fileName, initialPosition, windowSize,
+            localFileWriteHandler, file, statistics);
+
+    if ((fclose(file) != 0) && (*error == IED_ERROR_OK))
+        *error = IED_ERROR_UNKNOWN;
+
+    return bytesReceived;
+}
+
 void
 IedConnection_deleteFile(IedConnection self, IedClientError* error, char* fileName)
 {
@@ -1758,6 +2626,22 @@ IedConnection_readDataSetValues(IedConnection self, IedClientError* error, char*
 
     MmsValue* dataSetVal;
 
+    if (dataSet != NULL) {
+        /* decode directly into the existing values */
+        if (MmsConnection_readNamedVariableListValuesIntoValue(self->connection, &mmsError,
+                isAssociationSpecific ? NULL : domainId, itemId, true, ClientDataSet_getValues(dataSet)))
+        {
+            *error = IED_ERROR_OK;
+            goto cleanup_and_exit;
+        }
+
+        /* data set doesn't match the existing values - fall back to a full read */
+        if (mmsError != MMS_ERROR_PARSING_RESPONSE) {
+            *error = iedConnection_mapMmsErrorToIedError(mmsError);
+            goto cleanup_and_exit;
+        }
+    }
+
     if (isAssociationSpecific)
         dataSetVal = MmsConnection_readNamedVariableListValuesAssociationSpecific(self->connection,
                 &mmsError, itemId, true);
@@ -0,0 +1,573 @@
+/*
+ *  ied_connection_manager.c
+ *
+ *  Handling of many client connections by a small number of event loop threads.
+ *
+ *  Copyright 2014 Michael Zillgith
+ *
+ *  This file is part of libIEC61850.
+ *
+ *  libIEC61850 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libIEC61850 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libIEC61850.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  See COPYING file for the complete license text.
+ */
+
+#include "iec61850_client.h"
+
+#include "stack_config.h"
+
+#include "ied_connection_private.h"
+
+#include "mms_client_internal.h"
+#include "string_utilities.h"
+#include "socket.h"
+#include "hal.h"
+
+#define MANAGER_DEFAULT_MIN_BACKOFF 1000
+#define MANAGER_DEFAULT_MAX_BACKOFF 60000
+#define MANAGER_DEFAULT_CONNECT_TIMEOUT 10000
+
+/* maximum wait time of the event loop - also the period of the request timeout supervision */
+#define MANAGER_MAX_WAIT_TIME 100
+
+/* wait time while received data is waiting for free receive buffers */
+#define MANAGER_STALLED_WAIT_TIME 2
+
+#define MANAGER_MAX_EVENTS 64
+
+typedef enum {
+    MANAGED_STATE_WAITING, /* waiting for the next connect attempt */
+    MANAGED_STATE_CONNECTING,
+    MANAGED_STATE_CONNECTED
+} ManagedConnectionState;
+
+typedef struct sEventLoop EventLoop;
+
+typedef struct {
+    IedConnection connection;
+    EventLoop* eventLoop;
+    char* hostname;
+    int tcpPort;
+    ManagedConnectionState state;
+    uint64_t nextActionTime; /* connect attempt, connect timeout, or request timeout check (monotonic time) */
+    int backoff; /* delay of the next reconnect attempt */
+    Socket registeredSocket;
+    int registeredEvents;
+    bool stalled;
+    bool removed;
+} ManagedConnection;
+
+struct sEventLoop {
+    IedConnectionManager manager;
+    SocketEventSet eventSet;
+    Thread thread;
+    bool running;
+
+    LinkedList connections; /* <ManagedConnection*> - only accessed by the event loop thread */
+    int stalledCount;
+
+    Semaphore pendingLock; /* protects pendingConnections and removalPending */
+    LinkedList pendingConnections; /* added but not yet handled by the event loop thread */
+    bool removalPending;
+};
+
+struct sIedConnectionManager {
+    EventLoop* eventLoops;
+    int eventLoopCount;
+
+    Semaphore lock; /* protects connections and nextEventLoop */
+    LinkedList connections; /* <ManagedConnection*> */
+    int nextEventLoop;
+
+    IedConnectionManagerStateHandler stateHandler;
+    void* stateHandlerParameter;
+
+    int minBackoff;
+    int maxBackoff;
+    int connectTimeout;
+};
+
+static uint64_t
+getMonotonicTimeInMs(void)
+{
+    return Hal_getMonotonicTimeInNs() / 1000000;
+}
+
+static void
+updateSocketEvents(EventLoop* self, ManagedConnection* managed)
+{
+    MmsConnection mmsConnection = IedConnection_getMmsConnection(managed->connection);
+
+    Socket socket = mmsClient_getSocket(mmsConnection);
+
+    if (socket == NULL)
+        return;
+
+    int events = mmsClient_getSocketEvents(mmsConnection);
+
+    if ((socket != managed->registeredSocket) || (events != managed->registeredEvents)) {
+        SocketEventSet_setSocket(self->eventSet, socket, events, managed);
+
+        managed->registeredSocket = socket;
+        managed->registeredEvents = events;
+    }
+
+    bool stalled = mmsClient_isReceiverStalled(mmsConnection);
+
+    if (stalled != managed->stalled) {
+        managed->stalled = stalled;
+
+        if (stalled)
+            self->stalledCount++;
+        else
+            self->stalledCount--;
+    }
+}
+
+/* the socket has to be removed from the event set before it is destroyed */
+static void
+closeManagedConnection(EventLoop* self, ManagedConnection* managed)
+{
+    if (managed->registeredSocket != NULL) {
+        SocketEventSet_removeSocket(self->eventSet, managed->registeredSocket);
+        managed->registeredSocket = NULL;
+        managed->registeredEvents = 0;
+    }
+
+    if (managed->stalled) {
+        managed->stalled = false;
+        self->stalledCount--;
+    }
+
+    mmsClient_closeConnection(IedConnection_getMmsConnection(managed->connection));
+}
+
+static void
+scheduleReconnect(EventLoop* self, ManagedConnection* managed, uint64_t currentTime)
+{
+    managed->state = MANAGED_STATE_WAITING;
+    managed->nextActionTime = currentTime + managed->backoff;
+
+    managed->backoff = managed->backoff * 2;
+
+    if (managed->backoff > self->manager->maxBackoff)
+        managed->backoff = self->manager->maxBackoff;
+}
+
+static void
+handleConnectionFailed(EventLoop* self, ManagedConnection* managed, uint64_t currentTime)
+{
+    bool wasConnected = (managed->state == MANAGED_STATE_CONNECTED);
+
+    if (DEBUG_IED_CLIENT)
+        printf("IED_CLIENT: connection to %s:%i %s\n", managed->hostname, managed->tcpPort,
+                wasConnected ? "lost" : "failed");
+
+    /* calls the connection lost handler of the IedConnection if the connection was established */
+    closeManagedConnection(self, managed);
+
+    scheduleReconnect(self, managed, currentTime);
+
+    if (wasConnected && (self->manager->stateHandler != NULL))
+        self->manager->stateHandler(self->manager->stateHandlerParameter, managed->connection, IED_STATE_CLOSED);
+}
+
+static void
+handleConnectionEstablished(EventLoop* self, ManagedConnection* managed, uint64_t currentTime)
+{
+    if (DEBUG_IED_CLIENT)
+        printf("IED_CLIENT: connected to %s:%i\n", managed->hostname, managed->tcpPort);
+
+    managed->state = MANAGED_STATE_CONNECTED;
+    managed->backoff = self->manager->minBackoff;
+    managed->nextActionTime = currentTime + MANAGER_MAX_WAIT_TIME;
+
+    private_IedConnection_setState(managed->connection, IED_STATE_CONNECTED);
+
+    if (self->manager->stateHandler != NULL)
+        self->manager->stateHandler(self->manager->stateHandlerParameter, managed->connection, IED_STATE_CONNECTED);
+}
+
+static void
+startConnect(EventLoop* self, ManagedConnection* managed, uint64_t currentTime)
+{
+    MmsConnection mmsConnection = IedConnection_getMmsConnection(managed->connection);
+
+    if (mmsClient_startConnect(mmsConnection, managed->hostname, managed->tcpPort)) {
+        managed->state = MANAGED_STATE_CONNECTING;
+        managed->nextActionTime = currentTime + self->manager->connectTimeout;
+
+        updateSocketEvents(self, managed);
+    }
+    else
+        scheduleReconnect(self, managed, currentTime);
+}
+
+static void
+handleSocketEvent(EventLoop* self, ManagedConnection* managed, int events)
+{
+    if (managed->state == MANAGED_STATE_WAITING)
+        return;
+
+    MmsConnection mmsConnection = IedConnection_getMmsConnection(managed->connection);
+
+    AssociationState associationState = mmsClient_handleSocketEvent(mmsConnection, events);
+
+    if (associationState == MMS_STATE_CLOSED) {
+        handleConnectionFailed(self, managed, getMonotonicTimeInMs());
+        return;
+    }
+
+    if ((associationState == MMS_STATE_CONNECTED) && (managed->state == MANAGED_STATE_CONNECTING))
+        handleConnectionEstablished(self, managed, getMonotonicTimeInMs());
+
+    updateSocketEvents(self, managed);
+}
+
+/* handle connect attempts and timeouts - returns the time of the next required action */
+static uint64_t
+handleTimers(EventLoop* self, uint64_t currentTime)
+{
+    uint64_t nextActionTime = currentTime + MANAGER_MAX_WAIT_TIME;
+
+    LinkedList element = LinkedList_getNext(self->connections);
+
+    while (element != NULL) {
+        ManagedConnection* managed = (ManagedConnection*) element->data;
+
+        if (currentTime >= managed->nextActionTime) {
+            switch (managed->state) {
+            case MANAGED_STATE_WAITING:
+                startConnect(self, managed, currentTime);
+                break;
+
+            case MANAGED_STATE_CONNECTING:
+                if (DEBUG_IED_CLIENT)
+                    printf("IED_CLIENT: connect timeout (%s:%i)\n", managed->hostname, managed->tcpPort);
+
+                handleConnectionFailed(self, managed, currentTime);
+                break;
+
+            case MANAGED_STATE_CONNECTED:
+                MmsConnection_handleTimeouts(IedConnection_getMmsConnection(managed->connection));
+                managed->nextActionTime = currentTime + MANAGER_MAX_WAIT_TIME;
+                break;
+            }
+        }
+
+        if (managed->nextActionTime < nextActionTime)
+            nextActionTime = managed->nextActionTime;
+
+        element = LinkedList_getNext(element);
+    }
+
+    return nextActionTime;
+}
+
+/* continue the processing of received data after receive buffers have been released */
+static void
+handleStalledConnections(EventLoop* self)
+{
+    LinkedList element = LinkedList_getNext(self->connections);
+
+    while ((element != NULL) && (self->stalledCount > 0)) {
+        ManagedConnection* managed = (ManagedConnection*) element->data;
+
+        element = LinkedList_getNext(element);
+
+        if (managed->stalled)
+            handleSocketEvent(self, managed, 0);
+    }
+}
+
+static void
+destroyManagedConnection(EventLoop* self, ManagedConnection* managed)
+{
+    if (managed->state != MANAGED_STATE_WAITING)
+        closeManagedConnection(self, managed);
+
+    IedConnection_destroy(managed->connection);
+
+    free(managed->hostname);
+    free(managed);
+}
+
+/* take over added connections and destroy removed connections - returns true if there were changes */
+static bool
+handlePendingChanges(EventLoop* self)
+{
+    bool changed = false;
+    bool removalPending;
+
+    Semaphore_wait(self->pendingLock);
+
+    LinkedList element = LinkedList_getNext(self->pendingConnections);
+
+    while (element != NULL) {
+        LinkedList_add(self->connections, element->data);
+        changed = true;
+
+        element = LinkedList_getNext(element);
+    }
+
+    LinkedList_destroyStatic(self->pendingConnections);
+    self->pendingConnections = LinkedList_create();
+
+    removalPending = self->removalPending;
+    self->removalPending = false;
+
+    Semaphore_post(self->pendingLock);
+
+    if (removalPending) {
+        element = LinkedList_getNext(self->connections);
+
+        while (element != NULL) {
+            ManagedConnection* managed = (ManagedConnection*) element->data;
+
+            element = LinkedList_getNext(element);
+
+            if (managed->removed) {
+                LinkedList_remove(self->connections, managed);
+                destroyManagedConnection(self, managed);
+            }
+        }
+
+        changed = true;
+    }
+
+    return changed;
+}
+
+static void*
+eventLoopThread(void* parameter)
+{
+    EventLoop* self = (EventLoop*) parameter;
+
+    void* readyConnections[MANAGER_MAX_EVENTS];
+    int readyEvents[MANAGER_MAX_EVENTS];
+
+    uint64_t nextActionTime = 0;
+
+    while (self->running) {
+        uint64_t currentTime = getMonotonicTimeInMs();
+
+        if (handlePendingChanges(self) || (currentTime >= nextActionTime))
+            nextActionTime = handleTimers(self, currentTime);
+
+        if (self->stalledCount > 0)
+            handleStalledConnections(self);
+
+        int waitTime;
+
+        currentTime = getMonotonicTimeInMs();
+
+        if (self->stalledCount > 0)
+            waitTime = MANAGER_STALLED_WAIT_TIME;
+        else if (nextActionTime > currentTime)
+            waitTime = (int) (nextActionTime - currentTime);
+        else
+            waitTime = 0;
+
+        if (waitTime > MANAGER_MAX_WAIT_TIME)
+            waitTime = MANAGER_MAX_WAIT_TIME;
+
+        int readyCount = SocketEventSet_wait(self->eventSet, readyConnections, readyEvents, MANAGER_MAX_EVENTS,
+                waitTime);
+
+        int i;
+
+        for (i = 0; i < readyCount; i++)
+            handleSocketEvent(self, (ManagedConnection*) readyConnections[i], readyEvents[i]);
+    }
+
+    return NULL;
+}
+
+IedConnectionManager
+IedConnectionManager_create(int threadCount)
+{
+    IedConnectionManager self = (IedConnectionManager) calloc(1, sizeof(struct sIedConnectionManager));
+
+    if (threadCount < 1)
+        threadCount = 1;
+
+    self->minBackoff = MANAGER_DEFAULT_MIN_BACKOFF;
+    self->maxBackoff = MANAGER_DEFAULT_MAX_BACKOFF;
+    self->connectTimeout = MANAGER_DEFAULT_CONNECT_TIMEOUT;
+
+    self->lock = Semaphore_create(1);
+    self->connections = LinkedList_create();
+
+    self->eventLoopCount = threadCount;
+    self->eventLoops = (EventLoop*) calloc(threadCount, sizeof(EventLoop));
+
+    int i;
+
+    for (i = 0; i < threadCount; i++) {
+        EventLoop* eventLoop = &(self->eventLoops[i]);
+
+        eventLoop->manager = self;
+        eventLoop->eventSet = SocketEventSet_create();
+        eventLoop->connections = LinkedList_create();
+        eventLoop->pendingLock = Semaphore_create(1);
+        eventLoop->pendingConnections = LinkedList_create();
+        eventLoop->running = true;
+
+        eventLoop->thread = Thread_create(eventLoopThread, eventLoop, false);
+        Thread_start(eventLoop->thread);
+    }
+
+    return self;
+}
+
+void
+IedConnectionManager_setStateHandler(IedConnectionManager self, IedConnectionManagerStateHandler handler,
+        void* parameter)
+{
+    self->stateHandler = handler;
+    self->stateHandlerParameter = parameter;
+}
+
+void
+IedConnectionManager_setReconnectParameters(IedConnectionManager self, int minBackoffInMs, int maxBackoffInMs)
+{
+    if (minBackoffInMs < 1)
+        minBackoffInMs = 1;
+
+    if (maxBackoffInMs < minBackoffInMs)
+        maxBackoffInMs = minBackoffInMs;
+
+    self->minBackoff = minBackoffInMs;
+    self->maxBackoff = maxBackoffInMs;
+}
+
+void
+IedConnectionManager_setConnectTimeout(IedConnectionManager self, int timeoutInMs)
+{
+    self->connectTimeout = timeoutInMs;
+}
+
+IedConnection
+IedConnectionManager_addConnection(IedConnectionManager self, char* hostname, int tcpPort)
+{
+    ManagedConnection* managed = (ManagedConnection*) calloc(1, sizeof(ManagedConnection));
+
+    managed->connection = IedConnection_create();
+    managed->hostname = copyString(hostname);
+    managed->tcpPort = tcpPort;
+    managed->state = MANAGED_STATE_WAITING;
+    managed->nextActionTime = 0; /* connect immediately */
+    managed->backoff = self->minBackoff;
+
+    private_IedConnection_installMmsHandlers(managed->connection);
+
+    Semaphore_wait(self->lock);
+
+    EventLoop* eventLoop = &(self->eventLoops[self->nextEventLoop]);
+    self->nextEventLoop = (self->nextEventLoop + 1) % self->eventLoopCount;
+
+    LinkedList_add(self->connections, managed);
+
+    Semaphore_post(self->lock);
+
+    managed->eventLoop = eventLoop;
+
+    Semaphore_wait(eventLoop->pendingLock);
+    LinkedList_add(eventLoop->pendingConnections, managed);
+    Semaphore_post(eventLoop->pendingLock);
+
+    return managed->connection;
+}
+
+void
+IedConnectionManager_removeConnection(IedConnectionManager self, IedConnection connection)
+{
+    ManagedConnection* managed = NULL;
+
+    Semaphore_wait(self->lock);
+
+    LinkedList element = LinkedList_getNext(self->connections);
+
+    while (element != NULL) {
+        ManagedConnection* candidate = (ManagedConnection*) element->data;
+
+        if (candidate->connection == connection) {
+            managed = candidate;
+            LinkedList_remove(self->connections, managed);
+            break;
+        }
+
+        element = LinkedList_getNext(element);
+    }
+
+    Semaphore_post(self->lock);
+
+    if (managed == NULL)
+        return;
+
+    EventLoop* eventLoop = managed->eventLoop;
+
+    Semaphore_wait(eventLoop->pendingLock);
+
+    /* not yet taken over by the event loop */
+    if (LinkedList_remove(eventLoop->pendingConnections, managed)) {
+        Semaphore_post(eventLoop->pendingLock);
+
+        destroyManagedConnection(eventLoop, managed);
+        return;
+    }
+
+    managed->removed = true;
+    eventLoop->removalPending = true;
+
+    Semaphore_post(eventLoop->pendingLock);
+}
+
+void
+IedConnectionManager_destroy(IedConnectionManager self)
+{
+    int i;
+
+    for (i = 0; i < self->eventLoopCount; i++)
+        self->eventLoops[i].running = false;
+
+    for (i = 0; i < self->eventLoopCount; i++) {
+        EventLoop* eventLoop = &(self->eventLoops[i]);
+
+        Thread_destroy(eventLoop->thread);
+
+        /* the removed connections are destroyed here */
+        handlePendingChanges(eventLoop);
+
+        LinkedList element = LinkedList_getNext(eventLoop->connections);
+
+        while (element != NULL) {
+            destroyManagedConnection(eventLoop, (ManagedConnection*) element->data);
+
+            element = LinkedList_getNext(element);
+        }
+
+        LinkedList_destroyStatic(eventLoop->connections);
+        LinkedList_destroyStatic(eventLoop->pendingConnections);
+        Semaphore_destroy(eventLoop->pendingLock);
+        SocketEventSet_destroy(eventLoop->eventSet);
+    }
+
+    free(self->eventLoops);
+
+    LinkedList_destroyStatic(self->connections);
+    Semaphore_destroy(self->lock);
+
+    free(self);
+}
@@ -30,12 +30,38 @@
 
 #include "thread.h"
 
+typedef struct sClientReportIndex* ClientReportIndex;
+
+typedef struct sICLogicalDevice
+{
+    char* name;
+    LinkedList variables;
+    LinkedList dataSets;
+} ICLogicalDevice;
+
 struct sIedConnection
 {
     MmsConnection connection;
     IedConnectionState state;
     LinkedList enabledReports;
+    ClientReportIndex reportIndex; /* hash index of the enabled reports */
+    Semaphore reportsLock; /* protects enabledReports and reportIndex */
+    ClientReportHandlerPool reportHandlerPool;
+    LinkedList pollGroups;
+    Semaphore pollGroupsLock; /* protects pollGroups and pollGroupScheduler */
+    Semaphore pollGroupsWakeUp;
+    Thread pollGroupScheduler; /* shared by all poll groups of the connection */
+    bool pollGroupSchedulerRunning;
     LinkedList logicalDevices;
+    char* modelCacheDirectory;
+    char* modelCacheFileName; /* derived from the server identity - NULL when the cache is not open */
+    char* modelCacheIdentity;
+    int modelCacheIdentitySize;
+    LinkedList cachedLogicalDevices; /* model loaded from the cache file - not yet validated */
+    LinkedList typeSpecCache; /* encoded type specifications */
+    bool modelCacheDirty;
+    bool modelCacheUnavailable; /* identify or fingerprint failed - don't retry until the connection is closed */
+    Semaphore modelCacheLock; /* protects the model cache fields */
     LinkedList clientControls;
     LastApplError lastApplError;
     Semaphore stateMutex;
@@ -79,11 +105,72 @@ bool
 private_ClientReportControlBlock_updateValues(ClientReportControlBlock self, MmsValue* values);
 
 void
-private_IedConnection_handleReport(IedConnection self, MmsValue* value);
+private_IedConnection_handleEncodedReport(void* parameter, char* variableListName, uint8_t* buffer, int maxBufPos,
+        int* accessResults, int accessResultCount);
+
+void
+private_IedConnection_initReports(IedConnection self);
+
+void
+private_IedConnection_destroyReports(IedConnection self);
+
+/* install the MMS handlers for connection loss and reports (used by IedConnection_connect and the connection manager) */
+void
+private_IedConnection_installMmsHandlers(IedConnection self);
+
+void
+private_IedConnection_setState(IedConnection self, IedConnectionState newState);
+
+void
+private_IedConnection_initPollGroups(IedConnection self);
+
+void
+private_IedConnection_stopPollGroups(IedConnection self);
+
+void
+private_IedConnection_destroyPollGroups(IedConnection self);
+
+ICLogicalDevice*
+ICLogicalDevice_create(char* name);
+
+void
+ICLogicalDevice_destroy(ICLogicalDevice* self);
+
+void
+private_IedConnection_initModelCache(IedConnection self);
+
+/* determine the cache file from the server identity and load it (if the cache directory is set) */
+void
+private_IedConnection_openModelCache(IedConnection self);
+
+/* save the cache file (if modified) and forget the server identity */
+void
+private_IedConnection_closeModelCache(IedConnection self);
+
+void
+private_IedConnection_destroyModelCache(IedConnection self);
+
+void
+private_IedConnection_saveModelCache(IedConnection self);
+
+/* replace the cached model by the model retrieved from the server */
+void
+private_IedConnection_updateModelCache(IedConnection self);
+
+MmsVariableSpecification*
+private_IedConnection_getCachedTypeSpec(IedConnection self, char* domainId, char* itemId);
+
+/* takes ownership of encodedTypeSpec */
+void
+private_IedConnection_addCachedTypeSpec(IedConnection self, char* domainId, char* itemId,
+        uint8_t* encodedTypeSpec, int encodedTypeSpecSize);
 
 IedClientError
 iedConnection_mapMmsErrorToIedError(MmsError mmsError);
 
+MmsDataAccessError
+iedConnection_mapMmsErrorToDataAccessError(MmsError mmsError);
+
 IedClientError
 iedConnection_mapDataAccessErrorToIedError(MmsDataAccessError mmsError);
 
@@ -96,4 +183,8 @@ ClientReport_destroy(ClientReport self);
 void
 private_ControlObjectClient_invokeCommandTerminationHandler(ControlObjectClient self);
 
+/* complete an asynchronous action whose CommandTermination didn't arrive in time or can no longer arrive */
+void
+private_ControlObjectClient_handleTimeouts(ControlObjectClient self, bool connectionLost);
+
 #endif /* IED_CONNECTION_PRIVATE_H_ */
@@ -168,6 +168,38 @@ IedServer_enableGoosePublishing(IedServer self);
 void
 IedServer_setAuthenticator(IedServer self, AcseAuthenticator authenticator, void* authenticatorParameter);
 
+/**
+ * \brief set the policy that is applied when the send queue of a client connection is full
+ *
+ * Reports and command termination messages are not sent directly but added to a send queue
+ * of the client connection (see CONFIG_ISO_SERVER_SEND_QUEUE_SIZE). When a client doesn't read
+ * fast enough the queue runs full. Then the oldest queued unbuffered reports are dropped and
+ * buffered reports are paused (they are kept in the report buffer), or the connection is closed.
+ * Buffered reports are never dropped.
+ *
+ * The default policy is ISO_SEND_QUEUE_PAUSE_BUFFERED.
+ *
+ * \param self the instance of IedServer to operate on.
+ * \param policy the new overflow policy
+ */
+void
+IedServer_setSendQueueOverflowPolicy(IedServer self, IsoSendQueueOverflowPolicy policy);
+
+/**
+ * \brief Get a snapshot of the MMS server metrics (accumulated for all client connections)
+ *
+ * The snapshot contains request and error counters, bytes received and sent, the queueing delay
+ * and a latency histogram for each MMS service and for the sent reports. Collection can be
+ * switched off at runtime with MmsServer_enableMetrics or compiled out with CONFIG_MMS_SERVER_METRICS.
+ *
+ * \param self the instance of IedServer to operate on.
+ * \param snapshot the structure that receives the metrics
+ *
+ * \return true if metrics are available, false if they are compiled out
+ */
+bool
+IedServer_getMetrics(IedServer self, MmsServerMetrics* snapshot);
+
 
 
 /**
@@ -195,6 +227,29 @@ ClientConnection_getPeerAddress(ClientConnection self);
 void*
 ClientConnection_getSecurityToken(ClientConnection self);
 
+/**
+ * \brief Get the state of the send queue of this connection
+ *
+ * The statistics contain the current and the maximum queue depth, the number of dropped messages
+ * and how long writes to the connection are blocked (stall time).
+ *
+ * \param self the ClientConnection instance
+ * \param statistics the structure that receives the send queue state
+ */
+void
+ClientConnection_getSendQueueStatistics(ClientConnection self, IsoSendQueueStatistics* statistics);
+
+/**
+ * \brief Get a snapshot of the MMS server metrics of this connection
+ *
+ * \param self the ClientConnection instance
+ * \param snapshot the structure that receives the metrics
+ *
+ * \return true if metrics are available, false if they are compiled out
+ */
+bool
+ClientConnection_getMetrics(ClientConnection self, MmsServerMetrics* snapshot);
+
 /**
  * \brief User provided callback function that is invoked whenever a new client connects or an existing connection is closed
  *        or detected as lost.
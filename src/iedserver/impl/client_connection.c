@@ -106,3 +106,19 @@ ClientConnection_getSecurityToken(ClientConnection self)
 
     return IsoConnection_getSecurityToken(mmsConnection->isoConnection);
 }
+
+void
+ClientConnection_getSendQueueStatistics(ClientConnection self, IsoSendQueueStatistics* statistics)
+{
+    MmsServerConnection* mmsConnection = (MmsServerConnection*) self->serverConnectionHandle;
+
+    IsoConnection_getSendQueueStatistics(mmsConnection->isoConnection, statistics);
+}
+
+bool
+ClientConnection_getMetrics(ClientConnection self, MmsServerMetrics* snapshot)
+{
+    MmsServerConnection* mmsConnection = (MmsServerConnection*) self->serverConnectionHandle;
+
+    return MmsServerConnection_getMetrics(mmsConnection, snapshot);
+}
@@ -383,6 +383,18 @@ IedServer_setAuthenticator(IedServer self, AcseAuthenticator authenticator, void
     MmsServer_setClientAuthenticator(self->mmsServer, authenticator, authenticatorParameter);
 }
 
+void
+IedServer_setSendQueueOverflowPolicy(IedServer self, IsoSendQueueOverflowPolicy policy)
+{
+    IsoServer_setSendQueueOverflowPolicy(self->isoServer, policy);
+}
+
+bool
+IedServer_getMetrics(IedServer self, MmsServerMetrics* snapshot)
+{
+    return MmsServer_getMetrics(self->mmsServer, snapshot);
+}
+
 MmsServer
 IedServer_getMmsServer(IedServer self)
 {
@@ -33,6 +33,7 @@
 #include "reporting.h"
 #include "mms_mapping_internal.h"
 #include "mms_value_internal.h"
+#include "trace.h"
 
 #ifndef DEBUG_IED_SERVER
 #define DEBUG_IED_SERVER 0
@@ -326,7 +327,8 @@ sendReport(ReportControl* self, bool isIntegrity, bool isGI)
     for (i = 0; i < self->dataSet->elementCount; i++)
         self->inclusionFlags[i] = REPORT_CONTROL_NONE;
 
-    MmsServerConnection_sendInformationReportVMDSpecific(self->clientConnection, "RPT", reportElements, false);
+    MmsServerConnection_sendInformationReportVMDSpecific(self->clientConnection, "RPT", reportElements,
+            ISO_MESSAGE_UNBUFFERED);
 
     /* Increase sequence number */
     self->sqNum++;
@@ -1149,6 +1151,9 @@ Reporting_deactivateReportsForConnection(MmsMapping* self, MmsServerConnection*
     while ((reportControl = LinkedList_getNext(reportControl)) != NULL) {
         ReportControl* rc = (ReportControl*) reportControl->data;
 
+        /* wait until a report that is currently sent to the connection is finished */
+        Semaphore_wait(rc->createNotificationsMutex);
+
         if (rc->clientConnection == connection) {
 
             rc->enabled = false;
@@ -1172,6 +1177,8 @@ Reporting_deactivateReportsForConnection(MmsMapping* self, MmsServerConnection*
 
             updateOwner(rc, NULL);
         }
+
+        Semaphore_post(rc->createNotificationsMutex);
     }
 }
 
@@ -1206,9 +1213,6 @@ printEnqueuedReports(ReportControl* reportControl)
 static void
 enqueueReport(ReportControl* reportControl, bool isIntegrity, bool isGI)
 {
-    if (DEBUG_IED_SERVER) printf("enqueueReport: RCB name: %s (SQN:%u) enabled:%i buffered:%i buffering:%i intg:%i GI:%i\n", reportControl->name, (unsigned) reportControl->sqNum, reportControl->enabled,
-            reportControl->isBuffering, reportControl->buffered, isIntegrity, isGI);
-
     /* calculate size of complete buffer entry */
     int bufferEntrySize = sizeof(ReportBufferEntry);
 
@@ -1259,8 +1263,6 @@ enqueueReport(ReportControl* reportControl, bool isIntegrity, bool isGI)
     uint8_t* entryBufPos = NULL;
     uint8_t* entryStartPos;
 
-    if (DEBUG_IED_SERVER) printf("number of buffered reports:%i\n", buffer->reportsCount);
-
     if (buffer->lastEnqueuedReport == NULL) { /* buffer is empty - we start at the beginning of the memory block */
         entryBufPos = buffer->memoryBlock;
         buffer->oldestReport = (ReportBufferEntry*) entryBufPos;
@@ -1268,8 +1270,6 @@ enqueueReport(ReportControl* reportControl, bool isIntegrity, bool isGI)
     }
     else {
 
-        if (DEBUG_IED_SERVER) printf ("Last buffer offset: %i\n", (int) ((uint8_t*) buffer->lastEnqueuedReport - buffer->memoryBlock));
-
         if (buffer->lastEnqueuedReport == buffer->oldestReport) {
             entryBufPos = (uint8_t*) ((uint8_t*) buffer->lastEnqueuedReport + buffer->lastEnqueuedReport->entryLength);
 
@@ -1282,9 +1282,9 @@ enqueueReport(ReportControl* reportControl, bool isIntegrity, bool isGI)
 
             if (buffer->reportsCount != 1) {
                 while (entryBufPos + bufferEntrySize > (uint8_t*) buffer->oldestReport) {
-                    printf("enqueueReport: CASE 1: remove oldest report\n");
                     buffer->oldestReport = buffer->oldestReport->next;
                     buffer->reportsCount--;
+                    TRACE1(TRACE_REPORTING_REMOVE_OLDEST, buffer->reportsCount);
                 }
             }
 
@@ -1298,6 +1298,7 @@ enqueueReport(ReportControl* reportControl, bool isIntegrity, bool isGI)
                 while ((entryBufPos + bufferEntrySize) > (uint8_t*) buffer->oldestReport) {
                     buffer->oldestReport = buffer->oldestReport->next;
                     buffer->reportsCount--;
+                    TRACE1(TRACE_REPORTING_REMOVE_OLDEST, buffer->reportsCount);
                 }
             }
 
@@ -1313,17 +1314,20 @@ enqueueReport(ReportControl* reportControl, bool isIntegrity, bool isGI)
                 while ((uint8_t*) buffer->oldestReport > buffer->memoryBlock) {
                     buffer->oldestReport = buffer->oldestReport->next;
                     buffer->reportsCount--;
+                    TRACE1(TRACE_REPORTING_REMOVE_OLDEST, buffer->reportsCount);
                 }
 
                 while ((entryBufPos + bufferEntrySize) > (uint8_t*) buffer->oldestReport) {
                     buffer->oldestReport = buffer->oldestReport->next;
                     buffer->reportsCount--;
+                    TRACE1(TRACE_REPORTING_REMOVE_OLDEST, buffer->reportsCount);
                 }
             }
 
             while (((entryBufPos + bufferEntrySize) > (uint8_t*) buffer->oldestReport) && ((uint8_t*) buffer->oldestReport != buffer->memoryBlock)) {
                 buffer->oldestReport = buffer->oldestReport->next;
                 buffer->reportsCount--;
+                TRACE1(TRACE_REPORTING_REMOVE_OLDEST, buffer->reportsCount);
             }
 
             buffer->lastEnqueuedReport->next = (ReportBufferEntry*) entryBufPos;
@@ -1409,9 +1413,7 @@ enqueueReport(ReportControl* reportControl, bool isIntegrity, bool isGI)
     for (i = 0; i < reportControl->dataSet->elementCount; i++)
         reportControl->inclusionFlags[i] = REPORT_CONTROL_NONE;
 
-    if (DEBUG_IED_SERVER)
-        printf("enqueueReport: encoded %i bytes for report (estimated %i) at buffer offset %i\n", (int) (entryBufPos - entryStartPos), bufferEntrySize, (int) (entryStartPos -
-            buffer->memoryBlock));
+    TRACE4(TRACE_REPORTING_ENQUEUE, reportControl->sqNum, entryBufPos - entryStartPos, isIntegrity, isGI);
 
 #if (DEBUG_IED_SERVER == 1)
     printEnqueuedReports(reportControl);
@@ -1435,8 +1437,16 @@ sendNextReportEntry(ReportControl* self)
     if (self->reportBuffer->nextToTransmit == NULL)
         return;
 
+    /* slow client - keep the report in the buffer until the send queue has space */
+    if (!IsoConnection_canSendBufferedMessage(self->clientConnection->isoConnection)) {
+        TRACE0(TRACE_REPORTING_PAUSED);
+        return;
+    }
+
     ReportBufferEntry* report = self->reportBuffer->nextToTransmit;
 
+    TRACE1(TRACE_REPORTING_SEND_BUFFERED, self->reportBuffer->reportsCount);
+
     MmsValue* entryIdValue = MmsValue_getElement(self->rcbValues, 11);
     MmsValue_setOctetString(entryIdValue, (uint8_t*) report->entryId, 8);
 
@@ -1599,7 +1609,8 @@ sendNextReportEntry(ReportControl* self)
         }
     }
 
-    MmsServerConnection_sendInformationReportVMDSpecific(self->clientConnection, "RPT", reportElements, false);
+    MmsServerConnection_sendInformationReportVMDSpecific(self->clientConnection, "RPT", reportElements,
+            ISO_MESSAGE_BUFFERED);
 
     /* Increase sequence number */
     self->sqNum++;
@@ -82,6 +82,23 @@ BerDecoder_decodeUint32(uint8_t* buffer, int intlen, int bufPos) {
     return value;
 }
 
+int32_t
+BerDecoder_decodeInt32(uint8_t* buffer, int intlen, int bufPos)
+{
+    uint32_t value = 0;
+
+    if ((intlen > 0) && (buffer[bufPos] & 0x80))
+        value = 0xffffffff; /* negative value - sign extension */
+
+    int i;
+    for (i = 0; i < intlen; i++) {
+        value <<= 8;
+        value += buffer[bufPos + i];
+    }
+
+    return (int32_t) value;
+}
+
 float
 BerDecoder_decodeFloat(uint8_t* buffer, int bufPos)
 {
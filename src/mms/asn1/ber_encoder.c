@@ -307,6 +307,49 @@ BerEncoder_encodeFloat(uint8_t* floatValue, uint8_t formatWidth, uint8_t exponen
     return bufPos;
 }
 
+static int
+createInt32ValueBuffer(int32_t value, uint8_t* valueBuffer)
+{
+    uint8_t* valueArray = (uint8_t*) &value;
+
+    int i;
+    for (i = 0; i < 4; i++) {
+        valueBuffer[i] = valueArray[i];
+    }
+
+#if (ORDER_LITTLE_ENDIAN == 1)
+    BerEncoder_revertByteOrder(valueBuffer, 4);
+#endif
+
+    return BerEncoder_compressInteger(valueBuffer, 4);
+}
+
+int
+BerEncoder_encodeInt32WithTL(uint8_t tag, int32_t value, uint8_t* buffer, int bufPos)
+{
+    uint8_t valueBuffer[4];
+
+    int size = createInt32ValueBuffer(value, valueBuffer);
+
+    buffer[bufPos++] = tag;
+    buffer[bufPos++] = (uint8_t) size;
+
+    int i;
+    for (i = 0; i < size; i++) {
+        buffer[bufPos++] = valueBuffer[i];
+    }
+
+    return bufPos;
+}
+
+int
+BerEncoder_Int32determineEncodedSize(int32_t value)
+{
+    uint8_t valueBuffer[4];
+
+    return createInt32ValueBuffer(value, valueBuffer);
+}
+
 int
 BerEncoder_UInt32determineEncodedSize(uint32_t value)
 {
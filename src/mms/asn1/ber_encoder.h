@@ -58,6 +58,9 @@ BerEncoder_encodeUInt32(uint32_t value, uint8_t* buffer, int bufPos);
 int
 BerEncoder_encodeUInt32WithTL(uint8_t tag, uint32_t value, uint8_t* buffer, int bufPos);
 
+int
+BerEncoder_encodeInt32WithTL(uint8_t tag, int32_t value, uint8_t* buffer, int bufPos);
+
 int
 BerEncoder_encodeBitString(uint8_t tag, int bitStringSize, uint8_t* bitString, uint8_t* buffer, int bufPos);
 
@@ -75,6 +78,9 @@ BerEncoder_encodeFloat(uint8_t* floatValue, uint8_t formatWidth, uint8_t exponen
 int
 BerEncoder_UInt32determineEncodedSize(uint32_t value);
 
+int
+BerEncoder_Int32determineEncodedSize(int32_t value);
+
 int
 BerEncoder_determineLengthSize(uint32_t length);
 
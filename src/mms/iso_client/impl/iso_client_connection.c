@@ -47,8 +47,36 @@
 #define STATE_ASSOCIATED 1
 #define STATE_ERROR 2
 
+/* states of an event driven association (see IsoClientConnection_startAssociation) */
+#define ASYNC_STATE_IDLE 0
+#define ASYNC_STATE_TCP_CONNECTING 1
+#define ASYNC_STATE_COTP_CONNECTING 2
+#define ASYNC_STATE_ASSOCIATING 3
+#define ASYNC_STATE_ASSOCIATED 4
+
+#define TPKT_CONSUMED 0
+#define TPKT_STALLED 1
+#define TPKT_ERROR 2
+
 #define ISO_CLIENT_BUFFER_SIZE CONFIG_MMS_MAXIMUM_PDU_SIZE + 100
 
+#ifndef CONFIG_MMS_CLIENT_RECEIVE_BUFFERS
+#define CONFIG_MMS_CLIENT_RECEIVE_BUFFERS 4
+#endif
+
+#if (CONFIG_MMS_CLIENT_RECEIVE_BUFFERS < 2)
+#define ISO_CLIENT_RECEIVE_BUFFERS 2
+#else
+#define ISO_CLIENT_RECEIVE_BUFFERS CONFIG_MMS_CLIENT_RECEIVE_BUFFERS
+#endif
+
+typedef struct {
+    uint8_t* memory;
+    ByteBuffer cotpPayload; /* COTP payload (reassembled TPDUs) */
+    ByteBuffer payload; /* presentation layer user data handed to the API client */
+    bool isUsed;
+} IsoClientReceiveBuffer;
+
 struct sIsoClientConnection
 {
     IsoIndicationCallback callback;
@@ -61,18 +89,204 @@ struct sIsoClientConnection
     AcseConnection acseConnection;
 
     uint8_t* sendBuffer; /* send buffer */
-    uint8_t* cotpBuf; /* receive buffer */
-    ByteBuffer* cotpBuffer;
 
     ByteBuffer* transmitPayloadBuffer;
     Semaphore transmitBufferMutex;
 
-    ByteBuffer* receivePayloadBuffer;
-    Semaphore receiveBufferMutex;
+    /* The receive thread reads messages into free receive buffers and queues them. The
+     * dispatch thread passes the queued messages to the callback in the order of reception.
+     * A receive buffer is free again when the API client releases it. */
+    IsoClientReceiveBuffer receiveBuffers[ISO_CLIENT_RECEIVE_BUFFERS];
+    IsoClientReceiveBuffer* receiveQueue[ISO_CLIENT_RECEIVE_BUFFERS];
+    int receiveQueueHead;
+    int receiveQueueSize;
+
+    Semaphore receiveLock; /* protects receive buffers, queue, flags and statistics */
+
+    Semaphore receiveBufferReleased;
+    bool receiverWaiting;
+
+    Semaphore messageQueued;
+    bool dispatcherWaiting;
+
+    bool receiverStopped;
+    bool closing;
+
+    IsoClientReceiveStatistics statistics;
 
     Thread thread;
+    Thread dispatchThread;
+
+    /* event driven operation - the socket is handled by an external event loop */
+    int asyncState;
+    IsoConnectionParameters asyncParameters;
+    ByteBuffer* asyncPayload;
+    uint8_t* asyncSendBuffer; /* association request - the event loop never waits for the transmit buffer */
+    ByteBuffer asyncPayloadBuffer;
+    uint8_t* tpktBuffer; /* received bytes not yet processed */
+    int tpktBufferSize;
+    int tpktBufferFill;
+    IsoClientReceiveBuffer* currentReceiveBuffer; /* collects the TPDUs of the current message */
+    bool receiverStalled;
 };
 
+/* returns a free receive buffer - waits until a buffer is released if required */
+static IsoClientReceiveBuffer*
+getFreeReceiveBuffer(IsoClientConnection self)
+{
+    bool stalled = false;
+
+    Semaphore_wait(self->receiveLock);
+
+    while (self->closing == false) {
+        int i;
+
+        for (i = 0; i < ISO_CLIENT_RECEIVE_BUFFERS; i++) {
+            IsoClientReceiveBuffer* receiveBuffer = &(self->receiveBuffers[i]);
+
+            if (receiveBuffer->isUsed == false) {
+                receiveBuffer->isUsed = true;
+
+                self->statistics.buffersInUse++;
+
+                if (self->statistics.buffersInUse > self->statistics.maxBuffersInUse)
+                    self->statistics.maxBuffersInUse = self->statistics.buffersInUse;
+
+                Semaphore_post(self->receiveLock);
+
+                return receiveBuffer;
+            }
+        }
+
+        if (stalled == false) {
+            self->statistics.receiverStalls++;
+            stalled = true;
+        }
+
+        self->receiverWaiting = true;
+
+        Semaphore_post(self->receiveLock);
+
+        Semaphore_wait(self->receiveBufferReleased);
+
+        Semaphore_wait(self->receiveLock);
+    }
+
+    Semaphore_post(self->receiveLock);
+
+    return NULL;
+}
+
+/* returns a free receive buffer or NULL if all buffers are in use (event driven operation) */
+static IsoClientReceiveBuffer*
+getFreeReceiveBufferNonBlocking(IsoClientConnection self)
+{
+    IsoClientReceiveBuffer* freeBuffer = NULL;
+    int i;
+
+    Semaphore_wait(self->receiveLock);
+
+    for (i = 0; i < ISO_CLIENT_RECEIVE_BUFFERS; i++) {
+        IsoClientReceiveBuffer* receiveBuffer = &(self->receiveBuffers[i]);
+
+        if (receiveBuffer->isUsed == false) {
+            receiveBuffer->isUsed = true;
+
+            self->statistics.buffersInUse++;
+
+            if (self->statistics.buffersInUse > self->statistics.maxBuffersInUse)
+                self->statistics.maxBuffersInUse = self->statistics.buffersInUse;
+
+            freeBuffer = receiveBuffer;
+            break;
+        }
+    }
+
+    if ((freeBuffer == NULL) && (self->receiverStalled == false))
+        self->statistics.receiverStalls++;
+
+    self->receiverStalled = (freeBuffer == NULL);
+
+    Semaphore_post(self->receiveLock);
+
+    return freeBuffer;
+}
+
+static void
+releaseReceiveBuffer(IsoClientConnection self, IsoClientReceiveBuffer* receiveBuffer)
+{
+    Semaphore_wait(self->receiveLock);
+
+    if (receiveBuffer->isUsed) {
+        receiveBuffer->isUsed = false;
+        self->statistics.buffersInUse--;
+    }
+
+    if (self->receiverWaiting) {
+        self->receiverWaiting = false;
+        Semaphore_post(self->receiveBufferReleased);
+    }
+
+    Semaphore_post(self->receiveLock);
+}
+
+static void
+queueReceivedMessage(IsoClientConnection self, IsoClientReceiveBuffer* receiveBuffer)
+{
+    Semaphore_wait(self->receiveLock);
+
+    if (receiveBuffer != NULL) {
+        int index = (self->receiveQueueHead + self->receiveQueueSize) % ISO_CLIENT_RECEIVE_BUFFERS;
+
+        self->receiveQueue[index] = receiveBuffer;
+        self->receiveQueueSize++;
+
+        self->statistics.messagesReceived++;
+
+        if (self->receiveQueueSize > self->statistics.maxQueueDepth)
+            self->statistics.maxQueueDepth = self->receiveQueueSize;
+    }
+    else
+        self->receiverStopped = true;
+
+    if (self->dispatcherWaiting) {
+        self->dispatcherWaiting = false;
+        Semaphore_post(self->messageQueued);
+    }
+
+    Semaphore_post(self->receiveLock);
+}
+
+/* returns the next queued message or NULL when the connection is closed */
+static IsoClientReceiveBuffer*
+getNextReceivedMessage(IsoClientConnection self)
+{
+    IsoClientReceiveBuffer* receiveBuffer = NULL;
+
+    Semaphore_wait(self->receiveLock);
+
+    while ((self->receiveQueueSize == 0) && (self->receiverStopped == false)) {
+        self->dispatcherWaiting = true;
+
+        Semaphore_post(self->receiveLock);
+
+        Semaphore_wait(self->messageQueued);
+
+        Semaphore_wait(self->receiveLock);
+    }
+
+    if (self->receiveQueueSize > 0) {
+        receiveBuffer = self->receiveQueue[self->receiveQueueHead];
+
+        self->receiveQueueHead = (self->receiveQueueHead + 1) % ISO_CLIENT_RECEIVE_BUFFERS;
+        self->receiveQueueSize--;
+    }
+
+    Semaphore_post(self->receiveLock);
+
+    return receiveBuffer;
+}
+
 static void*
 connectionHandlingThread(void* threadParameter)
 {
@@ -83,9 +297,16 @@ connectionHandlingThread(void* threadParameter)
     if (DEBUG_ISO_CLIENT)
         printf("ISO_CLIENT_CONNECTION: new connection\n");
 
-    Semaphore_wait(self->receiveBufferMutex);
+    IsoClientReceiveBuffer* receiveBuffer;
+
+    while ((receiveBuffer = getFreeReceiveBuffer(self)) != NULL) {
 
-    while (CotpConnection_parseIncomingMessage(self->cotpConnection) == DATA_INDICATION) {
+        self->cotpConnection->payload = &(receiveBuffer->cotpPayload);
+
+        if (CotpConnection_parseIncomingMessage(self->cotpConnection) != DATA_INDICATION) {
+            releaseReceiveBuffer(self, receiveBuffer);
+            break;
+        }
 
         sessionIndication =
                 IsoSession_parseMessage(self->session,
@@ -97,23 +318,25 @@ connectionHandlingThread(void* threadParameter)
         if (sessionIndication != SESSION_DATA) {
             if (DEBUG_ISO_CLIENT)
                 printf("ISO_CLIENT_CONNECTION: Invalid session message\n");
+            releaseReceiveBuffer(self, receiveBuffer);
             break;
         }
 
         if (!IsoPresentation_parseUserData(self->presentation, IsoSession_getUserData(self->session))) {
             if (DEBUG_ISO_CLIENT)
                 printf("ISO_CLIENT_CONNECTION: Invalid presentation message\n");
+            releaseReceiveBuffer(self, receiveBuffer);
             break;
         }
 
-        self->callback(ISO_IND_DATA, self->callbackParameter,
-                &(self->presentation->nextPayload));
+        /* the user data refers to the receive buffer */
+        receiveBuffer->payload = self->presentation->nextPayload;
 
-        /* wait for user to release the buffer */
-        Semaphore_wait(self->receiveBufferMutex);
+        queueReceivedMessage(self, receiveBuffer);
     }
 
-    self->callback(ISO_IND_CLOSED, self->callbackParameter, NULL);
+    /* signal the end of the connection to the dispatch thread */
+    queueReceivedMessage(self, NULL);
 
     if (DEBUG_ISO_CLIENT)
         printf("ISO_CLIENT_CONNECTION: exit connection\n");
@@ -121,6 +344,21 @@ connectionHandlingThread(void* threadParameter)
     return NULL;
 }
 
+static void*
+dispatchThread(void* threadParameter)
+{
+    IsoClientConnection self = (IsoClientConnection) threadParameter;
+
+    IsoClientReceiveBuffer* receiveBuffer;
+
+    while ((receiveBuffer = getNextReceivedMessage(self)) != NULL)
+        self->callback(ISO_IND_DATA, self->callbackParameter, &(receiveBuffer->payload));
+
+    self->callback(ISO_IND_CLOSED, self->callbackParameter, NULL);
+
+    return NULL;
+}
+
 IsoClientConnection
 IsoClientConnection_create(IsoIndicationCallback callback, void* callbackParameter)
 {
@@ -136,11 +374,19 @@ IsoClientConnection_create(IsoIndicationCallback callback, void* callbackParamet
     self->transmitPayloadBuffer->buffer = self->sendBuffer;
     self->transmitPayloadBuffer->maxSize = ISO_CLIENT_BUFFER_SIZE;
 
-    self->receivePayloadBuffer = (ByteBuffer*) calloc(1, sizeof(ByteBuffer));
+    int i;
+
+    for (i = 0; i < ISO_CLIENT_RECEIVE_BUFFERS; i++) {
+        self->receiveBuffers[i].memory = (uint8_t*) malloc(ISO_CLIENT_BUFFER_SIZE);
+        ByteBuffer_wrap(&(self->receiveBuffers[i].cotpPayload), self->receiveBuffers[i].memory, 0,
+                ISO_CLIENT_BUFFER_SIZE);
+    }
 
     self->transmitBufferMutex = Semaphore_create(1);
 
-    self->receiveBufferMutex = Semaphore_create(1);
+    self->receiveLock = Semaphore_create(1);
+    self->receiveBufferReleased = Semaphore_create(0);
+    self->messageQueued = Semaphore_create(0);
 
     return self;
 }
@@ -148,6 +394,13 @@ IsoClientConnection_create(IsoIndicationCallback callback, void* callbackParamet
 void
 IsoClientConnection_sendMessage(IsoClientConnection self, ByteBuffer* payloadBuffer)
 {
+    if (self->state != STATE_ASSOCIATED) {
+        if (DEBUG_ISO_CLIENT)
+            printf("ISO_CLIENT: IsoClientConnection_sendMessage: not associated!\n");
+
+        Semaphore_post(self->transmitBufferMutex);
+        return;
+    }
 
     struct sBufferChain payloadBCMemory;
     BufferChain payload = &payloadBCMemory;
@@ -190,6 +443,18 @@ IsoClientConnection_close(IsoClientConnection self)
         Socket_destroy(self->socket);
     }
 
+    /* wake up the receive thread if it waits for a free receive buffer */
+    Semaphore_wait(self->receiveLock);
+
+    self->closing = true;
+
+    if (self->receiverWaiting) {
+        self->receiverWaiting = false;
+        Semaphore_post(self->receiveBufferReleased);
+    }
+
+    Semaphore_post(self->receiveLock);
+
     self->state = STATE_IDLE;
 }
 
@@ -210,10 +475,8 @@ IsoClientConnection_destroy(IsoClientConnection self)
     if (self->thread != NULL)
         Thread_destroy(self->thread);
 
-    if (self->cotpBuf != NULL)
-        free(self->cotpBuf);
-    if (self->cotpBuffer != NULL)
-        free(self->cotpBuffer);
+    if (self->dispatchThread != NULL)
+        Thread_destroy(self->dispatchThread);
     if (self->cotpConnection != NULL) {
         CotpConnection_destroy(self->cotpConnection);
         free(self->cotpConnection);
@@ -224,9 +487,21 @@ IsoClientConnection_destroy(IsoClientConnection self)
         free(self->presentation);
 
     free(self->transmitPayloadBuffer);
-    free(self->receivePayloadBuffer);
 
-    Semaphore_destroy(self->receiveBufferMutex);
+    if (self->tpktBuffer != NULL)
+        free(self->tpktBuffer);
+
+    if (self->asyncSendBuffer != NULL)
+        free(self->asyncSendBuffer);
+
+    int i;
+
+    for (i = 0; i < ISO_CLIENT_RECEIVE_BUFFERS; i++)
+        free(self->receiveBuffers[i].memory);
+
+    Semaphore_destroy(self->receiveLock);
+    Semaphore_destroy(self->receiveBufferReleased);
+    Semaphore_destroy(self->messageQueued);
     Semaphore_destroy(self->transmitBufferMutex);
 
     free(self->sendBuffer);
@@ -239,6 +514,11 @@ IsoClientConnection_abort(IsoClientConnection self)
     //TODO block other messages from being sent
     IsoClientConnection_allocateTransmitBuffer(self);
 
+    if (self->state != STATE_ASSOCIATED) {
+        Semaphore_post(self->transmitBufferMutex);
+        return;
+    }
+
     struct sBufferChain sAcseBuffer;
     BufferChain acseBuffer = &sAcseBuffer;
     acseBuffer->partMaxLength = ISO_CLIENT_BUFFER_SIZE;
@@ -274,6 +554,11 @@ IsoClientConnection_release(IsoClientConnection self)
     //TODO block other messages from being sent
     IsoClientConnection_allocateTransmitBuffer(self);
 
+    if (self->state != STATE_ASSOCIATED) {
+        Semaphore_post(self->transmitBufferMutex);
+        return;
+    }
+
     struct sBufferChain sAcseBuffer;
     BufferChain acseBuffer = &sAcseBuffer;
     acseBuffer->partMaxLength = ISO_CLIENT_BUFFER_SIZE;
@@ -303,34 +588,11 @@ IsoClientConnection_release(IsoClientConnection self)
     Semaphore_post(self->transmitBufferMutex);
 }
 
-void
-IsoClientConnection_associate(IsoClientConnection self, IsoConnectionParameters params,
-        ByteBuffer* payload)
+/* send the session connect SPDU with the ACSE associate request (payload is the MMS initiate request) */
+static bool
+sendAssociateRequest(IsoClientConnection self, IsoConnectionParameters params, ByteBuffer* payload,
+        uint8_t* sendBuffer)
 {
-    Socket socket = TcpSocket_create();
-
-    self->socket = socket;
-
-    if (!Socket_connect(socket, params->hostname, params->tcpPort))
-        goto returnError;
-
-    self->cotpBuf = (uint8_t*) malloc(ISO_CLIENT_BUFFER_SIZE);
-    self->cotpBuffer = (ByteBuffer*) calloc(1, sizeof(ByteBuffer));
-    ByteBuffer_wrap(self->cotpBuffer, self->cotpBuf, 0, ISO_CLIENT_BUFFER_SIZE);
-
-    self->cotpConnection = (CotpConnection*) calloc(1, sizeof(CotpConnection));
-    CotpConnection_init(self->cotpConnection, socket, self->cotpBuffer);
-
-    /* COTP (ISO transport) handshake */
-    CotpIndication cotpIndication =
-            CotpConnection_sendConnectionRequestMessage(self->cotpConnection, params);
-
-    cotpIndication = CotpConnection_parseIncomingMessage(self->cotpConnection);
-
-    if (cotpIndication != CONNECT_INDICATION)
-        goto returnError;
-
-    /* Upper layers handshake */
     struct sBufferChain sAcsePayload;
     BufferChain acsePayload = &sAcsePayload;
     acsePayload->buffer = payload->buffer;
@@ -348,7 +610,7 @@ IsoClientConnection_associate(IsoClientConnection self, IsoConnectionParameters
     struct sBufferChain sAcseBuffer;
     BufferChain acseBuffer = &sAcseBuffer;
 
-    acseBuffer->buffer = self->sendBuffer + payload->size;
+    acseBuffer->buffer = sendBuffer + payload->size;
     acseBuffer->partMaxLength = ISO_CLIENT_BUFFER_SIZE - acsePayload->length;
 
     AcseConnection_createAssociateRequestMessage(&(self->acseConnection), params, acseBuffer, acsePayload,
@@ -357,7 +619,7 @@ IsoClientConnection_associate(IsoClientConnection self, IsoConnectionParameters
     struct sBufferChain sPresentationBuffer;
     BufferChain presentationBuffer = &sPresentationBuffer;
 
-    presentationBuffer->buffer = self->sendBuffer + acseBuffer->length;
+    presentationBuffer->buffer = sendBuffer + acseBuffer->length;
     presentationBuffer->partMaxLength = ISO_CLIENT_BUFFER_SIZE - acseBuffer->length;
 
     self->presentation = (IsoPresentation*) calloc(1, sizeof(IsoPresentation));
@@ -367,7 +629,7 @@ IsoClientConnection_associate(IsoClientConnection self, IsoConnectionParameters
 
     struct sBufferChain sSessionBuffer;
     BufferChain sessionBuffer = &sSessionBuffer;
-    sessionBuffer->buffer = self->sendBuffer + presentationBuffer->length;
+    sessionBuffer->buffer = sendBuffer + presentationBuffer->length;
 
     self->session = (IsoSession*) calloc(1, sizeof(IsoSession));
     IsoSession_init(self->session);
@@ -375,15 +637,13 @@ IsoClientConnection_associate(IsoClientConnection self, IsoConnectionParameters
     IsoSession_createConnectSpdu(self->session, params, sessionBuffer,
             presentationBuffer);
 
-    CotpConnection_sendDataMessage(self->cotpConnection, sessionBuffer);
-
-    Semaphore_post(self->transmitBufferMutex);
-
-    cotpIndication = CotpConnection_parseIncomingMessage(self->cotpConnection);
-
-    if (cotpIndication != DATA_INDICATION)
-        goto returnError;
+    return (CotpConnection_sendDataMessage(self->cotpConnection, sessionBuffer) == OK);
+}
 
+/* parse the session accept SPDU received into receiveBuffer and provide the MMS initiate response as payload */
+static bool
+parseAssociateResponse(IsoClientConnection self, IsoClientReceiveBuffer* receiveBuffer)
+{
     IsoSessionIndication sessionIndication;
 
     sessionIndication =
@@ -392,13 +652,13 @@ IsoClientConnection_associate(IsoClientConnection self, IsoConnectionParameters
     if (sessionIndication != SESSION_CONNECT) {
         if (DEBUG_ISO_CLIENT)
             printf("IsoClientConnection_associate: no session connect indication\n");
-        goto returnError;
+        return false;
     }
 
     if (!IsoPresentation_parseAcceptMessage(self->presentation, IsoSession_getUserData(self->session))) {
         if (DEBUG_ISO_CLIENT)
             printf("IsoClientConnection_associate: no presentation ok indication\n");
-        goto returnError;
+        return false;
     }
 
     AcseIndication acseIndication;
@@ -408,25 +668,74 @@ IsoClientConnection_associate(IsoClientConnection self, IsoConnectionParameters
     if (acseIndication != ACSE_ASSOCIATE) {
         if (DEBUG_ISO_CLIENT)
             printf("IsoClientConnection_associate: no ACSE_ASSOCIATE indication\n");
-        goto returnError;
+        return false;
     }
 
-
-    ByteBuffer_wrap(self->receivePayloadBuffer, self->acseConnection.userDataBuffer,
+    ByteBuffer_wrap(&(receiveBuffer->payload), self->acseConnection.userDataBuffer,
             self->acseConnection.userDataBufferSize, self->acseConnection.userDataBufferSize);
 
-    Semaphore_wait(self->receiveBufferMutex);
+    return true;
+}
+
+void
+IsoClientConnection_associate(IsoClientConnection self, IsoConnectionParameters params,
+        ByteBuffer* payload)
+{
+    Socket socket = TcpSocket_create();
+
+    self->socket = socket;
+
+    if (!Socket_connect(socket, params->hostname, params->tcpPort))
+        goto returnError;
+
+    /* the association response is received into the first receive buffer */
+    IsoClientReceiveBuffer* receiveBuffer = &(self->receiveBuffers[0]);
+
+    receiveBuffer->isUsed = true;
+    self->statistics.buffersInUse = 1;
+    self->statistics.maxBuffersInUse = 1;
+
+    self->cotpConnection = (CotpConnection*) calloc(1, sizeof(CotpConnection));
+    CotpConnection_init(self->cotpConnection, socket, &(receiveBuffer->cotpPayload));
+
+    /* COTP (ISO transport) handshake */
+    CotpIndication cotpIndication =
+            CotpConnection_sendConnectionRequestMessage(self->cotpConnection, params);
+
+    cotpIndication = CotpConnection_parseIncomingMessage(self->cotpConnection);
+
+    if (cotpIndication != CONNECT_INDICATION)
+        goto returnError;
+
+    /* Upper layers handshake */
+    sendAssociateRequest(self, params, payload, self->sendBuffer);
+
+    Semaphore_post(self->transmitBufferMutex);
 
-    self->callback(ISO_IND_ASSOCIATION_SUCCESS, self->callbackParameter, self->receivePayloadBuffer);
+    cotpIndication = CotpConnection_parseIncomingMessage(self->cotpConnection);
+
+    if (cotpIndication != DATA_INDICATION)
+        goto returnError;
+
+    if (!parseAssociateResponse(self, receiveBuffer))
+        goto returnError;
+
+    self->callback(ISO_IND_ASSOCIATION_SUCCESS, self->callbackParameter, &(receiveBuffer->payload));
 
     self->state = STATE_ASSOCIATED;
 
+    self->dispatchThread = Thread_create(dispatchThread, self, false);
+    Thread_start(self->dispatchThread);
+
     self->thread = Thread_create(connectionHandlingThread, self, false);
     Thread_start(self->thread);
 
     return;
 
     returnError:
+    self->receiveBuffers[0].isUsed = false;
+    self->statistics.buffersInUse = 0;
+
     self->callback(ISO_IND_ASSOCIATION_FAILED, self->callbackParameter, NULL);
 
     self->state = STATE_ERROR;
@@ -437,6 +746,320 @@ IsoClientConnection_associate(IsoClientConnection self, IsoConnectionParameters
     return;
 }
 
+static void
+releaseConnectionLayers(IsoClientConnection self)
+{
+    if (self->cotpConnection != NULL) {
+        CotpConnection_destroy(self->cotpConnection);
+        free(self->cotpConnection);
+        self->cotpConnection = NULL;
+    }
+
+    if (self->session != NULL) {
+        free(self->session);
+        self->session = NULL;
+    }
+
+    if (self->presentation != NULL) {
+        free(self->presentation);
+        self->presentation = NULL;
+    }
+}
+
+bool
+IsoClientConnection_startAssociation(IsoClientConnection self, IsoConnectionParameters params,
+        ByteBuffer* payload)
+{
+    /* the connection object can be reused for a new association */
+    releaseConnectionLayers(self);
+
+    self->state = STATE_IDLE;
+    self->asyncParameters = params;
+    self->asyncPayload = payload;
+    self->tpktBufferFill = 0;
+    self->currentReceiveBuffer = NULL;
+    self->receiverStalled = false;
+
+    if (self->tpktBuffer == NULL) {
+        self->tpktBufferSize = CONFIG_COTP_MAX_TPDU_SIZE + 4;
+        self->tpktBuffer = (uint8_t*) malloc(self->tpktBufferSize);
+    }
+
+    self->socket = TcpSocket_create();
+
+    self->cotpConnection = (CotpConnection*) calloc(1, sizeof(CotpConnection));
+    CotpConnection_init(self->cotpConnection, self->socket, NULL);
+
+    if (Socket_connectAsync(self->socket, params->hostname, params->tcpPort) == false) {
+        self->asyncState = ASYNC_STATE_IDLE;
+        return false;
+    }
+
+    self->asyncState = ASYNC_STATE_TCP_CONNECTING;
+
+    return true;
+}
+
+Socket
+IsoClientConnection_getSocket(IsoClientConnection self)
+{
+    return self->socket;
+}
+
+int
+IsoClientConnection_getSocketEvents(IsoClientConnection self)
+{
+    if (self->socket == NULL)
+        return 0;
+
+    if (self->asyncState == ASYNC_STATE_TCP_CONNECTING)
+        return SOCKET_EVENT_WRITE;
+
+    if (self->receiverStalled)
+        return 0;
+
+    return SOCKET_EVENT_READ;
+}
+
+bool
+IsoClientConnection_isReceiverStalled(IsoClientConnection self)
+{
+    return self->receiverStalled;
+}
+
+static int
+handleDataTpkt(IsoClientConnection self, uint8_t* tpkt, int tpktSize)
+{
+    IsoClientReceiveBuffer* receiveBuffer = self->currentReceiveBuffer;
+
+    if (receiveBuffer == NULL) {
+        receiveBuffer = getFreeReceiveBufferNonBlocking(self);
+
+        if (receiveBuffer == NULL)
+            return TPKT_STALLED;
+
+        self->currentReceiveBuffer = receiveBuffer;
+        self->cotpConnection->payload = &(receiveBuffer->cotpPayload);
+        receiveBuffer->cotpPayload.size = 0;
+    }
+
+    CotpIndication cotpIndication = CotpConnection_parseTpdu(self->cotpConnection, tpkt, tpktSize);
+
+    if (cotpIndication == OK)
+        return TPKT_CONSUMED;
+
+    self->currentReceiveBuffer = NULL;
+
+    if (cotpIndication != DATA_INDICATION)
+        goto exit_error;
+
+    if (self->asyncState == ASYNC_STATE_ASSOCIATING) {
+        if (!parseAssociateResponse(self, receiveBuffer))
+            goto exit_error;
+
+        self->state = STATE_ASSOCIATED;
+        self->asyncState = ASYNC_STATE_ASSOCIATED;
+
+        self->callback(ISO_IND_ASSOCIATION_SUCCESS, self->callbackParameter, &(receiveBuffer->payload));
+
+        return TPKT_CONSUMED;
+    }
+
+    if (IsoSession_parseMessage(self->session, CotpConnection_getPayload(self->cotpConnection)) != SESSION_DATA) {
+        if (DEBUG_ISO_CLIENT)
+            printf("ISO_CLIENT_CONNECTION: Invalid session message\n");
+        goto exit_error;
+    }
+
+    if (!IsoPresentation_parseUserData(self->presentation, IsoSession_getUserData(self->session))) {
+        if (DEBUG_ISO_CLIENT)
+            printf("ISO_CLIENT_CONNECTION: Invalid presentation message\n");
+        goto exit_error;
+    }
+
+    receiveBuffer->payload = self->presentation->nextPayload;
+
+    Semaphore_wait(self->receiveLock);
+    self->statistics.messagesReceived++;
+    Semaphore_post(self->receiveLock);
+
+    self->callback(ISO_IND_DATA, self->callbackParameter, &(receiveBuffer->payload));
+
+    return TPKT_CONSUMED;
+
+    exit_error:
+    releaseReceiveBuffer(self, receiveBuffer);
+    return TPKT_ERROR;
+}
+
+static int
+handleTpkt(IsoClientConnection self, uint8_t* tpkt, int tpktSize)
+{
+    if (self->asyncState == ASYNC_STATE_COTP_CONNECTING) {
+        if (CotpConnection_parseTpdu(self->cotpConnection, tpkt, tpktSize) != CONNECT_INDICATION)
+            return TPKT_ERROR;
+
+        bool sent = sendAssociateRequest(self, self->asyncParameters, self->asyncPayload, self->asyncSendBuffer);
+
+        if (sent == false)
+            return TPKT_ERROR;
+
+        self->asyncState = ASYNC_STATE_ASSOCIATING;
+
+        return TPKT_CONSUMED;
+    }
+
+    return handleDataTpkt(self, tpkt, tpktSize);
+}
+
+/* frame and handle the complete TPKTs in the receive buffer */
+static bool
+handleReceivedData(IsoClientConnection self)
+{
+    int pos = 0;
+    bool success = true;
+
+    while ((self->tpktBufferFill - pos) >= 4) {
+        uint8_t* tpkt = self->tpktBuffer + pos;
+
+        if ((tpkt[0] != 3) || (tpkt[1] != 0)) {
+            success = false;
+            break;
+        }
+
+        int tpktSize = (tpkt[2] << 8) + tpkt[3];
+
+        if (tpktSize < 7) {
+            success = false;
+            break;
+        }
+
+        if ((self->tpktBufferFill - pos) < tpktSize) {
+
+            /* TPKT is larger than the negotiated TPDU size */
+            if (tpktSize > self->tpktBufferSize) {
+                self->tpktBufferSize = tpktSize;
+                self->tpktBuffer = (uint8_t*) realloc(self->tpktBuffer, self->tpktBufferSize);
+            }
+
+            break;
+        }
+
+        int result = handleTpkt(self, self->tpktBuffer + pos, tpktSize);
+
+        if (result == TPKT_STALLED)
+            break;
+
+        if (result == TPKT_ERROR) {
+            success = false;
+            break;
+        }
+
+        pos += tpktSize;
+    }
+
+    if (pos > 0) {
+        self->tpktBufferFill -= pos;
+        memmove(self->tpktBuffer, self->tpktBuffer + pos, self->tpktBufferFill);
+    }
+
+    return success;
+}
+
+bool
+IsoClientConnection_handleSocketEvent(IsoClientConnection self, int events)
+{
+    if (self->socket == NULL)
+        return false;
+
+    if (self->asyncState == ASYNC_STATE_TCP_CONNECTING) {
+        if (events == 0)
+            return true;
+
+        SocketState socketState = Socket_checkAsyncConnectState(self->socket);
+
+        if (socketState == SOCKET_STATE_CONNECTING)
+            return true;
+
+        if (socketState == SOCKET_STATE_FAILED)
+            return false;
+
+        if (CotpConnection_sendConnectionRequestMessage(self->cotpConnection, self->asyncParameters) != OK)
+            return false;
+
+        self->asyncState = ASYNC_STATE_COTP_CONNECTING;
+
+        return true;
+    }
+
+    if (events & SOCKET_EVENT_READ) {
+        int readBytes = Socket_read(self->socket, self->tpktBuffer + self->tpktBufferFill,
+                self->tpktBufferSize - self->tpktBufferFill);
+
+        /* the socket is readable - no data means the connection has been closed */
+        if (readBytes <= 0)
+            return false;
+
+        self->tpktBufferFill += readBytes;
+    }
+    else if (events & SOCKET_EVENT_ERROR)
+        return false;
+
+    return handleReceivedData(self);
+}
+
+void
+IsoClientConnection_shutdown(IsoClientConnection self)
+{
+    int asyncState = self->asyncState;
+
+    if (DEBUG_ISO_CLIENT)
+        printf("ISO_CLIENT: IsoClientConnection_shutdown\n");
+
+    /* unblock a user thread that is sending - then wait until it has released the transmit buffer
+     * before the socket is destroyed. Otherwise the user thread could write to a reused file descriptor. */
+    if (self->socket != NULL)
+        Socket_shutdown(self->socket);
+
+    Semaphore_wait(self->transmitBufferMutex);
+
+    self->state = STATE_IDLE;
+    self->asyncState = ASYNC_STATE_IDLE;
+
+    if (self->socket != NULL) {
+        Socket_destroy(self->socket);
+        self->socket = NULL;
+    }
+
+    Semaphore_post(self->transmitBufferMutex);
+
+    if (self->currentReceiveBuffer != NULL) {
+        releaseReceiveBuffer(self, self->currentReceiveBuffer);
+        self->currentReceiveBuffer = NULL;
+    }
+
+    self->tpktBufferFill = 0;
+    self->receiverStalled = false;
+
+    if (asyncState == ASYNC_STATE_ASSOCIATED)
+        self->callback(ISO_IND_CLOSED, self->callbackParameter, NULL);
+    else if (asyncState != ASYNC_STATE_IDLE)
+        self->callback(ISO_IND_ASSOCIATION_FAILED, self->callbackParameter, NULL);
+}
+
+ByteBuffer*
+IsoClientConnection_getAssociationBuffer(IsoClientConnection self)
+{
+    if (self->asyncSendBuffer == NULL) {
+        self->asyncSendBuffer = (uint8_t*) malloc(ISO_CLIENT_BUFFER_SIZE);
+        ByteBuffer_wrap(&(self->asyncPayloadBuffer), self->asyncSendBuffer, 0, ISO_CLIENT_BUFFER_SIZE);
+    }
+
+    self->asyncPayloadBuffer.size = 0;
+
+    return &(self->asyncPayloadBuffer);
+}
+
 ByteBuffer*
 IsoClientConnection_allocateTransmitBuffer(IsoClientConnection self)
 {
@@ -447,7 +1070,34 @@ IsoClientConnection_allocateTransmitBuffer(IsoClientConnection self)
 }
 
 void
-IsoClientConnection_releaseReceiveBuffer(IsoClientConnection self)
+IsoClientConnection_releaseTransmitBuffer(IsoClientConnection self)
+{
+    Semaphore_post(self->transmitBufferMutex);
+}
+
+void
+IsoClientConnection_releaseReceiveBuffer(IsoClientConnection self, ByteBuffer* payload)
 {
-    Semaphore_post(self->receiveBufferMutex);
+    int i;
+
+    for (i = 0; i < ISO_CLIENT_RECEIVE_BUFFERS; i++) {
+        if (payload == &(self->receiveBuffers[i].payload)) {
+            releaseReceiveBuffer(self, &(self->receiveBuffers[i]));
+            return;
+        }
+    }
+
+    if (DEBUG_ISO_CLIENT)
+        printf("ISO_CLIENT: IsoClientConnection_releaseReceiveBuffer: unknown buffer!\n");
+}
+
+void
+IsoClientConnection_getReceiveStatistics(IsoClientConnection self, IsoClientReceiveStatistics* statistics)
+{
+    Semaphore_wait(self->receiveLock);
+
+    *statistics = self->statistics;
+    statistics->queueDepth = self->receiveQueueSize;
+
+    Semaphore_post(self->receiveLock);
 }
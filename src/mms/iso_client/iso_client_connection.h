@@ -30,6 +30,7 @@
 
 #include "byte_buffer.h"
 #include "iso_connection_parameters.h"
+#include "socket.h"
 
 typedef enum
 {
@@ -57,6 +58,63 @@ void
 IsoClientConnection_associate(IsoClientConnection self, IsoConnectionParameters params,
         ByteBuffer* payload);
 
+/**
+ * Start an association without blocking (event driven operation).
+ *
+ * The socket has to be monitored by the caller (IsoClientConnection_getSocket/getSocketEvents) and
+ * events have to be passed to IsoClientConnection_handleSocketEvent. The payload (the association request of
+ * the application layer) has to be written to the buffer returned by IsoClientConnection_getAssociationBuffer.
+ * The transmit buffer is not used, so the calling thread never waits for API client threads. All indications
+ * are delivered by the thread that calls IsoClientConnection_handleSocketEvent or IsoClientConnection_shutdown.
+ * The connection can be reused for a new association after IsoClientConnection_shutdown.
+ *
+ * \return false if the TCP connect cannot be started (IsoClientConnection_shutdown has to be called)
+ */
+bool
+IsoClientConnection_startAssociation(IsoClientConnection self, IsoConnectionParameters params,
+        ByteBuffer* payload);
+
+/**
+ * Buffer for the payload of IsoClientConnection_startAssociation. It is separate from the transmit
+ * buffer and doesn't have to be allocated or released.
+ */
+ByteBuffer*
+IsoClientConnection_getAssociationBuffer(IsoClientConnection self);
+
+Socket
+IsoClientConnection_getSocket(IsoClientConnection self);
+
+/**
+ * Socket events (SOCKET_EVENT_READ/SOCKET_EVENT_WRITE) the connection is waiting for. Returns 0
+ * while the receiver is stalled because no receive buffer is free.
+ */
+int
+IsoClientConnection_getSocketEvents(IsoClientConnection self);
+
+/**
+ * Returns true when received data cannot be processed because all receive buffers are in use. In this case
+ * IsoClientConnection_handleSocketEvent has to be called (with events = 0) after receive buffers have been released.
+ */
+bool
+IsoClientConnection_isReceiverStalled(IsoClientConnection self);
+
+/**
+ * Handle socket events (SOCKET_EVENT_*) of an event driven connection.
+ *
+ * \return false if the connection failed or has been closed by the peer (IsoClientConnection_shutdown has to be called)
+ */
+bool
+IsoClientConnection_handleSocketEvent(IsoClientConnection self, int events);
+
+/**
+ * Close the socket of an event driven connection. Indicates ISO_IND_CLOSED if the connection was associated
+ * or ISO_IND_ASSOCIATION_FAILED if the association was in progress.
+ *
+ * The socket is shut down first. It is destroyed when no API client thread holds the transmit buffer.
+ */
+void
+IsoClientConnection_shutdown(IsoClientConnection self);
+
 void
 IsoClientConnection_sendMessage(IsoClientConnection self, ByteBuffer* payload);
 
@@ -76,13 +134,37 @@ IsoClientConnection_close(IsoClientConnection self);
 ByteBuffer*
 IsoClientConnection_allocateTransmitBuffer(IsoClientConnection self);
 
+/**
+ * Release the transmit buffer without sending a message (e.g. if the request cannot be sent).
+ * IsoClientConnection_sendMessage releases the buffer automatically.
+ */
+void
+IsoClientConnection_releaseTransmitBuffer(IsoClientConnection self);
+
 /*
  * The client should release the receive buffer in order for the IsoClientConnection to
- * reuse the buffer! If this function is not called then the reception of messages is
- * blocked!
+ * reuse the buffer! Messages are received into a small set of buffers. If the buffers
+ * are not released the reception of messages is blocked!
+ *
+ * \param payload the payload buffer passed to the IsoIndicationCallback
  */
 void
-IsoClientConnection_releaseReceiveBuffer(IsoClientConnection self);
+IsoClientConnection_releaseReceiveBuffer(IsoClientConnection self, ByteBuffer* payload);
+
+/**
+ * Statistics of the receive path of an IsoClientConnection
+ */
+typedef struct {
+    uint32_t messagesReceived; /* number of received data messages */
+    uint32_t receiverStalls; /* number of times the receiver had to wait for a free receive buffer */
+    int queueDepth; /* number of received messages waiting to be processed */
+    int maxQueueDepth; /* maximum number of messages waiting to be processed */
+    int buffersInUse; /* number of receive buffers not yet released by the API client */
+    int maxBuffersInUse; /* maximum number of receive buffers in use at the same time */
+} IsoClientReceiveStatistics;
+
+void
+IsoClientConnection_getReceiveStatistics(IsoClientConnection self, IsoClientReceiveStatistics* statistics);
 
 void*
 IsoClientConnection_getSecurityToken(IsoClientConnection self);
@@ -31,6 +31,7 @@
 #include "byte_stream.h"
 #include "byte_buffer.h"
 #include "buffer_chain.h"
+#include "trace.h"
 
 #define COTP_RFC1006_HEADER_SIZE 4
 
@@ -178,9 +179,6 @@ CotpConnection_sendDataMessage(CotpConnection* self, BufferChain payload)
     BufferChain currentChain = payload;
     int currentChainIndex = 0;
 
-    if (DEBUG_COTP)
-        printf("\nCOTP: nextBufferPart: len:%i partLen:%i\n", currentChain->length, currentChain->partLength);
-
     uint8_t* buffer = self->writeBuffer->buffer;
 
     while (fragments > 0) {
@@ -204,14 +202,9 @@ CotpConnection_sendDataMessage(CotpConnection* self, BufferChain payload)
 
             if (currentChainIndex >= currentChain->partLength) {
                 currentChain = currentChain->nextPart;
-                if (DEBUG_COTP)
-                    printf("\nCOTP: nextBufferPart: len:%i partLen:%i\n", currentChain->length, currentChain->partLength);
                 currentChainIndex = 0;
             }
 
-            if (DEBUG_COTP)
-                printf("%02x ", currentChain->buffer[currentChainIndex]);
-
             buffer[bufPos++] = currentChain->buffer[currentChainIndex];
 
             currentChainIndex++;
@@ -221,8 +214,7 @@ CotpConnection_sendDataMessage(CotpConnection* self, BufferChain payload)
 
         self->writeBuffer->size = bufPos;
 
-        if (DEBUG_COTP)
-            printf("COTP: Send COTP fragment %i bufpos: %i\n", fragments, currentBufPos);
+        TRACE2(TRACE_COTP_DATA_SENT, bufPos - 7, lastUnit);
 
         if (!sendBuffer(self))
             return ERROR;
@@ -579,13 +571,14 @@ addPayloadToBuffer(CotpConnection* self, int rfc1006Length)
             payloadLength);
 
     if (readLength != payloadLength) {
-        if (DEBUG_COTP)
-            printf("COTP: read %i bytes should have been %i\n", readLength, payloadLength);
+        TRACE2(TRACE_COTP_READ_ERROR, readLength, payloadLength);
         return 0;
     }
     else {
         self->payload->size += payloadLength;
 
+        TRACE2(TRACE_COTP_DATA_RECEIVED, payloadLength, self->isLastDataUnit);
+
         if (self->isLastDataUnit == false) {
             if (parseIncomingMessage(self) == DATA_INDICATION)
                 return 1;
@@ -649,3 +642,128 @@ CotpConnection_parseIncomingMessage(CotpConnection* self)
 
     return parseIncomingMessage(self);
 }
+
+static int
+parseOptionsFromBuffer(CotpConnection* self, uint8_t* buffer, int optLen)
+{
+    int pos = 0;
+
+    while (pos < optLen) {
+
+        if ((pos + 2) > optLen)
+            return -1;
+
+        uint8_t optionType = buffer[pos++];
+        uint8_t optionLen = buffer[pos++];
+
+        if ((pos + optionLen) > optLen)
+            return -1;
+
+        if (DEBUG_COTP)
+            printf("COTP: option: %02x len: %02x\n", optionType, optionLen);
+
+        switch (optionType) {
+        case 0xc0:
+            if (optionLen == 1)
+                CotpConnection_setTpduSize(self, (1 << buffer[pos]));
+            else
+                return -1;
+            break;
+        case 0xc1:
+            if (optionLen == 2)
+                self->options.tsap_id_src = (int32_t) ((buffer[pos] << 8) + buffer[pos + 1]);
+            else
+                return -1;
+            break;
+        case 0xc2:
+            if (optionLen == 2)
+                self->options.tsap_id_dst = (int32_t) ((buffer[pos] << 8) + buffer[pos + 1]);
+            else
+                return -1;
+            break;
+        default:
+            if (DEBUG_COTP)
+                printf("COTP: Unknown option %02x\n", optionType);
+            break;
+        }
+
+        pos += optionLen;
+    }
+
+    return 1;
+}
+
+CotpIndication
+CotpConnection_parseTpdu(CotpConnection* self, uint8_t* buffer, int size)
+{
+    if (size < 7)
+        return ERROR;
+
+    if ((buffer[0] != 3) || (buffer[1] != 0))
+        return ERROR;
+
+    int rfc1006Length = (buffer[2] << 8) + buffer[3];
+
+    if (rfc1006Length != size)
+        return ERROR;
+
+    uint8_t len = buffer[4];
+    uint8_t tpduType = buffer[5];
+
+    if ((len + 5) > size)
+        return ERROR;
+
+    switch (tpduType) {
+    case 0xe0: /* CR */
+    case 0xd0: /* CC */
+        if (len < 6)
+            return ERROR;
+
+        if (tpduType == 0xe0) {
+            self->dstRef = (buffer[6] << 8) + buffer[7];
+            self->srcRef = (buffer[8] << 8) + buffer[9];
+        }
+        else {
+            self->srcRef = (buffer[6] << 8) + buffer[7];
+            self->dstRef = (buffer[8] << 8) + buffer[9];
+            self->isLastDataUnit = true;
+        }
+
+        self->protocolClass = buffer[10];
+
+        if (parseOptionsFromBuffer(self, buffer + 11, len - 6) == 1)
+            return CONNECT_INDICATION;
+        else
+            return ERROR;
+
+    case 0xf0: /* DT */
+        {
+            if (len != 2)
+                return ERROR;
+
+            /* start a new message when the previous data unit was the last one */
+            if (self->isLastDataUnit)
+                self->payload->size = 0;
+
+            self->isLastDataUnit = ((buffer[6] & 0x80) != 0);
+
+            int payloadLength = size - 7;
+
+            if ((self->payload->size + payloadLength) > self->payload->maxSize)
+                return ERROR;
+
+            memcpy(self->payload->buffer + self->payload->size, buffer + 7, payloadLength);
+            self->payload->size += payloadLength;
+
+            TRACE2(TRACE_COTP_DATA_RECEIVED, payloadLength, self->isLastDataUnit);
+
+            if (self->isLastDataUnit)
+                return DATA_INDICATION;
+            else
+                return OK;
+        }
+
+    default:
+        return ERROR;
+    }
+}
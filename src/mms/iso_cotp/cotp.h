@@ -68,6 +68,18 @@ CotpConnection_destroy(CotpConnection* self);
 CotpIndication
 CotpConnection_parseIncomingMessage(CotpConnection* self);
 
+/**
+ * \brief Parse a complete TPKT (RFC 1006 header + TPDU) that has already been received
+ *
+ * Non-blocking alternative to CotpConnection_parseIncomingMessage for event driven connections.
+ * Segmented data units are collected in the payload buffer.
+ *
+ * \return CONNECT_INDICATION for CR/CC TPDUs, DATA_INDICATION when the last data unit of a
+ *         message has been received, OK when more data units are expected, ERROR otherwise
+ */
+CotpIndication
+CotpConnection_parseTpdu(CotpConnection* self, uint8_t* buffer, int size);
+
 CotpIndication
 CotpConnection_sendConnectionRequestMessage(CotpConnection* self, IsoConnectionParameters isoParameters);
 
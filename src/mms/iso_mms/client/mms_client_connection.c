@@ -32,15 +32,119 @@
 
 #include "byte_buffer.h"
 #include "ber_decode.h"
+#include "ber_encoder.h"
 
 #include <assert.h>
 
 #define CONFIG_MMS_CONNECTION_DEFAULT_TIMEOUT 5000
-#define OUTSTANDING_CALLS 10
+#define OUTSTANDING_CALLS_MIN_TABLE_SIZE 16
+
+static bool
+addReportAccessResult(MmsConnection self, int index, int bufPos)
+{
+    if (index >= self->reportAccessResultsSize) {
+        int newSize = (self->reportAccessResultsSize == 0) ? 32 : (2 * self->reportAccessResultsSize);
+
+        int* newAccessResults = (int*) realloc(self->reportAccessResults, newSize * sizeof(int));
+
+        if (newAccessResults == NULL)
+            return false;
+
+        self->reportAccessResults = newAccessResults;
+        self->reportAccessResultsSize = newSize;
+    }
+
+    self->reportAccessResults[index] = bufPos;
+
+    return true;
+}
+
+/*
+ * Handle information reports with a VMD specific variable list name without creating the asn1c
+ * structures and MmsValue instances. Returns false if the message is not such an information report.
+ */
+static bool
+handleEncodedInformationReport(MmsConnection self, ByteBuffer* message)
+{
+    uint8_t* buffer = ByteBuffer_getBuffer(message);
+    int maxBufPos = ByteBuffer_getSize(message);
+    int bufPos = 1;
+    int length;
+
+    /* unconfirmed-PDU */
+    bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, maxBufPos);
+    if (bufPos < 0)
+        return false;
+
+    /* informationReport */
+    if ((bufPos >= maxBufPos) || (buffer[bufPos++] != 0xa0))
+        return false;
+
+    bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, maxBufPos);
+    if (bufPos < 0)
+        return false;
+
+    /* variableListName */
+    if ((bufPos >= maxBufPos) || (buffer[bufPos++] != 0xa1))
+        return false;
+
+    bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, maxBufPos);
+    if (bufPos < 0)
+        return false;
+
+    /* vmd-specific */
+    if ((bufPos >= maxBufPos) || (buffer[bufPos++] != 0x80))
+        return false;
+
+    bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, maxBufPos);
+    if ((bufPos < 0) || (length < 0) || (length > 64) || (bufPos + length > maxBufPos))
+        return false;
+
+    char variableListName[65];
+
+    memcpy(variableListName, buffer + bufPos, length);
+    variableListName[length] = 0;
+
+    bufPos += length;
+
+    /* listOfAccessResult */
+    if ((bufPos >= maxBufPos) || (buffer[bufPos++] != 0xa0))
+        return false;
+
+    bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, maxBufPos);
+    if ((bufPos < 0) || (length < 0) || (bufPos + length > maxBufPos))
+        return false;
+
+    int endPos = bufPos + length;
+    int accessResultCount = 0;
+
+    while (bufPos < endPos) {
+        if (!addReportAccessResult(self, accessResultCount, bufPos))
+            return false;
+
+        accessResultCount++;
+
+        bufPos = BerDecoder_decodeLength(buffer, &length, bufPos + 1, endPos);
+        if ((bufPos < 0) || (length < 0) || (bufPos + length > endPos))
+            return false;
+
+        bufPos += length;
+    }
+
+    self->encodedReportHandler(self->encodedReportHandlerParameter, variableListName, buffer, endPos,
+            self->reportAccessResults, accessResultCount);
+
+    return true;
+}
 
 static void
 handleUnconfirmedMmsPdu(MmsConnection self, ByteBuffer* message)
 {
+    if (self->encodedReportHandler != NULL) {
+        if (handleEncodedInformationReport(self, message))
+            return;
+    }
+
     if (self->reportHandler != NULL) {
         MmsPdu_t* mmsPdu = 0; /* allow asn1c to allocate structure */
 
@@ -218,145 +322,374 @@ getNextInvokeId(MmsConnection self)
     return nextInvokeId;
 }
 
-static bool
-checkForOutstandingCall(MmsConnection self, uint32_t invokeId)
+static void
+createOutstandingCallsTable(MmsConnection self, int maxOutstandingCalls)
 {
-    int i = 0;
+    int tableSize = OUTSTANDING_CALLS_MIN_TABLE_SIZE;
 
-    Semaphore_wait(self->outstandingCallsLock);
+    /* keep the load factor below 0.5 */
+    while (tableSize < (2 * maxOutstandingCalls))
+        tableSize = tableSize * 2;
 
-    for (i = 0; i < OUTSTANDING_CALLS; i++) {
-        if (self->outstandingCalls[i] == invokeId) {
-            Semaphore_post(self->outstandingCallsLock);
-            return true;
-        }
+    self->outstandingCalls = (struct sMmsOutstandingCall*) calloc(tableSize, sizeof(struct sMmsOutstandingCall));
+    self->outstandingCallsTableSize = tableSize;
+    self->outstandingCallsCount = 0;
+    self->maxOutstandingCalls = maxOutstandingCalls;
+
+    int i;
+
+    for (i = 0; i < tableSize; i++)
+        self->outstandingCalls[i].responseReceived = Semaphore_create(0);
+}
+
+static void
+destroyOutstandingCallsTable(MmsConnection self)
+{
+    int i;
+
+    for (i = 0; i < self->outstandingCallsTableSize; i++)
+        Semaphore_destroy(self->outstandingCalls[i].responseReceived);
+
+    free(self->outstandingCalls);
+}
+
+/* has to be called with outstandingCallsLock held */
+static MmsOutstandingCall
+lookupOutstandingCall(MmsConnection self, uint32_t invokeId)
+{
+    int mask = self->outstandingCallsTableSize - 1;
+    int i;
+
+    for (i = 0; i < self->outstandingCallsTableSize; i++) {
+        MmsOutstandingCall call = &(self->outstandingCalls[(invokeId + i) & mask]);
+
+        if ((call->isUsed) && (call->invokeId == invokeId))
+            return call;
     }
 
-    Semaphore_post(self->outstandingCallsLock);
+    return NULL;
+}
+
+/* has to be called with outstandingCallsLock held */
+static void
+removeFromOutstandingCalls(MmsConnection self, MmsOutstandingCall call)
+{
+    call->isUsed = false;
+    self->outstandingCallsCount--;
 
-    return false;
+    if (self->outstandingCallSlotWaiters > 0)
+        Semaphore_post(self->outstandingCallSlotFreed);
 }
 
+/*
+ * reserve a slot in the window of outstanding calls. Blocks while the window is full. Has to be called
+ * before the transmit buffer is allocated - the slots are freed by the receive thread that may have
+ * to send a message itself.
+ */
 static bool
-addToOutstandingCalls(MmsConnection self, uint32_t invokeId)
+reserveOutstandingCallSlot(MmsConnection self, MmsError* mmsError)
 {
-    int i = 0;
+    uint64_t timeout = Hal_getTimeInMs() + self->requestTimeout;
 
-    Semaphore_wait(self->outstandingCallsLock);
+    while (true) {
+        if (self->associationState != MMS_STATE_CONNECTED) {
+            *mmsError = MMS_ERROR_CONNECTION_LOST;
+            return false;
+        }
+
+        Semaphore_wait(self->outstandingCallsLock);
+
+        if (self->outstandingCallsCount < self->maxOutstandingCalls) {
+            self->outstandingCallsCount++;
 
-    for (i = 0; i < OUTSTANDING_CALLS; i++) {
-        if (self->outstandingCalls[i] == 0) {
-            self->outstandingCalls[i] = invokeId;
             Semaphore_post(self->outstandingCallsLock);
+
             return true;
         }
+
+        self->outstandingCallSlotWaiters++;
+
+        Semaphore_post(self->outstandingCallsLock);
+
+        uint64_t currentTime = Hal_getTimeInMs();
+
+        if (currentTime < timeout)
+            Semaphore_waitWithTimeout(self->outstandingCallSlotFreed, (int) (timeout - currentTime));
+
+        Semaphore_wait(self->outstandingCallsLock);
+        self->outstandingCallSlotWaiters--;
+        Semaphore_post(self->outstandingCallsLock);
+
+        if (Hal_getTimeInMs() >= timeout) {
+            if (DEBUG_MMS_CLIENT)
+                printf("MMS_CLIENT: TIMEOUT waiting for free slot\n");
+
+            *mmsError = MMS_ERROR_SERVICE_TIMEOUT;
+            return false;
+        }
     }
+}
+
+static void
+releaseOutstandingCallSlot(MmsConnection self)
+{
+    Semaphore_wait(self->outstandingCallsLock);
+
+    self->outstandingCallsCount--;
+
+    if (self->outstandingCallSlotWaiters > 0)
+        Semaphore_post(self->outstandingCallSlotFreed);
 
     Semaphore_post(self->outstandingCallsLock);
+}
+
+/*
+ * allocate the transmit buffer for a new request. Returns NULL if no slot in the window of outstanding
+ * calls became free within the request timeout or the connection is lost (mmsError is set accordingly).
+ */
+static ByteBuffer*
+allocateRequestBuffer(MmsConnection self, MmsError* mmsError)
+{
+    if (reserveOutstandingCallSlot(self, mmsError) == false)
+        return NULL;
 
-    return false;
+    return IsoClientConnection_allocateTransmitBuffer(self->isoClient);
 }
 
-static void
-removeFromOutstandingCalls(MmsConnection self, uint32_t invokeId)
+/*
+ * add a request to the outstanding calls table. Uses the slot reserved by allocateRequestBuffer. The table
+ * has at least twice as many entries as the window, so there is always a free entry.
+ */
+static MmsOutstandingCall
+addToOutstandingCalls(MmsConnection self, uint32_t invokeId, MmsOutstandingCallHandler handler,
+        void* userCallback, void* userParameter, void* internalParameter, MmsError* mmsError)
 {
-    int i = 0;
+    MmsOutstandingCall call = NULL;
 
     Semaphore_wait(self->outstandingCallsLock);
 
-    for (i = 0; i < OUTSTANDING_CALLS; i++) {
-        if (self->outstandingCalls[i] == invokeId) {
-            self->outstandingCalls[i] = 0;
-            break;
+    if (self->associationState == MMS_STATE_CONNECTED) {
+        int mask = self->outstandingCallsTableSize - 1;
+        int i;
+
+        for (i = 0; i < self->outstandingCallsTableSize; i++) {
+            MmsOutstandingCall entry = &(self->outstandingCalls[(invokeId + i) & mask]);
+
+            if (entry->isUsed == false) {
+                call = entry;
+                break;
+            }
         }
     }
 
+    if (call != NULL) {
+        call->isUsed = true;
+        call->invokeId = invokeId;
+        call->timeout = Hal_getTimeInMs() + self->requestTimeout;
+        call->handler = handler;
+        call->userCallback = userCallback;
+        call->userParameter = userParameter;
+        call->internalParameter = internalParameter;
+        call->completed = false;
+        call->response = NULL;
+        call->error = MMS_ERROR_NONE;
+    }
+
     Semaphore_post(self->outstandingCallsLock);
+
+    if (call == NULL) {
+        *mmsError = MMS_ERROR_CONNECTION_LOST;
+        releaseOutstandingCallSlot(self);
+    }
+
+    return call;
 }
 
-static ByteBuffer*
-sendRequestAndWaitForResponse(MmsConnection self, uint32_t invokeId, ByteBuffer* message)
+/* complete all asynchronous requests that have timed out or all outstanding requests if connection is lost */
+static void
+completeOutstandingCalls(MmsConnection self, bool connectionLost)
 {
-    ByteBuffer* receivedMessage = NULL;
+    while (true) {
+        struct sMmsOutstandingCall expiredCall;
+        bool found = false;
+        int i;
 
-    uint64_t startTime = Hal_getTimeInMs();
+        uint64_t currentTime = Hal_getTimeInMs();
 
-    uint64_t waitUntilTime = startTime + self->requestTimeout;
+        Semaphore_wait(self->outstandingCallsLock);
 
-    uint64_t currentTime = startTime;
+        for (i = 0; i < self->outstandingCallsTableSize; i++) {
+            MmsOutstandingCall call = &(self->outstandingCalls[i]);
 
-    bool success = false;
+            if ((call->isUsed == false) || (call->completed))
+                continue;
+
+            if (call->handler == NULL) {
+                /* synchronous requests handle timeouts by themselves */
+                if (connectionLost) {
+                    call->error = MMS_ERROR_CONNECTION_LOST;
+                    call->completed = true;
+                    Semaphore_post(call->responseReceived);
+                }
+            }
+            else if (connectionLost || (call->timeout <= currentTime)) {
+                expiredCall = *call;
+                removeFromOutstandingCalls(self, call);
+                found = true;
+                break;
+            }
+        }
 
-    addToOutstandingCalls(self, invokeId);
+        Semaphore_post(self->outstandingCallsLock);
 
-    IsoClientConnection_sendMessage(self->isoClient, message);
+        if (found == false)
+            break;
 
-    while (currentTime < waitUntilTime) {
-        uint32_t receivedInvokeId;
+        if (DEBUG_MMS_CLIENT)
+            printf("MMS_CLIENT: request %u failed (%s)\n", expiredCall.invokeId,
+                    connectionLost ? "connection lost" : "timeout");
 
-        if (self->associationState == MMS_STATE_CLOSED)
-            goto connection_lost;
+        expiredCall.handler(self, &expiredCall,
+                connectionLost ? MMS_ERROR_CONNECTION_LOST : MMS_ERROR_SERVICE_TIMEOUT, NULL, 0);
+    }
 
-        Semaphore_wait(self->lastResponseLock);
-        receivedInvokeId = self->responseInvokeId;
-        Semaphore_post(self->lastResponseLock);
+    if ((connectionLost == false) && (self->timeoutHandler != NULL))
+        self->timeoutHandler(self->timeoutHandlerParameter);
+}
 
-        if (receivedInvokeId == invokeId) {
-            receivedMessage = self->lastResponse;
-            success = true;
-            break;
-        }
+/* called by the receive thread. The receive buffer is released here or by the waiting user thread. */
+static void
+handleResponse(MmsConnection self, uint32_t invokeId, ByteBuffer* response, int bufPos, MmsError mmsError)
+{
+    Semaphore_wait(self->outstandingCallsLock);
 
-        Thread_sleep(10);
+    MmsOutstandingCall call = lookupOutstandingCall(self, invokeId);
 
-        currentTime = Hal_getTimeInMs();
-    }
+    if ((call == NULL) || (call->completed)) {
+        Semaphore_post(self->outstandingCallsLock);
 
-    if (!success) {
         if (DEBUG_MMS_CLIENT)
-            printf("TIMEOUT for request %u: \n", invokeId);
-        self->lastResponseError = MMS_ERROR_SERVICE_TIMEOUT;
+            printf("MMS_CLIENT: unexpected message from server!\n");
+
+        IsoClientConnection_releaseReceiveBuffer(self->isoClient, response);
+        return;
     }
 
-    connection_lost:
+    if (call->handler == NULL) {
+        /* synchronous request - hand over the receive buffer to the waiting thread */
+        if (mmsError == MMS_ERROR_NONE) {
+            call->response = response;
+            call->responseBufPos = bufPos;
+        }
 
-    removeFromOutstandingCalls(self, invokeId);
+        call->error = mmsError;
+        call->completed = true;
 
-    return receivedMessage;
-}
+        Semaphore_post(self->outstandingCallsLock);
 
-static void
-releaseResponse(MmsConnection self)
-{
-    Semaphore_wait(self->lastResponseLock);
-    self->responseInvokeId = 0;
-    self->lastResponseError = MMS_ERROR_NONE;
-    Semaphore_post(self->lastResponseLock);
+        if (mmsError != MMS_ERROR_NONE)
+            IsoClientConnection_releaseReceiveBuffer(self->isoClient, response);
 
-    IsoClientConnection_releaseReceiveBuffer(self->isoClient);
+        Semaphore_post(call->responseReceived);
+    }
+    else {
+        struct sMmsOutstandingCall completedCall = *call;
+
+        removeFromOutstandingCalls(self, call);
+
+        Semaphore_post(self->outstandingCallsLock);
+
+        if (mmsError == MMS_ERROR_NONE)
+            completedCall.handler(self, &completedCall, MMS_ERROR_NONE, response, bufPos);
+        else
+            completedCall.handler(self, &completedCall, mmsError, NULL, 0);
+
+        IsoClientConnection_releaseReceiveBuffer(self->isoClient, response);
+    }
 }
 
-static uint32_t
-getResponseInvokeId(MmsConnection self)
+/*
+ * Send a request and wait for the response. Returns the response or NULL in case of an error
+ * (mmsError is set accordingly). The response has to be released with releaseResponse.
+ * If responseBufPos is not NULL it is set to the position after the invokeId of the response.
+ */
+static ByteBuffer*
+sendRequestAndWaitForResponse(MmsConnection self, uint32_t invokeId, ByteBuffer* message, int* responseBufPos,
+        MmsError* mmsError)
 {
-    uint32_t currentInvokeId;
+    MmsOutstandingCall call = addToOutstandingCalls(self, invokeId, NULL, NULL, NULL, NULL, mmsError);
+
+    if (call == NULL) {
+        IsoClientConnection_releaseTransmitBuffer(self->isoClient);
+        return NULL;
+    }
+
+    IsoClientConnection_sendMessage(self->isoClient, message);
+
+    if (Semaphore_waitWithTimeout(call->responseReceived, self->requestTimeout) == false) {
+        bool completed;
+
+        Semaphore_wait(self->outstandingCallsLock);
+
+        completed = call->completed;
+
+        if (completed == false)
+            removeFromOutstandingCalls(self, call);
+
+        Semaphore_post(self->outstandingCallsLock);
+
+        if (completed == false) {
+            if (DEBUG_MMS_CLIENT)
+                printf("TIMEOUT for request %u: \n", invokeId);
+
+            *mmsError = MMS_ERROR_SERVICE_TIMEOUT;
+            return NULL;
+        }
+
+        /* response arrived concurrently with the timeout - consume the signal */
+        Semaphore_wait(call->responseReceived);
+    }
+
+    Semaphore_wait(self->outstandingCallsLock);
+
+    ByteBuffer* response = call->response;
+
+    if (responseBufPos != NULL)
+        *responseBufPos = call->responseBufPos;
+
+    if (call->error != MMS_ERROR_NONE)
+        *mmsError = call->error;
 
-    Semaphore_wait(self->lastResponseLock);
-    currentInvokeId = self->responseInvokeId;
-    Semaphore_post(self->lastResponseLock);
+    removeFromOutstandingCalls(self, call);
 
-    return currentInvokeId;
+    Semaphore_post(self->outstandingCallsLock);
+
+    return response;
 }
 
 static void
-waitUntilLastResponseHasBeenProcessed(MmsConnection self)
+releaseResponse(MmsConnection self, ByteBuffer* response)
+{
+    if (response != NULL)
+        IsoClientConnection_releaseReceiveBuffer(self->isoClient, response);
+}
+
+/* send a request without waiting for the response. Returns the invokeId or 0 in case of an error. */
+static uint32_t
+sendAsyncRequest(MmsConnection self, uint32_t invokeId, ByteBuffer* message, MmsOutstandingCallHandler handler,
+        void* userCallback, void* userParameter, void* internalParameter, MmsError* mmsError)
 {
-    uint32_t currentInvokeId = getResponseInvokeId(self);
+    MmsOutstandingCall call = addToOutstandingCalls(self, invokeId, handler, userCallback, userParameter,
+            internalParameter, mmsError);
 
-    while (currentInvokeId != 0) {
-        Thread_sleep(1);
-        currentInvokeId = getResponseInvokeId(self);
+    if (call == NULL) {
+        IsoClientConnection_releaseTransmitBuffer(self->isoClient);
+        return 0;
     }
+
+    IsoClientConnection_sendMessage(self->isoClient, message);
+
+    return invokeId;
 }
 
 typedef struct sMmsServiceError
@@ -443,6 +776,9 @@ convertServiceErrorToMmsError(MmsServiceError serviceError)
 
     case 11: /* class: file */
         switch (serviceError.errorCode) {
+        case 5:
+            mmsError = MMS_ERROR_FILE_POSITION_INVALID;
+            break;
         case 7:
             mmsError = MMS_ERROR_FILE_FILE_NON_EXISTENT;
             break;
@@ -571,6 +907,10 @@ mmsIsoCallback(IsoIndication indication, void* parameter, ByteBuffer* payload)
         self->connectionState = MMS_CON_IDLE;
         self->associationState = MMS_STATE_CLOSED;
 
+        completeOutstandingCalls(self, true);
+
+        Semaphore_post(self->concludeStateChanged);
+
         /* Call user provided callback function */
         if (self->connectionLostHandler != NULL)
             self->connectionLostHandler(self, self->connectionLostHandlerParameter);
@@ -586,9 +926,11 @@ mmsIsoCallback(IsoIndication indication, void* parameter, ByteBuffer* payload)
         return;
     }
 
+    completeOutstandingCalls(self, false);
+
     if (payload != NULL) {
         if (ByteBuffer_getSize(payload) < 1) {
-            IsoClientConnection_releaseReceiveBuffer(self->isoClient);
+            IsoClientConnection_releaseReceiveBuffer(self->isoClient, payload);
             return;
         }
     }
@@ -613,7 +955,7 @@ mmsIsoCallback(IsoIndication indication, void* parameter, ByteBuffer* payload)
     }
     else if (tag == 0xa3) { /* unconfirmed PDU */
         handleUnconfirmedMmsPdu(self, payload);
-        IsoClientConnection_releaseReceiveBuffer(self->isoClient);
+        IsoClientConnection_releaseReceiveBuffer(self->isoClient, payload);
     }
     else if (tag == 0x8b) { /* conclude request PDU */
         if (DEBUG_MMS_CLIENT)
@@ -622,7 +964,7 @@ mmsIsoCallback(IsoIndication indication, void* parameter, ByteBuffer* payload)
         self->concludeState = CONCLUDE_STATE_REQUESTED;
 
         /* block all new user requests */
-        IsoClientConnection_releaseReceiveBuffer(self->isoClient);
+        IsoClientConnection_releaseReceiveBuffer(self->isoClient, payload);
     }
     else if (tag == 0x8c) { /* conclude response PDU */
         if (DEBUG_MMS_CLIENT)
@@ -632,7 +974,9 @@ mmsIsoCallback(IsoIndication indication, void* parameter, ByteBuffer* payload)
 
         IsoClientConnection_release(self->isoClient);
 
-        IsoClientConnection_releaseReceiveBuffer(self->isoClient);
+        IsoClientConnection_releaseReceiveBuffer(self->isoClient, payload);
+
+        Semaphore_post(self->concludeStateChanged);
     }
     else if (tag == 0x8d) { /* conclude error PDU */
         if (DEBUG_MMS_CLIENT)
@@ -640,7 +984,9 @@ mmsIsoCallback(IsoIndication indication, void* parameter, ByteBuffer* payload)
 
         self->concludeState = CONCLUDE_STATE_REJECTED;
 
-        IsoClientConnection_releaseReceiveBuffer(self->isoClient);
+        IsoClientConnection_releaseReceiveBuffer(self->isoClient, payload);
+
+        Semaphore_post(self->concludeStateChanged);
     }
     else if (tag == 0xa2) { /* confirmed error PDU */
         if (DEBUG_MMS_CLIENT)
@@ -651,24 +997,11 @@ mmsIsoCallback(IsoIndication indication, void* parameter, ByteBuffer* payload)
         if (parseConfirmedErrorPDU(payload, &invokeId, &serviceError) < 0) {
             if (DEBUG_MMS_CLIENT)
                 printf("MMS_CLIENT: Error parsing confirmedErrorPDU!\n");
-        }
-        else {
-            if (checkForOutstandingCall(self, invokeId)) {
 
-                waitUntilLastResponseHasBeenProcessed(self);
-
-                Semaphore_wait(self->lastResponseLock);
-                self->lastResponseError = convertServiceErrorToMmsError(serviceError);
-                self->responseInvokeId = invokeId;
-                Semaphore_post(self->lastResponseLock);
-            }
-            else {
-                if (DEBUG_MMS_CLIENT)
-                    printf("MMS_CLIENT: unexpected message from server!\n");
-                IsoClientConnection_releaseReceiveBuffer(self->isoClient);
-                return;
-            }
+            IsoClientConnection_releaseReceiveBuffer(self->isoClient, payload);
         }
+        else
+            handleResponse(self, invokeId, payload, 0, convertServiceErrorToMmsError(serviceError));
     }
     else if (tag == 0xa1) { /* confirmed response PDU */
 
@@ -695,26 +1028,17 @@ mmsIsoCallback(IsoIndication indication, void* parameter, ByteBuffer* payload)
 
             bufPos += invokeIdLength;
 
-            if (checkForOutstandingCall(self, invokeId)) {
-
-                waitUntilLastResponseHasBeenProcessed(self);
-
-                Semaphore_wait(self->lastResponseLock);
-                self->lastResponse = payload;
-                self->lastResponseBufPos = bufPos;
-                self->responseInvokeId = invokeId;
-                Semaphore_post(self->lastResponseLock);
-            }
-            else {
-                if (DEBUG_MMS_CLIENT)
-                    printf("MMS_CLIENT: unexpected message from server!\n");
-                IsoClientConnection_releaseReceiveBuffer(self->isoClient);
-                return;
-            }
+            handleResponse(self, invokeId, payload, bufPos, MMS_ERROR_NONE);
         }
         else
             goto exit_with_error;
     }
+    else {
+        if (DEBUG_MMS_CLIENT)
+            printf("MMS_CLIENT: unsupported MMS PDU type %02x\n", tag);
+
+        IsoClientConnection_releaseReceiveBuffer(self->isoClient, payload);
+    }
 
     if (DEBUG_MMS_CLIENT)
         printf("MMS_CLIENT: LEAVE mmsIsoCallback - OK\n");
@@ -725,7 +1049,7 @@ mmsIsoCallback(IsoIndication indication, void* parameter, ByteBuffer* payload)
 
     if (DEBUG_MMS_CLIENT)
         printf("received malformed message from server!\n");
-    IsoClientConnection_releaseReceiveBuffer(self->isoClient);
+    IsoClientConnection_releaseReceiveBuffer(self->isoClient, payload);
 
 
     if (DEBUG_MMS_CLIENT)
@@ -748,12 +1072,14 @@ MmsConnection_create()
     self->requestTimeout = CONFIG_MMS_CONNECTION_DEFAULT_TIMEOUT;
 
     self->lastInvokeIdLock = Semaphore_create(1);
-    self->lastResponseLock = Semaphore_create(1);
     self->outstandingCallsLock = Semaphore_create(1);
+    self->outstandingCallSlotFreed = Semaphore_create(0);
+    self->concludeStateChanged = Semaphore_create(0);
 
-    self->lastResponseError = MMS_ERROR_NONE;
+    self->proposedMaxServOutstandingCalling = DEFAULT_MAX_SERV_OUTSTANDING_CALLING;
+    self->proposedMaxServOutstandingCalled = DEFAULT_MAX_SERV_OUTSTANDING_CALLED;
 
-    self->outstandingCalls = (uint32_t*) calloc(OUTSTANDING_CALLS, sizeof(uint32_t));
+    createOutstandingCallsTable(self, self->proposedMaxServOutstandingCalling);
 
     self->isoParameters = IsoConnectionParameters_create();
 
@@ -776,10 +1102,14 @@ MmsConnection_destroy(MmsConnection self)
         IsoConnectionParameters_destroy(self->isoParameters);
 
     Semaphore_destroy(self->lastInvokeIdLock);
-    Semaphore_destroy(self->lastResponseLock);
     Semaphore_destroy(self->outstandingCallsLock);
+    Semaphore_destroy(self->outstandingCallSlotFreed);
+    Semaphore_destroy(self->concludeStateChanged);
 
-    free(self->outstandingCalls);
+    destroyOutstandingCallsTable(self);
+
+    if (self->reportAccessResults != NULL)
+        free(self->reportAccessResults);
 
     free(self);
 }
@@ -797,6 +1127,40 @@ MmsConnection_setRequestTimeout(MmsConnection self, uint32_t timeoutInMs)
     self->requestTimeout = timeoutInMs;
 }
 
+void
+MmsConnection_setMaxOutstandingCalls(MmsConnection self, int calling, int called)
+{
+    if (calling < 1)
+        calling = 1;
+
+    if (called < 1)
+        called = 1;
+
+    self->proposedMaxServOutstandingCalling = calling;
+    self->proposedMaxServOutstandingCalled = called;
+
+    destroyOutstandingCallsTable(self);
+    createOutstandingCallsTable(self, calling);
+}
+
+int
+MmsConnection_getMaxOutstandingCalls(MmsConnection self)
+{
+    return self->maxOutstandingCalls;
+}
+
+void
+MmsConnection_getReceiveStatistics(MmsConnection self, IsoClientReceiveStatistics* statistics)
+{
+    IsoClientConnection_getReceiveStatistics(self->isoClient, statistics);
+}
+
+void
+MmsConnection_handleTimeouts(MmsConnection self)
+{
+    completeOutstandingCalls(self, false);
+}
+
 void
 MmsConnection_setLocalDetail(MmsConnection self, int32_t localDetail)
 {
@@ -835,33 +1199,28 @@ waitForConnectResponse(MmsConnection self)
 
 }
 
-bool
-MmsConnection_connect(MmsConnection self, MmsError* mmsError, char* serverName, int serverPort)
+/* evaluate the initiate response and update the association state */
+static void
+handleConnectResponse(MmsConnection self)
 {
-    self->isoClient = IsoClientConnection_create((IsoIndicationCallback) mmsIsoCallback, (void*) self);
+    if (DEBUG_MMS_CLIENT)
+        printf("MmsConnection_connect: received response conState: %i\n", self->connectionState);
 
-    IsoConnectionParameters_setTcpParameters(self->isoParameters, serverName, serverPort);
+    if (self->connectionState == MMS_CON_ASSOCIATED) {
+        mmsClient_parseInitiateResponse(self);
 
-    if (self->parameters.maxPduSize == -1)
-        self->parameters.maxPduSize = CONFIG_MMS_MAXIMUM_PDU_SIZE;
+        IsoClientConnection_releaseReceiveBuffer(self->isoClient, self->lastResponse);
 
-    ByteBuffer* payload = IsoClientConnection_allocateTransmitBuffer(self->isoClient);
+        /* the window of outstanding requests is limited by the negotiated value */
+        int maxOutstandingCalls = self->parameters.maxServOutstandingCalling;
 
-    mmsClient_createInitiateRequest(self, payload);
+        if (maxOutstandingCalls > self->proposedMaxServOutstandingCalling)
+            maxOutstandingCalls = self->proposedMaxServOutstandingCalling;
 
-    self->connectionState = MMS_CON_WAITING;
+        if (maxOutstandingCalls < 1)
+            maxOutstandingCalls = 1;
 
-    IsoClientConnection_associate(self->isoClient, self->isoParameters, payload);
-
-    waitForConnectResponse(self);
-
-    if (DEBUG_MMS_CLIENT)
-        printf("MmsConnection_connect: received response conState: %i\n", self->connectionState);
-
-    if (self->connectionState == MMS_CON_ASSOCIATED) {
-        mmsClient_parseInitiateResponse(self);
-
-        releaseResponse(self);
+        self->maxOutstandingCalls = maxOutstandingCalls;
 
         self->associationState = MMS_STATE_CONNECTED;
     }
@@ -873,6 +1232,29 @@ MmsConnection_connect(MmsConnection self, MmsError* mmsError, char* serverName,
 
     if (DEBUG_MMS_CLIENT)
         printf("MmsConnection_connect: states: con %i ass %i\n", self->connectionState, self->associationState);
+}
+
+bool
+MmsConnection_connect(MmsConnection self, MmsError* mmsError, char* serverName, int serverPort)
+{
+    self->isoClient = IsoClientConnection_create((IsoIndicationCallback) mmsIsoCallback, (void*) self);
+
+    IsoConnectionParameters_setTcpParameters(self->isoParameters, serverName, serverPort);
+
+    if (self->parameters.maxPduSize == -1)
+        self->parameters.maxPduSize = CONFIG_MMS_MAXIMUM_PDU_SIZE;
+
+    ByteBuffer* payload = IsoClientConnection_allocateTransmitBuffer(self->isoClient);
+
+    mmsClient_createInitiateRequest(self, payload);
+
+    self->connectionState = MMS_CON_WAITING;
+
+    IsoClientConnection_associate(self->isoClient, self->isoParameters, payload);
+
+    waitForConnectResponse(self);
+
+    handleConnectResponse(self);
 
     if (self->associationState == MMS_STATE_CONNECTED) {
         *mmsError = MMS_ERROR_NONE;
@@ -884,6 +1266,83 @@ MmsConnection_connect(MmsConnection self, MmsError* mmsError, char* serverName,
     }
 }
 
+bool
+mmsClient_startConnect(MmsConnection self, char* serverName, int serverPort)
+{
+    /* the ISO connection is reused for reconnects */
+    if (self->isoClient == NULL)
+        self->isoClient = IsoClientConnection_create((IsoIndicationCallback) mmsIsoCallback, (void*) self);
+
+    IsoConnectionParameters_setTcpParameters(self->isoParameters, serverName, serverPort);
+
+    if (self->parameters.maxPduSize == -1)
+        self->parameters.maxPduSize = CONFIG_MMS_MAXIMUM_PDU_SIZE;
+
+    ByteBuffer* payload = IsoClientConnection_getAssociationBuffer(self->isoClient);
+
+    mmsClient_createInitiateRequest(self, payload);
+
+    self->connectionState = MMS_CON_WAITING;
+    self->associationState = MMS_STATE_CONNECTING;
+    self->concludeState = CONCLUDE_STATE_CONNECTION_ACTIVE;
+
+    if (IsoClientConnection_startAssociation(self->isoClient, self->isoParameters, payload) == false) {
+        mmsClient_closeConnection(self);
+        return false;
+    }
+
+    return true;
+}
+
+Socket
+mmsClient_getSocket(MmsConnection self)
+{
+    if (self->isoClient == NULL)
+        return NULL;
+
+    return IsoClientConnection_getSocket(self->isoClient);
+}
+
+int
+mmsClient_getSocketEvents(MmsConnection self)
+{
+    if (self->isoClient == NULL)
+        return 0;
+
+    return IsoClientConnection_getSocketEvents(self->isoClient);
+}
+
+bool
+mmsClient_isReceiverStalled(MmsConnection self)
+{
+    if (self->isoClient == NULL)
+        return false;
+
+    return IsoClientConnection_isReceiverStalled(self->isoClient);
+}
+
+AssociationState
+mmsClient_handleSocketEvent(MmsConnection self, int events)
+{
+    if (IsoClientConnection_handleSocketEvent(self->isoClient, events) == false)
+        return MMS_STATE_CLOSED;
+
+    if ((self->associationState == MMS_STATE_CONNECTING) && (self->connectionState == MMS_CON_ASSOCIATED))
+        handleConnectResponse(self);
+
+    return self->associationState;
+}
+
+void
+mmsClient_closeConnection(MmsConnection self)
+{
+    if (self->isoClient != NULL)
+        IsoClientConnection_shutdown(self->isoClient);
+
+    self->associationState = MMS_STATE_CLOSED;
+    self->connectionState = MMS_CON_IDLE;
+}
+
 void
 MmsConnection_abort(MmsConnection self, MmsError* mmsError)
 {
@@ -892,16 +1351,11 @@ MmsConnection_abort(MmsConnection self, MmsError* mmsError)
     IsoClientConnection_abort(self->isoClient);
 }
 
-static void
+static bool
 sendConcludeRequestAndWaitForResponse(MmsConnection self)
 {
-    uint64_t startTime = Hal_getTimeInMs();
-
-    uint64_t waitUntilTime = startTime + self->requestTimeout;
-
-    uint64_t currentTime = startTime;
-
-    bool success = false;
+    /* discard old signals */
+    while (Semaphore_waitWithTimeout(self->concludeStateChanged, 0));
 
     ByteBuffer* concludeMessage = IsoClientConnection_allocateTransmitBuffer(self->isoClient);
 
@@ -911,27 +1365,26 @@ sendConcludeRequestAndWaitForResponse(MmsConnection self)
 
     IsoClientConnection_sendMessage(self->isoClient, concludeMessage);
 
-    while (currentTime < waitUntilTime) {
+    uint64_t waitUntilTime = Hal_getTimeInMs() + self->requestTimeout;
+
+    while (self->concludeState == CONCLUDE_STATE_REQUESTED) {
 
         if (self->associationState == MMS_STATE_CLOSED)
-            return;
+            return true;
 
-        if (self->concludeState != CONCLUDE_STATE_REQUESTED) {
-            success = true;
-            break;
-        }
+        uint64_t currentTime = Hal_getTimeInMs();
 
-        Thread_sleep(10);
+        if (currentTime >= waitUntilTime) {
+            if (DEBUG_MMS_CLIENT)
+                printf("TIMEOUT for conclude request\n");
 
-        currentTime = Hal_getTimeInMs();
-    }
+            return false;
+        }
 
-    if (!success) {
-        if (DEBUG_MMS_CLIENT)
-            printf("TIMEOUT for conclude request\n");
-        self->lastResponseError = MMS_ERROR_SERVICE_TIMEOUT;
+        Semaphore_waitWithTimeout(self->concludeStateChanged, (int) (waitUntilTime - currentTime));
     }
 
+    return true;
 }
 
 void
@@ -939,12 +1392,8 @@ MmsConnection_conclude(MmsConnection self, MmsError* mmsError)
 {
     *mmsError = MMS_ERROR_NONE;
 
-    sendConcludeRequestAndWaitForResponse(self);
-
-    if (self->lastResponseError != MMS_ERROR_NONE)
-        *mmsError = self->lastResponseError;
-
-    releaseResponse(self);
+    if (sendConcludeRequestAndWaitForResponse(self) == false)
+        *mmsError = MMS_ERROR_SERVICE_TIMEOUT;
 
     if (self->concludeState != CONCLUDE_STATE_ACCEPTED) {
 
@@ -964,6 +1413,21 @@ MmsConnection_setInformationReportHandler(MmsConnection self, MmsInformationRepo
     self->reportHandlerParameter = parameter;
 }
 
+void
+mmsClient_setEncodedInformationReportHandler(MmsConnection self, MmsEncodedInformationReportHandler handler,
+        void* parameter)
+{
+    self->encodedReportHandler = handler;
+    self->encodedReportHandlerParameter = parameter;
+}
+
+void
+mmsClient_setTimeoutHandler(MmsConnection self, MmsTimeoutHandler handler, void* parameter)
+{
+    self->timeoutHandler = handler;
+    self->timeoutHandlerParameter = parameter;
+}
+
 static bool
 mmsClient_getNameListSingleRequest(
         LinkedList* nameList,
@@ -978,7 +1442,10 @@ mmsClient_getNameListSingleRequest(
 
     uint32_t invokeId = getNextInvokeId(self);
 
-    ByteBuffer* payload = IsoClientConnection_allocateTransmitBuffer(self->isoClient);
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return false;
 
     if (associationSpecific)
         mmsClient_createMmsGetNameListRequestAssociationSpecific(invokeId,
@@ -993,14 +1460,14 @@ mmsClient_getNameListSingleRequest(
                     payload, objectClass, continueAfter);
     }
 
-    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload);
+    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload, NULL, mmsError);
 
     bool moreFollows = false;
 
     if (responseMessage != NULL)
-        moreFollows = mmsClient_parseGetNameListResponse(nameList, self->lastResponse, NULL);
+        moreFollows = mmsClient_parseGetNameListResponse(nameList, responseMessage, NULL);
 
-    releaseResponse(self);
+    releaseResponse(self, responseMessage);
 
     if (self->associationState == MMS_STATE_CLOSED)
         *mmsError = MMS_ERROR_CONNECTION_LOST;
@@ -1070,7 +1537,10 @@ MmsValue*
 MmsConnection_readVariable(MmsConnection self, MmsError* mmsError,
         char* domainId, char* itemId)
 {
-    ByteBuffer* payload = IsoClientConnection_allocateTransmitBuffer(self->isoClient);
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return NULL;
 
     MmsValue* value = NULL;
 
@@ -1080,14 +1550,12 @@ MmsConnection_readVariable(MmsConnection self, MmsError* mmsError,
 
     mmsClient_createReadRequest(invokeId, domainId, itemId, payload);
 
-    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload);
+    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload, NULL, mmsError);
 
-    if (self->lastResponseError != MMS_ERROR_NONE)
-        *mmsError = self->lastResponseError;
-    else if (responseMessage != NULL)
-        value = mmsClient_parseReadResponse(self->lastResponse, NULL, false);
+    if (responseMessage != NULL)
+        value = mmsClient_parseReadResponse(responseMessage, NULL, false);
 
-    releaseResponse(self);
+    releaseResponse(self, responseMessage);
 
     if (self->associationState == MMS_STATE_CLOSED)
         *mmsError = MMS_ERROR_CONNECTION_LOST;
@@ -1100,7 +1568,10 @@ MmsConnection_readArrayElements(MmsConnection self, MmsError* mmsError,
         char* domainId, char* itemId,
         uint32_t startIndex, uint32_t numberOfElements)
 {
-    ByteBuffer* payload = IsoClientConnection_allocateTransmitBuffer(self->isoClient);
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return NULL;
 
     MmsValue* value = NULL;
 
@@ -1111,14 +1582,12 @@ MmsConnection_readArrayElements(MmsConnection self, MmsError* mmsError,
     mmsClient_createReadRequestAlternateAccessIndex(invokeId, domainId, itemId, startIndex,
             numberOfElements, payload);
 
-    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload);
+    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload, NULL, mmsError);
 
-    if (self->lastResponseError != MMS_ERROR_NONE)
-        *mmsError = self->lastResponseError;
-    else if (responseMessage != NULL)
-        value = mmsClient_parseReadResponse(self->lastResponse, NULL, false);
+    if (responseMessage != NULL)
+        value = mmsClient_parseReadResponse(responseMessage, NULL, false);
 
-    releaseResponse(self);
+    releaseResponse(self, responseMessage);
 
     if (self->associationState == MMS_STATE_CLOSED)
         *mmsError = MMS_ERROR_CONNECTION_LOST;
@@ -1130,7 +1599,10 @@ MmsValue*
 MmsConnection_readMultipleVariables(MmsConnection self, MmsError* mmsError,
         char* domainId, LinkedList /*<char*>*/items)
 {
-    ByteBuffer* payload = IsoClientConnection_allocateTransmitBuffer(self->isoClient);
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return NULL;
 
     MmsValue* value = NULL;
 
@@ -1140,14 +1612,12 @@ MmsConnection_readMultipleVariables(MmsConnection self, MmsError* mmsError,
 
     mmsClient_createReadRequestMultipleValues(invokeId, domainId, items, payload);
 
-    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload);
+    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload, NULL, mmsError);
 
-    if (self->lastResponseError != MMS_ERROR_NONE)
-        *mmsError = self->lastResponseError;
-    else if (responseMessage != NULL)
-        value = mmsClient_parseReadResponse(self->lastResponse, NULL, true);
+    if (responseMessage != NULL)
+        value = mmsClient_parseReadResponse(responseMessage, NULL, true);
 
-    releaseResponse(self);
+    releaseResponse(self, responseMessage);
 
     if (self->associationState == MMS_STATE_CLOSED)
         *mmsError = MMS_ERROR_CONNECTION_LOST;
@@ -1160,7 +1630,10 @@ MmsConnection_readNamedVariableListValues(MmsConnection self, MmsError* mmsError
         char* domainId, char* listName,
         bool specWithResult)
 {
-    ByteBuffer* payload = IsoClientConnection_allocateTransmitBuffer(self->isoClient);
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return NULL;
 
     MmsValue* value = NULL;
 
@@ -1171,16 +1644,13 @@ MmsConnection_readNamedVariableListValues(MmsConnection self, MmsError* mmsError
     mmsClient_createReadNamedVariableListRequest(invokeId, domainId, listName,
             payload, specWithResult);
 
-    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload);
+    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload, NULL, mmsError);
 
-    if (self->lastResponseError != MMS_ERROR_NONE) {
-        *mmsError = self->lastResponseError;
-    }
-    else if (responseMessage != NULL) {
-        value = mmsClient_parseReadResponse(self->lastResponse, NULL, true);
+    if (responseMessage != NULL) {
+        value = mmsClient_parseReadResponse(responseMessage, NULL, true);
     }
 
-    releaseResponse(self);
+    releaseResponse(self, responseMessage);
 
     if (self->associationState == MMS_STATE_CLOSED)
         *mmsError = MMS_ERROR_CONNECTION_LOST;
@@ -1194,7 +1664,10 @@ MmsConnection_readNamedVariableListValuesAssociationSpecific(
         char* listName,
         bool specWithResult)
 {
-    ByteBuffer* payload = IsoClientConnection_allocateTransmitBuffer(self->isoClient);
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return NULL;
 
     MmsValue* value = NULL;
 
@@ -1205,14 +1678,12 @@ MmsConnection_readNamedVariableListValuesAssociationSpecific(
     mmsClient_createReadAssociationSpecificNamedVariableListRequest(invokeId, listName,
             payload, specWithResult);
 
-    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload);
+    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload, NULL, mmsError);
 
-    if (self->lastResponseError != MMS_ERROR_NONE)
-        *mmsError = self->lastResponseError;
-    else if (responseMessage != NULL)
-        value = mmsClient_parseReadResponse(self->lastResponse, NULL, true);
+    if (responseMessage != NULL)
+        value = mmsClient_parseReadResponse(responseMessage, NULL, true);
 
-    releaseResponse(self);
+    releaseResponse(self, responseMessage);
 
     if (self->associationState == MMS_STATE_CLOSED)
         *mmsError = MMS_ERROR_CONNECTION_LOST;
@@ -1220,11 +1691,78 @@ MmsConnection_readNamedVariableListValuesAssociationSpecific(
     return value;
 }
 
+bool
+MmsConnection_readVariableIntoValue(MmsConnection self, MmsError* mmsError,
+        char* domainId, char* itemId, MmsValue* value)
+{
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return false;
+
+    bool success = false;
+
+    *mmsError = MMS_ERROR_NONE;
+
+    uint32_t invokeId = getNextInvokeId(self);
+
+    mmsClient_createReadRequest(invokeId, domainId, itemId, payload);
+
+    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload, NULL, mmsError);
+
+    if (responseMessage != NULL)
+        success = mmsClient_parseReadResponseIntoValue(responseMessage, NULL, value, false, mmsError);
+
+    releaseResponse(self, responseMessage);
+
+    if (self->associationState == MMS_STATE_CLOSED)
+        *mmsError = MMS_ERROR_CONNECTION_LOST;
+
+    return success;
+}
+
+bool
+MmsConnection_readNamedVariableListValuesIntoValue(MmsConnection self, MmsError* mmsError,
+        char* domainId, char* listName, bool specWithResult, MmsValue* values)
+{
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return false;
+
+    bool success = false;
+
+    *mmsError = MMS_ERROR_NONE;
+
+    uint32_t invokeId = getNextInvokeId(self);
+
+    if (domainId != NULL)
+        mmsClient_createReadNamedVariableListRequest(invokeId, domainId, listName, payload, specWithResult);
+    else
+        mmsClient_createReadAssociationSpecificNamedVariableListRequest(invokeId, listName, payload,
+                specWithResult);
+
+    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload, NULL, mmsError);
+
+    if (responseMessage != NULL)
+        success = mmsClient_parseReadResponseIntoValue(responseMessage, NULL, values, true, mmsError);
+
+    releaseResponse(self, responseMessage);
+
+    if (self->associationState == MMS_STATE_CLOSED)
+        *mmsError = MMS_ERROR_CONNECTION_LOST;
+
+    return success;
+}
+
 LinkedList /* <MmsVariableAccessSpecification*> */
 MmsConnection_readNamedVariableListDirectory(MmsConnection self, MmsError* mmsError,
         char* domainId, char* listName, bool* deletable)
 {
-    ByteBuffer* payload = IsoClientConnection_allocateTransmitBuffer(self->isoClient);
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return NULL;
 
     *mmsError = MMS_ERROR_NONE;
 
@@ -1235,15 +1773,13 @@ MmsConnection_readNamedVariableListDirectory(MmsConnection self, MmsError* mmsEr
     mmsClient_createGetNamedVariableListAttributesRequest(invokeId, payload, domainId,
             listName);
 
-    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload);
+    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload, NULL, mmsError);
 
-    if (self->lastResponseError != MMS_ERROR_NONE)
-        *mmsError = self->lastResponseError;
-    else if (responseMessage != NULL)
-        attributes = mmsClient_parseGetNamedVariableListAttributesResponse(self->lastResponse, NULL,
+    if (responseMessage != NULL)
+        attributes = mmsClient_parseGetNamedVariableListAttributesResponse(responseMessage, NULL,
                 deletable);
 
-    releaseResponse(self);
+    releaseResponse(self, responseMessage);
 
     if (self->associationState == MMS_STATE_CLOSED)
         *mmsError = MMS_ERROR_CONNECTION_LOST;
@@ -1255,7 +1791,10 @@ LinkedList /* <MmsVariableAccessSpecification*> */
 MmsConnection_readNamedVariableListDirectoryAssociationSpecific(MmsConnection self, MmsError* mmsError,
         char* listName, bool* deletable)
 {
-    ByteBuffer* payload = IsoClientConnection_allocateTransmitBuffer(self->isoClient);
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return NULL;
 
     *mmsError = MMS_ERROR_NONE;
 
@@ -1266,15 +1805,13 @@ MmsConnection_readNamedVariableListDirectoryAssociationSpecific(MmsConnection se
     mmsClient_createGetNamedVariableListAttributesRequestAssociationSpecific(invokeId, payload,
             listName);
 
-    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload);
+    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload, NULL, mmsError);
 
-    if (self->lastResponseError != MMS_ERROR_NONE)
-        *mmsError = self->lastResponseError;
-    else if (responseMessage != NULL)
-        attributes = mmsClient_parseGetNamedVariableListAttributesResponse(self->lastResponse, NULL,
+    if (responseMessage != NULL)
+        attributes = mmsClient_parseGetNamedVariableListAttributesResponse(responseMessage, NULL,
                 deletable);
 
-    releaseResponse(self);
+    releaseResponse(self, responseMessage);
 
     if (self->associationState == MMS_STATE_CLOSED)
         *mmsError = MMS_ERROR_CONNECTION_LOST;
@@ -1286,7 +1823,10 @@ void
 MmsConnection_defineNamedVariableList(MmsConnection self, MmsError* mmsError,
         char* domainId, char* listName, LinkedList variableSpecs)
 {
-    ByteBuffer* payload = IsoClientConnection_allocateTransmitBuffer(self->isoClient);
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return;
 
     *mmsError = MMS_ERROR_NONE;
 
@@ -1295,15 +1835,13 @@ MmsConnection_defineNamedVariableList(MmsConnection self, MmsError* mmsError,
     mmsClient_createDefineNamedVariableListRequest(invokeId, payload, domainId,
             listName, variableSpecs, false);
 
-    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload);
+    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload, NULL, mmsError);
 
-    if (self->lastResponseError != MMS_ERROR_NONE)
-        *mmsError = self->lastResponseError;
-    else if (responseMessage != NULL)
-        if (!mmsClient_parseDefineNamedVariableResponse(self->lastResponse, NULL))
+    if (responseMessage != NULL)
+        if (!mmsClient_parseDefineNamedVariableResponse(responseMessage, NULL))
             *mmsError = MMS_ERROR_DEFINITION_OTHER;
 
-    releaseResponse(self);
+    releaseResponse(self, responseMessage);
 
     if (self->associationState == MMS_STATE_CLOSED)
         *mmsError = MMS_ERROR_CONNECTION_LOST;
@@ -1313,7 +1851,10 @@ void
 MmsConnection_defineNamedVariableListAssociationSpecific(MmsConnection self,
         MmsError* mmsError, char* listName, LinkedList variableSpecs)
 {
-    ByteBuffer* payload = IsoClientConnection_allocateTransmitBuffer(self->isoClient);
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return;
 
     *mmsError = MMS_ERROR_NONE;
 
@@ -1322,15 +1863,13 @@ MmsConnection_defineNamedVariableListAssociationSpecific(MmsConnection self,
     mmsClient_createDefineNamedVariableListRequest(invokeId, payload, NULL,
             listName, variableSpecs, true);
 
-    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload);
+    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload, NULL, mmsError);
 
-    if (self->lastResponseError != MMS_ERROR_NONE)
-        *mmsError = self->lastResponseError;
-    else if (responseMessage != NULL)
-        if (!mmsClient_parseDefineNamedVariableResponse(self->lastResponse, NULL))
+    if (responseMessage != NULL)
+        if (!mmsClient_parseDefineNamedVariableResponse(responseMessage, NULL))
             *mmsError = MMS_ERROR_DEFINITION_OTHER;
 
-    releaseResponse(self);
+    releaseResponse(self, responseMessage);
 
     if (self->associationState == MMS_STATE_CLOSED)
         *mmsError = MMS_ERROR_CONNECTION_LOST;
@@ -1340,7 +1879,10 @@ void
 MmsConnection_deleteNamedVariableList(MmsConnection self, MmsError* mmsError,
         char* domainId, char* listName)
 {
-    ByteBuffer* payload = IsoClientConnection_allocateTransmitBuffer(self->isoClient);
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return;
 
     *mmsError = MMS_ERROR_NONE;
 
@@ -1348,15 +1890,13 @@ MmsConnection_deleteNamedVariableList(MmsConnection self, MmsError* mmsError,
 
     mmsClient_createDeleteNamedVariableListRequest(invokeId, payload, domainId, listName);
 
-    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload);
+    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload, NULL, mmsError);
 
-    if (self->lastResponseError != MMS_ERROR_NONE)
-        *mmsError = self->lastResponseError;
-    else if (responseMessage != NULL)
-        if (!mmsClient_parseDeleteNamedVariableListResponse(self->lastResponse, NULL))
+    if (responseMessage != NULL)
+        if (!mmsClient_parseDeleteNamedVariableListResponse(responseMessage, NULL))
             *mmsError = MMS_ERROR_ACCESS_OTHER;
 
-    releaseResponse(self);
+    releaseResponse(self, responseMessage);
 
     if (self->associationState == MMS_STATE_CLOSED)
         *mmsError = MMS_ERROR_CONNECTION_LOST;
@@ -1366,7 +1906,10 @@ void
 MmsConnection_deleteAssociationSpecificNamedVariableList(MmsConnection self,
         MmsError* mmsError, char* listName)
 {
-    ByteBuffer* payload = IsoClientConnection_allocateTransmitBuffer(self->isoClient);
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return;
 
     *mmsError = MMS_ERROR_NONE;
 
@@ -1375,15 +1918,13 @@ MmsConnection_deleteAssociationSpecificNamedVariableList(MmsConnection self,
     mmsClient_createDeleteAssociationSpecificNamedVariableListRequest(
             invokeId, payload, listName);
 
-    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload);
+    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload, NULL, mmsError);
 
-    if (self->lastResponseError != MMS_ERROR_NONE)
-        *mmsError = self->lastResponseError;
-    else if (responseMessage != NULL)
-        if (!mmsClient_parseDeleteNamedVariableListResponse(self->lastResponse, NULL))
+    if (responseMessage != NULL)
+        if (!mmsClient_parseDeleteNamedVariableListResponse(responseMessage, NULL))
             *mmsError = MMS_ERROR_ACCESS_OTHER;
 
-    releaseResponse(self);
+    releaseResponse(self, responseMessage);
 
     if (self->associationState == MMS_STATE_CLOSED)
         *mmsError = MMS_ERROR_CONNECTION_LOST;
@@ -1393,24 +1934,73 @@ MmsVariableSpecification*
 MmsConnection_getVariableAccessAttributes(MmsConnection self, MmsError* mmsError,
         char* domainId, char* itemId)
 {
-    ByteBuffer* payload = IsoClientConnection_allocateTransmitBuffer(self->isoClient);
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return NULL;
+
+    MmsVariableSpecification* typeSpec = NULL;
+
+    *mmsError = MMS_ERROR_NONE;
+
+    uint32_t invokeId = getNextInvokeId(self);
+
+    mmsClient_createGetVariableAccessAttributesRequest(invokeId, domainId, itemId, payload);
+
+    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload, NULL, mmsError);
+
+    if (responseMessage != NULL)
+        typeSpec = mmsClient_parseGetVariableAccessAttributesResponse(responseMessage, NULL);
+
+    releaseResponse(self, responseMessage);
+
+    if (self->associationState == MMS_STATE_CLOSED)
+        *mmsError = MMS_ERROR_CONNECTION_LOST;
+
+    return typeSpec;
+}
+
+MmsVariableSpecification*
+mmsClient_getVariableAccessAttributes(MmsConnection self, MmsError* mmsError, char* domainId, char* itemId,
+        uint8_t** encodedTypeSpec, int* encodedTypeSpecSize)
+{
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return NULL;
 
     MmsVariableSpecification* typeSpec = NULL;
 
     *mmsError = MMS_ERROR_NONE;
+    *encodedTypeSpec = NULL;
 
     uint32_t invokeId = getNextInvokeId(self);
 
     mmsClient_createGetVariableAccessAttributesRequest(invokeId, domainId, itemId, payload);
 
-    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload);
+    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload, NULL, mmsError);
+
+    if (responseMessage != NULL) {
+        int typeSpecPos;
+        int typeSpecSize;
+
+        if (mmsClient_findTypeSpecification(responseMessage, NULL, &typeSpecPos, &typeSpecSize)) {
+            uint8_t* buffer = ByteBuffer_getBuffer(responseMessage);
 
-    if (self->lastResponseError != MMS_ERROR_NONE)
-        *mmsError = self->lastResponseError;
-    else if (responseMessage != NULL)
-        typeSpec = mmsClient_parseGetVariableAccessAttributesResponse(self->lastResponse, NULL);
+            typeSpec = mmsClient_decodeTypeSpecification(buffer, typeSpecPos, typeSpecPos + typeSpecSize);
 
-    releaseResponse(self);
+            if (typeSpec != NULL) {
+                *encodedTypeSpec = (uint8_t*) malloc(typeSpecSize > 0 ? typeSpecSize : 1);
+                memcpy(*encodedTypeSpec, buffer + typeSpecPos, typeSpecSize);
+                *encodedTypeSpecSize = typeSpecSize;
+            }
+        }
+
+        if (typeSpec == NULL)
+            *mmsError = MMS_ERROR_PARSING_RESPONSE;
+    }
+
+    releaseResponse(self, responseMessage);
 
     if (self->associationState == MMS_STATE_CLOSED)
         *mmsError = MMS_ERROR_CONNECTION_LOST;
@@ -1421,7 +2011,10 @@ MmsConnection_getVariableAccessAttributes(MmsConnection self, MmsError* mmsError
 MmsServerIdentity*
 MmsConnection_identify(MmsConnection self, MmsError* mmsError)
 {
-    ByteBuffer* payload = IsoClientConnection_allocateTransmitBuffer(self->isoClient);
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return NULL;
 
     MmsServerIdentity* identity = NULL;
 
@@ -1431,14 +2024,14 @@ MmsConnection_identify(MmsConnection self, MmsError* mmsError)
 
     mmsClient_createIdentifyRequest(invokeId, payload);
 
-    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload);
+    int responseBufPos;
+
+    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload, &responseBufPos, mmsError);
 
-    if (self->lastResponseError != MMS_ERROR_NONE)
-        *mmsError = self->lastResponseError;
-    else if (responseMessage != NULL)
-        identity = mmsClient_parseIdentifyResponse(self);
+    if (responseMessage != NULL)
+        identity = mmsClient_parseIdentifyResponse(responseMessage, responseBufPos);
 
-    releaseResponse(self);
+    releaseResponse(self, responseMessage);
 
     if (self->associationState == MMS_STATE_CLOSED)
         *mmsError = MMS_ERROR_CONNECTION_LOST;
@@ -1450,7 +2043,10 @@ void
 MmsConnection_getServerStatus(MmsConnection self, MmsError* mmsError, int* vmdLogicalStatus, int* vmdPhysicalStatus,
         bool extendedDerivation)
 {
-    ByteBuffer* payload = IsoClientConnection_allocateTransmitBuffer(self->isoClient);
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return;
 
     *mmsError = MMS_ERROR_NONE;
 
@@ -1458,16 +2054,16 @@ MmsConnection_getServerStatus(MmsConnection self, MmsError* mmsError, int* vmdLo
 
     mmsClient_createStatusRequest(invokeId, payload, extendedDerivation);
 
-    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload);
+    int responseBufPos;
+
+    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload, &responseBufPos, mmsError);
 
-   if (self->lastResponseError != MMS_ERROR_NONE)
-       *mmsError = self->lastResponseError;
-   else if (responseMessage != NULL) {
-       if (mmsClient_parseStatusResponse(self, vmdLogicalStatus, vmdPhysicalStatus) == false)
+   if (responseMessage != NULL) {
+       if (mmsClient_parseStatusResponse(responseMessage, responseBufPos, vmdLogicalStatus, vmdPhysicalStatus) == false)
            *mmsError = MMS_ERROR_PARSING_RESPONSE;
    }
 
-   releaseResponse(self);
+   releaseResponse(self, responseMessage);
 
    if (self->associationState == MMS_STATE_CLOSED)
        *mmsError = MMS_ERROR_CONNECTION_LOST;
@@ -1480,7 +2076,10 @@ int32_t
 MmsConnection_fileOpen(MmsConnection self, MmsError* mmsError, char* filename, uint32_t initialPosition,
         uint32_t* fileSize, uint64_t* lastModified)
 {
-    ByteBuffer* payload = IsoClientConnection_allocateTransmitBuffer(self->isoClient);
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return -1;
 
     *mmsError = MMS_ERROR_NONE;
 
@@ -1490,16 +2089,16 @@ MmsConnection_fileOpen(MmsConnection self, MmsError* mmsError, char* filename, u
 
     mmsClient_createFileOpenRequest(invokeId, payload, filename, initialPosition);
 
-    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload);
+    int responseBufPos;
 
-    if (self->lastResponseError != MMS_ERROR_NONE)
-        *mmsError = self->lastResponseError;
-    else if (responseMessage != NULL) {
-        if (mmsClient_parseFileOpenResponse(self, &frsmId, fileSize, lastModified) == false)
+    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload, &responseBufPos, mmsError);
+
+    if (responseMessage != NULL) {
+        if (mmsClient_parseFileOpenResponse(responseMessage, responseBufPos, &frsmId, fileSize, lastModified) == false)
             *mmsError = MMS_ERROR_PARSING_RESPONSE;
     }
 
-    releaseResponse(self);
+    releaseResponse(self, responseMessage);
 
     if (self->associationState == MMS_STATE_CLOSED)
         *mmsError = MMS_ERROR_CONNECTION_LOST;
@@ -1510,7 +2109,10 @@ MmsConnection_fileOpen(MmsConnection self, MmsError* mmsError, char* filename, u
 void
 MmsConnection_fileClose(MmsConnection self, MmsError* mmsError, int32_t frsmId)
 {
-    ByteBuffer* payload = IsoClientConnection_allocateTransmitBuffer(self->isoClient);
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return;
 
      *mmsError = MMS_ERROR_NONE;
 
@@ -1518,14 +2120,11 @@ MmsConnection_fileClose(MmsConnection self, MmsError* mmsError, int32_t frsmId)
 
      mmsClient_createFileCloseRequest(invokeId, payload, frsmId);
 
-     sendRequestAndWaitForResponse(self, invokeId, payload);
-
-     if (self->lastResponseError != MMS_ERROR_NONE)
-         *mmsError = self->lastResponseError;
+     ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload, NULL, mmsError);
 
      /* nothing to do - response contains no data to evaluate */
 
-     releaseResponse(self);
+     releaseResponse(self, responseMessage);
 
      if (self->associationState == MMS_STATE_CLOSED)
          *mmsError = MMS_ERROR_CONNECTION_LOST;
@@ -1534,7 +2133,10 @@ MmsConnection_fileClose(MmsConnection self, MmsError* mmsError, int32_t frsmId)
 void
 MmsConnection_fileDelete(MmsConnection self, MmsError* mmsError, char* fileName)
 {
-    ByteBuffer* payload = IsoClientConnection_allocateTransmitBuffer(self->isoClient);
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return;
 
      *mmsError = MMS_ERROR_NONE;
 
@@ -1543,14 +2145,11 @@ MmsConnection_fileDelete(MmsConnection self, MmsError* mmsError, char* fileName)
      mmsClient_createFileDeleteRequest(invokeId, payload, fileName);
 
 
-     sendRequestAndWaitForResponse(self, invokeId, payload);
-
-     if (self->lastResponseError != MMS_ERROR_NONE)
-         *mmsError = self->lastResponseError;
+     ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload, NULL, mmsError);
 
      /* nothing to do - response contains no data to evaluate */
 
-     releaseResponse(self);
+     releaseResponse(self, responseMessage);
 
      if (self->associationState == MMS_STATE_CLOSED)
          *mmsError = MMS_ERROR_CONNECTION_LOST;
@@ -1560,7 +2159,10 @@ bool
 MmsConnection_fileRead(MmsConnection self, MmsError* mmsError, int32_t frsmId, MmsFileReadHandler handler,
         void* handlerParameter)
 {
-    ByteBuffer* payload = IsoClientConnection_allocateTransmitBuffer(self->isoClient);
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return false;
 
     *mmsError = MMS_ERROR_NONE;
 
@@ -1569,16 +2171,16 @@ MmsConnection_fileRead(MmsConnection self, MmsError* mmsError, int32_t frsmId, M
     bool moreFollows = false;
     mmsClient_createFileReadRequest(invokeId, payload, frsmId);
 
-    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload);
+    int responseBufPos;
 
-    if (self->lastResponseError != MMS_ERROR_NONE)
-        *mmsError = self->lastResponseError;
-    else if (responseMessage != NULL) {
-        if (mmsClient_parseFileReadResponse(self, frsmId, &moreFollows, handler, handlerParameter) == false)
+    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload, &responseBufPos, mmsError);
+
+    if (responseMessage != NULL) {
+        if (mmsClient_parseFileReadResponse(responseMessage, responseBufPos, frsmId, &moreFollows, handler, handlerParameter) == false)
             *mmsError = MMS_ERROR_PARSING_RESPONSE;
     }
 
-    releaseResponse(self);
+    releaseResponse(self, responseMessage);
 
     if (self->associationState == MMS_STATE_CLOSED)
         *mmsError = MMS_ERROR_CONNECTION_LOST;
@@ -1591,7 +2193,10 @@ bool
 MmsConnection_getFileDirectory(MmsConnection self, MmsError* mmsError, char* fileSpecification, char* continueAfter,
         MmsFileDirectoryHandler handler, void* handlerParameter)
 {
-    ByteBuffer* payload = IsoClientConnection_allocateTransmitBuffer(self->isoClient);
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return false;
 
     *mmsError = MMS_ERROR_NONE;
 
@@ -1599,18 +2204,18 @@ MmsConnection_getFileDirectory(MmsConnection self, MmsError* mmsError, char* fil
 
     mmsClient_createFileDirectoryRequest(invokeId, payload, fileSpecification, continueAfter);
 
-    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload);
+    int responseBufPos;
+
+    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload, &responseBufPos, mmsError);
 
     bool moreFollows = false;
 
-    if (self->lastResponseError != MMS_ERROR_NONE)
-        *mmsError = self->lastResponseError;
-    else if (responseMessage != NULL) {
-        if (mmsClient_parseFileDirectoryResponse(self, handler, handlerParameter, &moreFollows) == false)
+    if (responseMessage != NULL) {
+        if (mmsClient_parseFileDirectoryResponse(responseMessage, responseBufPos, handler, handlerParameter, &moreFollows) == false)
             *mmsError = MMS_ERROR_PARSING_RESPONSE;
     }
 
-    releaseResponse(self);
+    releaseResponse(self, responseMessage);
 
     if (self->associationState == MMS_STATE_CLOSED)
         *mmsError = MMS_ERROR_CONNECTION_LOST;
@@ -1621,7 +2226,10 @@ MmsConnection_getFileDirectory(MmsConnection self, MmsError* mmsError, char* fil
 void
 MmsConnection_fileRename(MmsConnection self, MmsError* mmsError, char* currentFileName, char* newFileName)
 {
-    ByteBuffer* payload = IsoClientConnection_allocateTransmitBuffer(self->isoClient);
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return;
 
     *mmsError = MMS_ERROR_NONE;
 
@@ -1629,14 +2237,11 @@ MmsConnection_fileRename(MmsConnection self, MmsError* mmsError, char* currentFi
 
     mmsClient_createFileRenameRequest(invokeId, payload, currentFileName, newFileName);
 
-    sendRequestAndWaitForResponse(self, invokeId, payload);
-
-    if (self->lastResponseError != MMS_ERROR_NONE)
-        *mmsError = self->lastResponseError;
+    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload, NULL, mmsError);
 
     /* nothing to do - response contains no data to evaluate */
 
-    releaseResponse(self);
+    releaseResponse(self, responseMessage);
 
     if (self->associationState == MMS_STATE_CLOSED)
         *mmsError = MMS_ERROR_CONNECTION_LOST;
@@ -1648,7 +2253,10 @@ MmsConnection_writeVariable(MmsConnection self, MmsError* mmsError,
         char* domainId, char* itemId,
         MmsValue* value)
 {
-    ByteBuffer* payload = IsoClientConnection_allocateTransmitBuffer(self->isoClient);
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return;
 
     *mmsError = MMS_ERROR_NONE;
 
@@ -1656,14 +2264,14 @@ MmsConnection_writeVariable(MmsConnection self, MmsError* mmsError,
 
     mmsClient_createWriteRequest(invokeId, domainId, itemId, value, payload);
 
-    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload);
+    int responseBufPos;
+
+    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload, &responseBufPos, mmsError);
 
-    if (self->lastResponseError != MMS_ERROR_NONE)
-        *mmsError = self->lastResponseError;
-    else if (responseMessage != NULL)
-        mmsClient_parseWriteResponse(self->lastResponse, self->lastResponseBufPos, mmsError);
+    if (responseMessage != NULL)
+        mmsClient_parseWriteResponse(responseMessage, responseBufPos, mmsError);
 
-    releaseResponse(self);
+    releaseResponse(self, responseMessage);
 
     if (self->associationState == MMS_STATE_CLOSED)
         *mmsError = MMS_ERROR_CONNECTION_LOST;
@@ -1679,28 +2287,384 @@ MmsConnection_writeMultipleVariables(MmsConnection self, MmsError* mmsError, cha
 
     uint32_t invokeId = getNextInvokeId(self);
 
-    ByteBuffer* payload = IsoClientConnection_allocateTransmitBuffer(self->isoClient);
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return;
 
     mmsClient_createWriteMultipleItemsRequest(invokeId, domainId, items, values, payload);
 
-    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload);
+    int responseBufPos;
+
+    ByteBuffer* responseMessage = sendRequestAndWaitForResponse(self, invokeId, payload, &responseBufPos, mmsError);
 
-    if (self->lastResponseError != MMS_ERROR_NONE)
-        *mmsError = self->lastResponseError;
-    else if (responseMessage != NULL) {
+    if (responseMessage != NULL) {
 
         int numberOfItems = LinkedList_size(items);
 
-        mmsClient_parseWriteMultipleItemsResponse(self->lastResponse, self->lastResponseBufPos, mmsError,
+        mmsClient_parseWriteMultipleItemsResponse(responseMessage, responseBufPos, mmsError,
                 numberOfItems, accessResults);
     }
 
-    releaseResponse(self);
+    releaseResponse(self, responseMessage);
 
     if (self->associationState == MMS_STATE_CLOSED)
         *mmsError = MMS_ERROR_CONNECTION_LOST;
 }
 
+static void
+handleAsyncReadResponse(MmsConnection self, MmsOutstandingCall call, MmsError mmsError, ByteBuffer* response,
+        bool createArray)
+{
+    MmsConnection_ReadVariableHandler handler = (MmsConnection_ReadVariableHandler) call->userCallback;
+
+    MmsValue* value = NULL;
+
+    if (response != NULL) {
+        value = mmsClient_parseReadResponse(response, NULL, createArray);
+
+        if (value == NULL)
+            mmsError = MMS_ERROR_PARSING_RESPONSE;
+    }
+
+    handler(call->invokeId, call->userParameter, mmsError, value);
+}
+
+static void
+handleAsyncReadSingleValueResponse(MmsConnection self, MmsOutstandingCall call, MmsError mmsError,
+        ByteBuffer* response, int bufPos)
+{
+    handleAsyncReadResponse(self, call, mmsError, response, false);
+}
+
+static void
+handleAsyncReadMultipleValuesResponse(MmsConnection self, MmsOutstandingCall call, MmsError mmsError,
+        ByteBuffer* response, int bufPos)
+{
+    handleAsyncReadResponse(self, call, mmsError, response, true);
+}
+
+static void
+handleAsyncWriteResponse(MmsConnection self, MmsOutstandingCall call, MmsError mmsError,
+        ByteBuffer* response, int bufPos)
+{
+    MmsConnection_WriteVariableHandler handler = (MmsConnection_WriteVariableHandler) call->userCallback;
+
+    if (response != NULL)
+        mmsClient_parseWriteResponse(response, bufPos, &mmsError);
+
+    handler(call->invokeId, call->userParameter, mmsError);
+}
+
+static void
+handleAsyncGetVariableAccessAttributesResponse(MmsConnection self, MmsOutstandingCall call, MmsError mmsError,
+        ByteBuffer* response, int bufPos)
+{
+    MmsConnection_GetVariableAccessAttributesHandler handler =
+            (MmsConnection_GetVariableAccessAttributesHandler) call->userCallback;
+
+    MmsVariableSpecification* typeSpec = NULL;
+
+    if (response != NULL) {
+        typeSpec = mmsClient_parseGetVariableAccessAttributesResponse(response, NULL);
+
+        if (typeSpec == NULL)
+            mmsError = MMS_ERROR_PARSING_RESPONSE;
+    }
+
+    handler(call->invokeId, call->userParameter, mmsError, typeSpec);
+}
+
+uint32_t
+MmsConnection_readVariableAsync(MmsConnection self, MmsError* mmsError, char* domainId, char* itemId,
+        MmsConnection_ReadVariableHandler handler, void* parameter)
+{
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return 0;
+
+    *mmsError = MMS_ERROR_NONE;
+
+    uint32_t invokeId = getNextInvokeId(self);
+
+    mmsClient_createReadRequest(invokeId, domainId, itemId, payload);
+
+    return sendAsyncRequest(self, invokeId, payload, handleAsyncReadSingleValueResponse,
+            (void*) handler, parameter, NULL, mmsError);
+}
+
+uint32_t
+MmsConnection_readArrayElementsAsync(MmsConnection self, MmsError* mmsError, char* domainId, char* itemId,
+        uint32_t startIndex, uint32_t numberOfElements,
+        MmsConnection_ReadVariableHandler handler, void* parameter)
+{
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return 0;
+
+    *mmsError = MMS_ERROR_NONE;
+
+    uint32_t invokeId = getNextInvokeId(self);
+
+    mmsClient_createReadRequestAlternateAccessIndex(invokeId, domainId, itemId, startIndex,
+            numberOfElements, payload);
+
+    return sendAsyncRequest(self, invokeId, payload, handleAsyncReadSingleValueResponse,
+            (void*) handler, parameter, NULL, mmsError);
+}
+
+uint32_t
+MmsConnection_readMultipleVariablesAsync(MmsConnection self, MmsError* mmsError, char* domainId,
+        LinkedList /*<char*>*/ items,
+        MmsConnection_ReadVariableHandler handler, void* parameter)
+{
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return 0;
+
+    *mmsError = MMS_ERROR_NONE;
+
+    uint32_t invokeId = getNextInvokeId(self);
+
+    mmsClient_createReadRequestMultipleValues(invokeId, domainId, items, payload);
+
+    return sendAsyncRequest(self, invokeId, payload, handleAsyncReadMultipleValuesResponse,
+            (void*) handler, parameter, NULL, mmsError);
+}
+
+uint32_t
+MmsConnection_readNamedVariableListValuesAsync(MmsConnection self, MmsError* mmsError, char* domainId,
+        char* listName, bool specWithResult,
+        MmsConnection_ReadVariableHandler handler, void* parameter)
+{
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return 0;
+
+    *mmsError = MMS_ERROR_NONE;
+
+    uint32_t invokeId = getNextInvokeId(self);
+
+    mmsClient_createReadNamedVariableListRequest(invokeId, domainId, listName,
+            payload, specWithResult);
+
+    return sendAsyncRequest(self, invokeId, payload, handleAsyncReadMultipleValuesResponse,
+            (void*) handler, parameter, NULL, mmsError);
+}
+
+uint32_t
+MmsConnection_writeVariableAsync(MmsConnection self, MmsError* mmsError, char* domainId, char* itemId,
+        MmsValue* value,
+        MmsConnection_WriteVariableHandler handler, void* parameter)
+{
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return 0;
+
+    *mmsError = MMS_ERROR_NONE;
+
+    uint32_t invokeId = getNextInvokeId(self);
+
+    mmsClient_createWriteRequest(invokeId, domainId, itemId, value, payload);
+
+    return sendAsyncRequest(self, invokeId, payload, handleAsyncWriteResponse,
+            (void*) handler, parameter, NULL, mmsError);
+}
+
+uint32_t
+MmsConnection_getVariableAccessAttributesAsync(MmsConnection self, MmsError* mmsError,
+        char* domainId, char* itemId,
+        MmsConnection_GetVariableAccessAttributesHandler handler, void* parameter)
+{
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return 0;
+
+    *mmsError = MMS_ERROR_NONE;
+
+    uint32_t invokeId = getNextInvokeId(self);
+
+    mmsClient_createGetVariableAccessAttributesRequest(invokeId, domainId, itemId, payload);
+
+    return sendAsyncRequest(self, invokeId, payload, handleAsyncGetVariableAccessAttributesResponse,
+            (void*) handler, parameter, NULL, mmsError);
+}
+
+static void
+handleAsyncGetNameListResponse(MmsConnection self, MmsOutstandingCall call, MmsError mmsError,
+        ByteBuffer* response, int bufPos)
+{
+    MmsConnection_GetNameListHandler handler = (MmsConnection_GetNameListHandler) call->userCallback;
+
+    LinkedList nameList = NULL;
+    bool moreFollows = false;
+
+    if (response != NULL) {
+        moreFollows = mmsClient_parseGetNameListResponse(&nameList, response, NULL);
+
+        if (nameList == NULL)
+            mmsError = MMS_ERROR_PARSING_RESPONSE;
+    }
+
+    handler(call->invokeId, call->userParameter, mmsError, nameList, moreFollows);
+}
+
+static uint32_t
+getNameListAsync(MmsConnection self, MmsError* mmsError, char* domainId, MmsObjectClass objectClass,
+        char* continueAfter, MmsConnection_GetNameListHandler handler, void* parameter)
+{
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return 0;
+
+    *mmsError = MMS_ERROR_NONE;
+
+    uint32_t invokeId = getNextInvokeId(self);
+
+    if (objectClass == MMS_DOMAIN_NAMES)
+        mmsClient_createMmsGetNameListRequestVMDspecific(invokeId, payload, continueAfter);
+    else
+        mmsClient_createGetNameListRequestDomainOrVMDSpecific(invokeId, domainId, payload, objectClass,
+                continueAfter);
+
+    return sendAsyncRequest(self, invokeId, payload, handleAsyncGetNameListResponse,
+            (void*) handler, parameter, NULL, mmsError);
+}
+
+uint32_t
+MmsConnection_getDomainNamesAsync(MmsConnection self, MmsError* mmsError, char* continueAfter,
+        MmsConnection_GetNameListHandler handler, void* parameter)
+{
+    return getNameListAsync(self, mmsError, NULL, MMS_DOMAIN_NAMES, continueAfter, handler, parameter);
+}
+
+uint32_t
+MmsConnection_getDomainVariableNamesAsync(MmsConnection self, MmsError* mmsError, char* domainId,
+        char* continueAfter, MmsConnection_GetNameListHandler handler, void* parameter)
+{
+    return getNameListAsync(self, mmsError, domainId, MMS_NAMED_VARIABLE, continueAfter, handler, parameter);
+}
+
+uint32_t
+MmsConnection_getDomainVariableListNamesAsync(MmsConnection self, MmsError* mmsError, char* domainId,
+        char* continueAfter, MmsConnection_GetNameListHandler handler, void* parameter)
+{
+    return getNameListAsync(self, mmsError, domainId, MMS_NAMED_VARIABLE_LIST, continueAfter, handler,
+            parameter);
+}
+
+typedef struct
+{
+    uint8_t* buffer;
+    uint32_t bytesReceived;
+} FileReadData;
+
+static void
+fileReadDataHandler(void* parameter, int32_t frsmId, uint8_t* buffer, uint32_t bytesReceived)
+{
+    FileReadData* data = (FileReadData*) parameter;
+
+    data->buffer = buffer;
+    data->bytesReceived = bytesReceived;
+}
+
+static void
+handleAsyncFileReadResponse(MmsConnection self, MmsOutstandingCall call, MmsError mmsError,
+        ByteBuffer* response, int bufPos)
+{
+    MmsConnection_FileReadHandler handler = (MmsConnection_FileReadHandler) call->userCallback;
+
+    int32_t frsmId = (int32_t) (intptr_t) call->internalParameter;
+
+    FileReadData data = { NULL, 0 };
+    bool moreFollows = false;
+
+    if (response != NULL) {
+        if (mmsClient_parseFileReadResponse(response, bufPos, frsmId, &moreFollows, fileReadDataHandler,
+                &data) == false)
+        {
+            mmsError = MMS_ERROR_PARSING_RESPONSE;
+            moreFollows = false;
+        }
+    }
+
+    handler(call->invokeId, call->userParameter, mmsError, frsmId, data.buffer, data.bytesReceived, moreFollows);
+}
+
+uint32_t
+MmsConnection_fileReadAsync(MmsConnection self, MmsError* mmsError, int32_t frsmId,
+        MmsConnection_FileReadHandler handler, void* parameter)
+{
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return 0;
+
+    *mmsError = MMS_ERROR_NONE;
+
+    uint32_t invokeId = getNextInvokeId(self);
+
+    mmsClient_createFileReadRequest(invokeId, payload, frsmId);
+
+    return sendAsyncRequest(self, invokeId, payload, handleAsyncFileReadResponse,
+            (void*) handler, parameter, (void*) (intptr_t) frsmId, mmsError);
+}
+
+static void
+handleAsyncEncodedServiceResponse(MmsConnection self, MmsOutstandingCall call, MmsError mmsError,
+        ByteBuffer* response, int bufPos)
+{
+    MmsEncodedServiceResponseHandler handler = (MmsEncodedServiceResponseHandler) call->userCallback;
+
+    handler(call->invokeId, call->userParameter, mmsError, response);
+}
+
+uint32_t
+mmsClient_sendEncodedServiceRequest(MmsConnection self, MmsError* mmsError, uint8_t* serviceRequest,
+        int serviceRequestSize, MmsEncodedServiceResponseHandler handler, void* parameter)
+{
+    ByteBuffer* payload = allocateRequestBuffer(self, mmsError);
+
+    if (payload == NULL)
+        return 0;
+
+    *mmsError = MMS_ERROR_NONE;
+
+    uint32_t invokeId = getNextInvokeId(self);
+
+    uint32_t invokeIdSize = BerEncoder_UInt32determineEncodedSize(invokeId);
+    uint32_t confirmedRequestPduSize = 2 + invokeIdSize + serviceRequestSize;
+
+    if ((int) (1 + BerEncoder_determineLengthSize(confirmedRequestPduSize) + confirmedRequestPduSize)
+            > payload->maxSize)
+    {
+        IsoClientConnection_releaseTransmitBuffer(self->isoClient);
+        *mmsError = MMS_ERROR_RESOURCE_OTHER;
+        return 0;
+    }
+
+    int bufPos = 0;
+    uint8_t* buffer = payload->buffer;
+
+    bufPos = BerEncoder_encodeTL(0xa0, confirmedRequestPduSize, buffer, bufPos);
+    bufPos = BerEncoder_encodeTL(0x02, invokeIdSize, buffer, bufPos);
+    bufPos = BerEncoder_encodeUInt32(invokeId, buffer, bufPos);
+
+    memcpy(buffer + bufPos, serviceRequest, serviceRequestSize);
+
+    payload->size = bufPos + serviceRequestSize;
+
+    return sendAsyncRequest(self, invokeId, payload, handleAsyncEncodedServiceResponse,
+            (void*) handler, parameter, NULL, mmsError);
+}
+
 void
 MmsServerIdentity_destroy(MmsServerIdentity* self)
 {
@@ -141,6 +141,42 @@ MmsConnection_setIsoConnectionParameters(MmsConnection self, IsoConnectionParame
 void
 MmsConnection_destroy(MmsConnection self);
 
+/**
+ * \brief Set the number of concurrently outstanding requests proposed to the server
+ *
+ * The client proposes these values in the initiate request. The number of requests the client
+ * sends without waiting for a response (the window) is limited by the value negotiated with the
+ * server. Further requests block until a response is received. The default for both values is 5.
+ * This function has to be called before MmsConnection_connect.
+ *
+ * \param self MmsConnection instance to operate on
+ * \param calling maximum number of outstanding requests sent by the client
+ * \param called maximum number of outstanding requests sent by the server
+ */
+void
+MmsConnection_setMaxOutstandingCalls(MmsConnection self, int calling, int called);
+
+/**
+ * \brief Get the negotiated number of concurrently outstanding requests (the request window)
+ *
+ * \param self MmsConnection instance to operate on
+ */
+int
+MmsConnection_getMaxOutstandingCalls(MmsConnection self);
+
+/**
+ * \brief Get the receive path statistics of the connection
+ *
+ * The statistics show if the receive buffers are sufficient for the application. A growing
+ * number of receiver stalls indicates that received messages are processed (or released)
+ * too slowly by the application.
+ *
+ * \param self MmsConnection instance to operate on
+ * \param statistics the structure the statistics are written to
+ */
+void
+MmsConnection_getReceiveStatistics(MmsConnection self, IsoClientReceiveStatistics* statistics);
+
 /*******************************************************************************
  * Blocking functions for connection establishment and data access
  *******************************************************************************/
@@ -273,6 +309,25 @@ MmsConnection_getVariableListNamesAssociationSpecific(MmsConnection self, MmsErr
 MmsValue*
 MmsConnection_readVariable(MmsConnection self, MmsError* mmsError, char* domainId, char* itemId);
 
+/**
+ * \brief Read a single variable from the server into an existing MmsValue instance
+ *
+ * The value has to be of the same type and structure as the variable (e.g. the result of a
+ * previous read). The response is decoded directly into the value without creating new MmsValue
+ * instances, so polling a variable periodically doesn't allocate memory.
+ *
+ * \param self MmsConnection instance to operate on
+ * \param mmsError user provided variable to store error code
+ * \param domainId the domain name of the variable to be read or NULL to read a VMD specific named variable
+ * \param itemId name of the variable to be read
+ * \param value the value to update
+ *
+ * \return true if the value has been updated, false otherwise
+ */
+bool
+MmsConnection_readVariableIntoValue(MmsConnection self, MmsError* mmsError, char* domainId, char* itemId,
+        MmsValue* value);
+
 /**
  * \brief Read an element of a single array variable from the server.
  *
@@ -374,6 +429,27 @@ MmsConnection_readNamedVariableListValues(MmsConnection self, MmsError* mmsError
         char* listName,	bool specWithResult);
 
 
+/**
+ * \brief Read the values of a named variable list into an existing MmsValue instance
+ *
+ * The values parameter has to be an MMS_ARRAY with one element for each list member, each of the
+ * same type and structure as the member (e.g. the result of a previous call to
+ * MmsConnection_readNamedVariableListValues). The response is decoded directly into the existing
+ * elements. Elements for which the server reports an access error keep their old value.
+ *
+ * \param self MmsConnection instance to operate on
+ * \param mmsError user provided variable to store error code
+ * \param domainId the domain name of the named variable list or NULL for an association specific list
+ * \param listName the name of the named variable list
+ * \param specWithResult if specWithResult is set to true, a IEC 61850 compliant request will be sent.
+ * \param values the MMS_ARRAY value to update
+ *
+ * \return true if the values have been updated, false otherwise
+ */
+bool
+MmsConnection_readNamedVariableListValuesIntoValue(MmsConnection self, MmsError* mmsError, char* domainId,
+        char* listName, bool specWithResult, MmsValue* values);
+
 /**
  * \brief Read the values of a association specific named variable list
  *
@@ -559,6 +635,181 @@ void
 MmsConnection_getServerStatus(MmsConnection self, MmsError* mmsError, int* vmdLogicalStatus, int* vmdPhysicalStatus,
         bool extendedDerivation);
 
+/*******************************************************************************
+ * Non-blocking (asynchronous) functions for data access
+ *******************************************************************************/
+
+/*
+ * The asynchronous functions send the request and return immediately with the invokeId of the
+ * request (0 if the request could not be sent - mmsError is set accordingly). They only block
+ * when the window of outstanding requests is full (see MmsConnection_setMaxOutstandingCalls).
+ *
+ * The handler is called by the connection's receive thread when the response is received, when the
+ * request timed out, or when the connection is lost. The handler must not call blocking functions
+ * of the same connection.
+ *
+ * Timeouts of asynchronous requests are checked by the receive thread when a message is received.
+ * Call MmsConnection_handleTimeouts periodically if there is no other traffic on the connection.
+ */
+
+/**
+ * \brief Handler for asynchronous read requests
+ *
+ * \param invokeId the invokeId of the request
+ * \param parameter user provided parameter
+ * \param mmsError MMS_ERROR_NONE on success
+ * \param value the read value or NULL in case of an error. The user is responsible to delete the value.
+ */
+typedef void
+(*MmsConnection_ReadVariableHandler) (uint32_t invokeId, void* parameter, MmsError mmsError, MmsValue* value);
+
+/**
+ * \brief Handler for asynchronous write requests
+ *
+ * \param invokeId the invokeId of the request
+ * \param parameter user provided parameter
+ * \param mmsError MMS_ERROR_NONE on success, otherwise the service error or data access error
+ */
+typedef void
+(*MmsConnection_WriteVariableHandler) (uint32_t invokeId, void* parameter, MmsError mmsError);
+
+/**
+ * \brief Handler for asynchronous get variable access attributes requests
+ *
+ * \param invokeId the invokeId of the request
+ * \param parameter user provided parameter
+ * \param mmsError MMS_ERROR_NONE on success
+ * \param typeSpec the variable specification or NULL in case of an error. The user is responsible to
+ *        delete the object.
+ */
+typedef void
+(*MmsConnection_GetVariableAccessAttributesHandler) (uint32_t invokeId, void* parameter, MmsError mmsError,
+        MmsVariableSpecification* typeSpec);
+
+/**
+ * \brief Asynchronous version of MmsConnection_readVariable
+ *
+ * \return the invokeId of the request or 0 if the request could not be sent
+ */
+uint32_t
+MmsConnection_readVariableAsync(MmsConnection self, MmsError* mmsError, char* domainId, char* itemId,
+        MmsConnection_ReadVariableHandler handler, void* parameter);
+
+/**
+ * \brief Asynchronous version of MmsConnection_readArrayElements
+ *
+ * \return the invokeId of the request or 0 if the request could not be sent
+ */
+uint32_t
+MmsConnection_readArrayElementsAsync(MmsConnection self, MmsError* mmsError, char* domainId, char* itemId,
+        uint32_t startIndex, uint32_t numberOfElements,
+        MmsConnection_ReadVariableHandler handler, void* parameter);
+
+/**
+ * \brief Asynchronous version of MmsConnection_readMultipleVariables
+ *
+ * \return the invokeId of the request or 0 if the request could not be sent
+ */
+uint32_t
+MmsConnection_readMultipleVariablesAsync(MmsConnection self, MmsError* mmsError, char* domainId,
+        LinkedList /*<char*>*/ items,
+        MmsConnection_ReadVariableHandler handler, void* parameter);
+
+/**
+ * \brief Asynchronous version of MmsConnection_readNamedVariableListValues
+ *
+ * \return the invokeId of the request or 0 if the request could not be sent
+ */
+uint32_t
+MmsConnection_readNamedVariableListValuesAsync(MmsConnection self, MmsError* mmsError, char* domainId,
+        char* listName, bool specWithResult,
+        MmsConnection_ReadVariableHandler handler, void* parameter);
+
+/**
+ * \brief Asynchronous version of MmsConnection_writeVariable
+ *
+ * \return the invokeId of the request or 0 if the request could not be sent
+ */
+uint32_t
+MmsConnection_writeVariableAsync(MmsConnection self, MmsError* mmsError, char* domainId, char* itemId,
+        MmsValue* value,
+        MmsConnection_WriteVariableHandler handler, void* parameter);
+
+/**
+ * \brief Asynchronous version of MmsConnection_getVariableAccessAttributes
+ *
+ * \return the invokeId of the request or 0 if the request could not be sent
+ */
+uint32_t
+MmsConnection_getVariableAccessAttributesAsync(MmsConnection self, MmsError* mmsError,
+        char* domainId, char* itemId,
+        MmsConnection_GetVariableAccessAttributesHandler handler, void* parameter);
+
+/**
+ * \brief Handler for asynchronous get name list requests
+ *
+ * \param invokeId the invokeId of the request
+ * \param parameter user provided parameter
+ * \param mmsError MMS_ERROR_NONE on success
+ * \param nameList the received names (char*) or NULL in case of an error. The user is responsible to
+ *        delete the list (LinkedList_destroy).
+ * \param moreFollows true if the server has more names. Continue with a new request using the last
+ *        received name as continueAfter parameter.
+ */
+typedef void
+(*MmsConnection_GetNameListHandler) (uint32_t invokeId, void* parameter, MmsError mmsError,
+        LinkedList /*<char*>*/ nameList, bool moreFollows);
+
+/**
+ * \brief Asynchronous version of MmsConnection_getDomainNames
+ *
+ * Only a single GetNameList request is sent. The handler has to take care of the moreFollows flag.
+ *
+ * \param continueAfter name of the last received domain or NULL to start at the beginning
+ *
+ * \return the invokeId of the request or 0 if the request could not be sent
+ */
+uint32_t
+MmsConnection_getDomainNamesAsync(MmsConnection self, MmsError* mmsError, char* continueAfter,
+        MmsConnection_GetNameListHandler handler, void* parameter);
+
+/**
+ * \brief Asynchronous version of MmsConnection_getDomainVariableNames
+ *
+ * Only a single GetNameList request is sent. The handler has to take care of the moreFollows flag.
+ *
+ * \param continueAfter name of the last received variable or NULL to start at the beginning
+ *
+ * \return the invokeId of the request or 0 if the request could not be sent
+ */
+uint32_t
+MmsConnection_getDomainVariableNamesAsync(MmsConnection self, MmsError* mmsError, char* domainId,
+        char* continueAfter, MmsConnection_GetNameListHandler handler, void* parameter);
+
+/**
+ * \brief Asynchronous version of MmsConnection_getDomainVariableListNames
+ *
+ * Only a single GetNameList request is sent. The handler has to take care of the moreFollows flag.
+ *
+ * \param continueAfter name of the last received named variable list or NULL to start at the beginning
+ *
+ * \return the invokeId of the request or 0 if the request could not be sent
+ */
+uint32_t
+MmsConnection_getDomainVariableListNamesAsync(MmsConnection self, MmsError* mmsError, char* domainId,
+        char* continueAfter, MmsConnection_GetNameListHandler handler, void* parameter);
+
+/**
+ * \brief Complete asynchronous requests whose timeout elapsed (handler is called with MMS_ERROR_SERVICE_TIMEOUT)
+ *
+ * The handlers are called by the calling thread. Don't call this function while holding a lock that
+ * the handlers require.
+ *
+ * \param self MmsConnection instance to operate on
+ */
+void
+MmsConnection_handleTimeouts(MmsConnection self);
+
 /*******************************************************************************
  * functions for MMS file services
  *******************************************************************************/
@@ -592,6 +843,33 @@ MmsConnection_fileOpen(MmsConnection self, MmsError* mmsError, char* filename, u
 bool
 MmsConnection_fileRead(MmsConnection self, MmsError* mmsError, int32_t frsmId, MmsFileReadHandler handler, void* handlerParameter);
 
+/**
+ * \brief Handler for asynchronous file read requests
+ *
+ * \param invokeId the invokeId of the request
+ * \param parameter user provided parameter
+ * \param mmsError MMS_ERROR_NONE on success
+ * \param frsmId the FRSM ID of the file
+ * \param buffer the received data. Only valid while the handler is running.
+ * \param bytesReceived number of bytes in the buffer
+ * \param moreFollows false if the end of the file is reached
+ */
+typedef void
+(*MmsConnection_FileReadHandler) (uint32_t invokeId, void* parameter, MmsError mmsError, int32_t frsmId,
+        uint8_t* buffer, uint32_t bytesReceived, bool moreFollows);
+
+/**
+ * \brief Asynchronous version of MmsConnection_fileRead
+ *
+ * Multiple requests for the same file can be sent without waiting for the responses. The server
+ * returns the data blocks in the order of the requests.
+ *
+ * \return the invokeId of the request or 0 if the request could not be sent
+ */
+uint32_t
+MmsConnection_fileReadAsync(MmsConnection self, MmsError* mmsError, int32_t frsmId,
+        MmsConnection_FileReadHandler handler, void* parameter);
+
 /**
  * \brief close the file with the specified frsmID
  *
@@ -344,12 +344,11 @@ parseListOfDirectoryEntries(uint8_t* buffer, int bufPos, int maxBufPos,
 
 
 bool
-mmsClient_parseFileDirectoryResponse(MmsConnection self, MmsFileDirectoryHandler handler, void* handlerParameter,
+mmsClient_parseFileDirectoryResponse(ByteBuffer* response, int bufPos, MmsFileDirectoryHandler handler, void* handlerParameter,
         bool* moreFollows)
 {
-    uint8_t* buffer = self->lastResponse->buffer;
-    int maxBufPos = self->lastResponse->size;
-    int bufPos = self->lastResponseBufPos;
+    uint8_t* buffer = response->buffer;
+    int maxBufPos = response->size;
     int length;
 
     uint8_t tag = buffer[bufPos++];
@@ -407,11 +406,10 @@ mmsClient_parseFileDirectoryResponse(MmsConnection self, MmsFileDirectoryHandler
 }
 
 bool
-mmsClient_parseFileOpenResponse(MmsConnection self, int32_t* frsmId, uint32_t* fileSize, uint64_t* lastModified)
+mmsClient_parseFileOpenResponse(ByteBuffer* response, int bufPos, int32_t* frsmId, uint32_t* fileSize, uint64_t* lastModified)
 {
-    uint8_t* buffer = self->lastResponse->buffer;
-    int maxBufPos = self->lastResponse->size;
-    int bufPos = self->lastResponseBufPos;
+    uint8_t* buffer = response->buffer;
+    int maxBufPos = response->size;
     int length;
 
     uint8_t tag = buffer[bufPos++];
@@ -470,11 +468,10 @@ mmsClient_parseFileOpenResponse(MmsConnection self, int32_t* frsmId, uint32_t* f
 
 
 bool
-mmsClient_parseFileReadResponse(MmsConnection self, int32_t frsmId,  bool* moreFollows, MmsFileReadHandler handler, void* handlerParameter)
+mmsClient_parseFileReadResponse(ByteBuffer* response, int bufPos, int32_t frsmId,  bool* moreFollows, MmsFileReadHandler handler, void* handlerParameter)
 {
-    uint8_t* buffer = self->lastResponse->buffer;
-    int maxBufPos = self->lastResponse->size;
-    int bufPos = self->lastResponseBufPos;
+    uint8_t* buffer = response->buffer;
+    int maxBufPos = response->size;
     int length;
 
     uint8_t tag = buffer[bufPos++];
@@ -29,136 +29,322 @@
 #include "string_utilities.h"
 
 #include "mms_client_internal.h"
+#include "mms_type_spec.h"
+#include "ber_decode.h"
 
 static MmsVariableSpecification*
-createTypeSpecification(TypeSpecification_t* asnTypeSpec) {
-	MmsVariableSpecification* typeSpec = (MmsVariableSpecification*) 
-						calloc(1, sizeof(MmsVariableSpecification));
-
-	switch (asnTypeSpec->present) {
-	case TypeSpecification_PR_structure:
-		{
-			typeSpec->type = MMS_STRUCTURE;
-
-			int elementCount = asnTypeSpec->choice.structure.components.list.count;
-			typeSpec->typeSpec.structure.elementCount = elementCount;
-
-			typeSpec->typeSpec.structure.elements = (MmsVariableSpecification**)
-					calloc(elementCount, sizeof(MmsVariableSpecification*));
-
-			int i;
-
-			for (i = 0; i < elementCount; i++) {
-
-				char* name = createStringFromBuffer(
-						asnTypeSpec->choice.structure.components.list.array[i]->componentName->buf,
-						asnTypeSpec->choice.structure.components.list.array[i]->componentName->size);
-
-				typeSpec->typeSpec.structure.elements[i] =
-						createTypeSpecification(asnTypeSpec->choice.structure.components.
-								list.array[i]->componentType);
-
-				typeSpec->typeSpec.structure.elements[i]->name = name;
-			}
-		}
-		break;
-	case TypeSpecification_PR_array:
-		{
-			typeSpec->type = MMS_ARRAY;
-
-			long elementCount;
-			asn_INTEGER2long(&asnTypeSpec->choice.array.numberOfElements, &elementCount);
-
-			typeSpec->typeSpec.array.elementCount = elementCount;
-
-			typeSpec->typeSpec.array.elementTypeSpec =
-					createTypeSpecification(asnTypeSpec->choice.array.elementType);
-		}
-		break;
-	case TypeSpecification_PR_boolean:
-		typeSpec->type = MMS_BOOLEAN;
-		break;
-	case TypeSpecification_PR_bitstring:
-		typeSpec->type = MMS_BIT_STRING;
-		typeSpec->typeSpec.bitString = asnTypeSpec->choice.bitstring;
-		break;
-	case TypeSpecification_PR_integer:
-		typeSpec->type = MMS_INTEGER;
-		typeSpec->typeSpec.integer = asnTypeSpec->choice.integer;
-		break;
-	case TypeSpecification_PR_unsigned:
-		typeSpec->type = MMS_UNSIGNED;
-		typeSpec->typeSpec.unsignedInteger = asnTypeSpec->choice.Unsigned;
-		break;
-	case TypeSpecification_PR_floatingpoint:
-		typeSpec->type = MMS_FLOAT;
-		typeSpec->typeSpec.floatingpoint.exponentWidth =
-				asnTypeSpec->choice.floatingpoint.exponentwidth;
-		typeSpec->typeSpec.floatingpoint.formatWidth =
-						asnTypeSpec->choice.floatingpoint.formatwidth;
-		break;
-	case TypeSpecification_PR_octetstring:
-		typeSpec->type = MMS_OCTET_STRING;
-		typeSpec->typeSpec.octetString = asnTypeSpec->choice.octetstring;
-		break;
-	case TypeSpecification_PR_visiblestring:
-		typeSpec->type = MMS_VISIBLE_STRING;
-		typeSpec->typeSpec.visibleString = asnTypeSpec->choice.visiblestring;
-		break;
-	case TypeSpecification_PR_mMSString:
-		typeSpec->type = MMS_STRING;
-		typeSpec->typeSpec.mmsString = asnTypeSpec->choice.mMSString;
-		break;
-	case TypeSpecification_PR_utctime:
-		typeSpec->type = MMS_UTC_TIME;
-		break;
-	case TypeSpecification_PR_binarytime:
-	    typeSpec->type = MMS_BINARY_TIME;
-	    if (asnTypeSpec->choice.binarytime == 0)
-	        typeSpec->typeSpec.binaryTime = 4;
-	    else
-	        typeSpec->typeSpec.binaryTime = 6;
-	    break;
-	default:
-		printf("ERROR: unknown type in type specification\n");
-		break;
-	}
-
-	return typeSpec;
+parseTypeSpecification(uint8_t* buffer, int bufPos, int maxBufPos);
+
+static int
+parseInteger(uint8_t* buffer, int bufPos, int maxBufPos, uint8_t expectedTag, int32_t* value)
+{
+    int length;
+
+    if ((bufPos >= maxBufPos) || (buffer[bufPos] != expectedTag))
+        return -1;
+
+    bufPos = BerDecoder_decodeLength(buffer, &length, bufPos + 1, maxBufPos);
+
+    if ((bufPos < 0) || (length < 1) || (length > 4) || (bufPos + length > maxBufPos))
+        return -1;
+
+    *value = BerDecoder_decodeInt32(buffer, length, bufPos);
+
+    return bufPos + length;
+}
+
+static bool
+parseStructureComponents(uint8_t* buffer, int bufPos, int maxBufPos, MmsVariableSpecification* typeSpec)
+{
+    int length;
+
+    if ((bufPos < maxBufPos) && (buffer[bufPos] == 0x80)) { /* skip packed */
+        bufPos = BerDecoder_decodeLength(buffer, &length, bufPos + 1, maxBufPos);
+        if ((bufPos < 0) || (length < 0)) return false;
+        bufPos += length;
+    }
+
+    if ((bufPos >= maxBufPos) || (buffer[bufPos] != 0xa1)) /* components */
+        return false;
+
+    bufPos = BerDecoder_decodeLength(buffer, &length, bufPos + 1, maxBufPos);
+    if ((bufPos < 0) || (length < 0) || (bufPos + length > maxBufPos)) return false;
+
+    int componentsEndPos = bufPos + length;
+
+    /* count components */
+    int elementCount = 0;
+    int pos = bufPos;
+
+    while (pos < componentsEndPos) {
+        pos = BerDecoder_decodeLength(buffer, &length, pos + 1, componentsEndPos);
+        if ((pos < 0) || (length < 0)) return false;
+        pos += length;
+        elementCount++;
+    }
+
+    typeSpec->typeSpec.structure.elements = (MmsVariableSpecification**)
+            calloc(elementCount, sizeof(MmsVariableSpecification*));
+
+    int i;
+
+    for (i = 0; i < elementCount; i++) {
+        if (buffer[bufPos] != 0x30)
+            return false;
+
+        bufPos = BerDecoder_decodeLength(buffer, &length, bufPos + 1, componentsEndPos);
+        if (bufPos < 0) return false;
+
+        int componentEndPos = bufPos + length;
+
+        char* name = NULL;
+
+        if ((bufPos < componentEndPos) && (buffer[bufPos] == 0x80)) { /* componentName */
+            bufPos = BerDecoder_decodeLength(buffer, &length, bufPos + 1, componentEndPos);
+            if ((bufPos < 0) || (length < 0) || (bufPos + length > componentEndPos)) return false;
+
+            name = createStringFromBuffer(buffer + bufPos, length);
+            bufPos += length;
+        }
+
+        if ((bufPos >= componentEndPos) || (buffer[bufPos] != 0xa1)) { /* componentType */
+            free(name);
+            return false;
+        }
+
+        bufPos = BerDecoder_decodeLength(buffer, &length, bufPos + 1, componentEndPos);
+
+        MmsVariableSpecification* element = NULL;
+
+        if (bufPos >= 0)
+            element = parseTypeSpecification(buffer, bufPos, componentEndPos);
+
+        if (element == NULL) {
+            free(name);
+            return false;
+        }
+
+        element->name = name;
+
+        typeSpec->typeSpec.structure.elements[i] = element;
+        typeSpec->typeSpec.structure.elementCount = i + 1;
+
+        bufPos = componentEndPos;
+    }
+
+    return true;
+}
+
+static bool
+parseArrayDescription(uint8_t* buffer, int bufPos, int maxBufPos, MmsVariableSpecification* typeSpec)
+{
+    int length;
+    int32_t elementCount;
+
+    if ((bufPos < maxBufPos) && (buffer[bufPos] == 0x80)) { /* skip packed */
+        bufPos = BerDecoder_decodeLength(buffer, &length, bufPos + 1, maxBufPos);
+        if ((bufPos < 0) || (length < 0)) return false;
+        bufPos += length;
+    }
+
+    bufPos = parseInteger(buffer, bufPos, maxBufPos, 0x81, &elementCount);
+    if (bufPos < 0) return false;
+
+    if ((bufPos >= maxBufPos) || (buffer[bufPos] != 0xa2)) /* elementType */
+        return false;
+
+    bufPos = BerDecoder_decodeLength(buffer, &length, bufPos + 1, maxBufPos);
+    if (bufPos < 0) return false;
+
+    typeSpec->typeSpec.array.elementCount = elementCount;
+    typeSpec->typeSpec.array.elementTypeSpec = parseTypeSpecification(buffer, bufPos, maxBufPos);
+
+    return (typeSpec->typeSpec.array.elementTypeSpec != NULL);
+}
+
+static void
+deleteIncompleteTypeSpecification(MmsVariableSpecification* typeSpec)
+{
+    if ((typeSpec->type == MMS_ARRAY) && (typeSpec->typeSpec.array.elementTypeSpec == NULL))
+        free(typeSpec);
+    else if ((typeSpec->type == MMS_STRUCTURE) && (typeSpec->typeSpec.structure.elements == NULL))
+        free(typeSpec);
+    else
+        MmsVariableSpecification_destroy(typeSpec);
+}
+
+static MmsVariableSpecification*
+parseTypeSpecification(uint8_t* buffer, int bufPos, int maxBufPos)
+{
+    int length;
+    int32_t intValue;
+
+    if (bufPos >= maxBufPos)
+        return NULL;
+
+    uint8_t tag = buffer[bufPos];
+
+    int contentPos = BerDecoder_decodeLength(buffer, &length, bufPos + 1, maxBufPos);
+
+    if ((contentPos < 0) || (length < 0) || (contentPos + length > maxBufPos))
+        return NULL;
+
+    int contentEndPos = contentPos + length;
+
+    MmsVariableSpecification* typeSpec = (MmsVariableSpecification*)
+            calloc(1, sizeof(MmsVariableSpecification));
+
+    switch (tag) {
+    case 0xa1: /* array */
+        typeSpec->type = MMS_ARRAY;
+        if (!parseArrayDescription(buffer, contentPos, contentEndPos, typeSpec))
+            goto exit_error;
+        break;
+    case 0xa2: /* structure */
+        typeSpec->type = MMS_STRUCTURE;
+        if (!parseStructureComponents(buffer, contentPos, contentEndPos, typeSpec))
+            goto exit_error;
+        break;
+    case 0x83: /* boolean */
+        typeSpec->type = MMS_BOOLEAN;
+        break;
+    case 0x84: /* bit-string */
+        typeSpec->type = MMS_BIT_STRING;
+        if (parseInteger(buffer, bufPos, maxBufPos, tag, &intValue) < 0) goto exit_error;
+        typeSpec->typeSpec.bitString = intValue;
+        break;
+    case 0x85: /* integer */
+        typeSpec->type = MMS_INTEGER;
+        if (parseInteger(buffer, bufPos, maxBufPos, tag, &intValue) < 0) goto exit_error;
+        typeSpec->typeSpec.integer = intValue;
+        break;
+    case 0x86: /* unsigned */
+        typeSpec->type = MMS_UNSIGNED;
+        if (parseInteger(buffer, bufPos, maxBufPos, tag, &intValue) < 0) goto exit_error;
+        typeSpec->typeSpec.unsignedInteger = intValue;
+        break;
+    case 0xa7: /* floating-point */
+        {
+            int32_t formatWidth;
+            int32_t exponentWidth;
+
+            typeSpec->type = MMS_FLOAT;
+
+            int pos = parseInteger(buffer, contentPos, contentEndPos, 0x02, &formatWidth);
+            if (pos < 0) goto exit_error;
+
+            if (parseInteger(buffer, pos, contentEndPos, 0x02, &exponentWidth) < 0) goto exit_error;
+
+            typeSpec->typeSpec.floatingpoint.formatWidth = (uint8_t) formatWidth;
+            typeSpec->typeSpec.floatingpoint.exponentWidth = (uint8_t) exponentWidth;
+        }
+        break;
+    case 0x89: /* octet-string */
+        typeSpec->type = MMS_OCTET_STRING;
+        if (parseInteger(buffer, bufPos, maxBufPos, tag, &intValue) < 0) goto exit_error;
+        typeSpec->typeSpec.octetString = intValue;
+        break;
+    case 0x8a: /* visible-string */
+        typeSpec->type = MMS_VISIBLE_STRING;
+        if (parseInteger(buffer, bufPos, maxBufPos, tag, &intValue) < 0) goto exit_error;
+        typeSpec->typeSpec.visibleString = intValue;
+        break;
+    case 0x8c: /* binary-time */
+        typeSpec->type = MMS_BINARY_TIME;
+        if ((length == 1) && (buffer[contentPos] != 0))
+            typeSpec->typeSpec.binaryTime = 6;
+        else
+            typeSpec->typeSpec.binaryTime = 4;
+        break;
+    case 0x90: /* MMS string */
+        typeSpec->type = MMS_STRING;
+        if (parseInteger(buffer, bufPos, maxBufPos, tag, &intValue) < 0) goto exit_error;
+        typeSpec->typeSpec.mmsString = intValue;
+        break;
+    case 0x91: /* UTC time */
+        typeSpec->type = MMS_UTC_TIME;
+        break;
+    default:
+        if (DEBUG_MMS_CLIENT) printf("MMS_CLIENT: unsupported type in type specification (tag %02x)\n", tag);
+        goto exit_error;
+    }
+
+    return typeSpec;
+
+exit_error:
+    deleteIncompleteTypeSpecification(typeSpec);
+    return NULL;
 }
 
 MmsVariableSpecification*
-mmsClient_parseGetVariableAccessAttributesResponse(ByteBuffer* message, uint32_t* invokeId)
+mmsClient_decodeTypeSpecification(uint8_t* buffer, int bufPos, int maxBufPos)
 {
-	MmsPdu_t* mmsPdu = 0; /* allow asn1c to allocate structure */
-	MmsVariableSpecification* typeSpec = NULL;
+    return parseTypeSpecification(buffer, bufPos, maxBufPos);
+}
+
+bool
+mmsClient_findTypeSpecification(ByteBuffer* message, uint32_t* invokeId, int* typeSpecPos, int* typeSpecSize)
+{
+    uint8_t* buffer = ByteBuffer_getBuffer(message);
+    int maxBufPos = ByteBuffer_getSize(message);
+    int bufPos = 0;
+    int length;
 
-	asn_dec_rval_t rval = ber_decode(NULL, &asn_DEF_MmsPdu,
-			(void**) &mmsPdu, ByteBuffer_getBuffer(message), ByteBuffer_getSize(message));
+    if ((maxBufPos < 1) || (buffer[bufPos++] != 0xa1)) /* confirmed response PDU */
+        return false;
 
-	if (rval.code != RC_OK)
-	    return NULL;
+    bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, maxBufPos);
+    if (bufPos < 0) return false;
 
-	if (mmsPdu->present == MmsPdu_PR_confirmedResponsePdu) {
+    if ((bufPos >= maxBufPos) || (buffer[bufPos++] != 0x02)) /* invokeId */
+        return false;
 
-	    if (invokeId != NULL)
-	        *invokeId = mmsClient_getInvokeId(&mmsPdu->choice.confirmedResponsePdu);
+    bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, maxBufPos);
+    if ((bufPos < 0) || (length < 0) || (bufPos + length > maxBufPos)) return false;
 
-		if (mmsPdu->choice.confirmedResponsePdu.confirmedServiceResponse.present ==
-				ConfirmedServiceResponse_PR_getVariableAccessAttributes)
-		{
-			GetVariableAccessAttributesResponse_t* response;
+    if (invokeId != NULL)
+        *invokeId = BerDecoder_decodeUint32(buffer, length, bufPos);
 
-			response = &(mmsPdu->choice.confirmedResponsePdu.confirmedServiceResponse.choice.getVariableAccessAttributes);
-			TypeSpecification_t* asnTypeSpec = &response->typeSpecification;
+    bufPos += length;
 
-			typeSpec = createTypeSpecification(asnTypeSpec);
-		}
-	}
+    if ((bufPos >= maxBufPos) || (buffer[bufPos++] != 0xa6)) /* getVariableAccessAttributes */
+        return false;
 
-	asn_DEF_MmsPdu.free_struct(&asn_DEF_MmsPdu, mmsPdu, 0);
+    bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, maxBufPos);
+    if ((bufPos < 0) || (length < 0) || (bufPos + length > maxBufPos)) return false;
+
+    int responseEndPos = bufPos + length;
+
+    while (bufPos < responseEndPos) {
+        uint8_t tag = buffer[bufPos++];
+
+        bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, responseEndPos);
+        if ((bufPos < 0) || (length < 0) || (bufPos + length > responseEndPos)) return false;
+
+        if (tag == 0xa2) { /* typeSpecification */
+            *typeSpecPos = bufPos;
+            *typeSpecSize = length;
+            return true;
+        }
+
+        /* skip mmsDeletable and address */
+        bufPos += length;
+    }
+
+    return false;
+}
+
+MmsVariableSpecification*
+mmsClient_parseGetVariableAccessAttributesResponse(ByteBuffer* message, uint32_t* invokeId)
+{
+    int typeSpecPos;
+    int typeSpecSize;
+
+    if (mmsClient_findTypeSpecification(message, invokeId, &typeSpecPos, &typeSpecSize))
+        return parseTypeSpecification(ByteBuffer_getBuffer(message), typeSpecPos, typeSpecPos + typeSpecSize);
 
-	return typeSpec;
+    if (DEBUG_MMS_CLIENT) printf("MMS_CLIENT: error parsing GetVariableAccessAttributes response!\n");
+    return NULL;
 }
 
 int
@@ -50,11 +50,10 @@ mmsClient_createIdentifyRequest(uint32_t invokeId, ByteBuffer* request)
 }
 
 MmsServerIdentity*
-mmsClient_parseIdentifyResponse(MmsConnection self)
+mmsClient_parseIdentifyResponse(ByteBuffer* response, int bufPos)
 {
-    uint8_t* buffer = self->lastResponse->buffer;
-    int maxBufPos = self->lastResponse->size;
-    int bufPos = self->lastResponseBufPos;
+    uint8_t* buffer = response->buffer;
+    int maxBufPos = response->size;
     int length;
     MmsServerIdentity* identityInfo = NULL;
 
@@ -41,8 +41,8 @@ createInitiateRequestPdu(MmsConnection self)
     request.localDetailCalling = (Integer32_t*) calloc(1, sizeof(Integer32_t));
     *(request.localDetailCalling) = self->parameters.maxPduSize;
 
-    request.proposedMaxServOutstandingCalled = DEFAULT_MAX_SERV_OUTSTANDING_CALLED;
-    request.proposedMaxServOutstandingCalling = DEFAULT_MAX_SERV_OUTSTANDING_CALLING;
+    request.proposedMaxServOutstandingCalled = self->proposedMaxServOutstandingCalled;
+    request.proposedMaxServOutstandingCalling = self->proposedMaxServOutstandingCalling;
 
     request.proposedDataStructureNestingLevel = (Integer8_t*) calloc(1, sizeof(Integer8_t));
     *(request.proposedDataStructureNestingLevel) = DEFAULT_DATA_STRUCTURE_NESTING_LEVEL;
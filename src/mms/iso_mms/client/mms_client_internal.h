@@ -54,19 +54,67 @@ typedef enum {
 #define CONCLUDE_STATE_REJECTED 2
 #define CONCLUDE_STATE_ACCEPTED 3
 
+/**
+ * Handler for information reports with a VMD specific variable list name that are decoded
+ * directly from the message buffer (used by the IEC 61850 client for reports).
+ *
+ * accessResults contains the buffer positions of the accessResultCount access results. The
+ * message buffer is only valid while the handler is running.
+ */
+typedef void (*MmsEncodedInformationReportHandler) (void* parameter, char* variableListName,
+        uint8_t* buffer, int maxBufPos, int* accessResults, int accessResultCount);
+
+/* called when the timeouts of the asynchronous requests have been checked (see mmsClient_setTimeoutHandler) */
+typedef void (*MmsTimeoutHandler) (void* parameter);
+
+typedef struct sMmsOutstandingCall* MmsOutstandingCall;
+
+/**
+ * Handler for the response of an asynchronous request. Called by the receive thread.
+ * In case of an error (or timeout) response is NULL.
+ */
+typedef void (*MmsOutstandingCallHandler) (MmsConnection self, MmsOutstandingCall call, MmsError mmsError,
+        ByteBuffer* response, int bufPos);
+
+/* entry of the outstanding calls table */
+struct sMmsOutstandingCall {
+    bool isUsed;
+    uint32_t invokeId;
+    uint64_t timeout; /* absolute time in ms */
+
+    /* asynchronous requests - handler is NULL for synchronous requests */
+    MmsOutstandingCallHandler handler;
+    void* userCallback;
+    void* userParameter;
+    void* internalParameter;
+
+    /* synchronous requests */
+    Semaphore responseReceived;
+    bool completed;
+    ByteBuffer* response;
+    int responseBufPos;
+    MmsError error;
+};
+
 /* private instance variables */
 struct sMmsConnection {
     Semaphore lastInvokeIdLock;
     uint32_t lastInvokeId;
 
-	Semaphore lastResponseLock;
-    uint32_t responseInvokeId;
+    /* initiate response - valid while the receive buffer is held */
 	ByteBuffer* lastResponse;
-	uint32_t lastResponseBufPos;
-	MmsError lastResponseError;
 
+	/* hash table of outstanding requests indexed by invokeId (size is a power of 2) */
 	Semaphore outstandingCallsLock;
-	uint32_t* outstandingCalls;
+	struct sMmsOutstandingCall* outstandingCalls;
+	int outstandingCallsTableSize;
+	int outstandingCallsCount;
+	int maxOutstandingCalls; /* window of concurrently outstanding requests */
+	int outstandingCallSlotWaiters;
+	Semaphore outstandingCallSlotFreed;
+
+	int proposedMaxServOutstandingCalling;
+	int proposedMaxServOutstandingCalled;
 
 	uint32_t requestTimeout;
 
@@ -81,14 +129,98 @@ struct sMmsConnection {
 	MmsInformationReportHandler reportHandler;
 	void* reportHandlerParameter;
 
+	MmsEncodedInformationReportHandler encodedReportHandler;
+	void* encodedReportHandlerParameter;
+
+	MmsTimeoutHandler timeoutHandler;
+	void* timeoutHandlerParameter;
+
+	/* buffer positions of the access results of the last information report */
+	int* reportAccessResults;
+	int reportAccessResultsSize;
+
 	MmsConnectionLostHandler connectionLostHandler;
 	void* connectionLostHandlerParameter;
 
 	/* state of an active connection conclude/release process */
 	int concludeState;
+	Semaphore concludeStateChanged;
 };
 
 
+/**
+ * Handler for the response of a request sent with mmsClient_sendEncodedServiceRequest. Called by
+ * the receive thread. In case of an error (or timeout) response is NULL. The response is only valid
+ * while the handler is running.
+ */
+typedef void (*MmsEncodedServiceResponseHandler) (uint32_t invokeId, void* parameter, MmsError mmsError,
+        ByteBuffer* response);
+
+/**
+ * \brief Send a pre-encoded confirmed service request without waiting for the response
+ *
+ * Only the confirmed request PDU header with the invokeId is encoded for each call.
+ *
+ * \return the invokeId of the request or 0 in case of an error
+ */
+uint32_t
+mmsClient_sendEncodedServiceRequest(MmsConnection self, MmsError* mmsError, uint8_t* serviceRequest,
+        int serviceRequestSize, MmsEncodedServiceResponseHandler handler, void* parameter);
+
+/**
+ * \brief Start to connect without blocking (event driven operation, see IedConnectionManager)
+ *
+ * The socket returned by mmsClient_getSocket has to be monitored for the events returned by
+ * mmsClient_getSocketEvents and the events have to be passed to mmsClient_handleSocketEvent.
+ * Responses and reports are handled by the thread that calls mmsClient_handleSocketEvent.
+ *
+ * \return false if the connect could not be started
+ */
+bool
+mmsClient_startConnect(MmsConnection self, char* serverName, int serverPort);
+
+Socket
+mmsClient_getSocket(MmsConnection self);
+
+int
+mmsClient_getSocketEvents(MmsConnection self);
+
+/**
+ * Returns true when received data is waiting for a free receive buffer. mmsClient_handleSocketEvent
+ * has to be called with events = 0 to continue.
+ */
+bool
+mmsClient_isReceiverStalled(MmsConnection self);
+
+/**
+ * \brief Handle socket events of a connection started with mmsClient_startConnect
+ *
+ * \return MMS_STATE_CONNECTING while the association is in progress, MMS_STATE_CONNECTED when
+ *         associated, MMS_STATE_CLOSED if the connection failed (mmsClient_closeConnection has to be called)
+ */
+AssociationState
+mmsClient_handleSocketEvent(MmsConnection self, int events);
+
+/**
+ * \brief Close a connection started with mmsClient_startConnect (e.g. after a timeout)
+ *
+ * The connection lost handler is called if the connection was associated.
+ */
+void
+mmsClient_closeConnection(MmsConnection self);
+
+/**
+ * \brief Synchronous GetVariableAccessAttributes request that also returns the BER encoded type specification
+ *
+ * \param encodedTypeSpec returns a copy of the encoded type specification (has to be released with free)
+ * \param encodedTypeSpecSize returns the size of the encoded type specification
+ *
+ * \return the decoded type specification or NULL in case of an error
+ */
+MmsVariableSpecification*
+mmsClient_getVariableAccessAttributes(MmsConnection self, MmsError* mmsError, char* domainId, char* itemId,
+        uint8_t** encodedTypeSpec, int* encodedTypeSpecSize);
+
 /**
  * MMS Object class enumeration type
  */
@@ -98,6 +230,21 @@ typedef enum {
 	MMS_DOMAIN_NAMES
 } MmsObjectClass;
 
+/**
+ * Install a handler for VMD specific named variable list information reports. If installed
+ * these reports are no longer delivered to the MmsInformationReportHandler.
+ */
+void
+mmsClient_setEncodedInformationReportHandler(MmsConnection self, MmsEncodedInformationReportHandler handler,
+        void* parameter);
+
+/**
+ * Install a handler that is called whenever the timeouts of the asynchronous requests are checked (by the
+ * receive thread or by MmsConnection_handleTimeouts). Used to supervise timeouts of higher layers.
+ */
+void
+mmsClient_setTimeoutHandler(MmsConnection self, MmsTimeoutHandler handler, void* parameter);
+
 MmsValue*
 mmsClient_parseListOfAccessResults(AccessResult_t** accessResultList, int listSize, bool createArray);
 
@@ -126,6 +273,40 @@ mmsClient_createGetNameListRequestDomainOrVMDSpecific(long invokeId, char* domai
 MmsValue*
 mmsClient_parseReadResponse(ByteBuffer* message, uint32_t* invokeId, bool createArray);
 
+/**
+ * \brief Decode the result(s) of a read response into an existing value
+ *
+ * \param isList if true the value is an array with one element for each access result. Elements
+ *        with an access failure keep their old value.
+ */
+bool
+mmsClient_parseReadResponseIntoValue(ByteBuffer* message, uint32_t* invokeId, MmsValue* value,
+        bool isList, MmsError* mmsError);
+
+/**
+ * \brief Decode the access results of a read response into an array of values
+ *
+ * Values are updated in place if the type matches. Otherwise (or if the value is NULL) the
+ * value is replaced by a new instance. Access failures are stored as data access error values.
+ *
+ * \return true on success, false if the response is malformed or the number of access results
+ *         doesn't match valueCount
+ */
+bool
+mmsClient_parseReadResponseIntoValues(ByteBuffer* message, uint32_t* invokeId, MmsValue** values, int valueCount);
+
+/**
+ * \brief Encode the read service request for multiple variables of a single domain without
+ *        the confirmed request PDU header
+ *
+ * The result can be sent multiple times with mmsClient_sendEncodedServiceRequest.
+ *
+ * \return the encoded service request (has to be released with free)
+ */
+uint8_t*
+mmsClient_encodeReadServiceRequestMultipleValues(char* domainId, LinkedList /*<char*>*/ items,
+        int* encodedSize);
+
 int
 mmsClient_createReadRequest(uint32_t invokeId, char* domainId, char* itemId, ByteBuffer* writeBuffer);
 
@@ -169,9 +350,34 @@ mmsClient_createGetVariableAccessAttributesRequest(
 MmsVariableSpecification*
 mmsClient_parseGetVariableAccessAttributesResponse(ByteBuffer* message, uint32_t* invokeId);
 
+/**
+ * \brief Find the type specification in a GetVariableAccessAttributes response
+ *
+ * \param typeSpecPos returns the position of the encoded type specification in the message
+ * \param typeSpecSize returns the size of the encoded type specification
+ */
+bool
+mmsClient_findTypeSpecification(ByteBuffer* message, uint32_t* invokeId, int* typeSpecPos, int* typeSpecSize);
+
+/**
+ * \brief Decode a BER encoded type specification (as received with GetVariableAccessAttributes)
+ */
+MmsVariableSpecification*
+mmsClient_decodeTypeSpecification(uint8_t* buffer, int bufPos, int maxBufPos);
+
+MmsError
+mmsClient_mapDataAccessErrorToMmsError(uint32_t dataAccessError);
+
 void
 mmsClient_parseWriteResponse(ByteBuffer* message, int32_t bufPos, MmsError* mmsError);
 
+/**
+ * \brief Parse the complete confirmed response PDU of a single write request
+ *        (e.g. received with mmsClient_sendEncodedServiceRequest)
+ */
+void
+mmsClient_parseWriteResponsePdu(ByteBuffer* message, MmsError* mmsError);
+
 void
 mmsClient_parseWriteMultipleItemsResponse(ByteBuffer* message, int32_t bufPos, MmsError* mmsError,
         int itemCount, LinkedList* accessResults);
@@ -209,25 +415,25 @@ void
 mmsClient_createIdentifyRequest(uint32_t invokeId, ByteBuffer* request);
 
 MmsServerIdentity*
-mmsClient_parseIdentifyResponse(MmsConnection self);
+mmsClient_parseIdentifyResponse(ByteBuffer* response, int bufPos);
 
 void
 mmsClient_createStatusRequest(uint32_t invokeId, ByteBuffer* request, bool extendedDerivation);
 
 bool
-mmsClient_parseStatusResponse(MmsConnection self, int* vmdLogicalStatus, int* vmdPhysicalStatus);
+mmsClient_parseStatusResponse(ByteBuffer* response, int bufPos, int* vmdLogicalStatus, int* vmdPhysicalStatus);
 
 void
 mmsClient_createFileOpenRequest(uint32_t invokeId, ByteBuffer* request, char* fileName, uint32_t initialPosition);
 
 bool
-mmsClient_parseFileOpenResponse(MmsConnection self, int32_t* frsmId, uint32_t* fileSize, uint64_t* lastModified);
+mmsClient_parseFileOpenResponse(ByteBuffer* response, int bufPos, int32_t* frsmId, uint32_t* fileSize, uint64_t* lastModified);
 
 void
 mmsClient_createFileReadRequest(uint32_t invokeId, ByteBuffer* request, int32_t frsmId);
 
 bool
-mmsClient_parseFileReadResponse(MmsConnection self, int32_t frsmId, bool* moreFollows, MmsFileReadHandler handler, void* handlerParameter);
+mmsClient_parseFileReadResponse(ByteBuffer* response, int bufPos, int32_t frsmId, bool* moreFollows, MmsFileReadHandler handler, void* handlerParameter);
 
 void
 mmsClient_createFileCloseRequest(uint32_t invokeId, ByteBuffer* request, int32_t frsmId);
@@ -242,7 +448,7 @@ void
 mmsClient_createFileDirectoryRequest(uint32_t invokeId, ByteBuffer* request, char* fileSpecification, char* continueAfter);
 
 bool
-mmsClient_parseFileDirectoryResponse(MmsConnection self, MmsFileDirectoryHandler handler, void* handlerParameter,
+mmsClient_parseFileDirectoryResponse(ByteBuffer* response, int bufPos, MmsFileDirectoryHandler handler, void* handlerParameter,
         bool* moreFollows);
 
 bool
@@ -31,6 +31,7 @@
 #include "string_utilities.h"
 #include "mms_client_internal.h"
 #include "mms_common_internal.h"
+#include "ber_decode.h"
 
 
 void
@@ -193,63 +194,143 @@ mmsClient_createGetNamedVariableListAttributesRequestAssociationSpecific(uint32_
     asn_DEF_MmsPdu.free_struct(&asn_DEF_MmsPdu, mmsPdu, 0);
 }
 
-static LinkedList /* <MmsVariableAccessSpecification*> */
-parseNamedVariableAttributes(GetNamedVariableListAttributesResponse_t* response, bool* deletable)
+static int
+parseObjectName(uint8_t* buffer, int bufPos, int maxBufPos, char** domainId, char** itemId)
 {
-	if (deletable != NULL)
-		*deletable = response->mmsDeletable;
+    int length;
 
-	int attributesCount = response->listOfVariable.list.count;
-	int i;
+    uint8_t tag = buffer[bufPos++];
 
-	LinkedList attributes = LinkedList_create();
+    bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, maxBufPos);
+    if ((bufPos < 0) || (length < 0) || (bufPos + length > maxBufPos)) return -1;
 
-	for (i = 0; i < attributesCount; i++) {
-	    char* domainId = mmsMsg_createStringFromAsnIdentifier(response->listOfVariable.list.array[i]->
-	            variableSpecification.choice.name.choice.domainspecific.domainId);
+    if (tag == 0xa1) { /* domain-specific */
+        int endPos = bufPos + length;
+        int strLength;
 
-		char* itemId = mmsMsg_createStringFromAsnIdentifier(response->listOfVariable.list.array[i]->
-				variableSpecification.choice.name.choice.domainspecific.itemId);
+        if (buffer[bufPos++] != 0x1a) return -1;
+        bufPos = BerDecoder_decodeLength(buffer, &strLength, bufPos, endPos);
+        if ((bufPos < 0) || (strLength < 0) || (bufPos + strLength > endPos)) return -1;
 
-		MmsVariableAccessSpecification* listEntry = MmsVariableAccessSpecification_create(domainId, itemId);
+        int domainIdPos = bufPos;
+        int domainIdLength = strLength;
 
-		LinkedList_add(attributes, listEntry);
-	}
+        bufPos += strLength;
+
+        if ((bufPos >= endPos) || (buffer[bufPos++] != 0x1a)) return -1;
+        bufPos = BerDecoder_decodeLength(buffer, &strLength, bufPos, endPos);
+        if ((bufPos < 0) || (strLength < 0) || (bufPos + strLength > endPos)) return -1;
+
+        *domainId = createStringFromBuffer(buffer + domainIdPos, domainIdLength);
+        *itemId = createStringFromBuffer(buffer + bufPos, strLength);
+
+        return endPos;
+    }
+    else if ((tag == 0x80) || (tag == 0x82)) { /* vmd-specific or aa-specific */
+        *domainId = NULL;
+        *itemId = createStringFromBuffer(buffer + bufPos, length);
+
+        return bufPos + length;
+    }
 
-	return attributes;
+    return -1;
 }
 
 LinkedList /* <MmsVariableAccessSpecification*> */
 mmsClient_parseGetNamedVariableListAttributesResponse(ByteBuffer* message, uint32_t* invokeId,
 		bool* /*OUT*/ deletable)
 {
-	MmsPdu_t* mmsPdu = 0;
+    uint8_t* buffer = ByteBuffer_getBuffer(message);
+    int maxBufPos = ByteBuffer_getSize(message);
+    int bufPos = 0;
+    int length;
 
-	LinkedList attributes = NULL;
+    LinkedList attributes = NULL;
 
-	asn_dec_rval_t rval = ber_decode(NULL, &asn_DEF_MmsPdu,
-			(void**) &mmsPdu, ByteBuffer_getBuffer(message), ByteBuffer_getSize(message));
+    if ((maxBufPos < 1) || (buffer[bufPos++] != 0xa1)) /* confirmed response PDU */
+        goto exit_error;
 
+    bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, maxBufPos);
+    if (bufPos < 0) goto exit_error;
 
-	if (rval.code == RC_OK) {
-		if (mmsPdu->present == MmsPdu_PR_confirmedResponsePdu) {
+    if ((bufPos >= maxBufPos) || (buffer[bufPos++] != 0x02)) /* invokeId */
+        goto exit_error;
 
-		    if (invokeId != NULL)
-		        *invokeId = mmsClient_getInvokeId(&mmsPdu->choice.confirmedResponsePdu);
+    bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, maxBufPos);
+    if ((bufPos < 0) || (length < 0) || (bufPos + length > maxBufPos)) goto exit_error;
 
-			if (mmsPdu->choice.confirmedResponsePdu.confirmedServiceResponse.present ==
-					ConfirmedServiceResponse_PR_getNamedVariableListAttributes)
-			{
-				attributes = parseNamedVariableAttributes(
-						&(mmsPdu->choice.confirmedResponsePdu.confirmedServiceResponse.choice.getNamedVariableListAttributes),
-						deletable);
-			}
-		}
-	}
+    if (invokeId != NULL)
+        *invokeId = BerDecoder_decodeUint32(buffer, length, bufPos);
 
-	asn_DEF_MmsPdu.free_struct(&asn_DEF_MmsPdu, mmsPdu, 0);
+    bufPos += length;
+
+    if ((bufPos >= maxBufPos) || (buffer[bufPos++] != 0xac)) /* getNamedVariableListAttributes */
+        goto exit_error;
+
+    bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, maxBufPos);
+    if ((bufPos < 0) || (length < 0) || (bufPos + length > maxBufPos)) goto exit_error;
+
+    int responseEndPos = bufPos + length;
+
+    while (bufPos < responseEndPos) {
+        uint8_t tag = buffer[bufPos++];
+
+        bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, responseEndPos);
+        if ((bufPos < 0) || (length < 0) || (bufPos + length > responseEndPos)) goto exit_error;
+
+        if (tag == 0x80) { /* mmsDeletable */
+            if ((deletable != NULL) && (length == 1))
+                *deletable = BerDecoder_decodeBoolean(buffer, bufPos);
+        }
+        else if (tag == 0xa1) { /* listOfVariable */
+            int listEndPos = bufPos + length;
+
+            attributes = LinkedList_create();
+
+            LinkedList element = attributes;
+
+            while (bufPos < listEndPos) {
+                if (buffer[bufPos++] != 0x30) goto exit_error;
+
+                bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, listEndPos);
+                if ((bufPos < 0) || (length < 0) || (bufPos + length > listEndPos)) goto exit_error;
+
+                int entryEndPos = bufPos + length;
+
+                /* variableSpecification: name [0] */
+                if ((bufPos >= entryEndPos) || (buffer[bufPos++] != 0xa0)) goto exit_error;
+
+                bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, entryEndPos);
+                if ((bufPos < 0) || (length < 1)) goto exit_error;
+
+                char* domainId;
+                char* itemId;
+
+                if (parseObjectName(buffer, bufPos, bufPos + length, &domainId, &itemId) < 0)
+                    goto exit_error;
+
+                element = LinkedList_insertAfter(element,
+                        MmsVariableAccessSpecification_create(domainId, itemId));
+
+                /* alternate access is ignored */
+                bufPos = entryEndPos;
+            }
+
+            continue;
+        }
+
+        bufPos += length;
+    }
+
+    return attributes;
+
+exit_error:
+    if (DEBUG_MMS_CLIENT) printf("MMS_CLIENT: error parsing GetNamedVariableListAttributes response!\n");
+
+    if (attributes != NULL)
+        LinkedList_destroyDeep(attributes, (LinkedListValueDeleteFunction) MmsVariableAccessSpecification_destroy);
 
-	return attributes;
+    return NULL;
 }
 
 
@@ -33,6 +33,8 @@
 #include "mms_client_internal.h"
 #include "mms_common_internal.h"
 #include "mms_value_internal.h"
+#include "ber_decode.h"
+#include "ber_encoder.h"
 
 MmsValue*
 mmsClient_parseListOfAccessResults(AccessResult_t** accessResultList, int listSize, bool createArray)
@@ -240,6 +242,109 @@ mmsClient_parseListOfAccessResults(AccessResult_t** accessResultList, int listSi
 }
 
 
+/*
+ * Returns the position of the first access result in the listOfAccessResult or -1 if the
+ * message is not a valid read response.
+ */
+static int
+parseReadResponseHeader(uint8_t* buffer, int maxBufPos, uint32_t* invokeId, int* listEndPos)
+{
+    int bufPos = 0;
+    int length;
+
+    if (maxBufPos < 1)
+        return -1;
+
+    if (buffer[bufPos++] != 0xa1) /* confirmed response PDU */
+        return -1;
+
+    bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, maxBufPos);
+    if (bufPos < 0) return -1;
+
+    if ((bufPos >= maxBufPos) || (buffer[bufPos++] != 0x02)) /* invokeId */
+        return -1;
+
+    bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, maxBufPos);
+    if ((bufPos < 0) || (length < 0) || (bufPos + length > maxBufPos)) return -1;
+
+    if (invokeId != NULL)
+        *invokeId = BerDecoder_decodeUint32(buffer, length, bufPos);
+
+    bufPos += length;
+
+    if ((bufPos >= maxBufPos) || (buffer[bufPos++] != 0xa4)) /* read response */
+        return -1;
+
+    bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, maxBufPos);
+    if (bufPos < 0) return -1;
+
+    if ((bufPos < maxBufPos) && (buffer[bufPos] == 0xa0)) { /* skip variableAccessSpecification */
+        bufPos = BerDecoder_decodeLength(buffer, &length, bufPos + 1, maxBufPos);
+        if ((bufPos < 0) || (length < 0)) return -1;
+
+        bufPos += length;
+    }
+
+    if ((bufPos >= maxBufPos) || (buffer[bufPos++] != 0xa1)) /* listOfAccessResult */
+        return -1;
+
+    bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, maxBufPos);
+    if ((bufPos < 0) || (length < 0) || (bufPos + length > maxBufPos)) return -1;
+
+    *listEndPos = bufPos + length;
+
+    return bufPos;
+}
+
+static int
+getNumberOfAccessResults(uint8_t* buffer, int bufPos, int maxBufPos)
+{
+    int elementCount = 0;
+    int length;
+
+    while (bufPos < maxBufPos) {
+        bufPos = BerDecoder_decodeLength(buffer, &length, bufPos + 1, maxBufPos);
+
+        if ((bufPos < 0) || (length < 0) || (bufPos + length > maxBufPos))
+            return -1;
+
+        bufPos += length;
+        elementCount++;
+    }
+
+    return elementCount;
+}
+
+static MmsValue*
+decodeAccessResult(uint8_t* buffer, int bufPos, int maxBufPos, int* endBufPos)
+{
+    if (buffer[bufPos] == 0x80) { /* failure */
+        int length;
+
+        bufPos = BerDecoder_decodeLength(buffer, &length, bufPos + 1, maxBufPos);
+
+        if ((bufPos < 0) || (length < 0) || (bufPos + length > maxBufPos))
+            return NULL;
+
+        if (DEBUG_MMS_CLIENT) printf("access error!\n");
+
+        MmsDataAccessError dataAccessError = DATA_ACCESS_ERROR_UNKNOWN;
+
+        if (length > 0) {
+            uint32_t errorCode = BerDecoder_decodeUint32(buffer, length, bufPos);
+
+            if (errorCode < 12)
+                dataAccessError = (MmsDataAccessError) errorCode;
+        }
+
+        *endBufPos = bufPos + length;
+
+        return MmsValue_newDataAccessError(dataAccessError);
+    }
+    else
+        return mmsMsg_decodeMmsData(buffer, bufPos, maxBufPos, endBufPos);
+}
+
 /*
  * \param createArray if multiple variables should be read (e.g. if a data set is read) an array should
  *                    be created that contains the access results.
@@ -247,34 +352,200 @@ mmsClient_parseListOfAccessResults(AccessResult_t** accessResultList, int listSi
 MmsValue*
 mmsClient_parseReadResponse(ByteBuffer* message, uint32_t* invokeId, bool createArray)
 {
-	MmsPdu_t* mmsPdu = 0; /* allow asn1c to allocate structure */
+    uint8_t* buffer = ByteBuffer_getBuffer(message);
+    int listEndPos;
 
-	MmsValue* valueList = NULL;
+    int bufPos = parseReadResponseHeader(buffer, ByteBuffer_getSize(message), invokeId, &listEndPos);
 
-	asn_dec_rval_t rval = ber_decode(NULL, &asn_DEF_MmsPdu,
-			(void**) &mmsPdu, ByteBuffer_getBuffer(message), ByteBuffer_getSize(message));
+    if (bufPos < 0)
+        goto exit_error;
 
-	if (rval.code != RC_OK)
-	    return NULL;
+    int elementCount = getNumberOfAccessResults(buffer, bufPos, listEndPos);
 
-	if (mmsPdu->present == MmsPdu_PR_confirmedResponsePdu) {
+    if (elementCount < 0)
+        goto exit_error;
 
-	    if (invokeId != NULL)
-	        *invokeId = mmsClient_getInvokeId(&mmsPdu->choice.confirmedResponsePdu);
+    if ((elementCount > 1) || createArray) {
+        MmsValue* valueList = MmsValue_createEmtpyArray(elementCount);
 
-		if (mmsPdu->choice.confirmedResponsePdu.confirmedServiceResponse.present == ConfirmedServiceResponse_PR_read) {
-			ReadResponse_t* response = &(mmsPdu->choice.confirmedResponsePdu.confirmedServiceResponse.choice.read);
+        int i;
 
-			int elementCount = response->listOfAccessResult.list.count;
+        for (i = 0; i < elementCount; i++) {
+            MmsValue* value = decodeAccessResult(buffer, bufPos, listEndPos, &bufPos);
 
-			valueList = mmsClient_parseListOfAccessResults(response->listOfAccessResult.list.array,
-			        elementCount, createArray);
-		}
-	}
+            if (value == NULL) {
+                MmsValue_delete(valueList);
+                goto exit_error;
+            }
 
-	asn_DEF_MmsPdu.free_struct(&asn_DEF_MmsPdu, mmsPdu, 0);
+            MmsValue_setElement(valueList, i, value);
+        }
+
+        return valueList;
+    }
+    else if (elementCount == 1) {
+        MmsValue* value = decodeAccessResult(buffer, bufPos, listEndPos, &bufPos);
+
+        if (value == NULL)
+            goto exit_error;
+
+        return value;
+    }
+
+    return NULL;
+
+exit_error:
+    if (DEBUG_MMS_CLIENT) printf("MMS_CLIENT: error parsing read response!\n");
+    return NULL;
+}
+
+bool
+mmsClient_parseReadResponseIntoValue(ByteBuffer* message, uint32_t* invokeId, MmsValue* value,
+        bool isList, MmsError* mmsError)
+{
+    uint8_t* buffer = ByteBuffer_getBuffer(message);
+    int listEndPos;
+
+    int bufPos = parseReadResponseHeader(buffer, ByteBuffer_getSize(message), invokeId, &listEndPos);
+
+    if (bufPos < 0)
+        goto exit_error;
+
+    int elementCount = getNumberOfAccessResults(buffer, bufPos, listEndPos);
+
+    if (isList) {
+        if ((MmsValue_getType(value) != MMS_ARRAY) || (elementCount != (int) MmsValue_getArraySize(value)))
+            goto exit_error;
+
+        /* elements with access failure keep their old value */
+        int i;
+
+        for (i = 0; i < elementCount; i++) {
+            MmsValue* element = MmsValue_getElement(value, i);
+
+            if (buffer[bufPos] == 0x80) {
+                int length;
+
+                bufPos = BerDecoder_decodeLength(buffer, &length, bufPos + 1, listEndPos);
+
+                if ((bufPos < 0) || (length < 0))
+                    goto exit_error;
+
+                bufPos += length;
+            }
+            else if (!mmsMsg_decodeMmsDataIntoValue(buffer, bufPos, listEndPos, &bufPos, element))
+                goto exit_error;
+        }
+    }
+    else {
+        if (elementCount != 1)
+            goto exit_error;
+
+        if (buffer[bufPos] == 0x80) {
+            int length;
+
+            bufPos = BerDecoder_decodeLength(buffer, &length, bufPos + 1, listEndPos);
+
+            if ((bufPos < 0) || (length < 0))
+                goto exit_error;
+
+            *mmsError = mmsClient_mapDataAccessErrorToMmsError(BerDecoder_decodeUint32(buffer, length, bufPos));
+
+            return false;
+        }
+
+        if (!mmsMsg_decodeMmsDataIntoValue(buffer, bufPos, listEndPos, NULL, value))
+            goto exit_error;
+    }
+
+    *mmsError = MMS_ERROR_NONE;
+
+    return true;
+
+exit_error:
+    if (DEBUG_MMS_CLIENT) printf("MMS_CLIENT: error parsing read response!\n");
+
+    *mmsError = MMS_ERROR_PARSING_RESPONSE;
+
+    return false;
+}
+
+bool
+mmsClient_parseReadResponseIntoValues(ByteBuffer* message, uint32_t* invokeId, MmsValue** values, int valueCount)
+{
+    uint8_t* buffer = ByteBuffer_getBuffer(message);
+    int listEndPos;
+
+    int bufPos = parseReadResponseHeader(buffer, ByteBuffer_getSize(message), invokeId, &listEndPos);
+
+    if (bufPos < 0)
+        goto exit_error;
+
+    if (getNumberOfAccessResults(buffer, bufPos, listEndPos) != valueCount)
+        goto exit_error;
+
+    int i;
+
+    for (i = 0; i < valueCount; i++) {
+        MmsValue* value = values[i];
+
+        if (buffer[bufPos] == 0x80) { /* failure */
+            int length;
+
+            bufPos = BerDecoder_decodeLength(buffer, &length, bufPos + 1, listEndPos);
+
+            if ((bufPos < 0) || (length < 0))
+                goto exit_error;
+
+            MmsDataAccessError dataAccessError = DATA_ACCESS_ERROR_UNKNOWN;
+
+            if (length > 0) {
+                uint32_t errorCode = BerDecoder_decodeUint32(buffer, length, bufPos);
+
+                if (errorCode < 12)
+                    dataAccessError = (MmsDataAccessError) errorCode;
+            }
+
+            bufPos += length;
+
+            if ((value != NULL) && (MmsValue_getType(value) == MMS_DATA_ACCESS_ERROR))
+                value->value.dataAccessError = dataAccessError;
+            else {
+                if (value != NULL)
+                    MmsValue_delete(value);
+
+                values[i] = MmsValue_newDataAccessError(dataAccessError);
+            }
+        }
+        else {
+            int endBufPos;
+
+            if ((value != NULL) && (MmsValue_getType(value) != MMS_DATA_ACCESS_ERROR) &&
+                    mmsMsg_decodeMmsDataIntoValue(buffer, bufPos, listEndPos, &endBufPos, value))
+            {
+                bufPos = endBufPos;
+            }
+            else {
+                /* first response or type has changed */
+                MmsValue* newValue = mmsMsg_decodeMmsData(buffer, bufPos, listEndPos, &bufPos);
 
-	return valueList;
+                if (newValue == NULL)
+                    goto exit_error;
+
+                if (value != NULL)
+                    MmsValue_delete(value);
+
+                values[i] = newValue;
+            }
+        }
+    }
+
+    return true;
+
+exit_error:
+    if (DEBUG_MMS_CLIENT) printf("MMS_CLIENT: error parsing read response!\n");
+
+    return false;
 }
 
 
@@ -563,3 +834,57 @@ mmsClient_createReadRequestMultipleValues(uint32_t invokeId, char* domainId, Lin
 	return rval.encoded;
 }
 
+
+uint8_t*
+mmsClient_encodeReadServiceRequestMultipleValues(char* domainId, LinkedList /*<char*>*/ items,
+        int* encodedSize)
+{
+    uint32_t domainIdSize = BerEncoder_determineEncodedStringSize(domainId);
+
+    uint32_t listOfVariableSize = 0;
+
+    LinkedList item = LinkedList_getNext(items);
+
+    while (item != NULL) {
+        uint32_t objectNameSize = domainIdSize + BerEncoder_determineEncodedStringSize((char*) item->data);
+        uint32_t nameSize = 1 + BerEncoder_determineLengthSize(objectNameSize) + objectNameSize;
+        uint32_t variableSpecSize = 1 + BerEncoder_determineLengthSize(nameSize) + nameSize;
+
+        listOfVariableSize += 1 + BerEncoder_determineLengthSize(variableSpecSize) + variableSpecSize;
+
+        item = LinkedList_getNext(item);
+    }
+
+    uint32_t variableAccessSpecSize = 1 + BerEncoder_determineLengthSize(listOfVariableSize) + listOfVariableSize;
+    uint32_t readRequestSize = 1 + BerEncoder_determineLengthSize(variableAccessSpecSize) + variableAccessSpecSize;
+    uint32_t serviceRequestSize = 1 + BerEncoder_determineLengthSize(readRequestSize) + readRequestSize;
+
+    uint8_t* buffer = (uint8_t*) malloc(serviceRequestSize);
+
+    int bufPos = 0;
+
+    bufPos = BerEncoder_encodeTL(0xa4, readRequestSize, buffer, bufPos);
+    bufPos = BerEncoder_encodeTL(0xa1, variableAccessSpecSize, buffer, bufPos);
+    bufPos = BerEncoder_encodeTL(0xa0, listOfVariableSize, buffer, bufPos);
+
+    item = LinkedList_getNext(items);
+
+    while (item != NULL) {
+        char* itemId = (char*) item->data;
+
+        uint32_t objectNameSize = domainIdSize + BerEncoder_determineEncodedStringSize(itemId);
+        uint32_t nameSize = 1 + BerEncoder_determineLengthSize(objectNameSize) + objectNameSize;
+
+        bufPos = BerEncoder_encodeTL(0x30, 1 + BerEncoder_determineLengthSize(nameSize) + nameSize, buffer, bufPos);
+        bufPos = BerEncoder_encodeTL(0xa0, nameSize, buffer, bufPos); /* name */
+        bufPos = BerEncoder_encodeTL(0xa1, objectNameSize, buffer, bufPos); /* domain-specific */
+        bufPos = BerEncoder_encodeStringWithTag(0x1a, domainId, buffer, bufPos);
+        bufPos = BerEncoder_encodeStringWithTag(0x1a, itemId, buffer, bufPos);
+
+        item = LinkedList_getNext(item);
+    }
+
+    *encodedSize = bufPos;
+
+    return buffer;
+}
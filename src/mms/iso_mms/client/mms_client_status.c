@@ -50,11 +50,10 @@ mmsClient_createStatusRequest(uint32_t invokeId, ByteBuffer* request, bool exten
 }
 
 bool
-mmsClient_parseStatusResponse(MmsConnection self, int* vmdLogicalStatus, int* vmdPhysicalStatus)
+mmsClient_parseStatusResponse(ByteBuffer* response, int bufPos, int* vmdLogicalStatus, int* vmdPhysicalStatus)
 {
-    uint8_t* buffer = self->lastResponse->buffer;
-    int maxBufPos = self->lastResponse->size;
-    int bufPos = self->lastResponseBufPos;
+    uint8_t* buffer = response->buffer;
+    int maxBufPos = response->size;
     int length;
 
     uint8_t tag = buffer[bufPos++];
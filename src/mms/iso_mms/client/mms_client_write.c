@@ -31,8 +31,8 @@
 
 #include "stack_config.h"
 
-static MmsError
-mapDataAccessErrorToMmsError(uint32_t dataAccessError)
+MmsError
+mmsClient_mapDataAccessErrorToMmsError(uint32_t dataAccessError)
 {
     switch (dataAccessError) {
     case 0:
@@ -164,13 +164,42 @@ mmsClient_parseWriteResponse(ByteBuffer* message, int32_t bufPos, MmsError* mmsE
             uint32_t dataAccessErrorCode =
                     BerDecoder_decodeUint32(buf, length, bufPos);
 
-            *mmsError = mapDataAccessErrorToMmsError(dataAccessErrorCode);
+            *mmsError = mmsClient_mapDataAccessErrorToMmsError(dataAccessErrorCode);
         }
     }
     else
         *mmsError = MMS_ERROR_PARSING_RESPONSE;
 }
 
+void
+mmsClient_parseWriteResponsePdu(ByteBuffer* message, MmsError* mmsError)
+{
+    uint8_t* buf = message->buffer;
+    int size = message->size;
+
+    int length;
+    int bufPos = 0;
+
+    /* skip confirmed response PDU header and invokeId */
+    if ((size < 2) || (buf[bufPos++] != 0xa1))
+        goto exit_with_error;
+
+    bufPos = BerDecoder_decodeLength(buf, &length, bufPos, size);
+    if ((bufPos < 0) || (bufPos >= size) || (buf[bufPos++] != 0x02))
+        goto exit_with_error;
+
+    bufPos = BerDecoder_decodeLength(buf, &length, bufPos, size);
+    if ((bufPos < 0) || (bufPos + length >= size))
+        goto exit_with_error;
+
+    mmsClient_parseWriteResponse(message, bufPos + length, mmsError);
+
+    return;
+
+exit_with_error:
+    *mmsError = MMS_ERROR_PARSING_RESPONSE;
+}
+
 static VariableSpecification_t*
 createNewDomainVariableSpecification(char* domainId, char* itemId)
 {
@@ -29,6 +29,30 @@
 MmsValue*
 mmsMsg_parseDataElement(Data_t* dataElement);
 
+/**
+ * \brief Decode a BER encoded MMS Data element into a new MmsValue instance
+ *
+ * \param endBufPos returns the position after the decoded element (can be NULL)
+ *
+ * \return the new MmsValue instance or NULL if the element is malformed
+ */
+MmsValue*
+mmsMsg_decodeMmsData(uint8_t* buffer, int bufPos, int maxBufPos, int* endBufPos);
+
+/**
+ * \brief Decode a BER encoded MMS Data element into an existing MmsValue instance
+ *
+ * The value has to have the same type and structure as the encoded element. Primitive values
+ * are updated in place without memory allocation (except for visible and MMS strings that
+ * are longer than the current value).
+ *
+ * \param endBufPos returns the position after the decoded element (can be NULL)
+ *
+ * \return true if the value has been updated, false if the element is malformed or doesn't match the value
+ */
+bool
+mmsMsg_decodeMmsDataIntoValue(uint8_t* buffer, int bufPos, int maxBufPos, int* endBufPos, MmsValue* value);
+
 void
 mmsMsg_createFloatData(MmsValue* value, int* size,  uint8_t** buf);
 
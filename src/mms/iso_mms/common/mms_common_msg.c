@@ -27,6 +27,7 @@
 #include "stack_config.h"
 #include "string_utilities.h"
 #include "mms_value_internal.h"
+#include "ber_decode.h"
 
 void
 mmsMsg_createFloatData(MmsValue* value, int* size, uint8_t** buf)
@@ -332,6 +333,345 @@ mmsMsg_parseDataElement(Data_t* dataElement)
     return value;
 }
 
+static int
+countDataElements(uint8_t* buffer, int bufPos, int maxBufPos)
+{
+    int elementCount = 0;
+    int length;
+
+    while (bufPos < maxBufPos) {
+        bufPos++; /* skip tag */
+
+        bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, maxBufPos);
+
+        if ((bufPos < 0) || (length < 0) || (bufPos + length > maxBufPos))
+            return -1;
+
+        bufPos += length;
+        elementCount++;
+    }
+
+    return elementCount;
+}
+
+static MmsValue*
+decodeComponents(uint8_t* buffer, int bufPos, int maxBufPos, MmsType type)
+{
+    int elementCount = countDataElements(buffer, bufPos, maxBufPos);
+
+    if (elementCount < 0)
+        return NULL;
+
+    MmsValue* value = (MmsValue*) calloc(1, sizeof(MmsValue));
+
+    value->type = type;
+    value->value.structure.size = elementCount;
+    value->value.structure.components = (MmsValue**) calloc(elementCount, sizeof(MmsValue*));
+
+    int i;
+
+    for (i = 0; i < elementCount; i++) {
+        MmsValue* element = mmsMsg_decodeMmsData(buffer, bufPos, maxBufPos, &bufPos);
+
+        if (element == NULL) {
+            MmsValue_delete(value);
+            return NULL;
+        }
+
+        value->value.structure.components[i] = element;
+    }
+
+    return value;
+}
+
+static void
+decodeFloat(uint8_t* buffer, int bufPos, int length, MmsValue* value)
+{
+    if (length == 5) { /* FLOAT32 */
+        value->value.floatingPoint.formatWidth = 32;
+        value->value.floatingPoint.exponentWidth = buffer[bufPos];
+#if (ORDER_LITTLE_ENDIAN == 1)
+        memcpyReverseByteOrder(value->value.floatingPoint.buf, buffer + bufPos + 1, 4);
+#else
+        memcpy(value->value.floatingPoint.buf, buffer + bufPos + 1, 4);
+#endif
+    }
+    else if (length == 9) { /* FLOAT64 */
+        value->value.floatingPoint.formatWidth = 64;
+        value->value.floatingPoint.exponentWidth = buffer[bufPos];
+#if (ORDER_LITTLE_ENDIAN == 1)
+        memcpyReverseByteOrder(value->value.floatingPoint.buf, buffer + bufPos + 1, 8);
+#else
+        memcpy(value->value.floatingPoint.buf, buffer + bufPos + 1, 8);
+#endif
+    }
+}
+
+MmsValue*
+mmsMsg_decodeMmsData(uint8_t* buffer, int bufPos, int maxBufPos, int* endBufPos)
+{
+    MmsValue* value = NULL;
+
+    if (bufPos >= maxBufPos)
+        return NULL;
+
+    uint8_t tag = buffer[bufPos++];
+
+    int length;
+
+    bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, maxBufPos);
+
+    if ((bufPos < 0) || (length < 0) || (bufPos + length > maxBufPos)) {
+        if (DEBUG_MMS_SERVER || DEBUG_MMS_CLIENT) printf("MMS_COMMON: invalid data element length\n");
+        return NULL;
+    }
+
+    int dataEndBufPos = bufPos + length;
+
+    switch (tag) {
+
+    case 0xa1: /* array */
+        value = decodeComponents(buffer, bufPos, dataEndBufPos, MMS_ARRAY);
+        break;
+
+    case 0xa2: /* structure */
+        value = decodeComponents(buffer, bufPos, dataEndBufPos, MMS_STRUCTURE);
+        break;
+
+    case 0x83: /* boolean */
+        if (length != 1)
+            return NULL;
+
+        value = MmsValue_newBoolean(BerDecoder_decodeBoolean(buffer, bufPos));
+        break;
+
+    case 0x84: /* bit string */
+        if (length < 1)
+            return NULL;
+
+        value = (MmsValue*) calloc(1, sizeof(MmsValue));
+        value->type = MMS_BIT_STRING;
+        value->value.bitString.size = (8 * (length - 1)) - buffer[bufPos];
+        value->value.bitString.buf = (uint8_t*) malloc(length - 1);
+        memcpy(value->value.bitString.buf, buffer + bufPos + 1, length - 1);
+        break;
+
+    case 0x85: /* integer */
+        value = MmsValue_newIntegerFromBerInteger(BerInteger_createFromBuffer(buffer + bufPos, length));
+        break;
+
+    case 0x86: /* unsigned */
+        value = MmsValue_newUnsignedFromBerInteger(BerInteger_createFromBuffer(buffer + bufPos, length));
+        break;
+
+    case 0x87: /* floating point */
+        value = (MmsValue*) calloc(1, sizeof(MmsValue));
+        value->type = MMS_FLOAT;
+
+        if ((length == 5) || (length == 9)) {
+            value->value.floatingPoint.buf = (uint8_t*) malloc(length - 1);
+            decodeFloat(buffer, bufPos, length, value);
+        }
+        break;
+
+    case 0x89: /* octet string */
+        value = (MmsValue*) calloc(1, sizeof(MmsValue));
+        value->type = MMS_OCTET_STRING;
+        value->value.octetString.size = length;
+        value->value.octetString.maxSize = length;
+        value->value.octetString.buf = (uint8_t*) malloc(length);
+        memcpy(value->value.octetString.buf, buffer + bufPos, length);
+        break;
+
+    case 0x8a: /* visible string */
+        value = MmsValue_newVisibleStringFromByteArray(buffer + bufPos, length);
+        break;
+
+    case 0x8c: /* binary time */
+        if (length <= 6) {
+            value = (MmsValue*) calloc(1, sizeof(MmsValue));
+            value->type = MMS_BINARY_TIME;
+            value->value.binaryTime.size = length;
+            memcpy(value->value.binaryTime.buf, buffer + bufPos, length);
+        }
+        else
+            value = MmsValue_newDataAccessError(DATA_ACCESS_ERROR_OBJECT_VALUE_INVALID);
+        break;
+
+    case 0x90: /* MMS string */
+        value = (MmsValue*) calloc(1, sizeof(MmsValue));
+        value->type = MMS_STRING;
+        value->value.visibleString = createStringFromBuffer(buffer + bufPos, length);
+        break;
+
+    case 0x91: /* UTC time */
+        if (length != 8)
+            return NULL;
+
+        value = (MmsValue*) calloc(1, sizeof(MmsValue));
+        value->type = MMS_UTC_TIME;
+        memcpy(value->value.utcTime, buffer + bufPos, 8);
+        break;
+
+    default:
+        if (DEBUG_MMS_SERVER || DEBUG_MMS_CLIENT) printf("MMS_COMMON: unsupported data element tag %02x\n", tag);
+        value = MmsValue_newDataAccessError(DATA_ACCESS_ERROR_OBJECT_VALUE_INVALID);
+        break;
+    }
+
+    if (endBufPos != NULL)
+        *endBufPos = dataEndBufPos;
+
+    return value;
+}
+
+static bool
+decodeComponentsIntoValue(uint8_t* buffer, int bufPos, int maxBufPos, MmsValue* value)
+{
+    int i = 0;
+
+    while (bufPos < maxBufPos) {
+        if (i >= value->value.structure.size)
+            return false;
+
+        if (!mmsMsg_decodeMmsDataIntoValue(buffer, bufPos, maxBufPos, &bufPos,
+                value->value.structure.components[i]))
+            return false;
+
+        i++;
+    }
+
+    return (i == value->value.structure.size);
+}
+
+static bool
+setStringValue(MmsValue* value, uint8_t* buffer, int length)
+{
+    char* str = value->value.visibleString;
+
+    if ((str == NULL) || ((int) strlen(str) < length)) {
+        free(str);
+        str = (char*) malloc(length + 1);
+        value->value.visibleString = str;
+    }
+
+    memcpy(str, buffer, length);
+    str[length] = 0;
+
+    return true;
+}
+
+bool
+mmsMsg_decodeMmsDataIntoValue(uint8_t* buffer, int bufPos, int maxBufPos, int* endBufPos, MmsValue* value)
+{
+    if ((value == NULL) || (bufPos >= maxBufPos))
+        return false;
+
+    uint8_t tag = buffer[bufPos++];
+
+    int length;
+
+    bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, maxBufPos);
+
+    if ((bufPos < 0) || (length < 0) || (bufPos + length > maxBufPos))
+        return false;
+
+    if (endBufPos != NULL)
+        *endBufPos = bufPos + length;
+
+    switch (tag) {
+
+    case 0xa1: /* array */
+        if (value->type != MMS_ARRAY)
+            return false;
+
+        return decodeComponentsIntoValue(buffer, bufPos, bufPos + length, value);
+
+    case 0xa2: /* structure */
+        if (value->type != MMS_STRUCTURE)
+            return false;
+
+        return decodeComponentsIntoValue(buffer, bufPos, bufPos + length, value);
+
+    case 0x83: /* boolean */
+        if ((value->type != MMS_BOOLEAN) || (length != 1))
+            return false;
+
+        value->value.boolean = BerDecoder_decodeBoolean(buffer, bufPos);
+        return true;
+
+    case 0x84: /* bit string */
+        if ((value->type != MMS_BIT_STRING) || (length < 1))
+            return false;
+
+        if ((8 * (length - 1)) - buffer[bufPos] != value->value.bitString.size)
+            return false;
+
+        memcpy(value->value.bitString.buf, buffer + bufPos + 1, length - 1);
+        return true;
+
+    case 0x85: /* integer */
+    case 0x86: /* unsigned */
+        if (value->type != ((tag == 0x85) ? MMS_INTEGER : MMS_UNSIGNED))
+            return false;
+
+        if (length > value->value.integer->maxSize)
+            return false;
+
+        value->value.integer->size = length;
+        memcpy(value->value.integer->octets, buffer + bufPos, length);
+        return true;
+
+    case 0x87: /* floating point */
+        if (value->type != MMS_FLOAT)
+            return false;
+
+        if (length != (value->value.floatingPoint.formatWidth / 8) + 1)
+            return false;
+
+        decodeFloat(buffer, bufPos, length, value);
+        return true;
+
+    case 0x89: /* octet string */
+        if ((value->type != MMS_OCTET_STRING) || (length > value->value.octetString.maxSize))
+            return false;
+
+        value->value.octetString.size = length;
+        memcpy(value->value.octetString.buf, buffer + bufPos, length);
+        return true;
+
+    case 0x8a: /* visible string */
+        if (value->type != MMS_VISIBLE_STRING)
+            return false;
+
+        return setStringValue(value, buffer + bufPos, length);
+
+    case 0x8c: /* binary time */
+        if ((value->type != MMS_BINARY_TIME) || (length > 6))
+            return false;
+
+        value->value.binaryTime.size = length;
+        memcpy(value->value.binaryTime.buf, buffer + bufPos, length);
+        return true;
+
+    case 0x90: /* MMS string */
+        if (value->type != MMS_STRING)
+            return false;
+
+        return setStringValue(value, buffer + bufPos, length);
+
+    case 0x91: /* UTC time */
+        if ((value->type != MMS_UTC_TIME) || (length != 8))
+            return false;
+
+        memcpy(value->value.utcTime, buffer + bufPos, 8);
+        return true;
+
+    default:
+        return false;
+    }
+}
+
 Data_t*
 mmsMsg_createDataElement(MmsValue* value)
 {
@@ -0,0 +1,179 @@
+/*
+ *  mms_buffer_pool.c
+ *
+ *  Copyright 2013 Michael Zillgith
+ *
+ *	This file is part of libIEC61850.
+ *
+ *	libIEC61850 is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	libIEC61850 is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with libIEC61850.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *	See COPYING file for the complete license text.
+ */
+
+#include "libiec61850_platform_includes.h"
+#include "mms_buffer_pool.h"
+#include "stack_config.h"
+#include "thread.h"
+
+#ifndef CONFIG_MMS_SERVER_BUFFER_POOL_SIZE
+#define CONFIG_MMS_SERVER_BUFFER_POOL_SIZE 2
+#endif
+
+/* small: single value reports and command termination, medium: typical data set reports */
+#define SMALL_BUFFER_SIZE 512
+#define MEDIUM_BUFFER_SIZE 4096
+
+#define MAX_SIZE_CLASSES 3
+
+typedef struct {
+    int bufferSize;
+    int freeBuffers;
+    ByteBuffer* freeList[CONFIG_MMS_SERVER_BUFFER_POOL_SIZE];
+} BufferSizeClass;
+
+struct sMmsBufferPool {
+    Semaphore lock;
+    int sizeClassCount;
+    BufferSizeClass sizeClasses[MAX_SIZE_CLASSES];
+    MmsBufferPoolStatistics statistics;
+};
+
+static void
+addSizeClass(MmsBufferPool self, int bufferSize)
+{
+    self->sizeClasses[self->sizeClassCount].bufferSize = bufferSize;
+    self->sizeClasses[self->sizeClassCount].freeBuffers = 0;
+    self->sizeClassCount++;
+}
+
+MmsBufferPool
+MmsBufferPool_create(int maxPduSize)
+{
+    MmsBufferPool self = (MmsBufferPool) calloc(1, sizeof(struct sMmsBufferPool));
+
+    self->lock = Semaphore_create(1);
+
+    if (maxPduSize > SMALL_BUFFER_SIZE)
+        addSizeClass(self, SMALL_BUFFER_SIZE);
+
+    if (maxPduSize > MEDIUM_BUFFER_SIZE)
+        addSizeClass(self, MEDIUM_BUFFER_SIZE);
+
+    addSizeClass(self, maxPduSize);
+
+    return self;
+}
+
+static BufferSizeClass*
+getSizeClass(MmsBufferPool self, int size)
+{
+    int i;
+
+    for (i = 0; i < self->sizeClassCount; i++) {
+        if (size <= self->sizeClasses[i].bufferSize)
+            return &(self->sizeClasses[i]);
+    }
+
+    return NULL;
+}
+
+ByteBuffer*
+MmsBufferPool_getBuffer(MmsBufferPool self, int size)
+{
+    ByteBuffer* buffer = NULL;
+
+    BufferSizeClass* sizeClass = getSizeClass(self, size);
+
+    Semaphore_wait(self->lock);
+
+    if ((sizeClass != NULL) && (sizeClass->freeBuffers > 0)) {
+        sizeClass->freeBuffers--;
+        buffer = sizeClass->freeList[sizeClass->freeBuffers];
+        self->statistics.hits++;
+    }
+    else
+        self->statistics.misses++;
+
+    self->statistics.buffersInUse++;
+
+    if (self->statistics.buffersInUse > self->statistics.peakBuffersInUse)
+        self->statistics.peakBuffersInUse = self->statistics.buffersInUse;
+
+    Semaphore_post(self->lock);
+
+    if (buffer == NULL) {
+        /* oversized requests get a buffer of exact size that is not kept by the pool */
+        if (sizeClass != NULL)
+            buffer = ByteBuffer_create(NULL, sizeClass->bufferSize);
+        else
+            buffer = ByteBuffer_create(NULL, size);
+    }
+
+    buffer->size = 0;
+
+    return buffer;
+}
+
+void
+MmsBufferPool_releaseBuffer(MmsBufferPool self, ByteBuffer* buffer)
+{
+    BufferSizeClass* sizeClass = getSizeClass(self, buffer->maxSize);
+
+    if ((sizeClass != NULL) && (sizeClass->bufferSize != buffer->maxSize))
+        sizeClass = NULL;
+
+    Semaphore_wait(self->lock);
+
+    self->statistics.buffersInUse--;
+
+    if ((sizeClass != NULL) && (sizeClass->freeBuffers < CONFIG_MMS_SERVER_BUFFER_POOL_SIZE)) {
+        sizeClass->freeList[sizeClass->freeBuffers] = buffer;
+        sizeClass->freeBuffers++;
+        buffer = NULL;
+    }
+
+    Semaphore_post(self->lock);
+
+    if (buffer != NULL)
+        ByteBuffer_destroy(buffer);
+}
+
+void
+MmsBufferPool_getStatistics(MmsBufferPool self, MmsBufferPoolStatistics* statistics)
+{
+    Semaphore_wait(self->lock);
+
+    *statistics = self->statistics;
+
+    Semaphore_post(self->lock);
+}
+
+void
+MmsBufferPool_destroy(MmsBufferPool self)
+{
+    int i;
+
+    for (i = 0; i < self->sizeClassCount; i++) {
+        BufferSizeClass* sizeClass = &(self->sizeClasses[i]);
+
+        while (sizeClass->freeBuffers > 0) {
+            sizeClass->freeBuffers--;
+            ByteBuffer_destroy(sizeClass->freeList[sizeClass->freeBuffers]);
+        }
+    }
+
+    Semaphore_destroy(self->lock);
+
+    free(self);
+}
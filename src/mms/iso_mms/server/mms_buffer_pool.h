@@ -0,0 +1,67 @@
+/*
+ *  mms_buffer_pool.h
+ *
+ *  Copyright 2013 Michael Zillgith
+ *
+ *	This file is part of libIEC61850.
+ *
+ *	libIEC61850 is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	libIEC61850 is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with libIEC61850.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *	See COPYING file for the complete license text.
+ */
+
+#ifndef MMS_BUFFER_POOL_H_
+#define MMS_BUFFER_POOL_H_
+
+#include "libiec61850_common_api.h"
+#include "byte_buffer.h"
+
+/**
+ * A size-classed pool of buffers for outbound MMS PDUs that are not sent as a response to
+ * a client request (information reports, command termination, delayed write responses).
+ *
+ * Buffers are kept in free lists per size class. The number of free buffers per class is
+ * bounded by CONFIG_MMS_SERVER_BUFFER_POOL_SIZE. A pool can be used by different threads.
+ */
+typedef struct sMmsBufferPool* MmsBufferPool;
+
+typedef struct {
+    uint32_t hits;          /* requests served with a buffer from a free list */
+    uint32_t misses;        /* requests that required a new allocation */
+    int buffersInUse;       /* number of buffers currently handed out */
+    int peakBuffersInUse;   /* maximum number of buffers handed out at the same time */
+} MmsBufferPoolStatistics;
+
+MmsBufferPool
+MmsBufferPool_create(int maxPduSize);
+
+/**
+ * \brief get a buffer that can hold at least size bytes
+ *
+ * The size of the returned buffer is zero. The buffer has to be returned to the pool
+ * with MmsBufferPool_releaseBuffer.
+ */
+ByteBuffer*
+MmsBufferPool_getBuffer(MmsBufferPool self, int size);
+
+void
+MmsBufferPool_releaseBuffer(MmsBufferPool self, ByteBuffer* buffer);
+
+void
+MmsBufferPool_getStatistics(MmsBufferPool self, MmsBufferPoolStatistics* statistics);
+
+void
+MmsBufferPool_destroy(MmsBufferPool self);
+
+#endif /* MMS_BUFFER_POOL_H_ */
@@ -45,6 +45,15 @@ struct sMmsDomain {
     int namedVariablesCount;
     MmsVariableSpecification** namedVariables;
     LinkedList /*<MmsNamedVariableList>*/ namedVariableLists;
+
+    /* index of all variable names for GetNameList (created with the first request) */
+    int variableNamesCount;
+    char** variableNames; /* in model order */
+    struct sMmsVariableNameIndexEntry* sortedVariableNames;
+
+    /* cached GetVariableAccessAttributes responses (same order as variableNames) */
+    uint8_t** encodedTypeSpecs;
+    int* encodedTypeSpecSizes;
 };
 
 /**
@@ -121,6 +121,23 @@ MmsDomain_destroy(MmsDomain* self)
 
 	LinkedList_destroyDeep(self->namedVariableLists, (LinkedListValueDeleteFunction) MmsNamedVariableList_destroy);
 
+	if (self->variableNames != NULL) {
+		free(self->variableNames);
+		free(self->sortedVariableNames);
+	}
+
+	if (self->encodedTypeSpecs != NULL) {
+		int i;
+
+		for (i = 0; i < self->variableNamesCount; i++) {
+			if (self->encodedTypeSpecs[i] != NULL)
+				free(self->encodedTypeSpecs[i]);
+		}
+
+		free(self->encodedTypeSpecs);
+		free(self->encodedTypeSpecSizes);
+	}
+
 	free(self);
 }
 
@@ -216,4 +233,122 @@ MmsDomain_getNamedVariable(MmsDomain* self, char* nameId)
 	return NULL;
 }
 
+struct sMmsVariableNameIndexEntry {
+	char* name;
+	int position;
+};
+
+static void
+countVariableNames(MmsVariableSpecification* variable, int prefixLength, int* nameCount, int* namesSize)
+{
+	int nameLength = prefixLength + strlen(variable->name);
+
+	*nameCount = *nameCount + 1;
+	*namesSize = *namesSize + nameLength + 1;
+
+	if (variable->type == MMS_STRUCTURE) {
+		int i;
+
+		for (i = 0; i < variable->typeSpec.structure.elementCount; i++)
+			countVariableNames(variable->typeSpec.structure.elements[i], nameLength + 1, nameCount, namesSize);
+	}
+}
+
+static char*
+addVariableNames(MmsDomain* self, MmsVariableSpecification* variable, char* prefix, int prefixLength,
+		char* nameBuffer)
+{
+	char* name = nameBuffer;
+	int nameLength = 0;
+
+	if (prefix != NULL) {
+		memcpy(name, prefix, prefixLength);
+		name[prefixLength] = '$';
+		nameLength = prefixLength + 1;
+	}
+
+	strcpy(name + nameLength, variable->name);
+	nameLength += strlen(variable->name);
+
+	self->variableNames[self->variableNamesCount++] = name;
+
+	nameBuffer += nameLength + 1;
+
+	if (variable->type == MMS_STRUCTURE) {
+		int i;
+
+		for (i = 0; i < variable->typeSpec.structure.elementCount; i++)
+			nameBuffer = addVariableNames(self, variable->typeSpec.structure.elements[i], name, nameLength,
+					nameBuffer);
+	}
+
+	return nameBuffer;
+}
+
+static int
+compareVariableNameIndexEntries(const void* a, const void* b)
+{
+	return strcmp(((struct sMmsVariableNameIndexEntry*) a)->name, ((struct sMmsVariableNameIndexEntry*) b)->name);
+}
+
+static void
+createVariableNameIndex(MmsDomain* self)
+{
+	int nameCount = 0;
+	int namesSize = 0;
+	int i;
+
+	for (i = 0; i < self->namedVariablesCount; i++)
+		countVariableNames(self->namedVariables[i], 0, &nameCount, &namesSize);
+
+	/* name pointers and name strings are stored in a single memory block */
+	self->variableNames = (char**) malloc(nameCount * sizeof(char*) + namesSize);
+	self->sortedVariableNames = (struct sMmsVariableNameIndexEntry*)
+			malloc(nameCount * sizeof(struct sMmsVariableNameIndexEntry));
+
+	char* nameBuffer = (char*) (self->variableNames + nameCount);
+
+	self->variableNamesCount = 0;
+
+	for (i = 0; i < self->namedVariablesCount; i++)
+		nameBuffer = addVariableNames(self, self->namedVariables[i], NULL, 0, nameBuffer);
+
+	for (i = 0; i < nameCount; i++) {
+		self->sortedVariableNames[i].name = self->variableNames[i];
+		self->sortedVariableNames[i].position = i;
+	}
 
+	qsort(self->sortedVariableNames, nameCount, sizeof(struct sMmsVariableNameIndexEntry),
+			compareVariableNameIndexEntries);
+}
+
+char**
+MmsDomain_getVariableNames(MmsDomain* self, int* nameCount)
+{
+	if (self->variableNames == NULL)
+		createVariableNameIndex(self);
+
+	*nameCount = self->variableNamesCount;
+
+	return self->variableNames;
+}
+
+int
+MmsDomain_getVariableNamePosition(MmsDomain* self, char* name)
+{
+	if (self->variableNames == NULL)
+		createVariableNameIndex(self);
+
+	struct sMmsVariableNameIndexEntry key;
+
+	key.name = name;
+
+	struct sMmsVariableNameIndexEntry* entry = (struct sMmsVariableNameIndexEntry*)
+			bsearch(&key, self->sortedVariableNames, self->variableNamesCount,
+					sizeof(struct sMmsVariableNameIndexEntry), compareVariableNameIndexEntries);
+
+	if (entry == NULL)
+		return -1;
+
+	return entry->position;
+}
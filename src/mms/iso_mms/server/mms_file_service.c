@@ -30,6 +30,31 @@
 
 #define CONFIG_MMS_FILE_SERVICE_MAX_FILENAME_LENGTH 256
 
+#ifndef CONFIG_MMS_FILE_DIRECTORY_SNAPSHOTS
+#define CONFIG_MMS_FILE_DIRECTORY_SNAPSHOTS 4
+#endif
+
+#ifndef CONFIG_MMS_FILE_DIRECTORY_SNAPSHOT_MAX_AGE
+#define CONFIG_MMS_FILE_DIRECTORY_SNAPSHOT_MAX_AGE 5000
+#endif
+
+typedef struct {
+    char* fileName; /* directories have a trailing '/' */
+    uint32_t fileSize;
+    uint64_t lastModified;
+} FileDirectoryEntry;
+
+/* listing of a directory - shared by all connections and protected by the model lock */
+typedef struct sFileDirectorySnapshot* FileDirectorySnapshot;
+
+struct sFileDirectorySnapshot {
+    char* directoryName;
+    uint64_t directoryModified;
+    uint64_t creationTime;
+    int entryCount;
+    FileDirectoryEntry* entries; /* sorted by file name */
+};
+
 static void
 createNullResponseExtendedTag(uint32_t invokeId, ByteBuffer* response, uint8_t tag)
 {
@@ -231,6 +256,8 @@ mmsServer_handleFileDeleteRequest(
         return;
     }
 
+    mmsServer_destroyFileDirectorySnapshots(connection->server);
+
     createNullResponseExtendedTag(invokeId, response, 0x4c);
     return;
 
@@ -286,6 +313,19 @@ mmsServer_handleFileOpenRequest(
             FileHandle fileHandle = FileSystem_openFile(filename, false);
 
             if (fileHandle != NULL) {
+                uint32_t fileSize = 0;
+
+                FileSystem_getFileInfo(filename, &fileSize, NULL);
+
+                /* resume a transfer at the requested position */
+                if ((filePosition > fileSize) ||
+                        ((filePosition > 0) && (FileSystem_setFilePosition(fileHandle, filePosition) == false)))
+                {
+                    FileSystem_closeFile(fileHandle);
+                    mmsServer_createConfirmedErrorPdu(invokeId, response, MMS_ERROR_FILE_POSITION_INVALID);
+                    return;
+                }
+
                 frsm->fileHandle = fileHandle;
                 frsm->readPosition = filePosition;
                 frsm->frsmId = getNextFrsmId(connection);
@@ -315,7 +355,8 @@ exit_reject_invalid_pdu:
 
 
 static void
-createFileReadResponse(uint32_t invokeId, ByteBuffer* response,  MmsFileReadStateMachine* frsm)
+createFileReadResponse(MmsServerConnection* connection, uint32_t invokeId, ByteBuffer* response,
+        MmsFileReadStateMachine* frsm)
 {
      /* determine remaining bytes in file */
      uint32_t bytesLeft = frsm->fileSize - frsm->readPosition;
@@ -347,6 +388,28 @@ createFileReadResponse(uint32_t invokeId, ByteBuffer* response,  MmsFileReadStat
      uint32_t confirmedResponsePDUSize = invokeIdSize + 2 + BerEncoder_determineLengthSize(fileReadResponseSize)
                 + fileReadResponseSize;
 
+     /* The file is read without holding the model lock and the connection lock so that a slow disk does
+      * not block other connections and reporting. The response buffer is the send buffer of the connection
+      * that is used by other threads in the meantime - the chunk is read into a separate buffer first.
+      * The read state machine is only accessed by the thread of this connection. */
+     ByteBuffer* chunkBuffer = MmsBufferPool_getBuffer(connection->sendBufferPool, fileChunkSize);
+
+     IsoConnection_releaseHandlerLocks(connection->isoConnection);
+
+     int bytesRead = FileSystem_readFile(frsm->fileHandle, chunkBuffer->buffer, fileChunkSize);
+
+     IsoConnection_acquireHandlerLocks(connection->isoConnection);
+
+     if (bytesRead != (int) fileChunkSize) {
+         if (DEBUG_MMS_SERVER)
+             printf("mms_file_service.c: failed to read file (file has been changed?)\n");
+
+         MmsBufferPool_releaseBuffer(connection->sendBufferPool, chunkBuffer);
+
+         mmsServer_createConfirmedErrorPdu(invokeId, response, MMS_ERROR_FILE_OTHER);
+         return;
+     }
+
      uint8_t* buffer = response->buffer;
 
      int bufPos = 0;
@@ -360,9 +423,12 @@ createFileReadResponse(uint32_t invokeId, ByteBuffer* response,  MmsFileReadStat
      bufPos = BerEncoder_encodeTL(0x49, fileReadResponseSize, buffer, bufPos);
 
      bufPos = BerEncoder_encodeTL(0x80, fileChunkSize, buffer, bufPos);
-     FileSystem_readFile(frsm->fileHandle, buffer + bufPos, fileChunkSize);
+
+     memcpy(buffer + bufPos, chunkBuffer->buffer, fileChunkSize);
      bufPos += fileChunkSize;
 
+     MmsBufferPool_releaseBuffer(connection->sendBufferPool, chunkBuffer);
+
      if (!moreFollows)
          bufPos = BerEncoder_encodeBoolean(0x81, false, buffer, bufPos);
 
@@ -384,7 +450,7 @@ mmsServer_handleFileReadRequest(
     MmsFileReadStateMachine* frsm = getFrsm(connection, frsmId);
 
     if (frsm != NULL)
-        createFileReadResponse(invokeId, response, frsm);
+        createFileReadResponse(connection, invokeId, response, frsm);
     else
         mmsServer_createConfirmedErrorPdu(invokeId, response, MMS_ERROR_FILE_OTHER);
 }
@@ -437,94 +503,194 @@ encodeFileSpecification(uint8_t tag, char* fileSpecification, uint8_t* buffer, i
 
 
 static void
-createFileDirectoryResponse(uint32_t invokeId, ByteBuffer* response, char* directoryName, char* continueAfterFileName)
+fileDirectorySnapshot_destroy(FileDirectorySnapshot self)
 {
-    int maxSize = response->maxSize - 3; /* reserve space for moreFollows */
-    uint8_t* buffer = response->buffer;
+    int i;
 
-    bool moreFollows = false;
+    for (i = 0; i < self->entryCount; i++)
+        free(self->entries[i].fileName);
 
-    int tempStartPos = 30; /* estimated header part with safety margin */
-    int tempCurPos = tempStartPos;
-    int tempEncoded = 0;
+    if (self->entries != NULL)
+        free(self->entries);
 
-    char extendedFileName[300];
+    free(self->directoryName);
+    free(self);
+}
 
+static int
+compareFileDirectoryEntries(const void* a, const void* b)
+{
+    return strcmp(((FileDirectoryEntry*) a)->fileName, ((FileDirectoryEntry*) b)->fileName);
+}
+
+static FileDirectorySnapshot
+fileDirectorySnapshot_create(char* directoryName, uint64_t directoryModified)
+{
     DirectoryHandle directory = FileSystem_openDirectory(directoryName);
 
-    if (directory != NULL) {
-        bool isDirectory;
-        char* fileName = FileSystem_readDirectory(directory, &isDirectory);
+    if (directory == NULL)
+        return NULL;
 
-        while (fileName != NULL) {
-            if (isDirectory) {
-                strcpy(extendedFileName, fileName);
-                strcat(extendedFileName, "/");
+    FileDirectorySnapshot self = (FileDirectorySnapshot) calloc(1, sizeof(struct sFileDirectorySnapshot));
 
-                fileName = extendedFileName;
-            }
+    self->directoryName = copyString(directoryName);
+    self->directoryModified = directoryModified;
+    self->creationTime = Hal_getTimeInMs();
+
+    int maxEntries = 0;
+
+    char extendedFileName[300];
+    char fullPath[CONFIG_MMS_FILE_SERVICE_MAX_FILENAME_LENGTH];
+
+    int directoryLen = strlen(directoryName);
+
+    bool isDirectory;
+    char* fileName = FileSystem_readDirectory(directory, &isDirectory);
+
+    while (fileName != NULL) {
+        if (isDirectory) {
+            strcpy(extendedFileName, fileName);
+            strcat(extendedFileName, "/");
+
+            fileName = extendedFileName;
+        }
+
+        if (directoryLen > 0) {
+            strcpy(fullPath, directoryName);
 
-            if (continueAfterFileName != NULL) {
-                if (strcmp(continueAfterFileName, fileName) == 0)
-                    continueAfterFileName = NULL;
+            if (directoryName[directoryLen - 1] != CONFIG_SYSTEM_FILE_SEPARATOR) {
+                fullPath[directoryLen] = CONFIG_SYSTEM_FILE_SEPARATOR;
+                fullPath[directoryLen + 1] = 0;
             }
-            else {
-                uint64_t msTime;
 
-                char fullPath[CONFIG_MMS_FILE_SERVICE_MAX_FILENAME_LENGTH];
+            strcat(fullPath, fileName);
+        }
+        else {
+            strncpy(fullPath, fileName, CONFIG_MMS_FILE_SERVICE_MAX_FILENAME_LENGTH - 1);
+            fullPath[CONFIG_MMS_FILE_SERVICE_MAX_FILENAME_LENGTH - 1] = 0;
+        }
 
-                if (directoryName != NULL) {
-                    int directoryLen = strlen(directoryName);
+        if (self->entryCount == maxEntries) {
+            maxEntries = (maxEntries == 0) ? 64 : (maxEntries * 2);
 
-                    strcpy(fullPath, directoryName);
+            self->entries = (FileDirectoryEntry*) realloc(self->entries, maxEntries * sizeof(FileDirectoryEntry));
+        }
 
-                    if (directoryName[directoryLen - 1] != CONFIG_SYSTEM_FILE_SEPARATOR) {
-                        fullPath[directoryLen] = CONFIG_SYSTEM_FILE_SEPARATOR;
-                        fullPath[directoryLen + 1] = 0;
-                    }
+        FileDirectoryEntry* entry = &(self->entries[self->entryCount++]);
 
-                    strcat(fullPath, fileName);
-                }
-                else {
-                    strncpy(fullPath, fileName, CONFIG_MMS_FILE_SERVICE_MAX_FILENAME_LENGTH - 1);
-                    fullPath[CONFIG_MMS_FILE_SERVICE_MAX_FILENAME_LENGTH - 1] = 0;
-                }
+        entry->fileName = copyString(fileName);
+        entry->fileSize = 0;
+        entry->lastModified = 0;
 
-                uint32_t fileSize;
+        FileSystem_getFileInfo(fullPath, &(entry->fileSize), &(entry->lastModified));
 
-                FileSystem_getFileInfo(fullPath, &fileSize, &msTime);
+        fileName = FileSystem_readDirectory(directory, &isDirectory);
+    }
 
-                char gtString[30];
+    FileSystem_closeDirectory(directory);
 
-                Conversions_msTimeToGeneralizedTime(msTime, (uint8_t*) gtString);
+    if (self->entryCount > 1)
+        qsort(self->entries, self->entryCount, sizeof(FileDirectoryEntry), compareFileDirectoryEntries);
 
-                int fileAttributesSize = encodeFileAttributes(0xa1, fileSize, gtString, NULL, 0);
+    if (DEBUG_MMS_SERVER)
+        printf("mms_file_service.c: created directory snapshot for (%s) with %i entries\n", directoryName,
+                self->entryCount);
 
-                int filenameSize = encodeFileSpecification(0xa0, fileName, NULL, 0);
+    return self;
+}
 
-                int dirEntrySize = 2 + fileAttributesSize + filenameSize;
+/* index of the first entry after continueAfterFileName (also when the file has been deleted in between) */
+static int
+fileDirectorySnapshot_getStartIndex(FileDirectorySnapshot self, char* continueAfterFileName)
+{
+    int low = 0;
+    int high = self->entryCount;
 
-                int overallEntrySize = 1 + BerEncoder_determineLengthSize(dirEntrySize) + dirEntrySize;
+    while (low < high) {
+        int middle = (low + high) / 2;
 
-                int bufferSpaceLeft = maxSize - tempCurPos;
+        if (strcmp(self->entries[middle].fileName, continueAfterFileName) <= 0)
+            low = middle + 1;
+        else
+            high = middle;
+    }
 
-                if (overallEntrySize > bufferSpaceLeft) {
-                    moreFollows = true;
-                    break;
-                }
+    return low;
+}
 
-                tempCurPos = BerEncoder_encodeTL(0x30, dirEntrySize, buffer, tempCurPos); /* SEQUENCE (DirectoryEntry) */
-                tempCurPos = encodeFileSpecification(0xa0, fileName, buffer, tempCurPos); /* fileName */
-                tempCurPos = encodeFileAttributes(0xa1, fileSize, gtString, buffer, tempCurPos); /* file attributes */
+void
+mmsServer_destroyFileDirectorySnapshots(MmsServer self)
+{
+    LinkedList_destroyDeep(self->fileDirectorySnapshots, (LinkedListValueDeleteFunction) fileDirectorySnapshot_destroy);
 
-            }
+    self->fileDirectorySnapshots = LinkedList_create();
+}
+
+static FileDirectorySnapshot
+getFileDirectorySnapshot(MmsServer server, char* directoryName)
+{
+    uint64_t directoryModified = 0;
 
-            fileName = FileSystem_readDirectory(directory, &isDirectory);
+    FileSystem_getFileInfo(directoryName, NULL, &directoryModified);
+
+    FileDirectorySnapshot snapshot = NULL;
+
+    LinkedList element = LinkedList_getNext(server->fileDirectorySnapshots);
+
+    while (element != NULL) {
+        FileDirectorySnapshot candidate = (FileDirectorySnapshot) element->data;
+
+        if (strcmp(candidate->directoryName, directoryName) == 0) {
+            snapshot = candidate;
+            break;
         }
 
-        FileSystem_closeDirectory(directory);
+        element = LinkedList_getNext(element);
     }
-    else {
+
+    if (snapshot != NULL) {
+        if ((snapshot->directoryModified == directoryModified) &&
+                ((Hal_getTimeInMs() - snapshot->creationTime) < CONFIG_MMS_FILE_DIRECTORY_SNAPSHOT_MAX_AGE))
+            return snapshot;
+
+        LinkedList_remove(server->fileDirectorySnapshots, snapshot);
+        fileDirectorySnapshot_destroy(snapshot);
+    }
+
+    snapshot = fileDirectorySnapshot_create(directoryName, directoryModified);
+
+    if (snapshot != NULL) {
+        LinkedList_insertAfter(server->fileDirectorySnapshots, snapshot);
+
+        /* remove least recently created snapshot */
+        if (LinkedList_size(server->fileDirectorySnapshots) > CONFIG_MMS_FILE_DIRECTORY_SNAPSHOTS) {
+            LinkedList lastElement = LinkedList_getLastElement(server->fileDirectorySnapshots);
+            FileDirectorySnapshot oldest = (FileDirectorySnapshot) lastElement->data;
+
+            LinkedList_remove(server->fileDirectorySnapshots, oldest);
+            fileDirectorySnapshot_destroy(oldest);
+        }
+    }
+
+    return snapshot;
+}
+
+static void
+createFileDirectoryResponse(MmsServer server, uint32_t invokeId, ByteBuffer* response, char* directoryName,
+        char* continueAfterFileName)
+{
+    int maxSize = response->maxSize - 3; /* reserve space for moreFollows */
+    uint8_t* buffer = response->buffer;
+
+    bool moreFollows = false;
+
+    int tempStartPos = 30; /* estimated header part with safety margin */
+    int tempCurPos = tempStartPos;
+    int tempEncoded = 0;
+
+    FileDirectorySnapshot snapshot = getFileDirectorySnapshot(server, directoryName);
+
+    if (snapshot == NULL) {
        if (DEBUG_MMS_SERVER)
             printf("Error opening directory!\n");
 
@@ -533,6 +699,38 @@ createFileDirectoryResponse(uint32_t invokeId, ByteBuffer* response, char* direc
        return;
     }
 
+    int i = 0;
+
+    if (continueAfterFileName != NULL)
+        i = fileDirectorySnapshot_getStartIndex(snapshot, continueAfterFileName);
+
+    for (; i < snapshot->entryCount; i++) {
+        FileDirectoryEntry* entry = &(snapshot->entries[i]);
+
+        char gtString[30];
+
+        Conversions_msTimeToGeneralizedTime(entry->lastModified, (uint8_t*) gtString);
+
+        int fileAttributesSize = encodeFileAttributes(0xa1, entry->fileSize, gtString, NULL, 0);
+
+        int filenameSize = encodeFileSpecification(0xa0, entry->fileName, NULL, 0);
+
+        int dirEntrySize = 2 + fileAttributesSize + filenameSize;
+
+        int overallEntrySize = 1 + BerEncoder_determineLengthSize(dirEntrySize) + dirEntrySize;
+
+        int bufferSpaceLeft = maxSize - tempCurPos;
+
+        if (overallEntrySize > bufferSpaceLeft) {
+            moreFollows = true;
+            break;
+        }
+
+        tempCurPos = BerEncoder_encodeTL(0x30, dirEntrySize, buffer, tempCurPos); /* SEQUENCE (DirectoryEntry) */
+        tempCurPos = encodeFileSpecification(0xa0, entry->fileName, buffer, tempCurPos); /* fileName */
+        tempCurPos = encodeFileAttributes(0xa1, entry->fileSize, gtString, buffer, tempCurPos); /* file attributes */
+    }
+
     tempEncoded = tempCurPos - tempStartPos;
 
     uint32_t invokeIdSize = BerEncoder_UInt32determineEncodedSize((uint32_t) invokeId) + 2;
@@ -624,6 +822,8 @@ mmsServer_handleFileRenameRequest(
 
     if ((strlen(currentFileName) != 0) && (strlen(newFileName) != 0)) {
         if (FileSystem_renameFile(currentFileName, newFileName)){
+            mmsServer_destroyFileDirectorySnapshots(connection->server);
+
             /* send positive response */
             createNullResponseExtendedTag(invokeId, response, 0x4b);
         }
@@ -691,7 +891,7 @@ mmsServer_handleFileDirectoryRequest(
 
     }
 
-    createFileDirectoryResponse(invokeId, response, filename, continueAfter);
+    createFileDirectoryResponse(connection->server, invokeId, response, filename, continueAfter);
 }
 
 #endif /* MMS_FILE_SERVICE == 1 */
@@ -56,92 +56,6 @@ getNameListVMDSpecific(MmsServerConnection* connection) {
 }
 
 
-static char* appendMmsSubVariable(char* name, char* child)
-{
-    int nameLen = strlen(name);
-    int childLen = strlen(child);
-
-    int newSize = nameLen + childLen + 2;
-
-    char* newName = (char*) malloc(newSize);
-
-    int bufPos = 0;
-    int i;
-    for (i = 0; i < nameLen; i++) {
-        newName[bufPos++] = name[i];
-    }
-    newName[bufPos++] = '$';
-
-    for (i = 0; i < childLen; i++) {
-        newName[bufPos++] = child[i];
-    }
-
-    newName[bufPos] = 0;
-
-    return newName;
-}
-
-static LinkedList
-addSubNamedVaribleNamesToList(LinkedList nameList, char* prefix, MmsVariableSpecification* variable)
-{
-	LinkedList listElement = nameList;
-
-	if (variable->type == MMS_STRUCTURE) {
-
-		int i;
-
-		MmsVariableSpecification** variables = variable->typeSpec.structure.elements;
-
-		for (i = 0; i < variable->typeSpec.structure.elementCount; i++) {
-
-
-			char* variableName;
-
-//			if (variables[i]->type == MMS_ARRAY) {
-//			    MmsVariableSpecification* arrayElementSpec = variables[i]->typeSpec.array.elementTypeSpec;
-//			    variableName = appendMmsSubVariable(prefix, arrayElementSpec);
-//			}
-//			else
-			    variableName = appendMmsSubVariable(prefix, variables[i]->name);
-
-
-			listElement = LinkedList_insertAfter(listElement, variableName);
-
-			listElement = addSubNamedVaribleNamesToList(listElement, variableName, variables[i]);
-		}
-	}
-
-	return listElement;
-}
-
-static LinkedList
-getNameListDomainSpecific(MmsServerConnection* connection, char* domainName) {
-	MmsDevice* device = MmsServer_getDevice(connection->server);
-
-	LinkedList nameList = NULL;
-
-	MmsDomain* domain = MmsDevice_getDomain(device, domainName);
-
-	if (domain != NULL) {
-		nameList = LinkedList_create();
-		MmsVariableSpecification** variables = domain->namedVariables;
-
-		int i;
-
-		LinkedList element = nameList;
-
-		for (i = 0; i < domain->namedVariablesCount; i++) {
-			element = LinkedList_insertAfter(element, copyString(variables[i]->name));
-
-			char* prefix = variables[i]->name;
-
-			element = addSubNamedVaribleNamesToList(element, prefix, variables[i]);
-		}
-	}
-
-	return nameList;
-}
-
 #if MMS_DATA_SET_SERVICE == 1
 
 static LinkedList
@@ -193,49 +107,29 @@ getNamedVariableListAssociationSpecific(MmsServerConnection* connection)
 #endif
 
 static void
-createNameListResponse(
+encodeNameListResponse(
         MmsServerConnection* connection,
         int invokeId,
-        LinkedList nameList,
-        ByteBuffer* response,
-        char* continueAfter)
+        char** names,
+        int namesCount,
+        int startIndex,
+        ByteBuffer* response)
 {
-    LinkedList startElement = NULL;
-
-    if (continueAfter != NULL) {
-        LinkedList element = nameList;
-
-        while ((element = LinkedList_getNext(element)) != NULL) {
-            if (strcmp((char*) (element->data), continueAfter) == 0) {
-                startElement = element;
-                break;
-            }
-        }
-
-        if (startElement == NULL) {
-            mmsServer_createConfirmedErrorPdu(invokeId, response, MMS_ERROR_ACCESS_OBJECT_ACCESS_UNSUPPORTED);
-            return;
-        }
-    }
-
     /* determine number of identifiers to include in response */
-    if (startElement == NULL)
-        startElement = nameList;
-
     int nameCount = 0;
     int estimatedMmsPduLength = 27; /* estimated overhead size of PDU encoding */
     int maxPduSize = connection->maxPduSize;
 
     bool moreFollows = false;
 
-    LinkedList element = startElement;
-
     uint32_t identifierListSize = 0;
 
-    while ((element = LinkedList_getNext(element)) != NULL) {
+    int i;
+
+    for (i = startIndex; i < namesCount; i++) {
         int elementLength;
 
-        elementLength = BerEncoder_determineEncodedStringSize((char*) element->data);
+        elementLength = BerEncoder_determineEncodedStringSize(names[i]);
 
         if ((estimatedMmsPduLength + elementLength) > maxPduSize) {
             moreFollows = true;
@@ -263,8 +157,6 @@ createNameListResponse(
     uint32_t confirmedResponsePDUSize = confirmedServiceResponseSize + invokeIdSize;
 
     /* encode response */
-    element = startElement;
-
     uint8_t* buffer = response->buffer;
     int bufPos = 0;
 
@@ -276,16 +168,8 @@ createNameListResponse(
     bufPos = BerEncoder_encodeTL(0xa1, getNameListSize, buffer, bufPos);
     bufPos = BerEncoder_encodeTL(0xa0, identifierListSize, buffer, bufPos);
 
-    int i = 0;
-
-    while ((element = LinkedList_getNext(element)) != NULL) {
-        bufPos = BerEncoder_encodeStringWithTag(0x1a, (char*) element->data, buffer, bufPos);
-
-        i++;
-
-        if (i == nameCount)
-            break;
-    }
+    for (i = startIndex; i < (startIndex + nameCount); i++)
+        bufPos = BerEncoder_encodeStringWithTag(0x1a, names[i], buffer, bufPos);
 
     if (moreFollows == false)
     	bufPos = BerEncoder_encodeBoolean(0x81, moreFollows, buffer, bufPos);
@@ -296,6 +180,81 @@ createNameListResponse(
         printf("getNameList: encoded %i bytes\n", response->size);
 }
 
+static void
+createNameListResponse(
+        MmsServerConnection* connection,
+        int invokeId,
+        LinkedList nameList,
+        ByteBuffer* response,
+        char* continueAfter)
+{
+    if (nameList == NULL) {
+        mmsServer_createConfirmedErrorPdu(invokeId, response, MMS_ERROR_ACCESS_OBJECT_NON_EXISTENT);
+        return;
+    }
+
+    int namesCount = LinkedList_size(nameList);
+
+    char** names = (char**) malloc((namesCount + 1) * sizeof(char*));
+
+    int startIndex = 0;
+    int i = 0;
+
+    LinkedList element = nameList;
+
+    while ((element = LinkedList_getNext(element)) != NULL)
+        names[i++] = (char*) element->data;
+
+    if (continueAfter != NULL) {
+        startIndex = -1;
+
+        for (i = 0; i < namesCount; i++) {
+            if (strcmp(names[i], continueAfter) == 0) {
+                startIndex = i + 1;
+                break;
+            }
+        }
+
+        if (startIndex == -1) {
+            mmsServer_createConfirmedErrorPdu(invokeId, response, MMS_ERROR_ACCESS_OBJECT_ACCESS_UNSUPPORTED);
+            goto exit_function;
+        }
+    }
+
+    encodeNameListResponse(connection, invokeId, names, namesCount, startIndex, response);
+
+exit_function:
+    free(names);
+}
+
+static void
+createDomainVariableNameListResponse(
+        MmsServerConnection* connection,
+        int invokeId,
+        MmsDomain* domain,
+        ByteBuffer* response,
+        char* continueAfter)
+{
+    int namesCount;
+
+    char** names = MmsDomain_getVariableNames(domain, &namesCount);
+
+    int startIndex = 0;
+
+    if (continueAfter != NULL) {
+        startIndex = MmsDomain_getVariableNamePosition(domain, continueAfter);
+
+        if (startIndex == -1) {
+            mmsServer_createConfirmedErrorPdu(invokeId, response, MMS_ERROR_ACCESS_OBJECT_ACCESS_UNSUPPORTED);
+            return;
+        }
+
+        startIndex++;
+    }
+
+    encodeNameListResponse(connection, invokeId, names, namesCount, startIndex, response);
+}
+
 void
 mmsServer_handleGetNameListRequest(
 		MmsServerConnection* connection,
@@ -391,20 +350,18 @@ mmsServer_handleGetNameListRequest(
 		    if (DEBUG_MMS_SERVER)
 		        printf("get namelist for (%s)\n", domainSpecificName);
 
-			LinkedList nameList = getNameListDomainSpecific(connection, domainSpecificName);
+			MmsDomain* domain = MmsDevice_getDomain(MmsServer_getDevice(connection->server), domainSpecificName);
 
-			if (nameList == NULL)
+			if (domain == NULL)
 				mmsServer_createConfirmedErrorPdu(invokeId, response, MMS_ERROR_ACCESS_OBJECT_NON_EXISTENT);
-			else {
-				createNameListResponse(connection, invokeId, nameList, response, continueAfterId);
-				LinkedList_destroy(nameList);
-			}
+			else
+				createDomainVariableNameListResponse(connection, invokeId, domain, response, continueAfterId);
 		}
 #if (MMS_DATA_SET_SERVICE == 1)
 		else if (objectClass == OBJECT_CLASS_NAMED_VARIABLE_LIST) {
 			LinkedList nameList = getNamedVariableListDomainSpecific(connection, domainSpecificName);
 
-			createNameListResponse(connection, invokeId, nameList, response, continueAfter);
+			createNameListResponse(connection, invokeId, nameList, response, continueAfterId);
 
 			LinkedList_destroy(nameList);
 		}
@@ -422,7 +379,7 @@ mmsServer_handleGetNameListRequest(
 
 		LinkedList nameList = getNameListVMDSpecific(connection);
 
-		createNameListResponse(connection, invokeId, nameList, response, continueAfter);
+		createNameListResponse(connection, invokeId, nameList, response, continueAfterId);
 
 		LinkedList_destroyStatic(nameList);
 	}
@@ -433,7 +390,7 @@ mmsServer_handleGetNameListRequest(
 		if (objectClass == OBJECT_CLASS_NAMED_VARIABLE_LIST) {
 			LinkedList nameList = getNamedVariableListAssociationSpecific(connection);
 
-			createNameListResponse(connection, invokeId, nameList, response, continueAfter);
+			createNameListResponse(connection, invokeId, nameList, response, continueAfterId);
 
 			LinkedList_destroy(nameList);
 		}
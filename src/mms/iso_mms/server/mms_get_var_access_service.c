@@ -30,179 +30,222 @@
  *********************************************************************************************/
 
 static int
-createTypeSpecification (
-		MmsVariableSpecification* namedVariable,
-		TypeSpecification_t* typeSpec)
+encodeTypeSpecification(MmsVariableSpecification* namedVariable, uint8_t* buffer, int bufPos, bool encode);
+
+static int
+encodeStructureComponents(MmsVariableSpecification* namedVariable, uint8_t* buffer, int bufPos, bool encode)
 {
+	int i;
+	int size = 0;
 
-	if (namedVariable->type == MMS_ARRAY) {
-		typeSpec->present = TypeSpecification_PR_array;
+	for (i = 0; i < namedVariable->typeSpec.structure.elementCount; i++) {
+		MmsVariableSpecification* element = namedVariable->typeSpec.structure.elements[i];
 
-		asn_long2INTEGER(&(typeSpec->choice.array.numberOfElements),
-				(long) namedVariable->typeSpec.array.elementCount);
+		int componentNameSize = BerEncoder_determineEncodedStringSize(element->name);
+		int componentTypeSize = encodeTypeSpecification(element, NULL, 0, false);
 
-		typeSpec->choice.array.packed = NULL;
-		typeSpec->choice.array.elementType = (TypeSpecification_t*) calloc(1, sizeof(TypeSpecification_t));
+		if (componentTypeSize < 0)
+			return -1;
 
-		createTypeSpecification(namedVariable->typeSpec.array.elementTypeSpec,
-				typeSpec->choice.array.elementType);
-	}
-	else if (namedVariable->type == MMS_STRUCTURE) {
+		int componentSize = componentNameSize + 1 + BerEncoder_determineLengthSize(componentTypeSize)
+				+ componentTypeSize;
 
-		typeSpec->present = TypeSpecification_PR_structure;
+		if (encode) {
+			bufPos = BerEncoder_encodeTL(0x30, componentSize, buffer, bufPos);
+			bufPos = BerEncoder_encodeStringWithTag(0x80, element->name, buffer, bufPos);
+			bufPos = BerEncoder_encodeTL(0xa1, componentTypeSize, buffer, bufPos);
+			bufPos = encodeTypeSpecification(element, buffer, bufPos, true);
+		}
+		else
+			size += 1 + BerEncoder_determineLengthSize(componentSize) + componentSize;
+	}
 
-		int componentCount = namedVariable->typeSpec.structure.elementCount;
+	if (encode)
+		return bufPos;
+	else
+		return size;
+}
 
-		typeSpec->choice.structure.components.list.count = componentCount;
-		typeSpec->choice.structure.components.list.size = componentCount;
+/*
+ * encode = false: return the encoded size. encode = true: return the new buffer position
+ * Returns -1 if the type specification contains an unsupported type.
+ */
+static int
+encodeTypeSpecification(MmsVariableSpecification* namedVariable, uint8_t* buffer, int bufPos, bool encode)
+{
+	int size;
 
-		typeSpec->choice.structure.components.list.array
-			= (StructComponent_t**) calloc(componentCount, sizeof(StructComponent_t*));
+	switch (namedVariable->type) {
+	case MMS_ARRAY:
+		{
+			int elementCount = namedVariable->typeSpec.array.elementCount;
 
-		int i;
+			int elementTypeSize = encodeTypeSpecification(namedVariable->typeSpec.array.elementTypeSpec,
+					NULL, 0, false);
 
-		for (i = 0; i < componentCount; i++) {
+			if (elementTypeSize < 0)
+				return -1;
 
-			typeSpec->choice.structure.components.list.array[i] = 
-					(StructComponent_t*) calloc(1, sizeof(StructComponent_t));
+			int arraySize = 2 + BerEncoder_Int32determineEncodedSize(elementCount)
+					+ 1 + BerEncoder_determineLengthSize(elementTypeSize) + elementTypeSize;
 
-			typeSpec->choice.structure.components.list.array[i]->componentName =
-					(Identifier_t*) calloc(1, sizeof(Identifier_t));
+			if (encode) {
+				bufPos = BerEncoder_encodeTL(0xa1, arraySize, buffer, bufPos);
+				bufPos = BerEncoder_encodeInt32WithTL(0x81, elementCount, buffer, bufPos);
+				bufPos = BerEncoder_encodeTL(0xa2, elementTypeSize, buffer, bufPos);
+				bufPos = encodeTypeSpecification(namedVariable->typeSpec.array.elementTypeSpec,
+						buffer, bufPos, true);
+			}
+			else
+				size = 1 + BerEncoder_determineLengthSize(arraySize) + arraySize;
+		}
+		break;
 
-			typeSpec->choice.structure.components.list.array[i]->componentName->buf =
-			        (uint8_t*) copyString(namedVariable->typeSpec.structure.elements[i]->name);
+	case MMS_STRUCTURE:
+		{
+			int componentsSize = encodeStructureComponents(namedVariable, NULL, 0, false);
 
-			typeSpec->choice.structure.components.list.array[i]->componentName->size =
-					strlen(namedVariable->typeSpec.structure.elements[i]->name);
+			if (componentsSize < 0)
+				return -1;
 
-			typeSpec->choice.structure.components.list.array[i]->componentType =
-					(TypeSpecification_t*) calloc(1, sizeof(TypeSpecification_t));
+			int structureSize = 1 + BerEncoder_determineLengthSize(componentsSize) + componentsSize;
 
-			createTypeSpecification(namedVariable->typeSpec.structure.elements[i],
-					typeSpec->choice.structure.components.list.array[i]->componentType);
+			if (encode) {
+				bufPos = BerEncoder_encodeTL(0xa2, structureSize, buffer, bufPos);
+				bufPos = BerEncoder_encodeTL(0xa1, componentsSize, buffer, bufPos);
+				bufPos = encodeStructureComponents(namedVariable, buffer, bufPos, true);
+			}
+			else
+				size = 1 + BerEncoder_determineLengthSize(structureSize) + structureSize;
 		}
-	}
-	else {
-
-		switch (namedVariable->type) {
-		case MMS_BOOLEAN:
-			typeSpec->present = TypeSpecification_PR_boolean;
-			break;
-		case MMS_BIT_STRING:
-			typeSpec->present = TypeSpecification_PR_bitstring;
-			typeSpec->choice.bitstring = namedVariable->typeSpec.bitString;
-			break;
-		case MMS_INTEGER:
-			typeSpec->present = TypeSpecification_PR_integer;
-			typeSpec->choice.integer = namedVariable->typeSpec.integer;
-			break;
-		case MMS_UNSIGNED:
-			typeSpec->present = TypeSpecification_PR_unsigned;
-			typeSpec->choice.Unsigned = namedVariable->typeSpec.unsignedInteger;
-			break;
-		case MMS_FLOAT:
-			typeSpec->present = TypeSpecification_PR_floatingpoint;
-			typeSpec->choice.floatingpoint.exponentwidth =
-					namedVariable->typeSpec.floatingpoint.exponentWidth;
-			typeSpec->choice.floatingpoint.formatwidth =
-					namedVariable->typeSpec.floatingpoint.formatWidth;
-			break;
-		case MMS_OCTET_STRING:
-			typeSpec->present = TypeSpecification_PR_octetstring;
-			typeSpec->choice.octetstring = namedVariable->typeSpec.octetString;
-			break;
-		case MMS_VISIBLE_STRING:
-			typeSpec->present = TypeSpecification_PR_visiblestring;
-			typeSpec->choice.visiblestring = namedVariable->typeSpec.visibleString;
-			break;
-		case MMS_STRING:
-			typeSpec->present = TypeSpecification_PR_mMSString;
-			typeSpec->choice.mMSString = namedVariable->typeSpec.mmsString;
-			break;
-		case MMS_UTC_TIME:
-			typeSpec->present = TypeSpecification_PR_utctime;
-			break;
-		case MMS_BINARY_TIME:
-			typeSpec->present = TypeSpecification_PR_binarytime;
-
-			if (namedVariable->typeSpec.binaryTime == 6)
-			    typeSpec->choice.binarytime = 1;
+		break;
+
+	case MMS_BOOLEAN:
+		if (encode)
+			bufPos = BerEncoder_encodeTL(0x83, 0, buffer, bufPos);
+		else
+			size = 2;
+		break;
+
+	case MMS_BIT_STRING:
+		if (encode)
+			bufPos = BerEncoder_encodeInt32WithTL(0x84, namedVariable->typeSpec.bitString, buffer, bufPos);
+		else
+			size = 2 + BerEncoder_Int32determineEncodedSize(namedVariable->typeSpec.bitString);
+		break;
+
+	case MMS_INTEGER:
+		if (encode)
+			bufPos = BerEncoder_encodeInt32WithTL(0x85, namedVariable->typeSpec.integer, buffer, bufPos);
+		else
+			size = 2 + BerEncoder_Int32determineEncodedSize(namedVariable->typeSpec.integer);
+		break;
+
+	case MMS_UNSIGNED:
+		if (encode)
+			bufPos = BerEncoder_encodeInt32WithTL(0x86, namedVariable->typeSpec.unsignedInteger, buffer, bufPos);
+		else
+			size = 2 + BerEncoder_Int32determineEncodedSize(namedVariable->typeSpec.unsignedInteger);
+		break;
+
+	case MMS_FLOAT:
+		{
+			int formatWidthSize = 2 + BerEncoder_Int32determineEncodedSize(
+					namedVariable->typeSpec.floatingpoint.formatWidth);
+			int exponentWidthSize = 2 + BerEncoder_Int32determineEncodedSize(
+					namedVariable->typeSpec.floatingpoint.exponentWidth);
+
+			if (encode) {
+				bufPos = BerEncoder_encodeTL(0xa7, formatWidthSize + exponentWidthSize, buffer, bufPos);
+				bufPos = BerEncoder_encodeInt32WithTL(0x02, namedVariable->typeSpec.floatingpoint.formatWidth,
+						buffer, bufPos);
+				bufPos = BerEncoder_encodeInt32WithTL(0x02, namedVariable->typeSpec.floatingpoint.exponentWidth,
+						buffer, bufPos);
+			}
 			else
-			    typeSpec->choice.binarytime = 0;
-
-			break;
-		default:
-			if (DEBUG_MMS_SERVER) 
-                            printf("MMS-SERVER: Unsupported type %i!\n", namedVariable->type);
-			return -1;
-			break;
+				size = 2 + formatWidthSize + exponentWidthSize;
 		}
+		break;
+
+	case MMS_OCTET_STRING:
+		if (encode)
+			bufPos = BerEncoder_encodeInt32WithTL(0x89, namedVariable->typeSpec.octetString, buffer, bufPos);
+		else
+			size = 2 + BerEncoder_Int32determineEncodedSize(namedVariable->typeSpec.octetString);
+		break;
+
+	case MMS_VISIBLE_STRING:
+		if (encode)
+			bufPos = BerEncoder_encodeInt32WithTL(0x8a, namedVariable->typeSpec.visibleString, buffer, bufPos);
+		else
+			size = 2 + BerEncoder_Int32determineEncodedSize(namedVariable->typeSpec.visibleString);
+		break;
+
+	case MMS_STRING:
+		if (encode)
+			bufPos = BerEncoder_encodeInt32WithTL(0x90, namedVariable->typeSpec.mmsString, buffer, bufPos);
+		else
+			size = 2 + BerEncoder_Int32determineEncodedSize(namedVariable->typeSpec.mmsString);
+		break;
+
+	case MMS_UTC_TIME:
+		if (encode)
+			bufPos = BerEncoder_encodeTL(0x91, 0, buffer, bufPos);
+		else
+			size = 2;
+		break;
+
+	case MMS_BINARY_TIME:
+		if (encode)
+			bufPos = BerEncoder_encodeBoolean(0x8c, (namedVariable->typeSpec.binaryTime == 6), buffer, bufPos);
+		else
+			size = 3;
+		break;
+
+	default:
+		if (DEBUG_MMS_SERVER)
+			printf("MMS-SERVER: Unsupported type %i!\n", namedVariable->type);
+
+		return -1;
 	}
 
-	return 1;
+	if (encode)
+		return bufPos;
+	else
+		return size;
 }
 
-static void
-freeTypeSpecRecursive(TypeSpecification_t* typeSpec) {
-	if (typeSpec->present == TypeSpecification_PR_structure) {
-		int elementCount =
-				typeSpec->choice.structure.components.list.count;
-
-		int i;
-
-		for (i = 0; i < elementCount; i++) {
-		    free(typeSpec->choice.structure.components.list.array[i]->componentName->buf);
-			free(typeSpec->choice.structure.components.list.array[i]->componentName);
-			freeTypeSpecRecursive(typeSpec->choice.structure.components.list.array[i]->componentType);
-			free(typeSpec->choice.structure.components.list.array[i]->componentType);
-			free(typeSpec->choice.structure.components.list.array[i]);
-		}
+/*
+ * Create the GetVariableAccessAttributes service response (without the confirmed response PDU
+ * header and the invokeId). The result can be reused for all requests of the variable.
+ * Returns NULL if the type of the variable can't be encoded.
+ */
+static uint8_t*
+createEncodedAccessAttributes(MmsVariableSpecification* namedVariable, int* encodedSize)
+{
+	int typeSpecSize = encodeTypeSpecification(namedVariable, NULL, 0, false);
 
-		free(typeSpec->choice.structure.components.list.array);
-	}
-	else if (typeSpec->present == TypeSpecification_PR_array) {
-		free(typeSpec->choice.array.numberOfElements.buf);
-		freeTypeSpecRecursive(typeSpec->choice.array.elementType);
-		free(typeSpec->choice.array.elementType);
-	}
-}
+	if (typeSpecSize < 0)
+		return NULL;
 
-static void
-deleteVariableAccessAttributesResponse(
-		GetVariableAccessAttributesResponse_t* getVarAccessAttr)
-{
-	if (getVarAccessAttr->typeSpecification.present	== TypeSpecification_PR_structure) {
-		int count =	getVarAccessAttr->typeSpecification.choice.structure.components.list.count;
-
-		int i;
-		for (i = 0; i < count; i++) {
-		    free(getVarAccessAttr->typeSpecification.choice.structure.components.list.array[i]->componentName->buf);
-			free(getVarAccessAttr->typeSpecification.choice.structure.components.list.array[i]->componentName);
-			TypeSpecification_t* typeSpec =
-					getVarAccessAttr->typeSpecification.choice.structure.components.list.array[i]->componentType;
-			freeTypeSpecRecursive(typeSpec);
-			free(typeSpec);
-			free(getVarAccessAttr->typeSpecification.choice.structure.components.list.array[i]);
-		}
+	/* mmsDeletable and typeSpecification */
+	int accessAttributesSize = 3 + 1 + BerEncoder_determineLengthSize(typeSpecSize) + typeSpecSize;
 
-		free(getVarAccessAttr->typeSpecification.choice.structure.components.list.array);
+	*encodedSize = 1 + BerEncoder_determineLengthSize(accessAttributesSize) + accessAttributesSize;
 
-		getVarAccessAttr->typeSpecification.choice.structure.components.list.array = NULL;
-		getVarAccessAttr->typeSpecification.choice.structure.components.list.count = 0;
-		getVarAccessAttr->typeSpecification.choice.structure.components.list.size =	0;
-	} else if (getVarAccessAttr->typeSpecification.present == TypeSpecification_PR_array) {
-		free(getVarAccessAttr->typeSpecification.choice.array.numberOfElements.buf);
-		getVarAccessAttr->typeSpecification.choice.array.numberOfElements.buf = NULL;
-		getVarAccessAttr->typeSpecification.choice.array.numberOfElements.size = 0;
-		freeTypeSpecRecursive(getVarAccessAttr->typeSpecification.choice.array.elementType);
+	uint8_t* buffer = (uint8_t*) malloc(*encodedSize);
 
-		free(getVarAccessAttr->typeSpecification.choice.array.elementType);
+	int bufPos = 0;
 
-		getVarAccessAttr->typeSpecification.choice.array.elementType = NULL;
-	}
+	bufPos = BerEncoder_encodeTL(0xa6, accessAttributesSize, buffer, bufPos);
+	bufPos = BerEncoder_encodeBoolean(0x80, false, buffer, bufPos);
+	bufPos = BerEncoder_encodeTL(0xa2, typeSpecSize, buffer, bufPos);
+	bufPos = encodeTypeSpecification(namedVariable, buffer, bufPos, true);
+
+	return buffer;
 }
 
-static int
+static void
 createVariableAccessAttributesResponse(
 		MmsServerConnection* connection,
 		char* domainId,
@@ -216,50 +259,81 @@ createVariableAccessAttributesResponse(
 
 	if (domain == NULL) {
 		if (DEBUG_MMS_SERVER) printf("mms_server: domain %s not known\n", domainId);
-		return -1;
+
+		mmsServer_createConfirmedErrorPdu(invokeId, response, MMS_ERROR_ACCESS_OBJECT_NON_EXISTENT);
+		return;
 	}
 
-	MmsVariableSpecification* namedVariable = MmsDomain_getNamedVariable(domain, nameId);
+	uint8_t* encodedAttributes = NULL;
+	int encodedAttributesSize = 0;
+	bool isCached = false;
 
-	if (namedVariable == NULL) {
-		if (DEBUG_MMS_SERVER) printf("mms_server: named variable %s not known\n", nameId);
-		return -1;
-	}
+	/* the responses for variables in the name index are cached (requests are handled with the model lock) */
+	int position = MmsDomain_getVariableNamePosition(domain, nameId);
+
+	if (position != -1) {
+		if (domain->encodedTypeSpecs == NULL) {
+			domain->encodedTypeSpecs = (uint8_t**) calloc(domain->variableNamesCount, sizeof(uint8_t*));
+			domain->encodedTypeSpecSizes = (int*) calloc(domain->variableNamesCount, sizeof(int));
+		}
 
-	MmsPdu_t* mmsPdu = mmsServer_createConfirmedResponse(invokeId);
+		encodedAttributes = domain->encodedTypeSpecs[position];
+		encodedAttributesSize = domain->encodedTypeSpecSizes[position];
+		isCached = true;
+	}
 
-	mmsPdu->choice.confirmedResponsePdu.confirmedServiceResponse.present =
-			ConfirmedServiceResponse_PR_getVariableAccessAttributes;
+	if (encodedAttributes == NULL) {
+		MmsVariableSpecification* namedVariable = MmsDomain_getNamedVariable(domain, nameId);
 
-	GetVariableAccessAttributesResponse_t* getVarAccessAttr;
+		if (namedVariable == NULL) {
+			if (DEBUG_MMS_SERVER) printf("mms_server: named variable %s not known\n", nameId);
 
-	getVarAccessAttr = &(mmsPdu->choice.confirmedResponsePdu.
-			confirmedServiceResponse.choice.getVariableAccessAttributes);
+			mmsServer_createConfirmedErrorPdu(invokeId, response, MMS_ERROR_ACCESS_OBJECT_NON_EXISTENT);
+			return;
+		}
 
-	getVarAccessAttr->mmsDeletable = 0;
+		encodedAttributes = createEncodedAccessAttributes(namedVariable, &encodedAttributesSize);
 
-	createTypeSpecification(namedVariable, &getVarAccessAttr->typeSpecification);
+		/* not cached - the error is reported for every request */
+		if (encodedAttributes == NULL) {
+			mmsServer_createConfirmedErrorPdu(invokeId, response, MMS_ERROR_SERVICE_OTHER);
+			return;
+		}
 
-	asn_enc_rval_t rval =
-	        der_encode(&asn_DEF_MmsPdu, mmsPdu, mmsServer_write_out, (void*) response);
+		if (isCached) {
+			domain->encodedTypeSpecs[position] = encodedAttributes;
+			domain->encodedTypeSpecSizes[position] = encodedAttributesSize;
+		}
+	}
 
-	if (rval.encoded == -1) {
-	    response->size = 0;
+	uint32_t invokeIdSize = BerEncoder_UInt32determineEncodedSize((uint32_t) invokeId) + 2;
 
-        if (DEBUG_MMS_SERVER)
-            printf("MMS getVariableAccessAttributes: message to large! send error PDU!\n");
+	uint32_t confirmedResponsePDUSize = invokeIdSize + encodedAttributesSize;
 
-        mmsServer_createConfirmedErrorPdu(invokeId, response,
-                      MMS_ERROR_SERVICE_OTHER);
+	if ((int) (1 + BerEncoder_determineLengthSize(confirmedResponsePDUSize) + confirmedResponsePDUSize)
+			> response->maxSize)
+	{
+		if (DEBUG_MMS_SERVER)
+			printf("MMS getVariableAccessAttributes: message to large! send error PDU!\n");
 
-        return 0;
+		mmsServer_createConfirmedErrorPdu(invokeId, response, MMS_ERROR_SERVICE_OTHER);
 	}
+	else {
+		uint8_t* buffer = response->buffer;
+		int bufPos = 0;
 
-	deleteVariableAccessAttributesResponse(getVarAccessAttr);
+		bufPos = BerEncoder_encodeTL(0xa1, confirmedResponsePDUSize, buffer, bufPos);
+		bufPos = BerEncoder_encodeTL(0x02, invokeIdSize - 2, buffer, bufPos);
+		bufPos = BerEncoder_encodeUInt32((uint32_t) invokeId, buffer, bufPos);
 
-	asn_DEF_MmsPdu.free_struct(&asn_DEF_MmsPdu, mmsPdu, 0);
+		memcpy(buffer + bufPos, encodedAttributes, encodedAttributesSize);
+		bufPos += encodedAttributesSize;
 
-	return 0;
+		response->size = bufPos;
+	}
+
+	if (isCached == false)
+		free(encodedAttributes);
 }
 
 int
@@ -269,48 +343,41 @@ mmsServer_handleGetVariableAccessAttributesRequest(
 		uint32_t invokeId,
 		ByteBuffer* response)
 {
-	int retVal = 0;
+	char domainId[65];
+	char nameId[130];
 
-	GetVariableAccessAttributesRequest_t* request = 0;
+	int length;
 
-	asn_dec_rval_t rval; /* Decoder return value  */
+	/* name [0] ObjectName */
+	if ((bufPos >= maxBufPos) || (buffer[bufPos++] != 0xa0)) {
+		if (DEBUG_MMS_SERVER) printf("GetVariableAccessAttributesRequest with address not supported!\n");
+		return -1;
+	}
 
-	rval = ber_decode(NULL, &asn_DEF_GetVariableAccessAttributesRequest,
-				(void**) &request, buffer + bufPos, maxBufPos - bufPos);
+	bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, maxBufPos);
 
-	if (rval.code == RC_OK) {
-		if (request->present == GetVariableAccessAttributesRequest_PR_name) {
-			if (request->choice.name.present == ObjectName_PR_domainspecific) {
-				Identifier_t domainId = request->choice.name.choice.domainspecific.domainId;
-				Identifier_t nameId = request->choice.name.choice.domainspecific.itemId;
+	if (bufPos < 0)
+		goto exit_parsing_failed;
 
-				char* domainIdStr = createStringFromBuffer(domainId.buf, domainId.size);
-				char* nameIdStr = createStringFromBuffer(nameId.buf, nameId.size);
-				if (DEBUG_MMS_SERVER) printf("getVariableAccessAttributes domainId: %s nameId: %s\n", domainIdStr, nameIdStr);
+	MmsObjectNameScope scope;
 
-				createVariableAccessAttributesResponse(connection, domainIdStr, nameIdStr, invokeId, response);
+	if (mmsServer_parseObjectName(buffer, bufPos, maxBufPos, &scope, domainId, nameId) < 0)
+		goto exit_parsing_failed;
 
-				free(domainIdStr);
-				free(nameIdStr);
-			}
-			else {
-				if (DEBUG_MMS_SERVER) printf("GetVariableAccessAttributesRequest with name other than domainspecific is not supported!\n");
-				retVal = -1;
-			}
-		}
-		else {
-			if (DEBUG_MMS_SERVER) printf("GetVariableAccessAttributesRequest with address not supported!\n");
-			retVal = -1;
-		}
-	}
-	else {
-		if (DEBUG_MMS_SERVER) printf("GetVariableAccessAttributesRequest parsing request failed!\n");
-		retVal = -1;
+	if (scope != MMS_OBJECT_NAME_DOMAIN_SPECIFIC) {
+		if (DEBUG_MMS_SERVER) printf("GetVariableAccessAttributesRequest with name other than domainspecific is not supported!\n");
+		return -1;
 	}
 
-	asn_DEF_GetVariableAccessAttributesRequest.free_struct(&asn_DEF_GetVariableAccessAttributesRequest, request, 0);
+	if (DEBUG_MMS_SERVER) printf("getVariableAccessAttributes domainId: %s nameId: %s\n", domainId, nameId);
+
+	createVariableAccessAttributesResponse(connection, domainId, nameId, invokeId, response);
+
+	return 0;
 
-	return retVal;
+exit_parsing_failed:
+	if (DEBUG_MMS_SERVER) printf("GetVariableAccessAttributesRequest parsing request failed!\n");
+	return -1;
 }
 
 #endif /* (MMS_GET_VARIABLE_ACCESS_ATTRIBUTES == 1) */
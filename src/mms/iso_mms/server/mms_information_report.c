@@ -28,11 +28,16 @@
 #include "mms_access_result.h"
 
 #include "ber_encoder.h"
+#include "trace.h"
 
 void
 MmsServerConnection_sendInformationReportSingleVariableVMDSpecific(MmsServerConnection* self,
 		char* itemId, MmsValue* value, bool handlerMode)
 {
+#if (CONFIG_MMS_SERVER_METRICS == 1)
+	uint64_t startTime = mmsServer_getMetricsTimestamp(self->server);
+#endif
+
 	uint32_t itemIdSize = strlen(itemId);
 	uint32_t varSpecSize = 1 + BerEncoder_determineLengthSize(itemIdSize) + itemIdSize;
 	uint32_t sequenceSize = 1 + BerEncoder_determineLengthSize(varSpecSize) + varSpecSize;
@@ -49,9 +54,9 @@ MmsServerConnection_sendInformationReportSingleVariableVMDSpecific(MmsServerConn
 	uint32_t informationReportSize = 1 + BerEncoder_determineLengthSize(informationReportContentSize) +
 			informationReportContentSize;
 
-	if (DEBUG) printf("sendInfReportSingle variable: %s\n", itemId);
+	uint32_t pduSize = 1 + BerEncoder_determineLengthSize(informationReportSize) + informationReportSize;
 
-	ByteBuffer* reportBuffer = ByteBuffer_create(NULL, self->maxPduSize);
+	ByteBuffer* reportBuffer = MmsBufferPool_getBuffer(self->sendBufferPool, pduSize);
 
 	uint8_t* buffer = reportBuffer->buffer;
 	int bufPos = 0;
@@ -72,9 +77,15 @@ MmsServerConnection_sendInformationReportSingleVariableVMDSpecific(MmsServerConn
 
     reportBuffer->size = bufPos;
 
+    TRACE2(TRACE_MMS_SERVER_INFORMATION_REPORT, 1, bufPos);
+
+#if (CONFIG_MMS_SERVER_METRICS == 1)
+    mmsServer_recordInformationReport(self, bufPos, startTime);
+#endif
+
     IsoConnection_sendMessage(self->isoConnection, reportBuffer, handlerMode);
 
-    ByteBuffer_destroy(reportBuffer);
+    MmsBufferPool_releaseBuffer(self->sendBufferPool, reportBuffer);
 }
 
 void
@@ -85,6 +96,10 @@ MmsServerConnection_sendInformationReportListOfVariables(
         bool handlerMode
         )
 {
+#if (CONFIG_MMS_SERVER_METRICS == 1)
+    uint64_t startTime = mmsServer_getMetricsTimestamp(self->server);
+#endif
+
     /* determine message size */
     uint32_t listOfVarSpecSize = 0;
 
@@ -134,7 +149,9 @@ MmsServerConnection_sendInformationReportListOfVariables(
             informationReportContentSize;
 
     /* encode message */
-    ByteBuffer* reportBuffer = ByteBuffer_create(NULL, self->maxPduSize);
+    uint32_t pduSize = 1 + BerEncoder_determineLengthSize(informationReportSize) + informationReportSize;
+
+    ByteBuffer* reportBuffer = MmsBufferPool_getBuffer(self->sendBufferPool, pduSize);
 
     uint8_t* buffer = reportBuffer->buffer;
     int bufPos = 0;
@@ -191,16 +208,25 @@ MmsServerConnection_sendInformationReportListOfVariables(
 
     reportBuffer->size = bufPos;
 
+    TRACE2(TRACE_MMS_SERVER_INFORMATION_REPORT, i, bufPos);
+
+#if (CONFIG_MMS_SERVER_METRICS == 1)
+    mmsServer_recordInformationReport(self, bufPos, startTime);
+#endif
+
     IsoConnection_sendMessage(self->isoConnection, reportBuffer, handlerMode);
 
-    ByteBuffer_destroy(reportBuffer);
+    MmsBufferPool_releaseBuffer(self->sendBufferPool, reportBuffer);
 }
 
 
 void /* send information report for a named variable list */
 MmsServerConnection_sendInformationReportVMDSpecific(MmsServerConnection* self, char* itemId, LinkedList values,
-        bool handlerMode)
+        IsoMessageType messageType)
 {
+#if (CONFIG_MMS_SERVER_METRICS == 1)
+    uint64_t startTime = mmsServer_getMetricsTimestamp(self->server);
+#endif
 
     uint32_t variableAccessSpecSize = 0;
     uint32_t objectNameSize = 0;
@@ -238,9 +264,9 @@ MmsServerConnection_sendInformationReportVMDSpecific(MmsServerConnection* self,
     informationReportSize = 1 +  informationReportContentSize +
             BerEncoder_determineLengthSize(informationReportContentSize);
 
-    if (DEBUG) printf("sendInfReport: %i items\n", variableCount);
+    uint32_t pduSize = 1 + BerEncoder_determineLengthSize(informationReportSize) + informationReportSize;
 
-    ByteBuffer* reportBuffer = ByteBuffer_create(NULL, self->maxPduSize);
+    ByteBuffer* reportBuffer = MmsBufferPool_getBuffer(self->sendBufferPool, pduSize);
 
     uint8_t* buffer = reportBuffer->buffer;
     int bufPos = 0;
@@ -268,9 +294,15 @@ MmsServerConnection_sendInformationReportVMDSpecific(MmsServerConnection* self,
 
     reportBuffer->size = bufPos;
 
-    IsoConnection_sendMessage(self->isoConnection, reportBuffer, false);
+    TRACE2(TRACE_MMS_SERVER_INFORMATION_REPORT, variableCount, bufPos);
+
+#if (CONFIG_MMS_SERVER_METRICS == 1)
+    mmsServer_recordInformationReport(self, bufPos, startTime);
+#endif
+
+    IsoConnection_enqueueMessage(self->isoConnection, reportBuffer, messageType);
 
-    ByteBuffer_destroy(reportBuffer);
+    MmsBufferPool_releaseBuffer(self->sendBufferPool, reportBuffer);
 }
 
 
@@ -46,6 +46,10 @@ void
 MmsNamedVariableListEntry_destroy(MmsNamedVariableListEntry self)
 {
 	free(self->variableName);
+
+	if (self->componentName != NULL)
+		free(self->componentName);
+
 	free(self);
 }
 
@@ -69,6 +73,7 @@ MmsNamedVariableList_create(char* name, bool deletable)
 	self->deletable = deletable;
 	self->name = copyString(name);
 	self->listOfVariables = LinkedList_create();
+	self->readPlan = NULL;
 
 	return self;
 }
@@ -89,6 +94,8 @@ void
 MmsNamedVariableList_addVariable(MmsNamedVariableList self, MmsNamedVariableListEntry variable)
 {
 	LinkedList_add(self->listOfVariables, variable);
+
+	MmsNamedVariableList_setReadPlan(self, NULL);
 }
 
 LinkedList
@@ -108,8 +115,36 @@ void
 MmsNamedVariableList_destroy(MmsNamedVariableList self)
 {
 	LinkedList_destroyDeep(self->listOfVariables, deleteVariableListEntry);
+
+	if (self->readPlan != NULL)
+		MmsNamedVariableListReadPlan_destroy(self->readPlan);
+
 	free(self->name);
 	free(self);
 }
 
+MmsNamedVariableListReadPlan
+MmsNamedVariableList_getReadPlan(MmsNamedVariableList self)
+{
+	return self->readPlan;
+}
+
+void
+MmsNamedVariableList_setReadPlan(MmsNamedVariableList self, MmsNamedVariableListReadPlan readPlan)
+{
+	if (self->readPlan != NULL)
+		MmsNamedVariableListReadPlan_destroy(self->readPlan);
+
+	self->readPlan = readPlan;
+}
+
+void
+MmsNamedVariableListReadPlan_destroy(MmsNamedVariableListReadPlan self)
+{
+	free(self->entries);
+	free(self->values);
+	MmsValue_delete(self->objectNonExistentError);
+	free(self);
+}
+
 
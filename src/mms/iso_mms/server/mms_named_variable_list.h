@@ -31,11 +31,35 @@
 #include "libiec61850_common_api.h"
 #include "linked_list.h"
 #include "mms_common.h"
+#include "mms_value.h"
+
+typedef struct {
+	MmsNamedVariableListEntry listEntry;
+	MmsVariableSpecification* typeSpec;
+
+	/* resolved value (or access error) - NULL if the value has to be resolved for each read */
+	MmsValue* value;
+
+	/* size of the encoded access result if the encoding has a fixed size - otherwise -1 */
+	int accessResultSize;
+} MmsNamedVariableListReadPlanEntry;
+
+/* resolved entries of a named variable list - created by the read service with the first read */
+typedef struct sMmsNamedVariableListReadPlan {
+	int entryCount;
+	MmsNamedVariableListReadPlanEntry* entries;
+
+	/* values of the current read (reads are serialized by the model lock) */
+	MmsValue** values;
+
+	MmsValue* objectNonExistentError;
+} *MmsNamedVariableListReadPlan;
 
 struct sMmsNamedVariableList {
 	bool deletable;
 	char* name;
 	LinkedList listOfVariables;
+	MmsNamedVariableListReadPlan readPlan;
 };
 
 MmsNamedVariableListEntry
@@ -68,6 +92,15 @@ MmsNamedVariableList_getVariableList(MmsNamedVariableList self);
 void
 MmsNamedVariableList_destroy(MmsNamedVariableList self);
 
+MmsNamedVariableListReadPlan
+MmsNamedVariableList_getReadPlan(MmsNamedVariableList self);
+
+void
+MmsNamedVariableList_setReadPlan(MmsNamedVariableList self, MmsNamedVariableListReadPlan readPlan);
+
+void
+MmsNamedVariableListReadPlan_destroy(MmsNamedVariableListReadPlan self);
+
 /**@}*/
 
 #endif /* MMS_NAMED_VARIABLE_LIST_H_ */
@@ -66,86 +66,125 @@ createDeleteNamedVariableListResponse(uint32_t invokeId, ByteBuffer* response,
     response->size = bufPos;
 }
 
+static bool
+deleteNamedVariableList(MmsServerConnection* connection, MmsDevice* device,
+        MmsObjectNameScope scope, char* domainId, char* listName, int* numberDeleted)
+{
+    if (scope == MMS_OBJECT_NAME_DOMAIN_SPECIFIC) {
+        MmsDomain* domain = MmsDevice_getDomain(device, domainId);
+
+        if (domain == NULL)
+            return false;
+
+        MmsNamedVariableList variableList = MmsDomain_getNamedVariableList(domain, listName);
+
+        if (variableList == NULL)
+            return false;
+
+        if (MmsNamedVariableList_isDeletable(variableList)) {
+            MmsDomain_deleteNamedVariableList(domain, listName);
+            (*numberDeleted)++;
+        }
+
+        return true;
+    }
+    else if (scope == MMS_OBJECT_NAME_AA_SPECIFIC) {
+        MmsNamedVariableList variableList = MmsServerConnection_getNamedVariableList(connection, listName);
+
+        if (variableList == NULL)
+            return false;
+
+        MmsServerConnection_deleteNamedVariableList(connection, listName);
+        (*numberDeleted)++;
+
+        return true;
+    }
+
+    //TODO vmd-specific lists are not supported
+
+    return false;
+}
+
 void
 mmsServer_handleDeleteNamedVariableListRequest(MmsServerConnection* connection,
 		uint8_t* buffer, int bufPos, int maxBufPos,
 		uint32_t invokeId,
 		ByteBuffer* response)
 {
-	DeleteNamedVariableListRequest_t* request = 0;
+	long scopeOfDelete = 0; /* specific (default) */
 
-    MmsPdu_t* mmsPdu = 0;
+	int listOfNamesPos = -1;
+	int listOfNamesEndPos = 0;
 
-    asn_dec_rval_t rval = ber_decode(NULL, &asn_DEF_MmsPdu, (void**) &mmsPdu, buffer, maxBufPos);
+	int length;
 
-    if (rval.code != RC_OK)
-        mmsServer_writeMmsRejectPdu(&invokeId, MMS_ERROR_REJECT_INVALID_PDU, response);
+	while (bufPos < maxBufPos) {
+		uint8_t tag = buffer[bufPos++];
 
-    request = &(mmsPdu->choice.confirmedRequestPdu.confirmedServiceRequest.choice.deleteNamedVariableList);
+		bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, maxBufPos);
 
-	long scopeOfDelete;
+		if ((bufPos < 0) || (length < 0) || (bufPos + length > maxBufPos))
+			goto exit_invalid_pdu;
 
-	asn_INTEGER2long(request->scopeOfDelete, &scopeOfDelete);
+		switch (tag) {
+		case 0x80: /* scopeOfDelete */
+			if ((length < 1) || (length > 4))
+				goto exit_invalid_pdu;
 
-	MmsDevice* device = MmsServer_getDevice(connection->server);
+			scopeOfDelete = BerDecoder_decodeInt32(buffer, length, bufPos);
+			break;
 
-	if (scopeOfDelete == DeleteNamedVariableListRequest__scopeOfDelete_specific) {
-		int numberMatched = 0;
-		int numberDeleted = 0;
+		case 0xa1: /* listOfVariableListName */
+			listOfNamesPos = bufPos;
+			listOfNamesEndPos = bufPos + length;
+			break;
 
-		int numberItems = request->listOfVariableListName->list.count;
+		case 0x82: /* domainName */
+			break;
 
-		int i;
+		default:
+			goto exit_invalid_pdu;
+		}
 
-		for (i = 0; i < numberItems; i++) {
-			if (request->listOfVariableListName->list.array[i]->present == ObjectName_PR_domainspecific) {
-		        char domainIdStr[65];
-		        char nameIdStr[65];
+		bufPos += length;
+	}
 
-		        mmsMsg_copyAsn1IdentifierToStringBuffer(request->listOfVariableListName->list.array[i]->choice.domainspecific.domainId,
-		                domainIdStr, 65);
+	if (scopeOfDelete != 0) {
+		mmsServer_createConfirmedErrorPdu(invokeId, response, MMS_ERROR_ACCESS_OBJECT_ACCESS_UNSUPPORTED);
+		return;
+	}
 
-		        mmsMsg_copyAsn1IdentifierToStringBuffer(request->listOfVariableListName->list.array[i]->choice.domainspecific.itemId,
-		                nameIdStr, 65);
+	MmsDevice* device = MmsServer_getDevice(connection->server);
 
-		        MmsDomain* domain = MmsDevice_getDomain(device, domainIdStr);
+	int numberMatched = 0;
+	int numberDeleted = 0;
 
-				MmsNamedVariableList variableList = MmsDomain_getNamedVariableList(domain, nameIdStr);
+	if (listOfNamesPos != -1) {
+		bufPos = listOfNamesPos;
 
-				if (variableList != NULL) {
-					numberMatched++;
+		while (bufPos < listOfNamesEndPos) {
+			MmsObjectNameScope scope;
+			char domainId[65];
+			char listName[130];
 
-					if (MmsNamedVariableList_isDeletable(variableList)) {
-						MmsDomain_deleteNamedVariableList(domain, nameIdStr);
-						numberDeleted++;
-					}
-				}
-			}
-			else if (request->listOfVariableListName->list.array[i]->present == ObjectName_PR_aaspecific) {
-				char* itemId = mmsMsg_createStringFromAsnIdentifier(
-						request->listOfVariableListName->list.array[i]->choice.aaspecific);
+			bufPos = mmsServer_parseObjectName(buffer, bufPos, listOfNamesEndPos, &scope, domainId, listName);
 
-				MmsNamedVariableList variableList = MmsServerConnection_getNamedVariableList(connection, itemId);
+			if (bufPos < 0)
+				goto exit_invalid_pdu;
 
-				if (variableList != NULL) {
-					numberMatched++;
-					numberDeleted++;
+			if (deleteNamedVariableList(connection, device, scope, domainId, listName, &numberDeleted))
+				numberMatched++;
+		}
+	}
 
-					MmsServerConnection_deleteNamedVariableList(connection, itemId);
-				}
+	createDeleteNamedVariableListResponse(invokeId, response, numberMatched, numberDeleted);
 
-				free(itemId);
-			}
-			//TODO else send error???
-		}
+	return;
 
-		createDeleteNamedVariableListResponse(invokeId, response, numberMatched, numberDeleted);
-	}
-	else {
-		mmsServer_createConfirmedErrorPdu(invokeId, response, MMS_ERROR_ACCESS_OBJECT_ACCESS_UNSUPPORTED);
-	}
+exit_invalid_pdu:
+	if (DEBUG_MMS_SERVER) printf("MMS_SERVER: failed to parse DeleteNamedVariableList request!\n");
 
-    asn_DEF_MmsPdu.free_struct(&asn_DEF_MmsPdu, mmsPdu, 0);
+	mmsServer_writeMmsRejectPdu(&invokeId, MMS_ERROR_REJECT_INVALID_PDU, response);
 }
 
 static void
@@ -168,94 +207,162 @@ createDefineNamedVariableListResponse(uint32_t invokeId, ByteBuffer* response)
     response->size = bufPos;
 }
 
+/* returns the buffer position after the alternate access or -1 if not supported */
+static int
+parseAlternateAccess(uint8_t* buffer, int bufPos, int maxBufPos, int* arrayIndex, char* componentName)
+{
+	int length;
+
+	uint8_t tag = buffer[bufPos++];
+
+	bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, maxBufPos);
+
+	if ((bufPos < 0) || (length < 1) || (bufPos + length > maxBufPos))
+		return -1;
+
+	int endPos = bufPos + length;
+
+	if (tag == 0x82) { /* selectAccess: index */
+		if (length > 4)
+			return -1;
+
+		*arrayIndex = (int) BerDecoder_decodeUint32(buffer, length, bufPos);
+
+		return endPos;
+	}
+
+	if (tag != 0xa0) /* selectAlternateAccess */
+		return -1;
+
+	/* accessSelection: index */
+	if (buffer[bufPos++] != 0x81)
+		return -1;
+
+	bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, endPos);
+
+	if ((bufPos < 0) || (length < 1) || (length > 4) || (bufPos + length > endPos))
+		return -1;
+
+	*arrayIndex = (int) BerDecoder_decodeUint32(buffer, length, bufPos);
+
+	bufPos += length;
+
+	if (bufPos < endPos) {
+		/* alternateAccess: SEQUENCE OF with a single component selection */
+		if (buffer[bufPos++] != 0x30)
+			return -1;
+
+		bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, endPos);
+
+		if ((bufPos < 0) || (length < 2) || (bufPos + length != endPos))
+			return -1;
+
+		/* selectAccess: component */
+		if (buffer[bufPos++] != 0x81)
+			return -1;
+
+		bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, endPos);
+
+		if ((bufPos < 0) || (length < 0) || (length > 129) || (bufPos + length != endPos))
+			return -1;
+
+		memcpy(componentName, buffer + bufPos, length);
+		componentName[length] = 0;
+	}
+
+	return endPos;
+}
+
+/* returns NULL if the list of variables is not supported. Sets parsingError if the request is invalid. */
 static MmsNamedVariableList
-createNamedVariableList(MmsDevice* device,
-		DefineNamedVariableListRequest_t* request,
-		char* variableListName)
+createNamedVariableList(MmsDevice* device, uint8_t* buffer, int bufPos, int maxBufPos,
+		char* variableListName, bool* parsingError)
 {
 	MmsNamedVariableList namedVariableList = MmsNamedVariableList_create(variableListName, true);
 
-	int variableCount = request->listOfVariable.list.count;
+	/* append at the end of the list without traversing it for every entry */
+	LinkedList lastElement = MmsNamedVariableList_getVariableList(namedVariableList);
 
-	int i;
-	for (i = 0; i < variableCount; i++) {
-		VariableSpecification_t* varSpec =
-				&request->listOfVariable.list.array[i]->variableSpecification;
+	int length;
 
-		long arrayIndex = -1;
-		char* componentName = NULL;
+	while (bufPos < maxBufPos) {
+		/* SEQUENCE { variableSpecification, alternateAccess [5] OPTIONAL } */
+		if (buffer[bufPos++] != 0x30)
+			goto exit_parsing_error;
 
-		/* Handle alternate access specification - for array element definition */
-		if (request->listOfVariable.list.array[i]->alternateAccess != NULL) {
+		bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, maxBufPos);
 
+		if ((bufPos < 0) || (length < 0) || (bufPos + length > maxBufPos))
+			goto exit_parsing_error;
 
-			if (request->listOfVariable.list.array[i]->alternateAccess->list.count != 1) {
-				MmsNamedVariableList_destroy(namedVariableList);
-				namedVariableList = NULL;
-				break;
-			}
-			else {
+		int entryEndPos = bufPos + length;
 
-				struct AlternateAccess__Member* alternateAccess =
-						request->listOfVariable.list.array[i]->alternateAccess->list.array[0];
+		/* variableSpecification: name [0] */
+		if ((bufPos >= entryEndPos) || (buffer[bufPos] != 0xa0))
+			goto exit_not_supported;
 
-				if (alternateAccess->present ==	AlternateAccess__Member_PR_unnamed)
-				{
-					//TODO add checks!
+		bufPos = BerDecoder_decodeLength(buffer, &length, bufPos + 1, entryEndPos);
 
-					asn_INTEGER2long(&(alternateAccess->choice.unnamed->choice.selectAlternateAccess.accessSelection.choice.index),
-							&arrayIndex);
+		if ((bufPos < 0) || (length < 0) || (bufPos + length > entryEndPos))
+			goto exit_parsing_error;
 
-					componentName =
-						mmsMsg_createStringFromAsnIdentifier(alternateAccess->choice.unnamed->
-								choice.selectAlternateAccess.alternateAccess->list.array[0]->
-								choice.unnamed->choice.selectAccess.choice.component);
+		MmsObjectNameScope scope;
+		char domainId[65];
+		char variableName[130];
 
-				}
-				else {
-					MmsNamedVariableList_destroy(namedVariableList);
-					namedVariableList = NULL;
-					break;
-				}
+		bufPos = mmsServer_parseObjectName(buffer, bufPos, bufPos + length, &scope, domainId, variableName);
 
-			}
+		if (bufPos < 0)
+			goto exit_parsing_error;
 
-		}
+		if (scope != MMS_OBJECT_NAME_DOMAIN_SPECIFIC)
+			goto exit_not_supported;
 
-		if (varSpec->present == VariableSpecification_PR_name) {
-			char* variableName = createStringFromBuffer(
-					varSpec->choice.name.choice.domainspecific.itemId.buf,
-					varSpec->choice.name.choice.domainspecific.itemId.size);
+		MmsAccessSpecifier accessSpecifier;
+		char componentName[130];
 
-			char* domainId = createStringFromBuffer(
-					varSpec->choice.name.choice.domainspecific.domainId.buf,
-					varSpec->choice.name.choice.domainspecific.domainId.size);
+		accessSpecifier.domain = MmsDevice_getDomain(device, domainId);
+		accessSpecifier.variableName = variableName;
+		accessSpecifier.arrayIndex = -1;
+		accessSpecifier.componentName = NULL;
 
-			MmsDomain* domain = MmsDevice_getDomain(device, domainId);
+		if (accessSpecifier.domain == NULL)
+			goto exit_not_supported;
 
-			MmsAccessSpecifier accessSpecifier;
+		/* alternateAccess [5] - for array element definition */
+		if (bufPos < entryEndPos) {
+			if (buffer[bufPos++] != 0xa5)
+				goto exit_parsing_error;
 
-			accessSpecifier.domain = domain;
-			accessSpecifier.variableName = variableName;
-			accessSpecifier.arrayIndex = arrayIndex;
-			accessSpecifier.componentName = componentName;
+			bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, entryEndPos);
 
-			MmsNamedVariableListEntry variable =
-					MmsNamedVariableListEntry_create(accessSpecifier);
+			if ((bufPos < 0) || (length < 1) || (bufPos + length != entryEndPos))
+				goto exit_parsing_error;
 
-			MmsNamedVariableList_addVariable(namedVariableList, variable);
+			componentName[0] = 0;
 
-			free(domainId);
-			free(variableName);
-		}
-		else {
-			MmsNamedVariableList_destroy(namedVariableList);
-			namedVariableList = NULL;
-			break;
+			/* only a single alternate access selection is supported */
+			if (parseAlternateAccess(buffer, bufPos, entryEndPos, &(accessSpecifier.arrayIndex),
+					componentName) != entryEndPos)
+				goto exit_not_supported;
+
+			if (componentName[0] != 0)
+				accessSpecifier.componentName = componentName;
 		}
+
+		lastElement = LinkedList_insertAfter(lastElement, MmsNamedVariableListEntry_create(accessSpecifier));
+
+		bufPos = entryEndPos;
 	}
 
 	return namedVariableList;
+
+exit_parsing_error:
+	*parsingError = true;
+
+exit_not_supported:
+	MmsNamedVariableList_destroy(namedVariableList);
+	return NULL;
 }
 
 void
@@ -265,149 +372,171 @@ mmsServer_handleDefineNamedVariableListRequest(
 		uint32_t invokeId,
 		ByteBuffer* response)
 {
-	DefineNamedVariableListRequest_t* request = 0;
+	MmsObjectNameScope scope;
+	char domainId[65];
+	char variableListName[130];
 
-	MmsPdu_t* mmsPdu = 0;
+	int length;
 
-	asn_dec_rval_t rval = ber_decode(NULL, &asn_DEF_MmsPdu, (void**) &mmsPdu, buffer, maxBufPos);
+	/* variableListName */
+	bufPos = mmsServer_parseObjectName(buffer, bufPos, maxBufPos, &scope, domainId, variableListName);
 
-	if (rval.code != RC_OK)
-	    mmsServer_writeMmsRejectPdu(&invokeId, MMS_ERROR_REJECT_INVALID_PDU, response);
+	if (bufPos < 0)
+		goto exit_invalid_pdu;
 
-	request = &(mmsPdu->choice.confirmedRequestPdu.confirmedServiceRequest.choice.defineNamedVariableList);
+	/* listOfVariable [0] */
+	if ((bufPos >= maxBufPos) || (buffer[bufPos++] != 0xa0))
+		goto exit_invalid_pdu;
 
-	MmsDevice* device = MmsServer_getDevice(connection->server);
+	bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, maxBufPos);
+
+	if ((bufPos < 0) || (length < 0) || (bufPos + length > maxBufPos))
+		goto exit_invalid_pdu;
 
-	if (request->variableListName.present == ObjectName_PR_domainspecific) {
+	int listEndPos = bufPos + length;
 
-		char* domainName = createStringFromBuffer(
-				request->variableListName.choice.domainspecific.domainId.buf,
-				request->variableListName.choice.domainspecific.domainId.size);
+	MmsDevice* device = MmsServer_getDevice(connection->server);
 
-		MmsDomain* domain = MmsDevice_getDomain(device, domainName);
+	MmsDomain* domain = NULL;
 
-		free(domainName);
+	if (scope == MMS_OBJECT_NAME_DOMAIN_SPECIFIC) {
+		domain = MmsDevice_getDomain(device, domainId);
 
 		if (domain == NULL) {
 			mmsServer_createConfirmedErrorPdu(invokeId, response, MMS_ERROR_ACCESS_OBJECT_NON_EXISTENT);
 			return;
 		}
 
-		char* variableListName = createStringFromBuffer(
-				request->variableListName.choice.domainspecific.itemId.buf,
-				request->variableListName.choice.domainspecific.itemId.size);
-
 		if (MmsDomain_getNamedVariableList(domain, variableListName) != NULL) {
-            mmsServer_createConfirmedErrorPdu(invokeId, response, MMS_ERROR_DEFINITION_OBJECT_EXISTS);
+			mmsServer_createConfirmedErrorPdu(invokeId, response, MMS_ERROR_DEFINITION_OBJECT_EXISTS);
+			return;
 		}
-		else {
-		    MmsNamedVariableList namedVariableList = createNamedVariableList(device,
-		                    request, variableListName);
-
-	        if (namedVariableList != NULL) {
-	            MmsDomain_addNamedVariableList(domain, namedVariableList);
-	            createDefineNamedVariableListResponse(invokeId, response);
-	        }
-	        else
-	            mmsServer_createConfirmedErrorPdu(invokeId, response, MMS_ERROR_ACCESS_OBJECT_ACCESS_UNSUPPORTED);
+	}
+	else if (scope == MMS_OBJECT_NAME_AA_SPECIFIC) {
+		if (MmsServerConnection_getNamedVariableList(connection, variableListName) != NULL) {
+			mmsServer_createConfirmedErrorPdu(invokeId, response, MMS_ERROR_DEFINITION_OBJECT_EXISTS);
+			return;
 		}
-
-		free(variableListName);
 	}
-	else if (request->variableListName.present == ObjectName_PR_aaspecific) {
+	else {
+		mmsServer_createConfirmedErrorPdu(invokeId, response, MMS_ERROR_ACCESS_OBJECT_ACCESS_UNSUPPORTED);
+		return;
+	}
 
-		char* variableListName = createStringFromBuffer(
-				request->variableListName.choice.aaspecific.buf,
-				request->variableListName.choice.aaspecific.size);
+	bool parsingError = false;
 
+	MmsNamedVariableList namedVariableList = createNamedVariableList(device, buffer, bufPos, listEndPos,
+			variableListName, &parsingError);
 
-		if (MmsServerConnection_getNamedVariableList(connection, variableListName) != NULL) {
-		    mmsServer_createConfirmedErrorPdu(invokeId, response, MMS_ERROR_DEFINITION_OBJECT_EXISTS);
-		}
-		else {
-            MmsNamedVariableList namedVariableList = createNamedVariableList(device,
-                    request, variableListName);
-
-            if (namedVariableList != NULL) {
-                MmsServerConnection_addNamedVariableList(connection, namedVariableList);
-                createDefineNamedVariableListResponse(invokeId, response);
-            }
-            else
-                mmsServer_createConfirmedErrorPdu(invokeId, response, MMS_ERROR_ACCESS_OBJECT_ACCESS_UNSUPPORTED);
-		}
+	if (parsingError)
+		goto exit_invalid_pdu;
+
+	if (namedVariableList != NULL) {
+		if (domain != NULL)
+			MmsDomain_addNamedVariableList(domain, namedVariableList);
+		else
+			MmsServerConnection_addNamedVariableList(connection, namedVariableList);
 
-		free(variableListName);
+		createDefineNamedVariableListResponse(invokeId, response);
 	}
 	else
 		mmsServer_createConfirmedErrorPdu(invokeId, response, MMS_ERROR_ACCESS_OBJECT_ACCESS_UNSUPPORTED);
 
-	asn_DEF_MmsPdu.free_struct(&asn_DEF_MmsPdu, mmsPdu, 0);
+	return;
+
+exit_invalid_pdu:
+	if (DEBUG_MMS_SERVER) printf("MMS_SERVER: failed to parse DefineNamedVariableList request!\n");
+
+	mmsServer_writeMmsRejectPdu(&invokeId, MMS_ERROR_REJECT_INVALID_PDU, response);
 }
 
 #endif /* (MMS_DYNAMIC_DATA_SETS == 1) */
 
 #if (MMS_GET_DATA_SET_ATTRIBUTES == 1)
 
-static void
-createGetNamedVariableListAttributesResponse(int invokeId, ByteBuffer* response,
-		MmsNamedVariableList variableList, char* domainName)
+static int
+encodeVariableListEntry(MmsNamedVariableListEntry variableEntry, uint8_t* buffer, int bufPos, bool encode)
 {
-	MmsPdu_t* mmsPdu = mmsServer_createConfirmedResponse(invokeId);
+	char* domainName = MmsDomain_getName(variableEntry->domain);
 
-	mmsPdu->choice.confirmedResponsePdu.confirmedServiceResponse.present =
-			ConfirmedServiceResponse_PR_getNamedVariableListAttributes;
+	/* domain-specific ObjectName */
+	int objectNameSize = BerEncoder_determineEncodedStringSize(domainName)
+			+ BerEncoder_determineEncodedStringSize(variableEntry->variableName);
 
-	GetNamedVariableListAttributesResponse_t* varListResponse =
-		&(mmsPdu->choice.confirmedResponsePdu.confirmedServiceResponse.
-				choice.getNamedVariableListAttributes);
+	/* variableSpecification: name [0] */
+	int nameSize = 1 + BerEncoder_determineLengthSize(objectNameSize) + objectNameSize;
 
-	varListResponse->mmsDeletable = MmsNamedVariableList_isDeletable(variableList);
+	int entrySize = 1 + BerEncoder_determineLengthSize(nameSize) + nameSize;
 
-	LinkedList variables = MmsNamedVariableList_getVariableList(variableList);
+	if (encode == false)
+		return 1 + BerEncoder_determineLengthSize(entrySize) + entrySize;
 
-	int variableCount = LinkedList_size(variables);
+	bufPos = BerEncoder_encodeTL(0x30, entrySize, buffer, bufPos);
+	bufPos = BerEncoder_encodeTL(0xa0, nameSize, buffer, bufPos);
+	bufPos = BerEncoder_encodeTL(0xa1, objectNameSize, buffer, bufPos);
+	bufPos = BerEncoder_encodeStringWithTag(0x1a, domainName, buffer, bufPos);
+	bufPos = BerEncoder_encodeStringWithTag(0x1a, variableEntry->variableName, buffer, bufPos);
 
-	varListResponse->listOfVariable.list.count = variableCount;
-	varListResponse->listOfVariable.list.size = variableCount;
+	return bufPos;
+}
 
-	varListResponse->listOfVariable.list.array = (struct GetNamedVariableListAttributesResponse__listOfVariable__Member**) 
-		 calloc(variableCount, sizeof(void*));
+static void
+createGetNamedVariableListAttributesResponse(int invokeId, ByteBuffer* response,
+		MmsNamedVariableList variableList)
+{
+	LinkedList variables = MmsNamedVariableList_getVariableList(variableList);
+
+	uint32_t listOfVariableSize = 0;
 
 	LinkedList variable = LinkedList_getNext(variables);
 
-	int i;
-	for (i = 0; i < variableCount; i++) {
-		MmsNamedVariableListEntry variableEntry = (MmsNamedVariableListEntry) variable->data;
+	while (variable != NULL) {
+		listOfVariableSize += encodeVariableListEntry((MmsNamedVariableListEntry) variable->data,
+				NULL, 0, false);
+
+		variable = LinkedList_getNext(variable);
+	}
 
-		varListResponse->listOfVariable.list.array[i] =  (struct GetNamedVariableListAttributesResponse__listOfVariable__Member*) 
-			calloc(1, sizeof(struct GetNamedVariableListAttributesResponse__listOfVariable__Member));
+	uint32_t invokeIdSize = BerEncoder_UInt32determineEncodedSize((uint32_t) invokeId) + 2;
 
-		varListResponse->listOfVariable.list.array[i]->variableSpecification.present =
-				VariableSpecification_PR_name;
+	/* mmsDeletable and listOfVariable [1] */
+	uint32_t varListResponseSize = 3 + 1 + BerEncoder_determineLengthSize(listOfVariableSize)
+			+ listOfVariableSize;
 
-		varListResponse->listOfVariable.list.array[i]->variableSpecification.choice.name.present =
-				ObjectName_PR_domainspecific;
+	uint32_t confirmedResponsePDUSize = invokeIdSize + 1 + BerEncoder_determineLengthSize(varListResponseSize)
+			+ varListResponseSize;
 
-		char* variableDomainName = MmsDomain_getName(variableEntry->domain);
+	if ((int) (1 + BerEncoder_determineLengthSize(confirmedResponsePDUSize) + confirmedResponsePDUSize)
+			> response->maxSize)
+	{
+		if (DEBUG_MMS_SERVER)
+			printf("MMS getNamedVariableListAttributes: message to large! send error PDU!\n");
+
+		mmsServer_createConfirmedErrorPdu(invokeId, response, MMS_ERROR_SERVICE_OTHER);
+		return;
+	}
 
-		varListResponse->listOfVariable.list.array[i]->variableSpecification.choice.name.choice.
-			domainspecific.domainId.buf = (uint8_t*) copyString(variableDomainName);
+	uint8_t* buffer = response->buffer;
+	int bufPos = 0;
 
-		varListResponse->listOfVariable.list.array[i]->variableSpecification.choice.name.choice.
-			domainspecific.domainId.size = strlen(variableDomainName);
+	bufPos = BerEncoder_encodeTL(0xa1, confirmedResponsePDUSize, buffer, bufPos);
 
-		varListResponse->listOfVariable.list.array[i]->variableSpecification.choice.name.choice.
-			domainspecific.itemId.buf = (uint8_t*) copyString(variableEntry->variableName);
+	bufPos = BerEncoder_encodeTL(0x02, invokeIdSize - 2, buffer, bufPos);
+	bufPos = BerEncoder_encodeUInt32((uint32_t) invokeId, buffer, bufPos);
 
-		varListResponse->listOfVariable.list.array[i]->variableSpecification.choice.name.choice.
-			domainspecific.itemId.size = strlen(variableEntry->variableName);
+	bufPos = BerEncoder_encodeTL(0xac, varListResponseSize, buffer, bufPos);
+	bufPos = BerEncoder_encodeBoolean(0x80, MmsNamedVariableList_isDeletable(variableList), buffer, bufPos);
+	bufPos = BerEncoder_encodeTL(0xa1, listOfVariableSize, buffer, bufPos);
+
+	variable = LinkedList_getNext(variables);
+
+	while (variable != NULL) {
+		bufPos = encodeVariableListEntry((MmsNamedVariableListEntry) variable->data, buffer, bufPos, true);
 
 		variable = LinkedList_getNext(variable);
 	}
 
-	der_encode(&asn_DEF_MmsPdu, mmsPdu,	mmsServer_write_out, (void*) response);
-
-	asn_DEF_MmsPdu.free_struct(&asn_DEF_MmsPdu, mmsPdu, 0);
+	response->size = bufPos;
 }
 
 void
@@ -417,25 +546,16 @@ mmsServer_handleGetNamedVariableListAttributesRequest(
 		uint32_t invokeId,
 		ByteBuffer* response)
 {
-	GetNamedVariableListAttributesRequest_t* request = 0;
+	MmsObjectNameScope scope;
+	char domainName[65];
+	char itemName[130];
 
-	asn_dec_rval_t rval = ber_decode(NULL, &asn_DEF_GetNamedVariableListAttributesRequest,
-				(void**) &request, buffer + bufPos, maxBufPos - bufPos);
-
-	if (rval.code != RC_OK) {
-	    mmsServer_writeMmsRejectPdu(&invokeId, MMS_ERROR_REJECT_INVALID_PDU, response);
-	    return;
+	if (mmsServer_parseObjectName(buffer, bufPos, maxBufPos, &scope, domainName, itemName) < 0) {
+		mmsServer_writeMmsRejectPdu(&invokeId, MMS_ERROR_REJECT_INVALID_PDU, response);
+		return;
 	}
 
-	if (request->present == ObjectName_PR_domainspecific) {
-
-		char* domainName = createStringFromBuffer(
-				request->choice.domainspecific.domainId.buf,
-				request->choice.domainspecific.domainId.size);
-
-		char* itemName = createStringFromBuffer(
-				request->choice.domainspecific.itemId.buf,
-				request->choice.domainspecific.itemId.size);
+	if (scope == MMS_OBJECT_NAME_DOMAIN_SPECIFIC) {
 
 		MmsDevice* mmsDevice = MmsServer_getDevice(connection->server);
 
@@ -446,23 +566,16 @@ mmsServer_handleGetNamedVariableListAttributesRequest(
 					MmsDomain_getNamedVariableList(domain, itemName);
 
 			if (variableList != NULL)
-				createGetNamedVariableListAttributesResponse(invokeId, response, variableList, domainName);
+				createGetNamedVariableListAttributesResponse(invokeId, response, variableList);
 			else
 				mmsServer_createConfirmedErrorPdu(invokeId, response, MMS_ERROR_ACCESS_OBJECT_NON_EXISTENT);
 		}
 		else
 			mmsServer_createConfirmedErrorPdu(invokeId, response, MMS_ERROR_ACCESS_OBJECT_NON_EXISTENT);
-
-
-		free(domainName);
-		free(itemName);
 	}
 	else {
 		mmsServer_createConfirmedErrorPdu(invokeId, response, MMS_ERROR_ACCESS_OBJECT_ACCESS_UNSUPPORTED);
 	}
-
-	asn_DEF_GetVariableAccessAttributesRequest.free_struct(&asn_DEF_GetNamedVariableListAttributesRequest,
-			request, 0);
 }
 
 #endif /* (MMS_GET_DATA_SET_ATTRIBUTES == 1) */
@@ -364,36 +364,17 @@ encodeVariableAccessSpecification(VarAccessSpec* accessSpec, uint8_t* buffer, in
 	return bufPos;
 }
 
-static void
-encodeReadResponse(MmsServerConnection* connection,
-		uint32_t invokeId, ByteBuffer* response, LinkedList values,
-		VarAccessSpec* accessSpec)
+/* returns the buffer position of the first access result or -1 if the response doesn't fit in the MMS PDU */
+static int
+encodeReadResponseHeader(MmsServerConnection* connection, uint32_t invokeId, ByteBuffer* response,
+		int accessResultSize, VarAccessSpec* accessSpec)
 {
-	int i;
-
-	int variableCount = LinkedList_size(values);
-
 	int varAccessSpecSize = 0;
 
 	if (accessSpec != NULL) {
 		varAccessSpecSize = encodeVariableAccessSpecification(accessSpec, NULL, 0, false);
 	}
 
-	/* determine BER encoded message sizes */
-	int accessResultSize = 0;
-
-	/* iterate values list to determine encoded size  */
-	LinkedList value = LinkedList_getNext(values);
-
-	for (i = 0; i < variableCount; i++) {
-
-	   MmsValue* data = (MmsValue*) value->data;
-
-	   accessResultSize += mmsServer_encodeAccessResult(data, NULL, 0, false);
-
-		value = LinkedList_getNext(value);
-	}
-
 	int listOfAccessResultsLength = 1 +
 									BerEncoder_determineLengthSize(accessResultSize) +
 									accessResultSize;
@@ -418,7 +399,7 @@ encodeReadResponse(MmsServerConnection* connection,
 
 		mmsServer_createConfirmedErrorPdu(invokeId, response,
 					  MMS_ERROR_SERVICE_OTHER);
-		return;
+		return -1;
 	}
 
 	/* encode message */
@@ -443,6 +424,40 @@ encodeReadResponse(MmsServerConnection* connection,
 	/* encode list of access results */
 	bufPos = BerEncoder_encodeTL(0xa1, accessResultSize, buffer, bufPos);
 
+	return bufPos;
+}
+
+static void
+encodeReadResponse(MmsServerConnection* connection,
+		uint32_t invokeId, ByteBuffer* response, LinkedList values,
+		VarAccessSpec* accessSpec)
+{
+	int i;
+
+	int variableCount = LinkedList_size(values);
+
+	/* determine BER encoded message sizes */
+	int accessResultSize = 0;
+
+	/* iterate values list to determine encoded size  */
+	LinkedList value = LinkedList_getNext(values);
+
+	for (i = 0; i < variableCount; i++) {
+
+	   MmsValue* data = (MmsValue*) value->data;
+
+	   accessResultSize += mmsServer_encodeAccessResult(data, NULL, 0, false);
+
+		value = LinkedList_getNext(value);
+	}
+
+	int bufPos = encodeReadResponseHeader(connection, invokeId, response, accessResultSize, accessSpec);
+
+	if (bufPos == -1)
+		return;
+
+	uint8_t* buffer = response->buffer;
+
 	/* encode access results */
 	value = LinkedList_getNext(values);
 
@@ -540,42 +555,159 @@ exit:
 
 #if (MMS_DATA_SET_SERVICE == 1)
 
-static void
-createNamedVariableListResponse(MmsServerConnection* connection, MmsNamedVariableList namedList,
-		int invokeId, ByteBuffer* response, ReadRequest_t* read, VarAccessSpec* accessSpec)
+static bool
+hasFixedSizeEncoding(MmsValue* value)
 {
+	switch (MmsValue_getType(value)) {
+	case MMS_ARRAY:
+	case MMS_STRUCTURE:
+		{
+			int elementCount = MmsValue_getArraySize(value);
 
-	LinkedList /*<MmsValue>*/ values = LinkedList_create();
+			int i;
+
+			for (i = 0; i < elementCount; i++) {
+				MmsValue* element = MmsValue_getElement(value, i);
+
+				if ((element == NULL) || (hasFixedSizeEncoding(element) == false))
+					return false;
+			}
+
+			return true;
+		}
+
+	case MMS_BOOLEAN:
+	case MMS_BIT_STRING:
+	case MMS_FLOAT:
+	case MMS_UTC_TIME:
+	case MMS_BINARY_TIME:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+/*
+ * Resolve the entries of the named variable list. Values of the value cache are resolved to
+ * the MmsValue instances of the data model. Other values (provided by the read handler) are
+ * resolved for each read.
+ */
+static MmsNamedVariableListReadPlan
+createReadPlan(MmsServerConnection* connection, MmsNamedVariableList namedList)
+{
 	LinkedList variables = MmsNamedVariableList_getVariableList(namedList);
 
-	int variableCount = LinkedList_size(variables);
+	int entryCount = LinkedList_size(variables);
 
-	int i;
+	MmsNamedVariableListReadPlan plan = (MmsNamedVariableListReadPlan)
+			malloc(sizeof(struct sMmsNamedVariableListReadPlan));
+
+	plan->entryCount = entryCount;
+	plan->entries = (MmsNamedVariableListReadPlanEntry*)
+			calloc(entryCount, sizeof(MmsNamedVariableListReadPlanEntry));
+	plan->values = (MmsValue**) calloc(entryCount, sizeof(MmsValue*));
+	plan->objectNonExistentError = MmsValue_newDataAccessError(DATA_ACCESS_ERROR_OBJECT_NONE_EXISTENT);
 
 	LinkedList variable = LinkedList_getNext(variables);
 
-	for (i = 0; i < variableCount; i++) {
+	int i;
+
+	for (i = 0; i < entryCount; i++) {
+		MmsNamedVariableListReadPlanEntry* entry = &(plan->entries[i]);
 
 		MmsNamedVariableListEntry variableListEntry = (MmsNamedVariableListEntry) variable->data;
 
 		MmsDomain* variableDomain = MmsNamedVariableListEntry_getDomain(variableListEntry);
 		char* variableName = MmsNamedVariableListEntry_getVariableName(variableListEntry);
 
-		MmsVariableSpecification* namedVariable = MmsDomain_getNamedVariable(variableDomain,
-				variableName);
+		entry->listEntry = variableListEntry;
+		entry->accessResultSize = -1;
 
-		addNamedVariableToResultList(namedVariable, variableDomain, variableName,
-								values, connection, NULL);
+		if (variableDomain != NULL)
+			entry->typeSpec = MmsDomain_getNamedVariable(variableDomain, variableName);
+
+		if (entry->typeSpec == NULL)
+			entry->value = plan->objectNonExistentError;
+		else
+			entry->value = MmsServer_getValueFromCache(connection->server, variableDomain, variableName);
+
+		if ((entry->value != NULL) && hasFixedSizeEncoding(entry->value))
+			entry->accessResultSize = mmsServer_encodeAccessResult(entry->value, NULL, 0, false);
 
 		variable = LinkedList_getNext(variable);
 	}
 
-	if (isSpecWithResult(read)) /* add specification to result */
-		encodeReadResponse(connection, invokeId, response, values, accessSpec);
+	return plan;
+}
+
+static MmsValue*
+getReadPlanEntryValue(MmsServerConnection* connection, MmsNamedVariableListReadPlanEntry* entry)
+{
+	MmsDomain* variableDomain = MmsNamedVariableListEntry_getDomain(entry->listEntry);
+	char* variableName = MmsNamedVariableListEntry_getVariableName(entry->listEntry);
+
+	if (entry->typeSpec->type == MMS_STRUCTURE)
+		return addNamedVariableValue(entry->typeSpec, connection, variableDomain, variableName);
 	else
-		encodeReadResponse(connection, invokeId, response, values, NULL);
+		return mmsServer_getValue(connection->server, variableDomain, variableName, connection);
+}
+
+static void
+createNamedVariableListResponse(MmsServerConnection* connection, MmsNamedVariableList namedList,
+		int invokeId, ByteBuffer* response, ReadRequest_t* read, VarAccessSpec* accessSpec)
+{
+	MmsNamedVariableListReadPlan plan = MmsNamedVariableList_getReadPlan(namedList);
+
+	if (plan == NULL) {
+		plan = createReadPlan(connection, namedList);
+		MmsNamedVariableList_setReadPlan(namedList, plan);
+	}
+
+	int accessResultSize = 0;
+
+	int i;
+
+	for (i = 0; i < plan->entryCount; i++) {
+		MmsNamedVariableListReadPlanEntry* entry = &(plan->entries[i]);
+
+		MmsValue* value = entry->value;
+
+		if (value == NULL) {
+			value = getReadPlanEntryValue(connection, entry);
 
-	deleteValueList(values);
+			if (value == NULL)
+				value = plan->objectNonExistentError;
+		}
+
+		plan->values[i] = value;
+
+		if (entry->accessResultSize != -1)
+			accessResultSize += entry->accessResultSize;
+		else
+			accessResultSize += mmsServer_encodeAccessResult(value, NULL, 0, false);
+	}
+
+	if (isSpecWithResult(read) == false) /* don't add specification to result */
+		accessSpec = NULL;
+
+	int bufPos = encodeReadResponseHeader(connection, invokeId, response, accessResultSize, accessSpec);
+
+	if (bufPos != -1) {
+		for (i = 0; i < plan->entryCount; i++)
+			bufPos = mmsServer_encodeAccessResult(plan->values[i], response->buffer, bufPos, true);
+
+		response->size = bufPos;
+
+		if (DEBUG_MMS_SERVER)
+			printf("MMS read: sent message for request with id %i (size = %i)\n", invokeId, bufPos);
+	}
+
+	/* release the values created by the read handler */
+	for (i = 0; i < plan->entryCount; i++) {
+		if (plan->entries[i].value == NULL)
+			MmsValue_deleteConditional(plan->values[i]);
+	}
 }
 
 static void
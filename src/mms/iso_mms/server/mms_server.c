@@ -57,6 +57,14 @@ MmsServer_create(IsoServer isoServer, MmsDevice* device)
 
     IsoServer_setUserLock(isoServer, self->modelMutex);
 
+#if (MMS_FILE_SERVICE == 1)
+    self->fileDirectorySnapshots = LinkedList_create();
+#endif
+
+#if (CONFIG_MMS_SERVER_METRICS == 1)
+    mmsServer_initMetrics(self);
+#endif
+
     return self;
 }
 
@@ -120,6 +128,15 @@ MmsServer_destroy(MmsServer self)
     Map_deleteDeep(self->openConnections, false, closeConnection);
     Map_deleteDeep(self->valueCaches, false, (void (*) (void*)) deleteSingleCache);
     Semaphore_destroy(self->modelMutex);
+
+#if (MMS_FILE_SERVICE == 1)
+    mmsServer_destroyFileDirectorySnapshots(self);
+#endif
+
+#if (CONFIG_MMS_SERVER_METRICS == 1)
+    mmsServer_destroyMetrics(self);
+#endif
+
     free(self);
 }
 
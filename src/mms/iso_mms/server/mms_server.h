@@ -56,6 +56,58 @@ typedef struct {
 
 #endif /* (MMS_FILE_SERVICE == 1) */
 
+/**
+ * MMS services for which the server collects metrics.
+ *
+ * MMS_SERVER_SERVICE_OTHER counts unknown or rejected PDUs. MMS_SERVER_SERVICE_INFORMATION_REPORT
+ * counts the information reports sent by the server (reports and command termination messages).
+ */
+typedef enum {
+    MMS_SERVER_SERVICE_INITIATE,
+    MMS_SERVER_SERVICE_CONCLUDE,
+    MMS_SERVER_SERVICE_STATUS,
+    MMS_SERVER_SERVICE_GET_NAME_LIST,
+    MMS_SERVER_SERVICE_IDENTIFY,
+    MMS_SERVER_SERVICE_READ,
+    MMS_SERVER_SERVICE_WRITE,
+    MMS_SERVER_SERVICE_GET_VARIABLE_ACCESS_ATTRIBUTES,
+    MMS_SERVER_SERVICE_DEFINE_NAMED_VARIABLE_LIST,
+    MMS_SERVER_SERVICE_GET_NAMED_VARIABLE_LIST_ATTRIBUTES,
+    MMS_SERVER_SERVICE_DELETE_NAMED_VARIABLE_LIST,
+    MMS_SERVER_SERVICE_FILE_OPEN,
+    MMS_SERVER_SERVICE_FILE_READ,
+    MMS_SERVER_SERVICE_FILE_CLOSE,
+    MMS_SERVER_SERVICE_FILE_RENAME,
+    MMS_SERVER_SERVICE_FILE_DELETE,
+    MMS_SERVER_SERVICE_FILE_DIRECTORY,
+    MMS_SERVER_SERVICE_OTHER,
+    MMS_SERVER_SERVICE_INFORMATION_REPORT,
+    MMS_SERVER_SERVICE_COUNT
+} MmsServerService;
+
+/**
+ * Number of buckets of the latency histograms.
+ *
+ * The histograms are log-linear (HDR style): values below 4 ns have their own bucket, every
+ * power of two above is split into 4 buckets. So the relative error of a bucket is below 25%.
+ * The last bucket (starting at about 64 s) also counts all larger values.
+ */
+#define MMS_SERVER_METRICS_HISTOGRAM_SIZE 144
+
+typedef struct {
+    uint64_t requests;          /* handled requests (reports passed to the send queue for MMS_SERVER_SERVICE_INFORMATION_REPORT) */
+    uint64_t errors;            /* requests answered with an error or reject PDU */
+    uint64_t bytesIn;           /* size of the received MMS PDUs */
+    uint64_t bytesOut;          /* size of the sent MMS PDUs */
+    uint64_t queueingDelay;     /* accumulated time (ns) between reception of a request and the start of its processing */
+    uint64_t processingTime;    /* accumulated processing (report encoding) time in ns */
+    uint32_t latencyHistogram[MMS_SERVER_METRICS_HISTOGRAM_SIZE]; /* distribution of the processing time */
+} MmsServiceMetrics;
+
+typedef struct sMmsServerMetrics {
+    MmsServiceMetrics services[MMS_SERVER_SERVICE_COUNT];
+} MmsServerMetrics;
+
 typedef struct sMmsServerConnection {
 	int maxServOutstandingCalling;
 	int maxServOutstandingCalled;
@@ -65,7 +117,8 @@ typedef struct sMmsServerConnection {
 	MmsServer server;
 	LinkedList /*<MmsNamedVariableList>*/namedVariableLists; /* aa-specific named variable lists */
 	uint32_t lastInvokeId;
-
+	struct sMmsBufferPool* sendBufferPool; /* buffers for unsolicited PDUs (information reports) */
+	MmsServerMetrics* metrics; /* NULL if metrics are compiled out */
 
 #if (MMS_FILE_SERVICE == 1)
 	int32_t nextFrsmId;
@@ -155,6 +208,70 @@ MmsServer_stopListening(MmsServer self);
 void
 MmsServer_destroy(MmsServer self);
 
+/***************************************************
+ * Functions for MMS server metrics
+ ***************************************************/
+
+/**
+ * \brief enable or disable the collection of metrics at runtime
+ *
+ * Metrics are enabled by default. When metrics are compiled out (CONFIG_MMS_SERVER_METRICS == 0)
+ * this function has no effect.
+ *
+ * \param self the MmsServer instance to operate on
+ * \param enable true to collect metrics, false otherwise
+ */
+void
+MmsServer_enableMetrics(MmsServer self, bool enable);
+
+/**
+ * \brief get a snapshot of the metrics of all connections since the server was created
+ *
+ * The counters are updated without locking. Every value of the snapshot is consistent by itself
+ * but the values can represent slightly different points in time.
+ *
+ * \param self the MmsServer instance to operate on
+ * \param snapshot the structure that receives the metrics
+ *
+ * \return true if metrics are available, false if they are compiled out
+ */
+bool
+MmsServer_getMetrics(MmsServer self, MmsServerMetrics* snapshot);
+
+/**
+ * \brief get a snapshot of the metrics of a single client connection
+ *
+ * \param self the connection to operate on
+ * \param snapshot the structure that receives the metrics
+ *
+ * \return true if metrics are available, false if they are compiled out
+ */
+bool
+MmsServerConnection_getMetrics(MmsServerConnection* self, MmsServerMetrics* snapshot);
+
+/**
+ * \brief get an estimate of a percentile of the processing time of a service
+ *
+ * \param self the metrics of a service (as contained in a snapshot)
+ * \param percentile the percentile (0 - 100), e.g. 99.9
+ *
+ * \return the upper limit (in ns) of the histogram bucket that contains the percentile, or 0 if the histogram is empty
+ */
+uint64_t
+MmsServiceMetrics_getLatencyPercentile(MmsServiceMetrics* self, double percentile);
+
+/**
+ * \brief get the largest value (in ns) counted by a bucket of the latency histograms
+ */
+uint64_t
+MmsServiceMetrics_getHistogramBucketLimit(int bucketIndex);
+
+/**
+ * \brief get the name of a service (for logging and diagnostics)
+ */
+const char*
+MmsServerService_getName(MmsServerService service);
+
 
 
 /***************************************************
@@ -93,6 +93,12 @@ mmsServer_createConfirmedErrorPdu(uint32_t invokeId, ByteBuffer* response, MmsEr
         asn_long2INTEGER(&mmsPdu->choice.confirmedErrorPDU.serviceError.errorClass.choice.access,
                         ServiceError__errorClass__file_filenonexistent);
 	}
+	else if (errorType == MMS_ERROR_FILE_POSITION_INVALID) {
+        mmsPdu->choice.confirmedErrorPDU.serviceError.errorClass.present =
+                        ServiceError__errorClass_PR_file;
+        asn_long2INTEGER(&mmsPdu->choice.confirmedErrorPDU.serviceError.errorClass.choice.access,
+                        ServiceError__errorClass__file_positioninvalid);
+	}
 	else if (errorType == MMS_ERROR_FILE_OTHER) {
         mmsPdu->choice.confirmedErrorPDU.serviceError.errorClass.present =
                         ServiceError__errorClass_PR_file;
@@ -199,4 +205,74 @@ mmsServer_deleteVariableList(LinkedList namedVariableLists, char* variableListNa
 	}
 }
 
+static int
+parseIdentifier(uint8_t* buffer, int bufPos, int maxBufPos, char* identifier, int maxLength)
+{
+    int length;
+
+    if ((bufPos >= maxBufPos) || (buffer[bufPos++] != 0x1a))
+        return -1;
+
+    bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, maxBufPos);
+
+    if ((bufPos < 0) || (length < 0) || (length > maxLength) || (bufPos + length > maxBufPos))
+        return -1;
+
+    memcpy(identifier, buffer + bufPos, length);
+    identifier[length] = 0;
+
+    return bufPos + length;
+}
+
+int
+mmsServer_parseObjectName(uint8_t* buffer, int bufPos, int maxBufPos, MmsObjectNameScope* scope,
+        char* domainId, char* itemId)
+{
+    int length;
+
+    if (bufPos >= maxBufPos)
+        return -1;
 
+    uint8_t tag = buffer[bufPos++];
+
+    bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, maxBufPos);
+
+    if ((bufPos < 0) || (length < 0) || (bufPos + length > maxBufPos))
+        return -1;
+
+    int endPos = bufPos + length;
+
+    switch (tag) {
+    case 0xa1: /* domain-specific */
+        bufPos = parseIdentifier(buffer, bufPos, endPos, domainId, 64);
+
+        if (bufPos < 0)
+            return -1;
+
+        if (parseIdentifier(buffer, bufPos, endPos, itemId, 129) < 0)
+            return -1;
+
+        *scope = MMS_OBJECT_NAME_DOMAIN_SPECIFIC;
+        break;
+
+    case 0x80: /* vmd-specific */
+    case 0x82: /* aa-specific */
+        if (length > 129)
+            return -1;
+
+        domainId[0] = 0;
+        memcpy(itemId, buffer + bufPos, length);
+        itemId[length] = 0;
+
+        if (tag == 0x80)
+            *scope = MMS_OBJECT_NAME_VMD_SPECIFIC;
+        else
+            *scope = MMS_OBJECT_NAME_AA_SPECIFIC;
+        break;
+
+    default:
+        return -1;
+    }
+
+    return endPos;
+}
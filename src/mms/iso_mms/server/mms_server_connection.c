@@ -31,6 +31,7 @@
 #include "iso_server.h"
 #include "ber_encoder.h"
 #include "ber_decode.h"
+#include "trace.h"
 
 /**********************************************************************************************
  * MMS Common support functions
@@ -77,13 +78,14 @@ mmsServer_writeMmsRejectPdu(uint32_t* invokeId, int reason, ByteBuffer* response
  * MMS General service handling functions
  *********************************************************************************************/
 
-static void
+static MmsServerService
 handleConfirmedRequestPdu(
 		MmsServerConnection* self,
 		uint8_t* buffer, int bufPos, int maxBufPos,
 		ByteBuffer* response)
 {
 	uint32_t invokeId = 0;
+	MmsServerService service = MMS_SERVER_SERVICE_OTHER;
 
 	while (bufPos < maxBufPos) {
 		uint8_t tag = buffer[bufPos++];
@@ -99,44 +101,53 @@ handleConfirmedRequestPdu(
 		bufPos = BerDecoder_decodeLength(buffer, &length, bufPos, maxBufPos);
 
 		if (bufPos < 0)  {
+			TRACE2(TRACE_MMS_SERVER_REJECT, tag, invokeId);
 			mmsServer_writeMmsRejectPdu(&invokeId, MMS_ERROR_REJECT_UNRECOGNIZED_SERVICE, response);
-			return;
+			return MMS_SERVER_SERVICE_OTHER;
 		}
 
-		if (DEBUG_MMS_SERVER) printf("tag %02x extended tag: %i size: %i\n", tag, extendedTag, length);
+		if (extendedTag || (tag != 0x02))
+			TRACE4(TRACE_MMS_SERVER_CONFIRMED_REQUEST, tag, extendedTag, invokeId, length);
 
 		if (extendedTag) {
 		    switch(tag) {
 
 #if (MMS_FILE_SERVICE == 1)
 		    case 0x48: /* file-open-request */
+		        service = MMS_SERVER_SERVICE_FILE_OPEN;
 		        mmsServer_handleFileOpenRequest(self, buffer, bufPos, bufPos + length, invokeId, response);
 		        break;
 
 		    case 0x49: /* file-read-request */
+		        service = MMS_SERVER_SERVICE_FILE_READ;
 		        mmsServer_handleFileReadRequest(self, buffer, bufPos, bufPos + length, invokeId, response);
 		        break;
 
 		    case 0x4a: /* file-close-request */
+		        service = MMS_SERVER_SERVICE_FILE_CLOSE;
 		        mmsServer_handleFileCloseRequest(self, buffer, bufPos, bufPos + length, invokeId, response);
 		        break;
 
 		    case 0x4b: /* file-rename-request */
+                service = MMS_SERVER_SERVICE_FILE_RENAME;
                 mmsServer_handleFileRenameRequest(self, buffer, bufPos, bufPos + length, invokeId, response);
                 break;
 
 		    case 0x4c: /* file-delete-request */
+		        service = MMS_SERVER_SERVICE_FILE_DELETE;
 		        mmsServer_handleFileDeleteRequest(self, buffer, bufPos, bufPos + length, invokeId, response);
 		        break;
 
 		    case 0x4d: /* file-directory-request */
+		        service = MMS_SERVER_SERVICE_FILE_DIRECTORY;
 		        mmsServer_handleFileDirectoryRequest(self, buffer, bufPos, bufPos + length, invokeId, response);
 		        break;
 #endif /* MMS_FILE_SERVICE == 1 */
 
             default:
+                TRACE2(TRACE_MMS_SERVER_REJECT, tag, invokeId);
                 mmsServer_writeMmsRejectPdu(&invokeId, MMS_ERROR_REJECT_UNRECOGNIZED_SERVICE, response);
-                return;
+                return MMS_SERVER_SERVICE_OTHER;
                 break;
 		    }
 		}
@@ -144,18 +155,19 @@ handleConfirmedRequestPdu(
             switch(tag) {
             case 0x02: /* invoke Id */
                 invokeId = BerDecoder_decodeUint32(buffer, length, bufPos);
-                if (DEBUG_MMS_SERVER) printf("invokeId: %i\n", invokeId);
                 self->lastInvokeId = invokeId;
                 break;
 
 #if (MMS_STATUS_SERVICE == 1)
             case 0x80: /* status-request */
+                service = MMS_SERVER_SERVICE_STATUS;
                 mmsServer_handleStatusRequest(self, buffer, bufPos, invokeId, response);
                 break;
 #endif /* MMS_STATUS_SERVICE == 1 */
 
 #if (MMS_GET_NAME_LIST == 1)
             case 0xa1: /* get-name-list-request */
+                service = MMS_SERVER_SERVICE_GET_NAME_LIST;
                 mmsServer_handleGetNameListRequest(self, buffer, bufPos, bufPos + length,
                         invokeId, response);
                 break;
@@ -163,17 +175,20 @@ handleConfirmedRequestPdu(
 
 #if (MMS_IDENTIFY_SERVICE == 1)
             case 0x82: /* identify */
+                service = MMS_SERVER_SERVICE_IDENTIFY;
                 mmsServer_handleIdentifyRequest(self, invokeId, response);
                 break;
 #endif /* MMS_IDENTIFY_SERVICE == 1 */
 
             case 0xa4: /* read-request */
+                service = MMS_SERVER_SERVICE_READ;
                 mmsServer_handleReadRequest(self, buffer, bufPos, bufPos + length,
                         invokeId, response);
                 break;
 
 #if (MMS_WRITE_SERVICE == 1)
             case 0xa5: /* write-request */
+                service = MMS_SERVER_SERVICE_WRITE;
                 mmsServer_handleWriteRequest(self, buffer, bufPos, bufPos + length,
                                 invokeId, response);
                 break;
@@ -181,6 +196,7 @@ handleConfirmedRequestPdu(
 
 #if (MMS_GET_VARIABLE_ACCESS_ATTRIBUTES == 1)
             case 0xa6: /* get-variable-access-attributes-request */
+                service = MMS_SERVER_SERVICE_GET_VARIABLE_ACCESS_ATTRIBUTES;
                 mmsServer_handleGetVariableAccessAttributesRequest(self,
                         buffer, bufPos, bufPos + length,
                         invokeId, response);
@@ -190,6 +206,7 @@ handleConfirmedRequestPdu(
 
 #if (MMS_DYNAMIC_DATA_SETS == 1)
             case 0xab: /* define-named-variable-list */
+                service = MMS_SERVER_SERVICE_DEFINE_NAMED_VARIABLE_LIST;
                 mmsServer_handleDefineNamedVariableListRequest(self,
                         buffer, bufPos, bufPos + length,
                         invokeId, response);
@@ -199,6 +216,7 @@ handleConfirmedRequestPdu(
 
 #if (MMS_GET_DATA_SET_ATTRIBUTES == 1)
             case 0xac: /* get-named-variable-list-attributes-request */
+                service = MMS_SERVER_SERVICE_GET_NAMED_VARIABLE_LIST_ATTRIBUTES;
                 mmsServer_handleGetNamedVariableListAttributesRequest(self,
                         buffer, bufPos, bufPos + length,
                         invokeId, response);
@@ -207,6 +225,7 @@ handleConfirmedRequestPdu(
 
 #if (MMS_DYNAMIC_DATA_SETS == 1)
             case 0xad: /* delete-named-variable-list-request */
+                service = MMS_SERVER_SERVICE_DELETE_NAMED_VARIABLE_LIST;
                 mmsServer_handleDeleteNamedVariableListRequest(self,
                         buffer, bufPos, bufPos + length,
                         invokeId, response);
@@ -214,25 +233,47 @@ handleConfirmedRequestPdu(
 #endif /* (MMS_DYNAMIC_DATA_SETS == 1) */
 
             default:
+                TRACE2(TRACE_MMS_SERVER_REJECT, tag, invokeId);
                 mmsServer_writeMmsRejectPdu(&invokeId, MMS_ERROR_REJECT_UNRECOGNIZED_SERVICE, response);
-                return;
+                return MMS_SERVER_SERVICE_OTHER;
                 break;
             }
 		}
 
 		bufPos += length;
 	}
+
+	return service;
 }
 
+#if (CONFIG_MMS_SERVER_METRICS == 1)
+static bool
+isErrorResponse(ByteBuffer* response)
+{
+	if (response->size < 1)
+		return false;
+
+	/* confirmed-ErrorPDU, rejectPDU, initiate-ErrorPDU */
+	return ((response->buffer[0] == 0xa2) || (response->buffer[0] == 0xa4) || (response->buffer[0] == 0xaa));
+}
+#endif /* (CONFIG_MMS_SERVER_METRICS == 1) */
+
 MmsIndication
 MmsServerConnection_parseMessage(MmsServerConnection* self, ByteBuffer* message, ByteBuffer* response)
 {
 	MmsIndication retVal;
+	MmsServerService service = MMS_SERVER_SERVICE_OTHER;
+
+#if (CONFIG_MMS_SERVER_METRICS == 1)
+	uint64_t startTime = mmsServer_getMetricsTimestamp(self->server);
+#endif
 
 	uint8_t* buffer = message->buffer;
 
-	if (message->size < 2)
-		return MMS_ERROR;
+	if (message->size < 2) {
+		retVal = MMS_ERROR;
+		goto exit_function;
+	}
 
 	int bufPos = 0;
 
@@ -241,22 +282,25 @@ MmsServerConnection_parseMessage(MmsServerConnection* self, ByteBuffer* message,
 
 	bufPos = BerDecoder_decodeLength(buffer, &pduLength, bufPos, message->size);
 
-	if (bufPos < 0)
-		return MMS_ERROR;
+	if (bufPos < 0) {
+		retVal = MMS_ERROR;
+		goto exit_function;
+	}
 
-	if (DEBUG_MMS_SERVER)
-	    printf("mms_server: recvd MMS-PDU type: %02x size: %i\n", pduType, pduLength);
+	TRACE2(TRACE_MMS_SERVER_PDU_RECEIVED, pduType, pduLength);
 
 	switch (pduType) {
 	case 0xa8: /* Initiate request PDU */
+		service = MMS_SERVER_SERVICE_INITIATE;
 		mmsServer_handleInitiateRequest(self, buffer, bufPos, bufPos + pduLength, response);
 		retVal = MMS_INITIATE;
 		break;
 	case 0xa0: /* Confirmed request PDU */
-		handleConfirmedRequestPdu(self, buffer, bufPos, bufPos + pduLength, response);
+		service = handleConfirmedRequestPdu(self, buffer, bufPos, bufPos + pduLength, response);
 		retVal = MMS_CONFIRMED_REQUEST;
 		break;
 	case 0x8b: /* Conclude request PDU */
+		service = MMS_SERVER_SERVICE_CONCLUDE;
 		mmsServer_writeConcludeResponsePdu(response);
 		retVal = MMS_CONCLUDE;
 		break;
@@ -270,6 +314,14 @@ MmsServerConnection_parseMessage(MmsServerConnection* self, ByteBuffer* message,
 		break;
 	}
 
+exit_function:
+
+#if (CONFIG_MMS_SERVER_METRICS == 1)
+	mmsServer_recordRequest(self, service, message->size, response->size,
+			(retVal == MMS_ERROR) || isErrorResponse(response),
+			IsoConnection_getMessageReceivedTime(self->isoConnection), startTime);
+#endif
+
 	return retVal;
 }
 
@@ -302,6 +354,11 @@ MmsServerConnection_init(MmsServerConnection* connection, MmsServer server, IsoC
 	self->server = server;
 	self->isoConnection = isoCon;
 	self->namedVariableLists = LinkedList_create();
+	self->sendBufferPool = MmsBufferPool_create(self->maxPduSize);
+
+#if (CONFIG_MMS_SERVER_METRICS == 1)
+	mmsServer_addConnectionMetrics(self);
+#endif
 
 	IsoConnection_installListener(isoCon, messageReceived, (void*) self);
 
@@ -320,6 +377,21 @@ MmsServerConnection_destroy(MmsServerConnection* self)
             FileSystem_closeFile(self->frsms[frsmIndex].fileHandle);
 #endif
 
+	if (DEBUG_MMS_SERVER) {
+	    MmsBufferPoolStatistics statistics;
+
+	    MmsBufferPool_getStatistics(self->sendBufferPool, &statistics);
+
+	    printf("MMS_SERVER: send buffer pool: %u hits, %u misses, peak usage %i\n",
+	            statistics.hits, statistics.misses, statistics.peakBuffersInUse);
+	}
+
+	MmsBufferPool_destroy(self->sendBufferPool);
+
+#if (CONFIG_MMS_SERVER_METRICS == 1)
+	mmsServer_removeConnectionMetrics(self);
+#endif
+
 	LinkedList_destroyDeep(self->namedVariableLists, (LinkedListValueDeleteFunction) MmsNamedVariableList_destroy);
 	free(self);
 }
@@ -374,6 +446,12 @@ MmsServerConnection_getNamedVariableLists(MmsServerConnection* self)
 	return self->namedVariableLists;
 }
 
+void
+MmsServerConnection_getBufferPoolStatistics(MmsServerConnection* self, MmsBufferPoolStatistics* statistics)
+{
+	MmsBufferPool_getStatistics(self->sendBufferPool, statistics);
+}
+
 uint32_t
 MmsServerConnection_getLastInvokeId(MmsServerConnection* self)
 {
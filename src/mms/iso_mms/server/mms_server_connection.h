@@ -37,6 +37,7 @@
 #include "iso_server.h"
 #include "linked_list.h"
 #include "byte_buffer.h"
+#include "mms_buffer_pool.h"
 
 MmsServerConnection*
 MmsServerConnection_init(MmsServerConnection* connection, MmsServer server, IsoConnection isoCon);
@@ -75,11 +76,13 @@ MmsServerConnection_sendInformationReportSingleVariableVMDSpecific(MmsServerConn
 
 /** \brief send information report for a VMD specific named variable list
  *
- *   \param handlerMode send this message in the context of a stack callback handler
+ *   The report is added to the send queue of the connection.
+ *
+ *   \param messageType defines if the report can be dropped when the send queue is full
  */
 void /* send information report for a VMD specific named variable list */
 MmsServerConnection_sendInformationReportVMDSpecific(MmsServerConnection* self, char* itemId, LinkedList values
-        , bool handlerMode);
+        , IsoMessageType messageType);
 
 /** \brief send information report for list of variables
  *
@@ -96,6 +99,12 @@ MmsServerConnection_sendInformationReportListOfVariables(
 void
 MmsServerConnection_sendWriteResponse(MmsServerConnection* self, uint32_t invokeId, MmsDataAccessError indication);
 
+/** \brief get the usage counters of the buffer pool for information reports and other unsolicited PDUs
+ *
+ *   \param statistics the structure that receives the counters
+ */
+void
+MmsServerConnection_getBufferPoolStatistics(MmsServerConnection* self, MmsBufferPoolStatistics* statistics);
 
 uint32_t
 MmsServerConnection_getLastInvokeId(MmsServerConnection* self);
@@ -57,6 +57,10 @@
 #define MMS_FILE_SERVICE 1
 #endif
 
+#ifndef CONFIG_MMS_SERVER_METRICS
+#define CONFIG_MMS_SERVER_METRICS 1
+#endif
+
 struct sMmsServer {
     IsoServer isoServer;
     MmsDevice* device;
@@ -75,6 +79,10 @@ struct sMmsServer {
     bool isLocked;
     Semaphore modelMutex;
 
+#if (MMS_FILE_SERVICE == 1)
+    LinkedList fileDirectorySnapshots;
+#endif
+
 #if MMS_STATUS_SERVICE == 1
     int vmdLogicalStatus;
     int vmdPhysicalStatus;
@@ -87,6 +95,13 @@ struct sMmsServer {
     char* modelName;
     char* revision;
 #endif /* MMS_IDENTIFY_SERVICE == 1 */
+
+#if (CONFIG_MMS_SERVER_METRICS == 1)
+    MmsServerMetrics* metrics; /* accumulated metrics of the closed connections */
+    bool metricsEnabled;
+    Semaphore metricsLock;
+    LinkedList metricsConnections; /* open connections (MmsServerConnection*) */
+#endif
 };
 
 /* write_out function required for ASN.1 encoding */
@@ -224,6 +239,88 @@ mmsServer_getNumberOfElements(AlternateAccess_t* alternateAccess);
 void
 mmsServer_deleteVariableList(LinkedList namedVariableLists, char* variableListName);
 
+typedef enum {
+    MMS_OBJECT_NAME_VMD_SPECIFIC = 0,
+    MMS_OBJECT_NAME_DOMAIN_SPECIFIC = 1,
+    MMS_OBJECT_NAME_AA_SPECIFIC = 2
+} MmsObjectNameScope;
+
+/**
+ * \brief Parse an ObjectName (including tag and length) from a BER encoded request
+ *
+ * \param domainId buffer for the domain name (at least 65 bytes). Empty for vmd- and aa-specific names.
+ * \param itemId buffer for the item name (at least 130 bytes)
+ *
+ * \return the buffer position after the ObjectName or -1 in case of a parsing error
+ */
+int
+mmsServer_parseObjectName(uint8_t* buffer, int bufPos, int maxBufPos, MmsObjectNameScope* scope,
+        char* domainId, char* itemId);
+
+#if (MMS_FILE_SERVICE == 1)
+void
+mmsServer_destroyFileDirectorySnapshots(MmsServer self);
+#endif
+
+#if (CONFIG_MMS_SERVER_METRICS == 1)
+
+void
+mmsServer_initMetrics(MmsServer self);
+
+void
+mmsServer_destroyMetrics(MmsServer self);
+
+void
+mmsServer_addConnectionMetrics(MmsServerConnection* self);
+
+/* adds the metrics of a closed connection to the server metrics */
+void
+mmsServer_removeConnectionMetrics(MmsServerConnection* self);
+
+/**
+ * \brief get the start time of a measurement
+ *
+ * \return the current time of the monotonic clock or 0 when metrics are disabled
+ */
+uint64_t
+mmsServer_getMetricsTimestamp(MmsServer self);
+
+/**
+ * \brief add a handled request to the metrics of the connection
+ *
+ * \param receptionTime time when the request was received or 0 if unknown
+ * \param startTime start time of the processing (as returned by mmsServer_getMetricsTimestamp)
+ */
+void
+mmsServer_recordRequest(MmsServerConnection* self, MmsServerService service, int bytesIn, int bytesOut,
+        bool error, uint64_t receptionTime, uint64_t startTime);
+
+/**
+ * \brief add a sent information report to the metrics of the connection
+ *
+ * \param startTime start time of the report encoding (as returned by mmsServer_getMetricsTimestamp)
+ */
+void
+mmsServer_recordInformationReport(MmsServerConnection* self, int bytesOut, uint64_t startTime);
+
+#endif /* (CONFIG_MMS_SERVER_METRICS == 1) */
+
+/**
+ * \brief Get the names of all named variables of the domain (including sub elements) in model order
+ *
+ * The name index is created with the first call. Has to be called with the model lock.
+ */
+char**
+MmsDomain_getVariableNames(MmsDomain* self, int* nameCount);
+
+/**
+ * \brief Get the position of a variable name in the list returned by MmsDomain_getVariableNames
+ *
+ * \return the position or -1 if the name does not exist
+ */
+int
+MmsDomain_getVariableNamePosition(MmsDomain* self, char* name);
+
 MmsDataAccessError
 mmsServer_setValue(MmsServer self, MmsDomain* domain, char* itemId, MmsValue* value,
         MmsServerConnection* connection);
@@ -0,0 +1,340 @@
+/*
+ *  mms_server_metrics.c
+ *
+ *  Copyright 2013 Michael Zillgith
+ *
+ *	This file is part of libIEC61850.
+ *
+ *	libIEC61850 is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	libIEC61850 is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with libIEC61850.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *	See COPYING file for the complete license text.
+ */
+
+#include "libiec61850_platform_includes.h"
+#include "mms_server_internal.h"
+#include "hal.h"
+
+#if (CONFIG_MMS_SERVER_METRICS == 1)
+#include "atomic_operations.h"
+#endif
+
+/* each power of two is split into 2^SUB_BUCKET_BITS buckets */
+#define SUB_BUCKET_BITS 2
+#define SUB_BUCKETS (1 << SUB_BUCKET_BITS)
+
+static const char* serviceNames[] = {
+    "initiate",
+    "conclude",
+    "status",
+    "getNameList",
+    "identify",
+    "read",
+    "write",
+    "getVariableAccessAttributes",
+    "defineNamedVariableList",
+    "getNamedVariableListAttributes",
+    "deleteNamedVariableList",
+    "fileOpen",
+    "fileRead",
+    "fileClose",
+    "fileRename",
+    "fileDelete",
+    "fileDirectory",
+    "other",
+    "informationReport"
+};
+
+const char*
+MmsServerService_getName(MmsServerService service)
+{
+    if (((int) service < 0) || (service >= MMS_SERVER_SERVICE_COUNT))
+        return "unknown";
+
+    return serviceNames[service];
+}
+
+uint64_t
+MmsServiceMetrics_getHistogramBucketLimit(int bucketIndex)
+{
+    if (bucketIndex < SUB_BUCKETS)
+        return (uint64_t) bucketIndex;
+
+    int exponent = (bucketIndex >> SUB_BUCKET_BITS) + 1;
+    int subBucket = bucketIndex & (SUB_BUCKETS - 1);
+
+    uint64_t lowerLimit = ((uint64_t) (SUB_BUCKETS + subBucket)) << (exponent - SUB_BUCKET_BITS);
+
+    return lowerLimit + (((uint64_t) 1) << (exponent - SUB_BUCKET_BITS)) - 1;
+}
+
+uint64_t
+MmsServiceMetrics_getLatencyPercentile(MmsServiceMetrics* self, double percentile)
+{
+    uint64_t count = 0;
+
+    int i;
+
+    for (i = 0; i < MMS_SERVER_METRICS_HISTOGRAM_SIZE; i++)
+        count += self->latencyHistogram[i];
+
+    if (count == 0)
+        return 0;
+
+    double exactRank = (percentile * count) / 100.0;
+
+    uint64_t rank = (uint64_t) exactRank;
+
+    if ((rank < exactRank) || (rank < 1))
+        rank++;
+
+    uint64_t accumulated = 0;
+
+    for (i = 0; i < MMS_SERVER_METRICS_HISTOGRAM_SIZE; i++) {
+        accumulated += self->latencyHistogram[i];
+
+        if (accumulated >= rank)
+            break;
+    }
+
+    if (i == MMS_SERVER_METRICS_HISTOGRAM_SIZE)
+        i--;
+
+    return MmsServiceMetrics_getHistogramBucketLimit(i);
+}
+
+#if (CONFIG_MMS_SERVER_METRICS == 1)
+
+static int
+getHistogramBucket(uint64_t value)
+{
+    if (value < SUB_BUCKETS)
+        return (int) value;
+
+    int exponent;
+
+#if defined(__GNUC__)
+    exponent = 63 - __builtin_clzll(value);
+#else
+    exponent = SUB_BUCKET_BITS;
+
+    while ((value >> (exponent + 1)) != 0)
+        exponent++;
+#endif
+
+    int bucket = ((exponent - 1) << SUB_BUCKET_BITS) +
+            (int) ((value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1));
+
+    if (bucket >= MMS_SERVER_METRICS_HISTOGRAM_SIZE)
+        bucket = MMS_SERVER_METRICS_HISTOGRAM_SIZE - 1;
+
+    return bucket;
+}
+
+static void
+addSample(MmsServiceMetrics* metrics, int bucket, int bytesIn, int bytesOut, bool error,
+        uint64_t queueingDelay, uint64_t processingTime)
+{
+    Atomic_add64(&(metrics->requests), 1);
+
+    if (error)
+        Atomic_add64(&(metrics->errors), 1);
+
+    if (bytesIn > 0)
+        Atomic_add64(&(metrics->bytesIn), (uint64_t) bytesIn);
+
+    if (bytesOut > 0)
+        Atomic_add64(&(metrics->bytesOut), (uint64_t) bytesOut);
+
+    if (queueingDelay > 0)
+        Atomic_add64(&(metrics->queueingDelay), queueingDelay);
+
+    Atomic_add64(&(metrics->processingTime), processingTime);
+
+    Atomic_add32(&(metrics->latencyHistogram[bucket]), 1);
+}
+
+static void
+recordSample(MmsServerConnection* self, MmsServerService service, int bytesIn, int bytesOut, bool error,
+        uint64_t queueingDelay, uint64_t processingTime)
+{
+    /* only the counters of the connection are updated here. The server counters are computed
+     * when a snapshot is taken. So connections don't compete for the same cache lines. */
+    addSample(&(self->metrics->services[service]), getHistogramBucket(processingTime), bytesIn, bytesOut, error,
+            queueingDelay, processingTime);
+}
+
+uint64_t
+mmsServer_getMetricsTimestamp(MmsServer self)
+{
+    if (self->metricsEnabled)
+        return Hal_getMonotonicTimeInNs();
+    else
+        return 0;
+}
+
+void
+mmsServer_recordRequest(MmsServerConnection* self, MmsServerService service, int bytesIn, int bytesOut,
+        bool error, uint64_t receptionTime, uint64_t startTime)
+{
+    if (startTime == 0)
+        return;
+
+    uint64_t endTime = Hal_getMonotonicTimeInNs();
+
+    uint64_t queueingDelay = 0;
+
+    if ((receptionTime != 0) && (receptionTime < startTime))
+        queueingDelay = startTime - receptionTime;
+
+    recordSample(self, service, bytesIn, bytesOut, error, queueingDelay, endTime - startTime);
+}
+
+void
+mmsServer_recordInformationReport(MmsServerConnection* self, int bytesOut, uint64_t startTime)
+{
+    if (startTime == 0)
+        return;
+
+    uint64_t endTime = Hal_getMonotonicTimeInNs();
+
+    recordSample(self, MMS_SERVER_SERVICE_INFORMATION_REPORT, 0, bytesOut, false, 0, endTime - startTime);
+}
+
+/* add the counters of metrics to the counters of the snapshot */
+static void
+accumulateMetrics(MmsServerMetrics* metrics, MmsServerMetrics* snapshot)
+{
+    int serviceIndex;
+
+    for (serviceIndex = 0; serviceIndex < MMS_SERVER_SERVICE_COUNT; serviceIndex++) {
+        MmsServiceMetrics* source = &(metrics->services[serviceIndex]);
+        MmsServiceMetrics* destination = &(snapshot->services[serviceIndex]);
+
+        uint64_t requests = Atomic_load64(&(source->requests));
+
+        if (requests == 0)
+            continue;
+
+        destination->requests += requests;
+        destination->errors += Atomic_load64(&(source->errors));
+        destination->bytesIn += Atomic_load64(&(source->bytesIn));
+        destination->bytesOut += Atomic_load64(&(source->bytesOut));
+        destination->queueingDelay += Atomic_load64(&(source->queueingDelay));
+        destination->processingTime += Atomic_load64(&(source->processingTime));
+
+        int i;
+
+        for (i = 0; i < MMS_SERVER_METRICS_HISTOGRAM_SIZE; i++)
+            destination->latencyHistogram[i] +=
+                    (uint32_t) Atomic_load32((volatile int32_t*) &(source->latencyHistogram[i]));
+    }
+}
+
+void
+mmsServer_initMetrics(MmsServer self)
+{
+    self->metrics = (MmsServerMetrics*) calloc(1, sizeof(MmsServerMetrics));
+    self->metricsEnabled = true;
+    self->metricsLock = Semaphore_create(1);
+    self->metricsConnections = LinkedList_create();
+}
+
+void
+mmsServer_destroyMetrics(MmsServer self)
+{
+    LinkedList_destroyStatic(self->metricsConnections);
+    Semaphore_destroy(self->metricsLock);
+    free(self->metrics);
+}
+
+void
+mmsServer_addConnectionMetrics(MmsServerConnection* self)
+{
+    MmsServer server = self->server;
+
+    self->metrics = (MmsServerMetrics*) calloc(1, sizeof(MmsServerMetrics));
+
+    Semaphore_wait(server->metricsLock);
+    LinkedList_add(server->metricsConnections, self);
+    Semaphore_post(server->metricsLock);
+}
+
+void
+mmsServer_removeConnectionMetrics(MmsServerConnection* self)
+{
+    MmsServer server = self->server;
+
+    Semaphore_wait(server->metricsLock);
+
+    LinkedList_remove(server->metricsConnections, self);
+
+    /* keep the counters of the closed connection in the server metrics */
+    accumulateMetrics(self->metrics, server->metrics);
+
+    Semaphore_post(server->metricsLock);
+
+    free(self->metrics);
+}
+
+#endif /* (CONFIG_MMS_SERVER_METRICS == 1) */
+
+void
+MmsServer_enableMetrics(MmsServer self, bool enable)
+{
+#if (CONFIG_MMS_SERVER_METRICS == 1)
+    self->metricsEnabled = enable;
+#endif
+}
+
+bool
+MmsServer_getMetrics(MmsServer self, MmsServerMetrics* snapshot)
+{
+#if (CONFIG_MMS_SERVER_METRICS == 1)
+    memset(snapshot, 0, sizeof(MmsServerMetrics));
+
+    Semaphore_wait(self->metricsLock);
+
+    accumulateMetrics(self->metrics, snapshot);
+
+    LinkedList element = LinkedList_getNext(self->metricsConnections);
+
+    while (element != NULL) {
+        MmsServerConnection* connection = (MmsServerConnection*) element->data;
+
+        accumulateMetrics(connection->metrics, snapshot);
+
+        element = LinkedList_getNext(element);
+    }
+
+    Semaphore_post(self->metricsLock);
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool
+MmsServerConnection_getMetrics(MmsServerConnection* self, MmsServerMetrics* snapshot)
+{
+#if (CONFIG_MMS_SERVER_METRICS == 1)
+    memset(snapshot, 0, sizeof(MmsServerMetrics));
+
+    accumulateMetrics(self->metrics, snapshot);
+
+    return true;
+#else
+    return false;
+#endif
+}
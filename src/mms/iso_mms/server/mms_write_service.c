@@ -74,13 +74,14 @@ mmsServer_createMmsWriteResponse(MmsServerConnection* connection,
 void
 MmsServerConnection_sendWriteResponse(MmsServerConnection* self, uint32_t invokeId, MmsDataAccessError indication)
 {
-    ByteBuffer* response = ByteBuffer_create(NULL, self->maxPduSize);
+    /* a write response for a single item is always smaller than 32 byte */
+    ByteBuffer* response = MmsBufferPool_getBuffer(self->sendBufferPool, 32);
 
     mmsServer_createMmsWriteResponse(self, invokeId, response, 1, &indication);
 
     IsoConnection_sendMessage(self->isoConnection, response, false);
 
-    ByteBuffer_destroy(response);
+    MmsBufferPool_releaseBuffer(self->sendBufferPool, response);
 }
 
 void
@@ -33,6 +33,8 @@
 #include "iso_server.h"
 #include "socket.h"
 #include "thread.h"
+#include "hal.h"
+#include "trace.h"
 
 #include "iso_server_private.h"
 
@@ -50,6 +52,28 @@
 #define ISO_CON_STATE_RUNNING 1
 #define ISO_CON_STATE_STOPPED 0
 
+#ifndef CONFIG_ISO_SERVER_SEND_QUEUE_SIZE
+#define CONFIG_ISO_SERVER_SEND_QUEUE_SIZE 16
+#endif
+
+#ifndef CONFIG_MMS_SERVER_METRICS
+#define CONFIG_MMS_SERVER_METRICS 1
+#endif
+
+#if (CONFIG_ISO_SERVER_SEND_QUEUE_SIZE > 0)
+
+typedef struct sSendQueueEntry* SendQueueEntry;
+
+struct sSendQueueEntry {
+    SendQueueEntry next;
+    IsoMessageType messageType;
+    int size;
+    int maxSize;
+    uint8_t* buffer;
+};
+
+#endif /* (CONFIG_ISO_SERVER_SEND_QUEUE_SIZE > 0) */
+
 struct sIsoConnection
 {
     uint8_t* receiveBuffer;
@@ -66,10 +90,248 @@ struct sIsoConnection
     Thread thread;
     Semaphore conMutex;
 
+#if (CONFIG_ISO_SERVER_SEND_QUEUE_SIZE > 0)
+    Thread sendThread;
+    bool sendThreadRunning;
+    Semaphore sendQueueLock;
+    Semaphore sendQueueSignal; /* counts the messages added to the queue */
+    SendQueueEntry sendQueueHead;
+    SendQueueEntry sendQueueTail;
+    SendQueueEntry freeEntries;
+    int freeEntryCount;
+    uint64_t writeStartTime; /* start time of the pending write or 0 */
+    IsoSendQueueStatistics sendQueueStatistics;
+#endif
 
     void* securityToken;
+
+    uint64_t messageReceivedTime; /* monotonic time of the last data indication (for MMS server metrics) */
 };
 
+static void
+sendPayload(IsoConnection self, uint8_t* payload, int payloadSize);
+
+#if (CONFIG_ISO_SERVER_SEND_QUEUE_SIZE > 0)
+
+static void
+releaseSendQueueEntry(IsoConnection self, SendQueueEntry entry)
+{
+    if (self->freeEntryCount < CONFIG_ISO_SERVER_SEND_QUEUE_SIZE) {
+        entry->next = self->freeEntries;
+        self->freeEntries = entry;
+        self->freeEntryCount++;
+    }
+    else {
+        free(entry->buffer);
+        free(entry);
+    }
+}
+
+static SendQueueEntry
+getSendQueueEntry(IsoConnection self, int size)
+{
+    SendQueueEntry entry = self->freeEntries;
+
+    if (entry != NULL) {
+        self->freeEntries = entry->next;
+        self->freeEntryCount--;
+
+        if (entry->maxSize < size) {
+            free(entry->buffer);
+            entry->buffer = (uint8_t*) malloc(size);
+            entry->maxSize = size;
+        }
+    }
+    else {
+        entry = (SendQueueEntry) malloc(sizeof(struct sSendQueueEntry));
+        entry->buffer = (uint8_t*) malloc(size);
+        entry->maxSize = size;
+    }
+
+    entry->next = NULL;
+
+    return entry;
+}
+
+/* only unbuffered reports are dropped - buffered reports stay in the report buffer until they are sent */
+static bool
+isDroppable(IsoMessageType messageType)
+{
+    return (messageType == ISO_MESSAGE_UNBUFFERED);
+}
+
+/* has to be called with sendQueueLock */
+static bool
+hasDroppableMessage(IsoConnection self)
+{
+    SendQueueEntry entry = self->sendQueueHead;
+
+    while (entry != NULL) {
+        if (isDroppable(entry->messageType))
+            return true;
+
+        entry = entry->next;
+    }
+
+    return false;
+}
+
+/* remove the oldest message from the queue that can be dropped - has to be called with sendQueueLock */
+static bool
+dropOldestMessage(IsoConnection self)
+{
+    SendQueueEntry previous = NULL;
+    SendQueueEntry entry = self->sendQueueHead;
+
+    while (entry != NULL) {
+        if (isDroppable(entry->messageType)) {
+
+            if (previous == NULL)
+                self->sendQueueHead = entry->next;
+            else
+                previous->next = entry->next;
+
+            if (self->sendQueueTail == entry)
+                self->sendQueueTail = previous;
+
+            TRACE2(TRACE_SEND_QUEUE_DROP_OLDEST, TRACE_ID(self), entry->messageType);
+
+            releaseSendQueueEntry(self, entry);
+
+            self->sendQueueStatistics.queuedMessages--;
+            self->sendQueueStatistics.droppedMessages++;
+
+            return true;
+        }
+
+        previous = entry;
+        entry = entry->next;
+    }
+
+    return false;
+}
+
+static void
+handleSendQueue(IsoConnection self)
+{
+    while (true) {
+        Semaphore_wait(self->sendQueueSignal);
+
+        Semaphore_wait(self->sendQueueLock);
+
+        if (self->sendThreadRunning == false) {
+            Semaphore_post(self->sendQueueLock);
+            break;
+        }
+
+        /* signals of dropped messages find no entry */
+        SendQueueEntry entry = self->sendQueueHead;
+
+        if (entry != NULL) {
+            self->sendQueueHead = entry->next;
+
+            if (self->sendQueueHead == NULL)
+                self->sendQueueTail = NULL;
+
+            self->sendQueueStatistics.queuedMessages--;
+        }
+
+        Semaphore_post(self->sendQueueLock);
+
+        if (entry == NULL)
+            continue;
+
+        Semaphore_wait(self->conMutex);
+
+        if (self->state == ISO_CON_STATE_RUNNING) {
+            uint64_t startTime = Hal_getTimeInMs();
+
+            Semaphore_wait(self->sendQueueLock);
+            self->writeStartTime = startTime;
+            Semaphore_post(self->sendQueueLock);
+
+            sendPayload(self, entry->buffer, entry->size);
+
+            uint64_t writeTime = Hal_getTimeInMs() - startTime;
+
+            Semaphore_wait(self->sendQueueLock);
+            self->writeStartTime = 0;
+            self->sendQueueStatistics.totalStallTime += writeTime;
+            Semaphore_post(self->sendQueueLock);
+
+            if (writeTime > 0)
+                TRACE2(TRACE_SEND_QUEUE_WRITE_BLOCKED, TRACE_ID(self), writeTime);
+        }
+
+        Semaphore_post(self->conMutex);
+
+        Semaphore_wait(self->sendQueueLock);
+        releaseSendQueueEntry(self, entry);
+        Semaphore_post(self->sendQueueLock);
+    }
+}
+
+static void
+startSendQueue(IsoConnection self)
+{
+    self->sendQueueLock = Semaphore_create(1);
+    self->sendQueueSignal = Semaphore_create(0);
+    self->sendThreadRunning = true;
+
+    self->sendThread = Thread_create((ThreadExecutionFunction) handleSendQueue, self, false);
+
+    Thread_start(self->sendThread);
+}
+
+/* stop the writer thread - the semaphores stay valid until destroySendQueue is called */
+static void
+stopSendQueue(IsoConnection self)
+{
+    Semaphore_wait(self->sendQueueLock);
+    self->sendThreadRunning = false;
+    Semaphore_post(self->sendQueueLock);
+
+    Semaphore_post(self->sendQueueSignal);
+
+    /* unblock a pending write */
+    if (self->socket != NULL)
+        Socket_shutdown(self->socket);
+
+    Thread_destroy(self->sendThread);
+
+    Semaphore_wait(self->sendQueueLock);
+
+    while (self->sendQueueHead != NULL) {
+        SendQueueEntry entry = self->sendQueueHead;
+        self->sendQueueHead = entry->next;
+
+        releaseSendQueueEntry(self, entry);
+    }
+
+    self->sendQueueTail = NULL;
+    self->sendQueueStatistics.queuedMessages = 0;
+
+    Semaphore_post(self->sendQueueLock);
+}
+
+/* has to be called after the connection has been removed from the server (no more users of the queue) */
+static void
+destroySendQueue(IsoConnection self)
+{
+    while (self->freeEntries != NULL) {
+        SendQueueEntry entry = self->freeEntries;
+        self->freeEntries = entry->next;
+
+        free(entry->buffer);
+        free(entry);
+    }
+
+    Semaphore_destroy(self->sendQueueSignal);
+    Semaphore_destroy(self->sendQueueLock);
+}
+
+#endif /* (CONFIG_ISO_SERVER_SEND_QUEUE_SIZE > 0) */
+
 static void
 handleTcpConnection(IsoConnection self)
 {
@@ -122,11 +384,14 @@ handleTcpConnection(IsoConnection self)
             break;
         case DATA_INDICATION:
             {
-                if (DEBUG_ISO_SERVER)
-                    printf("ISO_SERVER: COTP data indication\n");
+#if (CONFIG_MMS_SERVER_METRICS == 1)
+                self->messageReceivedTime = Hal_getMonotonicTimeInNs();
+#endif
 
                 ByteBuffer* cotpPayload = CotpConnection_getPayload(self->cotpConnection);
 
+                TRACE2(TRACE_ISO_SERVER_DATA_INDICATION, TRACE_ID(self), cotpPayload->size);
+
                 sIndication = IsoSession_parseMessage(self->session, cotpPayload);
 
                 ByteBuffer* sessionUserData = IsoSession_getUserData(self->session);
@@ -219,20 +484,13 @@ handleTcpConnection(IsoConnection self)
                     }
                     break;
                 case SESSION_DATA:
-                    if (DEBUG_ISO_SERVER)
-                        printf("ISO_SERVER: iso_connection: session data indication\n");
-
                     if (!IsoPresentation_parseUserData(self->presentation, sessionUserData)) {
-                        if (DEBUG_ISO_SERVER)
-                            printf("ISO_SERVER: cotp_server: presentation error\n");
+                        TRACE1(TRACE_ISO_SERVER_PRESENTATION_ERROR, TRACE_ID(self));
                         self->state = ISO_CON_STATE_STOPPED;
                         break;
                     }
 
                     if (self->presentation->nextContextId == self->presentation->mmsContextId) {
-                        if (DEBUG_ISO_SERVER)
-                            printf("ISO_SERVER: iso_connection: mms message\n");
-
                         ByteBuffer* mmsRequest = &(self->presentation->nextPayload);
 
                         ByteBuffer mmsResponseBuffer;
@@ -245,6 +503,8 @@ handleTcpConnection(IsoConnection self)
                         self->msgRcvdHandler(self->msgRcvdHandlerParameter,
                                 mmsRequest, &mmsResponseBuffer);
 
+                        TRACE3(TRACE_ISO_SERVER_MMS_MESSAGE, TRACE_ID(self), mmsRequest->size, mmsResponseBuffer.size);
+
                         if (mmsResponseBuffer.size > 0) {
 
 
@@ -276,8 +536,7 @@ handleTcpConnection(IsoConnection self)
                         IsoServer_userUnlock(self->isoServer);
                     }
                     else {
-                        if (DEBUG_ISO_SERVER)
-                            printf("ISO_SERVER: iso_connection: unknown presentation layer context!");
+                        TRACE2(TRACE_ISO_SERVER_UNKNOWN_CONTEXT, TRACE_ID(self), self->presentation->nextContextId);
                     }
 
                     break;
@@ -345,6 +604,10 @@ handleTcpConnection(IsoConnection self)
         }
     }
 
+#if (CONFIG_ISO_SERVER_SEND_QUEUE_SIZE > 0)
+    stopSendQueue(self);
+#endif
+
     IsoServer_closeConnection(self->isoServer, self);
 
     if (self->socket != NULL)
@@ -360,6 +623,10 @@ handleTcpConnection(IsoConnection self)
 
     Semaphore_destroy(self->conMutex);
 
+#if (CONFIG_ISO_SERVER_SEND_QUEUE_SIZE > 0)
+    destroySendQueue(self);
+#endif
+
     free(self->receiveBuffer);
     free(self->sendBuffer);
     free(self->clientAddress);
@@ -390,6 +657,10 @@ IsoConnection_create(Socket socket, IsoServer isoServer)
     self->thread = Thread_create((ThreadExecutionFunction) handleTcpConnection, self, true);
     self->conMutex = Semaphore_create(1);
 
+#if (CONFIG_ISO_SERVER_SEND_QUEUE_SIZE > 0)
+    startSendQueue(self);
+#endif
+
     Thread_start(self->thread);
 
     if (DEBUG_ISO_SERVER)
@@ -404,24 +675,15 @@ IsoConnection_getPeerAddress(IsoConnection self)
     return self->clientAddress;
 }
 
-void
-IsoConnection_sendMessage(IsoConnection self, ByteBuffer* message, bool handlerMode)
+static void
+sendPayload(IsoConnection self, uint8_t* payload, int payloadSize)
 {
-    if (self->state == ISO_CON_STATE_STOPPED) {
-        if (DEBUG_ISO_SERVER)
-            printf("DEBUG_ISO_SERVER: sendMessage: connection already stopped!\n");
-        return;
-    }
-
-    if (!handlerMode)
-        Semaphore_wait(self->conMutex);
-
     struct sBufferChain payloadBufferStruct;
     BufferChain payloadBuffer = &payloadBufferStruct;
-    payloadBuffer->length = message->size;
-    payloadBuffer->partLength = message->size;
-    payloadBuffer->partMaxLength = message->size;
-    payloadBuffer->buffer = message->buffer;
+    payloadBuffer->length = payloadSize;
+    payloadBuffer->partLength = payloadSize;
+    payloadBuffer->partMaxLength = payloadSize;
+    payloadBuffer->buffer = payload;
     payloadBuffer->nextPart = NULL;
 
     struct sBufferChain presentationBufferStruct;
@@ -448,20 +710,159 @@ IsoConnection_sendMessage(IsoConnection self, ByteBuffer* message, bool handlerM
         else
             printf("ISO_SERVER: IsoConnection_sendMessage success!\n");
     }
+}
+
+void
+IsoConnection_sendMessage(IsoConnection self, ByteBuffer* message, bool handlerMode)
+{
+#if (CONFIG_ISO_SERVER_SEND_QUEUE_SIZE > 0)
+    /* outside of the connection thread the message is sent by the send queue thread */
+    if (!handlerMode) {
+        IsoConnection_enqueueMessage(self, message, ISO_MESSAGE_DEFAULT);
+        return;
+    }
+#endif
+
+    if (self->state == ISO_CON_STATE_STOPPED) {
+        if (DEBUG_ISO_SERVER)
+            printf("DEBUG_ISO_SERVER: sendMessage: connection already stopped!\n");
+        return;
+    }
+
+    if (!handlerMode)
+        Semaphore_wait(self->conMutex);
+
+    sendPayload(self, message->buffer, message->size);
 
     if (!handlerMode)
         Semaphore_post(self->conMutex);
 }
 
+void
+IsoConnection_enqueueMessage(IsoConnection self, ByteBuffer* message, IsoMessageType messageType)
+{
+#if (CONFIG_ISO_SERVER_SEND_QUEUE_SIZE > 0)
+    if (self->state == ISO_CON_STATE_STOPPED) {
+        if (DEBUG_ISO_SERVER)
+            printf("DEBUG_ISO_SERVER: enqueueMessage: connection already stopped!\n");
+        return;
+    }
+
+    IsoSendQueueOverflowPolicy policy = IsoServer_getSendQueueOverflowPolicy(self->isoServer);
+
+    bool closeConnection = false;
+
+    Semaphore_wait(self->sendQueueLock);
+
+    if (self->sendThreadRunning == false)
+        goto exit_function;
+
+    if (self->sendQueueStatistics.queuedMessages >= CONFIG_ISO_SERVER_SEND_QUEUE_SIZE) {
+
+        if (policy == ISO_SEND_QUEUE_DISCONNECT) {
+            TRACE1(TRACE_SEND_QUEUE_DISCONNECT, TRACE_ID(self));
+
+            closeConnection = true;
+            goto exit_function;
+        }
+
+        /* messages that cannot be dropped are added even if the queue is full */
+        if (dropOldestMessage(self) == false) {
+            if (isDroppable(messageType)) {
+                TRACE2(TRACE_SEND_QUEUE_DROP_NEW, TRACE_ID(self), messageType);
+                self->sendQueueStatistics.droppedMessages++;
+                goto exit_function;
+            }
+        }
+    }
+
+    SendQueueEntry entry = getSendQueueEntry(self, message->size);
+
+    memcpy(entry->buffer, message->buffer, message->size);
+    entry->size = message->size;
+    entry->messageType = messageType;
+
+    if (self->sendQueueTail == NULL)
+        self->sendQueueHead = entry;
+    else
+        self->sendQueueTail->next = entry;
+
+    self->sendQueueTail = entry;
+
+    self->sendQueueStatistics.queuedMessages++;
+
+    if (self->sendQueueStatistics.queuedMessages > self->sendQueueStatistics.peakQueuedMessages)
+        self->sendQueueStatistics.peakQueuedMessages = self->sendQueueStatistics.queuedMessages;
+
+    Semaphore_post(self->sendQueueSignal);
+
+exit_function:
+    Semaphore_post(self->sendQueueLock);
+
+    if (closeConnection)
+        IsoConnection_close(self);
+#else
+    IsoConnection_sendMessage(self, message, false);
+#endif /* (CONFIG_ISO_SERVER_SEND_QUEUE_SIZE > 0) */
+}
+
+bool
+IsoConnection_canSendBufferedMessage(IsoConnection self)
+{
+    bool canSend = true;
+
+    if (self->state == ISO_CON_STATE_STOPPED)
+        return false;
+
+#if (CONFIG_ISO_SERVER_SEND_QUEUE_SIZE > 0)
+    IsoSendQueueOverflowPolicy policy = IsoServer_getSendQueueOverflowPolicy(self->isoServer);
+
+    if (policy != ISO_SEND_QUEUE_DISCONNECT) {
+        Semaphore_wait(self->sendQueueLock);
+
+        if (self->sendQueueStatistics.queuedMessages >= CONFIG_ISO_SERVER_SEND_QUEUE_SIZE) {
+
+            /* with DROP_OLDEST a queued unbuffered report makes room for the buffered report */
+            if (policy == ISO_SEND_QUEUE_DROP_OLDEST)
+                canSend = hasDroppableMessage(self);
+            else
+                canSend = false;
+        }
+
+        Semaphore_post(self->sendQueueLock);
+    }
+#endif
+
+    return canSend;
+}
+
+void
+IsoConnection_getSendQueueStatistics(IsoConnection self, IsoSendQueueStatistics* statistics)
+{
+#if (CONFIG_ISO_SERVER_SEND_QUEUE_SIZE > 0)
+    Semaphore_wait(self->sendQueueLock);
+
+    *statistics = self->sendQueueStatistics;
+
+    if (self->writeStartTime != 0)
+        statistics->stallTime = Hal_getTimeInMs() - self->writeStartTime;
+    else
+        statistics->stallTime = 0;
+
+    Semaphore_post(self->sendQueueLock);
+#else
+    memset(statistics, 0, sizeof(IsoSendQueueStatistics));
+#endif
+}
+
 void
 IsoConnection_close(IsoConnection self)
 {
     if (self->state != ISO_CON_STATE_STOPPED) {
-        Socket socket = self->socket;
         self->state = ISO_CON_STATE_STOPPED;
-        self->socket = NULL;
 
-        Socket_destroy(socket);
+        /* the socket is released by the connection thread */
+        Socket_shutdown(self->socket);
     }
 }
 
@@ -479,3 +880,23 @@ IsoConnection_getSecurityToken(IsoConnection self)
     return self->securityToken;
 }
 
+uint64_t
+IsoConnection_getMessageReceivedTime(IsoConnection self)
+{
+    return self->messageReceivedTime;
+}
+
+void
+IsoConnection_releaseHandlerLocks(IsoConnection self)
+{
+    Semaphore_post(self->conMutex);
+    IsoServer_userUnlock(self->isoServer);
+}
+
+void
+IsoConnection_acquireHandlerLocks(IsoConnection self)
+{
+    IsoServer_userLock(self->isoServer);
+    Semaphore_wait(self->conMutex);
+}
+
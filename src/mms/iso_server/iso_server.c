@@ -70,6 +70,8 @@ struct sIsoServer {
 
     Semaphore userLock;
 
+    IsoSendQueueOverflowPolicy sendQueueOverflowPolicy;
+
     Semaphore connectionCounterMutex;
     int connectionCounter;
 };
@@ -219,6 +221,8 @@ IsoServer_create()
     self->connectionCounterMutex = Semaphore_create(1);
     self->connectionCounter = 0;
 
+    self->sendQueueOverflowPolicy = ISO_SEND_QUEUE_PAUSE_BUFFERED;
+
     return self;
 }
 
@@ -228,6 +232,18 @@ IsoServer_setTcpPort(IsoServer self, int port)
     self->tcpPort = port;
 }
 
+void
+IsoServer_setSendQueueOverflowPolicy(IsoServer self, IsoSendQueueOverflowPolicy policy)
+{
+    self->sendQueueOverflowPolicy = policy;
+}
+
+IsoSendQueueOverflowPolicy
+IsoServer_getSendQueueOverflowPolicy(IsoServer self)
+{
+    return self->sendQueueOverflowPolicy;
+}
+
 void
 IsoServer_setLocalIpAddress(IsoServer self, char* ipAddress)
 {
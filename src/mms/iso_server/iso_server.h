@@ -49,6 +49,46 @@ typedef enum
 
 typedef struct sIsoConnection* IsoConnection;
 
+/**
+ * \brief What happens when the send queue of a connection is full (the client doesn't read fast enough)
+ */
+typedef enum
+{
+    /** drop the oldest queued unbuffered report. Buffered reports replace queued unbuffered reports.
+     * When there is none left, buffered reports are paused (the entries stay in the report buffer) */
+    ISO_SEND_QUEUE_DROP_OLDEST,
+
+    /** drop the oldest queued unbuffered report, stop sending buffered reports (the entries stay in the report buffer) */
+    ISO_SEND_QUEUE_PAUSE_BUFFERED,
+
+    /** close the connection */
+    ISO_SEND_QUEUE_DISCONNECT
+} IsoSendQueueOverflowPolicy;
+
+/**
+ * \brief Type of an outgoing message. Defines how a message is treated when the send queue is full.
+ */
+typedef enum
+{
+    /** message is never dropped (responses, command termination) */
+    ISO_MESSAGE_DEFAULT,
+
+    /** message can be dropped (unbuffered reports) */
+    ISO_MESSAGE_UNBUFFERED,
+
+    /** message content is kept by the application until it is sent (buffered reports) */
+    ISO_MESSAGE_BUFFERED
+} IsoMessageType;
+
+typedef struct
+{
+    int queuedMessages;        /* number of messages in the send queue */
+    int peakQueuedMessages;    /* maximum number of messages in the send queue */
+    uint32_t droppedMessages;  /* messages dropped because the send queue was full */
+    uint64_t stallTime;        /* time in ms the pending write is blocked (0 if no write is pending) */
+    uint64_t totalStallTime;   /* accumulated time in ms spent in blocked writes */
+} IsoSendQueueStatistics;
+
 typedef struct sIsoServerCallbacks
 {
     void
@@ -75,15 +115,69 @@ IsoConnection_installListener(IsoConnection self, MessageReceivedHandler handler
 void*
 IsoConnection_getSecurityToken(IsoConnection self);
 
+/**
+ * \brief get the time when the message that is currently handled was received
+ *
+ * \return the time of the monotonic clock (see Hal_getMonotonicTimeInNs) or 0 if not recorded
+ */
+uint64_t
+IsoConnection_getMessageReceivedTime(IsoConnection self);
+
+/**
+ * \brief release the locks that are held while the message received handler is called
+ *
+ * Can be used by the message received handler before a blocking operation. The user lock and the
+ * connection lock are released. The response buffer must not be accessed until the locks are
+ * acquired again with IsoConnection_acquireHandlerLocks.
+ */
+void
+IsoConnection_releaseHandlerLocks(IsoConnection self);
+
+/**
+ * \brief acquire the locks released by IsoConnection_releaseHandlerLocks again
+ *
+ * The locks are acquired in the same order as before the message received handler is called.
+ */
+void
+IsoConnection_acquireHandlerLocks(IsoConnection self);
+
 /**
  * \brief send a message over an ISO connection
  *
+ * Outside of the connection handling thread the message is added to the send queue of the connection
+ * (see IsoConnection_enqueueMessage). Messages sent with this function are never dropped.
+ *
  * \param handlerMode specifies if this function is used in the context of the connection handling thread
  *        (handlerMode)
  */
 void
 IsoConnection_sendMessage(IsoConnection self, ByteBuffer* message, bool handlerMode);
 
+/**
+ * \brief send a message over an ISO connection without waiting for the TCP socket
+ *
+ * The message is copied to the send queue of the connection that is processed by a separate
+ * thread. When the send queue is full the overflow policy of the server is applied.
+ * If the send queue is disabled (CONFIG_ISO_SERVER_SEND_QUEUE_SIZE = 0) the message is sent
+ * immediately.
+ *
+ * \param messageType specifies if the message may be dropped when the send queue is full
+ */
+void
+IsoConnection_enqueueMessage(IsoConnection self, ByteBuffer* message, IsoMessageType messageType);
+
+/**
+ * \brief check if a buffered report can be sent
+ *
+ * \return false when the connection is closed or the send queue is full and buffered reports
+ *         are paused, true otherwise
+ */
+bool
+IsoConnection_canSendBufferedMessage(IsoConnection self);
+
+void
+IsoConnection_getSendQueueStatistics(IsoConnection self, IsoSendQueueStatistics* statistics);
+
 IsoServer
 IsoServer_create(void);
 
@@ -100,6 +194,12 @@ void
 IsoServer_setConnectionHandler(IsoServer self, ConnectionIndicationHandler handler,
         void* parameter);
 
+void
+IsoServer_setSendQueueOverflowPolicy(IsoServer self, IsoSendQueueOverflowPolicy policy);
+
+IsoSendQueueOverflowPolicy
+IsoServer_getSendQueueOverflowPolicy(IsoServer self);
+
 void
 IsoServer_setAuthenticator(IsoServer self, AcseAuthenticator authenticator, void* authenticatorParameter);
 